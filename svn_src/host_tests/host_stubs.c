@@ -0,0 +1,37 @@
+/** @file host_stubs.c
+ *  @brief Host Test Stubs
+ *
+ *  Host replacements for the BSP functions used by the framework code under test.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "xil_types.h"
+#include "host_test.h"
+
+unsigned int host_test_num_failures = 0;
+
+void xil_printf(const char *ctrl1, ...){
+	va_list args;
+
+	va_start(args, ctrl1);
+	vprintf(ctrl1, args);
+	va_end(args);
+}
+
+u16 Xil_EndianSwap16(u16 Data){
+	return (u16)((Data >> 8) | (Data << 8));
+}
+
+u32 Xil_EndianSwap32(u32 Data){
+	return ((Data >> 24) & 0x000000FF) | ((Data >> 8) & 0x0000FF00) |
+	       ((Data << 8) & 0x00FF0000) | ((Data << 24) & 0xFF000000);
+}
@@ -0,0 +1,39 @@
+/** @file host_test.h
+ *  @brief Host Test Helpers
+ *
+ *  Minimal check macros shared by the host-compiled tests.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdio.h>
+
+// Number of failed checks in the test (defined by host_stubs.c)
+extern unsigned int host_test_num_failures;
+
+// Report a failed check; printing is limited so an exhaustive sweep stays readable
+#define HOST_TEST_CHECK(cond, ...)                                                   \
+	do {                                                                             \
+		if (!(cond)) {                                                               \
+			if (host_test_num_failures++ < 20) {                                     \
+				printf("FAIL %s:%d: ", __FILE__, __LINE__);                          \
+				printf(__VA_ARGS__);                                                 \
+				printf("\n");                                                        \
+			}                                                                        \
+		}                                                                            \
+	} while (0)
+
+// Print the result and return the exit status for main()
+#define HOST_TEST_RESULT(name)                                                       \
+	((host_test_num_failures == 0) ? (printf("PASS %s\n", name), 0)                   \
+	                               : (printf("FAIL %s (%u failed checks)\n", name, host_test_num_failures), 1))
+
+#endif /* HOST_TEST_H_ */
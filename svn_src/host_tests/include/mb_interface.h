@@ -0,0 +1,28 @@
+/** @file mb_interface.h
+ *  @brief Host Test MicroBlaze Interface
+ *
+ *  Replaces the BSP mb_interface.h for host-compiled tests. It is force-included
+ *  (-include mb_interface.h) so the BSP copy is skipped by its include guard.
+ *
+ *  Only the memory barrier reached through xil_io.h (INST_SYNC / DATA_SYNC) and
+ *  the data cache range functions behind xil_cache.h are provided. On the host
+ *  the barrier is a compiler barrier; a test that reaches the cache functions
+ *  defines them.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#ifndef _MICROBLAZE_INTERFACE_H_
+#define _MICROBLAZE_INTERFACE_H_
+
+extern void microblaze_invalidate_dcache_range(unsigned int cacheaddr, unsigned int len);
+extern void microblaze_flush_dcache_range(unsigned int cacheaddr, unsigned int len);
+
+#define mbar(mask)                                         __asm__ __volatile__ ("" ::: "memory")
+
+#endif /* _MICROBLAZE_INTERFACE_H_ */
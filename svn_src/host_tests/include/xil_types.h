@@ -0,0 +1,49 @@
+/** @file xil_types.h
+ *  @brief Host Test Types
+ *
+ *  Replaces the BSP xil_types.h for host-compiled tests. It is force-included
+ *  (-include xil_types.h) so the BSP copy is skipped by its include guard.
+ *
+ *  The BSP defines u32 as unsigned long, which is 64 bits on an LP64 host, so
+ *  the fixed-width types are used instead. 64-bit types are limited to 4-byte
+ *  alignment, as on the MicroBlaze, so that structs shared with wlan_exp keep
+ *  the sizes checked by ASSERT_TYPE_SIZE().
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#ifndef XIL_TYPES_H
+#define XIL_TYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef TRUE
+#  define TRUE                                             1
+#endif
+
+#ifndef FALSE
+#  define FALSE                                            0
+#endif
+
+#define XIL_COMPONENT_IS_READY                             0x11111111
+#define XIL_COMPONENT_IS_STARTED                           0x22222222
+
+typedef uint8_t        u8;
+typedef uint16_t       u16;
+typedef uint32_t       u32;
+typedef uint64_t       u64 __attribute__ ((aligned(4)));
+
+typedef char           s8;
+typedef int16_t        s16;
+typedef int32_t        s32;
+typedef int64_t        s64 __attribute__ ((aligned(4)));
+
+typedef uintptr_t      UINTPTR;
+
+#endif /* XIL_TYPES_H */
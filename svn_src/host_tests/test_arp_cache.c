@@ -0,0 +1,231 @@
+/** @file test_arp_cache.c
+ *  @brief Host Test - wlan_exp ARP Cache
+ *
+ *  Drives the ARP cache of the wlan_exp IP/UDP library with random update,
+ *  lookup and timeout sequences and compares it against a reference LRU model.
+ *  After every operation the test checks the lookup result, the order of the
+ *  cache's LRU list and the consistency of its hash index.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "xstatus.h"
+#include "wlan_exp_ip_udp.h"
+#include "wlan_exp_ip_udp_internal.h"
+
+
+#define TEST_NUM_OPS                                       3000000
+#define TEST_NUM_ETH_DEVICES                               2
+#define TEST_NUM_HOSTS                                     40          ///< Hosts per Ethernet device; more than the cache holds
+
+// Defined by wlan_exp_ip_udp_eth.c, which is not linked into this test
+volatile eth_int_enable_func_ptr_t     interrupt_enable_callback;
+volatile eth_int_disable_func_ptr_t    interrupt_disable_callback;
+
+void arp_init_cache();
+
+
+//-----------------------------------------------
+// Reference model
+//     - model[0] is the most recently used entry
+//
+typedef struct {
+	u32 eth_dev_num;
+	u8  paddr[IP_ADDR_LEN];
+	u8  haddr[ETH_ADDR_LEN];
+	u64 timestamp;
+} test_model_entry_t;
+
+static test_model_entry_t model[WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES];
+static u32                model_num_entries;
+
+static u64                test_time;
+
+
+static int  test_int_disable(){ return 0; }
+static int  test_int_enable(int status){ return 0; }
+static u64  test_get_time(){ return test_time; }
+
+static int model_find(u32 eth_dev_num, u8* paddr){
+	u32 i;
+
+	for (i = 0; i < model_num_entries; i++) {
+		if ((model[i].eth_dev_num == eth_dev_num) && (memcmp(model[i].paddr, paddr, IP_ADDR_LEN) == 0)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void model_remove(u32 index){
+	memmove(&model[index], &model[index + 1], (model_num_entries - index - 1) * sizeof(test_model_entry_t));
+	model_num_entries--;
+}
+
+static void model_add_head(test_model_entry_t* entry){
+	memmove(&model[1], &model[0], model_num_entries * sizeof(test_model_entry_t));
+	model[0] = *entry;
+	model_num_entries++;
+}
+
+static void model_update(u32 eth_dev_num, u8* haddr, u8* paddr){
+	test_model_entry_t entry;
+	int                index = model_find(eth_dev_num, paddr);
+
+	if (index >= 0) {
+		entry = model[index];
+		model_remove(index);
+	} else {
+		// The least recently used entry is replaced when the cache is full
+		if (model_num_entries == WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES) {
+			model_num_entries--;
+		}
+		entry.eth_dev_num = eth_dev_num;
+		memcpy(entry.paddr, paddr, IP_ADDR_LEN);
+	}
+
+	memcpy(entry.haddr, haddr, ETH_ADDR_LEN);
+	entry.timestamp = test_time;
+	model_add_head(&entry);
+}
+
+static int model_lookup(u32 eth_dev_num, u8* haddr, u8* paddr){
+	test_model_entry_t entry;
+	int                index = model_find(eth_dev_num, paddr);
+
+	if (index < 0) return XST_FAILURE;
+
+	entry = model[index];
+	model_remove(index);
+
+	if ((test_time - entry.timestamp) > WLAN_EXP_IP_UDP_ARP_TIMEOUT_USEC) {
+		return XST_FAILURE;
+	}
+
+	memcpy(haddr, entry.haddr, ETH_ADDR_LEN);
+	entry.timestamp = test_time;
+	model_add_head(&entry);
+
+	return XST_SUCCESS;
+}
+
+
+//-----------------------------------------------
+// Cache checks
+//
+static void test_check_cache(u32 op){
+	u32 index;
+	u32 num_used   = 0;
+	u32 num_listed = 0;
+	u32 num_hashed = 0;
+	u32 prev       = ARP_CACHE_NULL_INDEX;
+	u32 bucket;
+	arp_cache_entry* entry;
+
+	// LRU list:  used entries in the model's order, then every unused entry
+	for (index = ETH_arp_lru_head; index != ARP_CACHE_NULL_INDEX; index = entry->lru_next) {
+		HOST_TEST_CHECK(index < WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES, "op %u: LRU index %u out of range", op, index);
+		if (index >= WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES) return;
+
+		entry = &(ETH_arp_cache[index]);
+
+		HOST_TEST_CHECK(entry->lru_prev == prev, "op %u: entry %u has lru_prev %u, expected %u", op, index, entry->lru_prev, prev);
+		HOST_TEST_CHECK(num_listed < WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES, "op %u: LRU list loops", op);
+		if (num_listed++ >= WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES) return;
+
+		if (entry->state == ARP_TABLE_USED) {
+			HOST_TEST_CHECK(num_used == (num_listed - 1), "op %u: used entry %u behind an unused entry", op, index);
+			HOST_TEST_CHECK((num_used < model_num_entries) &&
+			                (entry->eth_dev_num == model[num_used].eth_dev_num) &&
+			                (memcmp(entry->paddr, model[num_used].paddr, IP_ADDR_LEN) == 0) &&
+			                (memcmp(entry->haddr, model[num_used].haddr, ETH_ADDR_LEN) == 0),
+			                "op %u: LRU position %u does not match the model", op, num_used);
+			num_used++;
+		}
+		prev = index;
+	}
+
+	HOST_TEST_CHECK(ETH_arp_lru_tail == prev, "op %u: LRU tail %u, expected %u", op, ETH_arp_lru_tail, prev);
+	HOST_TEST_CHECK(num_listed == WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES, "op %u: %u entries on the LRU list", op, num_listed);
+	HOST_TEST_CHECK(num_used == model_num_entries, "op %u: %u used entries, model has %u", op, num_used, model_num_entries);
+
+	// Hash index:  exactly the used entries
+	for (bucket = 0; bucket < WLAN_EXP_IP_UDP_ARP_HASH_NUM_BUCKETS; bucket++) {
+		if (ETH_arp_hash[bucket] == 0) continue;
+
+		num_hashed++;
+		HOST_TEST_CHECK(ETH_arp_cache[ETH_arp_hash[bucket] - 1].state == ARP_TABLE_USED,
+		                "op %u: bucket %u indexes unused entry %u", op, bucket, ETH_arp_hash[bucket] - 1);
+	}
+
+	HOST_TEST_CHECK(num_hashed == num_used, "op %u: %u hashed entries for %u used", op, num_hashed, num_used);
+}
+
+
+int main(){
+	u32 op;
+	u32 eth_dev_num;
+	u8  paddr[IP_ADDR_LEN];
+	u8  haddr[ETH_ADDR_LEN];
+	u8  haddr_out[ETH_ADDR_LEN];
+	u8  haddr_model[ETH_ADDR_LEN];
+	int status;
+	int expected;
+
+	srand(1);
+
+	interrupt_enable_callback  = test_int_enable;
+	interrupt_disable_callback = test_int_disable;
+	arp_set_time_callback(test_get_time);
+
+	test_time = 1;
+	arp_init_cache();
+	test_check_cache(0);
+
+	for (op = 1; op <= TEST_NUM_OPS; op++) {
+		eth_dev_num = rand() % TEST_NUM_ETH_DEVICES;
+
+		paddr[0] = 10;
+		paddr[1] = 0;
+		paddr[2] = 0;
+		paddr[3] = 1 + (rand() % TEST_NUM_HOSTS);
+
+		// Advance time so that some entries go unused past the timeout
+		test_time += rand() % (WLAN_EXP_IP_UDP_ARP_TIMEOUT_USEC / 16);
+
+		if (rand() & 1) {
+			haddr[0] = 0x40; haddr[1] = 0xD8; haddr[2] = 0x55;
+			haddr[3] = rand(); haddr[4] = rand(); haddr[5] = rand();
+
+			status = arp_update_cache(eth_dev_num, haddr, paddr);
+			model_update(eth_dev_num, haddr, paddr);
+
+			HOST_TEST_CHECK(status == XST_SUCCESS, "op %u: update failed", op);
+		} else {
+			memset(haddr_out, 0, sizeof(haddr_out));
+			memset(haddr_model, 0, sizeof(haddr_model));
+
+			status   = arp_get_hw_addr(eth_dev_num, haddr_out, paddr);
+			expected = model_lookup(eth_dev_num, haddr_model, paddr);
+
+			HOST_TEST_CHECK(status == expected, "op %u: lookup of dev %u host %u returned %d, expected %d", op, eth_dev_num, paddr[3], status, expected);
+			HOST_TEST_CHECK(memcmp(haddr_out, haddr_model, ETH_ADDR_LEN) == 0, "op %u: lookup returned the wrong hardware address", op);
+		}
+
+		test_check_cache(op);
+
+		if (host_test_num_failures) break;
+	}
+
+	return HOST_TEST_RESULT("arp_cache");
+}
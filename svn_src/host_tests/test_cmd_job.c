@@ -0,0 +1,365 @@
+/** @file test_cmd_job.c
+ *  @brief Host Test - wlan_exp Deferred Commands
+ *
+ *  Checks the deferred command jobs of wlan_exp_node.c:
+ *      - node_cmd_job_start() / node_cmd_job_poll() with a test step function:
+ *        job IDs, one job at a time, one step per poll of the job's Ethernet
+ *        device and no steps once the job is done
+ *      - A deferred log transfer (node_log_transfer_start()) driven from a
+ *        simulated main loop against a simulated Ethernet Tx ring. The packets
+ *        the Tx ring sends must match the packets of the blocking transfer
+ *        (transfer_log_data()) byte for byte. No step may send more than
+ *        WLAN_EXP_CMD_JOB_MAX_PKTS_PER_POLL packets or queue a packet the Tx
+ *        ring has no descriptors for, which is when the Ethernet send waits
+ *        with interrupts disabled.
+ *
+ *  The Tx ring reads each packet's header and data when the packet is sent,
+ *  not when it is queued, so a header buffer reused too early is caught.
+ *
+ *  This test is linked with -no-pie: wlan_exp_node.c computes buffer addresses
+ *  in 32-bit words, so the buffers must be static and below 4 GB.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "xil_io.h"
+#include "xstatus.h"
+#include "wlan_exp_common.h"
+#include "wlan_exp_node.h"
+#include "wlan_exp_ip_udp.h"
+
+
+#define TEST_ETH_DEV_NUM                                   1
+#define TEST_SOCKET_INDEX                                  0
+#define TEST_MAX_RESP_LEN                                  363         ///< Words; 1452 byte payload, as for a 1500 byte MTU
+#define TEST_LOG_SIZE                                      (1 << 20)
+#define TEST_NUM_TRANSFERS                                 200
+#define TEST_MAX_PKTS                                      2048
+#define TEST_MAX_PKT_SIZE                                  2048
+#define TEST_MAX_PKTS_PER_POLL                             4           ///< WLAN_EXP_CMD_JOB_MAX_PKTS_PER_POLL in wlan_exp_node.c
+#define TEST_MAX_TX_BDS                                    17          ///< Largest Tx ring the deferred transfer accepts
+#define TEST_STALL_POLLS                                   10000
+
+// Defined in wlan_exp_node.c
+void transfer_log_data(u32 socket_index, void* from, void* resp_buffer_data, u32 eth_dev_num, u32 max_resp_len,
+                       u32 id, u32 flags, u32 start_index, u32 size);
+int  node_log_transfer_start(int socket_index, void* from, void* resp_buffer_data, u32 max_resp_len,
+                             u32 id, u32 flags, u32 start_index, u32 size, u32* job_id);
+
+
+//-----------------------------------------------
+// Packets sent by the simulated Tx ring
+//
+typedef struct {
+	u32 size;
+	u8  data[TEST_MAX_PKT_SIZE];
+} test_pkt_t;
+
+typedef struct {
+	test_pkt_t pkts[TEST_MAX_PKTS];
+	u32        num_pkts;
+} test_pkt_list_t;
+
+static test_pkt_list_t        test_ref_pkts;                   // Sent by transfer_log_data()
+static test_pkt_list_t        test_job_pkts;                   // Sent by the deferred transfer
+
+
+//-----------------------------------------------
+// Simulated Ethernet Tx ring
+//     - A packet takes one descriptor per buffer until the ring sends it
+//
+typedef struct {
+	u32                       num_buffers;
+	wlan_exp_ip_udp_buffer    buffers[2];
+} test_tx_pkt_t;
+
+static test_tx_pkt_t          test_tx_ring[TEST_MAX_TX_BDS];
+static u32                    test_tx_head;                    // Next packet the ring sends
+static u32                    test_tx_num_pkts;                // Packets queued
+static u32                    test_tx_num_bds_used;
+static u32                    test_tx_num_bds;                 // Size of the Tx ring in descriptors
+static u32                    test_tx_send_immediately;        // Send each packet as it is queued
+static u32                    test_tx_num_queued;              // Packets queued since the last check
+static test_pkt_list_t      * test_tx_pkt_list;
+
+static u8                     test_log[TEST_LOG_SIZE];
+static u8                     test_resp_data[256];
+static wlan_exp_ip_udp_header test_socket_header;
+static struct sockaddr_in     test_from;
+static u64                    test_time;
+
+
+static void test_tx_send_pkt(){
+	test_tx_pkt_t * tx_pkt = &test_tx_ring[test_tx_head];
+	test_pkt_t    * pkt;
+	u32             i;
+
+	HOST_TEST_CHECK(test_tx_pkt_list->num_pkts < TEST_MAX_PKTS, "too many packets");
+	if (test_tx_pkt_list->num_pkts >= TEST_MAX_PKTS) return;
+
+	pkt       = &test_tx_pkt_list->pkts[test_tx_pkt_list->num_pkts++];
+	pkt->size = 0;
+
+	for (i = 0; i < tx_pkt->num_buffers; i++) {
+		memcpy(&pkt->data[pkt->size], tx_pkt->buffers[i].offset, tx_pkt->buffers[i].length);
+		pkt->size += tx_pkt->buffers[i].length;
+	}
+
+	test_tx_head          = (test_tx_head + 1) % TEST_MAX_TX_BDS;
+	test_tx_num_pkts     -= 1;
+	test_tx_num_bds_used -= tx_pkt->num_buffers;
+}
+
+int eth_get_num_tx_descriptors(){
+	return test_tx_num_bds;
+}
+
+int eth_get_num_free_tx_descriptors(u32 eth_dev_num){
+	return test_tx_num_bds - test_tx_num_bds_used;
+}
+
+int socket_sendto_raw(int socket_index, wlan_exp_ip_udp_buffer ** buffers, u32 num_buffers){
+	test_tx_pkt_t * tx_pkt;
+	u32             i;
+	u32             size = 0;
+
+	HOST_TEST_CHECK(num_buffers <= 2, "packet with %u buffers", num_buffers);
+	if (num_buffers > 2) return WLAN_EXP_IP_UDP_FAILURE;
+
+	// The Ethernet send waits here, with interrupts disabled, until the ring has room
+	HOST_TEST_CHECK((test_tx_num_bds - test_tx_num_bds_used) >= num_buffers, "packet queued on a full Tx ring");
+	if ((test_tx_num_bds - test_tx_num_bds_used) < num_buffers) return WLAN_EXP_IP_UDP_FAILURE;
+
+	tx_pkt = &test_tx_ring[(test_tx_head + test_tx_num_pkts) % TEST_MAX_TX_BDS];
+	tx_pkt->num_buffers = num_buffers;
+
+	for (i = 0; i < num_buffers; i++) {
+		tx_pkt->buffers[i] = *(buffers[i]);
+		size += buffers[i]->length;
+	}
+
+	HOST_TEST_CHECK(size <= TEST_MAX_PKT_SIZE, "packet of %u bytes", size);
+
+	test_tx_num_pkts     += 1;
+	test_tx_num_bds_used += num_buffers;
+	test_tx_num_queued   += 1;
+
+	if (test_tx_send_immediately) test_tx_send_pkt();
+
+	return size;
+}
+
+
+//-----------------------------------------------
+// Stubs for the rest of the node
+//     - IP / UDP header updates are checked by test_ip_udp_checksum
+//
+u32 socket_get_eth_dev_num(int socket_index){
+	return TEST_ETH_DEV_NUM;
+}
+
+wlan_exp_ip_udp_header* socket_get_wlan_exp_ip_udp_header(int socket_index){
+	return &test_socket_header;
+}
+
+int arp_get_hw_addr(u32 eth_dev_num, u8 * hw_addr, u8 * ip_addr){
+	u8 addr[ETH_ADDR_LEN] = { 0x40, 0xD8, 0x55, 0x04, 0x20, 0x01 };
+
+	memcpy(hw_addr, addr, ETH_ADDR_LEN);
+	return XST_SUCCESS;
+}
+
+void ipv4_update_header(ipv4_header * header, u32 dest_ip_addr, u16 ip_length, u8 protocol){
+	header->total_length = Xil_Htons(ip_length);
+	header->dest_ip_addr = dest_ip_addr;
+	header->protocol     = protocol;
+}
+
+void udp_update_checksum(wlan_exp_ip_udp_header * header, u32 header_size, wlan_exp_ip_udp_buffer ** buffers, u32 num_buffers){ }
+
+volatile u64 get_system_time_usec(){
+	return test_time;
+}
+
+u32 event_log_get_data(u32 start_index, u32 size, void* buffer, u8 copy_data){
+	u32 num_bytes = size;
+
+	if (start_index > TEST_LOG_SIZE) return 0;
+	if ((start_index + size) > TEST_LOG_SIZE) num_bytes = TEST_LOG_SIZE - start_index;
+
+	((wlan_exp_ip_udp_buffer *)buffer)->data   = &test_log[start_index];
+	((wlan_exp_ip_udp_buffer *)buffer)->offset = &test_log[start_index];
+	((wlan_exp_ip_udp_buffer *)buffer)->length = num_bytes;
+	((wlan_exp_ip_udp_buffer *)buffer)->size   = num_bytes;
+
+	return num_bytes;
+}
+
+
+//-----------------------------------------------
+// Job machinery
+//
+static u32 test_step_num_calls;
+static u32 test_step_arg;
+
+static int test_step(u32 arg, u32* status){
+	test_step_num_calls++;
+	test_step_arg = arg;
+
+	if (test_step_num_calls == arg) {
+		*status = CMD_PARAM_SUCCESS;
+		return CMD_PARAM_NODE_CMD_JOB_DONE;
+	}
+	return CMD_PARAM_NODE_CMD_JOB_RUNNING;
+}
+
+static void test_job_machinery(u32* job_id){
+	u32 prev_job_id = *job_id;
+	u32 other_job_id;
+	u32 i;
+
+	test_step_num_calls = 0;
+
+	HOST_TEST_CHECK(node_cmd_job_start(TEST_SOCKET_INDEX, CMDID_LOG_GET_ENTRIES, (function_ptr_t)test_step, 5, job_id) == XST_SUCCESS,
+	                "job start failed");
+	HOST_TEST_CHECK(*job_id == (prev_job_id + 1), "job ID %u after %u", *job_id, prev_job_id);
+
+	// Only one job at a time
+	HOST_TEST_CHECK(node_cmd_job_start(TEST_SOCKET_INDEX, CMDID_LOG_GET_ENTRIES, (function_ptr_t)test_step, 1, &other_job_id) == XST_FAILURE,
+	                "second job started while the first is running");
+
+	// Only the job's Ethernet device runs it
+	node_cmd_job_poll(TEST_ETH_DEV_NUM - 1);
+	HOST_TEST_CHECK(test_step_num_calls == 0, "job stepped by the poll of another Ethernet device");
+
+	for (i = 0; i < 8; i++) {
+		node_cmd_job_poll(TEST_ETH_DEV_NUM);
+	}
+
+	HOST_TEST_CHECK(test_step_num_calls == 5, "job took %u steps, expected 5", test_step_num_calls);
+	HOST_TEST_CHECK(test_step_arg == 5, "step called with %u", test_step_arg);
+}
+
+
+//-----------------------------------------------
+// Deferred log transfer
+//
+static void test_log_transfer(u32 num_tx_bds, u32* job_id){
+	u32 start_index;
+	u32 size;
+	u32 id;
+	u32 flags;
+	u32 i;
+	u32 n;
+	u32 polls;
+	u32 prev_job_id;
+	u32 other_job_id;
+
+	start_index = rand() % TEST_LOG_SIZE;
+	size        = (rand() & 0x7) ? (rand() % (TEST_LOG_SIZE - start_index + 1)) : (rand() % 4096);
+	size        = (size > (TEST_MAX_PKTS - 1) * 1400) ? ((TEST_MAX_PKTS - 1) * 1400) : size;
+	id          = rand();
+	flags       = rand();
+
+	test_tx_num_bds = num_tx_bds;
+
+	// Reference:  blocking transfer, every packet sent as it is queued
+	test_ref_pkts.num_pkts   = 0;
+	test_tx_pkt_list         = &test_ref_pkts;
+	test_tx_send_immediately = 1;
+
+	transfer_log_data(TEST_SOCKET_INDEX, &test_from, test_resp_data, TEST_ETH_DEV_NUM, TEST_MAX_RESP_LEN, id, flags, start_index, size);
+
+	// Deferred transfer from the main loop; the Tx ring sends a random number of packets between polls
+	test_job_pkts.num_pkts   = 0;
+	test_tx_pkt_list         = &test_job_pkts;
+	test_tx_send_immediately = 0;
+	prev_job_id              = *job_id;
+
+	HOST_TEST_CHECK(node_log_transfer_start(TEST_SOCKET_INDEX, &test_from, test_resp_data, TEST_MAX_RESP_LEN,
+	                                        id, flags, start_index, size, job_id) == XST_SUCCESS, "log transfer start failed");
+	HOST_TEST_CHECK(*job_id == (prev_job_id + 1), "job ID %u after %u", *job_id, prev_job_id);
+
+	for (polls = 0; (test_job_pkts.num_pkts + test_tx_num_pkts) < test_ref_pkts.num_pkts; polls++) {
+		test_tx_num_queued = 0;
+		test_time         += 10;
+
+		node_cmd_job_poll(TEST_ETH_DEV_NUM);
+
+		HOST_TEST_CHECK(test_tx_num_queued <= TEST_MAX_PKTS_PER_POLL, "step queued %u packets", test_tx_num_queued);
+
+		n = rand() % (test_tx_num_pkts + 1);
+		for (i = 0; i < n; i++) test_tx_send_pkt();
+
+		// A command arriving while the transfer runs cannot be deferred as well
+		if (((polls % 64) == 0) && ((test_job_pkts.num_pkts + test_tx_num_pkts) < test_ref_pkts.num_pkts)) {
+			HOST_TEST_CHECK(node_cmd_job_start(TEST_SOCKET_INDEX, CMDID_LOG_GET_ENTRIES, (function_ptr_t)test_step, 1, &other_job_id) == XST_FAILURE,
+			                "job started during the log transfer");
+		}
+
+		HOST_TEST_CHECK(polls < TEST_STALL_POLLS, "log transfer stalled after %u of %u packets", test_job_pkts.num_pkts + test_tx_num_pkts, test_ref_pkts.num_pkts);
+		if (host_test_num_failures) return;
+	}
+
+	// An empty transfer is done on its first step
+	if (size == 0) node_cmd_job_poll(TEST_ETH_DEV_NUM);
+
+	while (test_tx_num_pkts) test_tx_send_pkt();
+
+	// The transfer is done:  no more packets, and the next command can be deferred
+	node_cmd_job_poll(TEST_ETH_DEV_NUM);
+	HOST_TEST_CHECK(test_tx_num_pkts == 0, "packets queued after the log transfer");
+
+	HOST_TEST_CHECK(test_job_pkts.num_pkts == test_ref_pkts.num_pkts, "%u packets, expected %u", test_job_pkts.num_pkts, test_ref_pkts.num_pkts);
+
+	for (i = 0; i < test_ref_pkts.num_pkts; i++) {
+		HOST_TEST_CHECK((test_job_pkts.pkts[i].size == test_ref_pkts.pkts[i].size) &&
+		                (memcmp(test_job_pkts.pkts[i].data, test_ref_pkts.pkts[i].data, test_ref_pkts.pkts[i].size) == 0),
+		                "index 0x%x, size %u, Tx ring of %u: packet %u differs from the blocking transfer", start_index, size, num_tx_bds, i);
+		if (host_test_num_failures) return;
+	}
+
+	test_job_machinery(job_id);
+}
+
+
+int main(){
+	u32 i;
+	u32 job_id = 0;
+
+	srand(1);
+
+	// The refused starts below are expected
+	wlan_exp_set_print_level(WLAN_EXP_PRINT_NONE);
+
+	for (i = 0; i < TEST_LOG_SIZE; i++) test_log[i] = rand();
+	for (i = 0; i < sizeof(test_resp_data); i++) test_resp_data[i] = rand();
+	for (i = 0; i < sizeof(test_socket_header); i++) ((u8*)&test_socket_header)[i] = rand();
+
+	test_from.sin_family      = 2;
+	test_from.sin_port        = Xil_Htons(9500);
+	test_from.sin_addr.s_addr = Xil_Htonl(0x0A000001);
+
+	test_job_machinery(&job_id);
+
+	for (i = 0; (i < TEST_NUM_TRANSFERS) && !host_test_num_failures; i++) {
+		test_log_transfer((i & 1) ? 10 : TEST_MAX_TX_BDS, &job_id);
+	}
+
+	// A Tx ring deeper than the header ring is refused
+	test_tx_num_bds = TEST_MAX_TX_BDS + 2;
+	HOST_TEST_CHECK(node_log_transfer_start(TEST_SOCKET_INDEX, &test_from, test_resp_data, TEST_MAX_RESP_LEN,
+	                                        0, 0, 0, 1, &job_id) == XST_FAILURE, "log transfer started with a Tx ring of %u", test_tx_num_bds);
+
+	return HOST_TEST_RESULT("cmd_job");
+}
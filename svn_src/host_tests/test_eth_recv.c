@@ -0,0 +1,308 @@
+/** @file test_eth_recv.c
+ *  @brief Host Test - wlan_exp Ethernet Receive Batching
+ *
+ *  Runs eth_recv_frame() / eth_free_recv_buffers() against an AXI DMA Rx BD
+ *  ring built with the BSP's own BD ring driver. The driver enforces the
+ *  in-order rules of the ring (BDs are freed in the order they were taken from
+ *  hardware and allocated / returned in the order they were freed). The test
+ *  plays the DMA engine, completing BDs of the hardware group in order with
+ *  frames that are:
+ *      - for the node (delivered to the caller)
+ *      - for another node, ARP or empty (freed by the library)
+ *      - marked with a DMA error (freed by the library, reported as a failure)
+ *
+ *  Every delivered frame must be the next frame for the node, in the buffer it
+ *  was written to, and no frame may be lost or the ring stalled.
+ *
+ *  This test is linked with -no-pie: the BSP driver keeps BD and buffer
+ *  addresses in 32-bit words, so they must be static and below 4 GB.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xaxidma.h"
+#include "wlan_exp_ip_udp.h"
+#include "wlan_exp_ip_udp_internal.h"
+
+
+#define TEST_ETH_DEV_NUM                                   1
+#define TEST_NUM_RX_BDS                                    WLAN_EXP_IP_UDP_ETH_1_RXBD_CNT
+#define TEST_NUM_FRAMES                                    500000
+#define TEST_MAX_FRAME_SIZE                                256
+#define TEST_STALL_DMA_ATTEMPTS                            1000
+#define TEST_ERROR_FRAME_INTERVAL                          100000      ///< Keep error frames rare; each prints an error message
+
+#define ADDR32(x)                                          ((u32)(uintptr_t)(x))
+
+// Defined by wlan_exp_ip_udp_config.c, which is not linked into this test
+ethernet_device        eth_device[WLAN_EXP_IP_UDP_NUM_ETH_DEVICES];
+
+
+//-----------------------------------------------
+// Frames written by the test DMA engine
+//
+typedef enum {
+	FRAME_FOR_NODE,
+	FRAME_FOR_OTHER_NODE,
+	FRAME_ARP,
+	FRAME_EMPTY,
+	FRAME_DMA_ERROR
+} test_frame_type_t;
+
+typedef struct {
+	test_frame_type_t type;
+	u32               size;                                        ///< Frame size without the FCS
+} test_frame_t;
+
+static test_frame_t      test_frames[TEST_NUM_FRAMES];
+static u32               test_num_written;                         ///< Frames written by the DMA engine
+static u32               test_num_checked;                         ///< Frames accounted for by the caller
+
+static XAxiDma_BdRing    test_rx_ring;
+static u32               test_dma_regs[16];                        ///< DMA channel registers (never halted)
+static u32               test_rx_bds[TEST_NUM_RX_BDS * XAXIDMA_BD_NUM_WORDS] __attribute__ ((aligned(XAXIDMA_BD_MINIMUM_ALIGNMENT)));
+static u8                test_rx_buffers[TEST_NUM_RX_BDS][WLAN_EXP_IP_UDP_ETH_BUF_SIZE] __attribute__ ((aligned(64)));
+
+static u8                test_node_addr[ETH_ADDR_LEN]  = { 0x40, 0xD8, 0x55, 0x04, 0x20, 0x01 };
+static u8                test_other_addr[ETH_ADDR_LEN] = { 0x40, 0xD8, 0x55, 0x04, 0x20, 0x02 };
+
+static wlan_exp_ip_udp_buffer  test_frame;
+
+
+//-----------------------------------------------
+// Platform and protocol stubs
+//
+void microblaze_flush_dcache_range(unsigned int cacheaddr, unsigned int len){ }
+void microblaze_invalidate_dcache_range(unsigned int cacheaddr, unsigned int len){ }
+
+void XAxiDma_Reset(XAxiDma * InstancePtr){
+	HOST_TEST_CHECK(0, "DMA reset");
+}
+
+// IP / UDP processing is covered elsewhere; every IPv4 frame has data for the caller
+int ipv4_process_packet(u32 eth_dev_num, wlan_exp_ip_udp_buffer * buffer){
+	return buffer->length;
+}
+
+int arp_process_packet(u32 eth_dev_num, wlan_exp_ip_udp_buffer * packet){
+	return 0;
+}
+
+
+//-----------------------------------------------
+// DMA engine
+//     - Completes the next BD in the hardware group with the next frame
+//
+static int test_dma_complete_bd(){
+	XAxiDma_Bd      * bd_ptr = test_rx_ring.HwHead;
+	ethernet_header * header;
+	test_frame_t    * frame;
+	u8              * data;
+	u32               status;
+	int               i;
+
+	if (test_num_written == TEST_NUM_FRAMES) return 0;
+
+	// Find the first BD of the hardware group that is not complete
+	for (i = 0; i < test_rx_ring.HwCnt; i++) {
+		if (!(XAxiDma_BdRead(bd_ptr, XAXIDMA_BD_STS_OFFSET) & XAXIDMA_BD_STS_COMPLETE_MASK)) break;
+		bd_ptr = XAxiDma_BdRingNext(&test_rx_ring, bd_ptr);
+	}
+
+	if (i == test_rx_ring.HwCnt) return 0;
+
+	frame  = &test_frames[test_num_written];
+	data   = (u8 *)(uintptr_t)XAxiDma_BdGetBufAddr(bd_ptr);
+	header = (ethernet_header *)data;
+
+	if ((test_num_written % TEST_ERROR_FRAME_INTERVAL) == (TEST_ERROR_FRAME_INTERVAL - 1)) {
+		frame->type = FRAME_DMA_ERROR;
+	} else {
+		switch (rand() % 8) {
+			case 0:  frame->type = FRAME_FOR_OTHER_NODE;  break;
+			case 1:  frame->type = FRAME_ARP;             break;
+			case 2:  frame->type = FRAME_EMPTY;           break;
+			default: frame->type = FRAME_FOR_NODE;        break;
+		}
+	}
+
+	frame->size = (frame->type == FRAME_EMPTY) ? 0 : (ETH_HEADER_LEN + 4 + (rand() % (TEST_MAX_FRAME_SIZE - ETH_HEADER_LEN - 4)));
+
+	if (frame->type == FRAME_FOR_OTHER_NODE) {
+		memcpy(header->dest_mac_addr, test_other_addr, ETH_ADDR_LEN);
+	} else if (frame->type == FRAME_ARP) {
+		memset(header->dest_mac_addr, 0xFF, ETH_ADDR_LEN);
+	} else {
+		memcpy(header->dest_mac_addr, test_node_addr, ETH_ADDR_LEN);
+	}
+
+	memcpy(header->src_mac_addr, test_other_addr, ETH_ADDR_LEN);
+	header->ethertype = Xil_Htons((frame->type == FRAME_ARP) ? ETHERTYPE_ARP : ETHERTYPE_IP_V4);
+	memcpy(data + ETH_HEADER_LEN, &test_num_written, sizeof(u32));
+
+	status = XAXIDMA_BD_STS_COMPLETE_MASK | XAXIDMA_BD_STS_RXSOF_MASK | XAXIDMA_BD_STS_RXEOF_MASK;
+	if (frame->type == FRAME_DMA_ERROR) {
+		status |= XAXIDMA_BD_STS_SLV_ERR_MASK;
+	}
+
+	XAxiDma_BdWrite(bd_ptr, XAXIDMA_BD_USR4_OFFSET, frame->size + 4);          // Frame length includes the FCS
+	XAxiDma_BdWrite(bd_ptr, XAXIDMA_BD_STS_OFFSET, status);
+
+	test_num_written++;
+	return 1;
+}
+
+
+//-----------------------------------------------
+// Caller
+//     - Frames the library frees itself are skipped; the result of each receive
+//       must match the next frame that is reported to the caller
+//
+static void test_skip_library_frames(){
+	while ((test_num_checked < test_num_written) &&
+	       (test_frames[test_num_checked].type != FRAME_FOR_NODE) &&
+	       (test_frames[test_num_checked].type != FRAME_DMA_ERROR)) {
+		test_num_checked++;
+	}
+}
+
+static int test_recv(){
+	int          length;
+	u32          seq;
+	test_frame_t * frame;
+
+	length = eth_recv_frame(TEST_ETH_DEV_NUM, &test_frame);
+
+	HOST_TEST_CHECK(eth_device[TEST_ETH_DEV_NUM].rx_batch_cnt <= WLAN_EXP_IP_UDP_RXBD_BATCH_CNT,
+	                "batch of %d BDs", eth_device[TEST_ETH_DEV_NUM].rx_batch_cnt);
+
+	if (length == 0) return 0;
+
+	test_skip_library_frames();
+
+	HOST_TEST_CHECK(test_num_checked < test_num_written, "receive returned %d with no frame pending", length);
+	if (test_num_checked >= test_num_written) return length;
+
+	frame = &test_frames[test_num_checked];
+
+	if (length < 0) {
+		HOST_TEST_CHECK(frame->type == FRAME_DMA_ERROR, "frame %u: receive failed", test_num_checked);
+	} else {
+		HOST_TEST_CHECK(frame->type == FRAME_FOR_NODE, "frame %u: receive returned a frame of type %d", test_num_checked, frame->type);
+		HOST_TEST_CHECK(length == (int)(frame->size - ETH_HEADER_LEN - WLAN_EXP_IP_UDP_DELIM_LEN),
+		                "frame %u: length %d, expected %u", test_num_checked, length, frame->size - ETH_HEADER_LEN - WLAN_EXP_IP_UDP_DELIM_LEN);
+		HOST_TEST_CHECK(test_frame.data == (u8 *)(uintptr_t)XAxiDma_BdGetId(test_frame.descriptor),
+		                "frame %u: data is not in the buffer of its descriptor", test_num_checked);
+
+		memcpy(&seq, test_frame.data + ETH_HEADER_LEN, sizeof(u32));
+		HOST_TEST_CHECK(seq == test_num_checked, "frame %u: received frame %u", test_num_checked, seq);
+
+		// Let the DMA engine run while the caller holds the frame
+		if (rand() & 1) test_dma_complete_bd();
+
+		HOST_TEST_CHECK(eth_free_recv_buffers(TEST_ETH_DEV_NUM, test_frame.descriptor, 1) == XST_SUCCESS,
+		                "frame %u: free failed", test_num_checked);
+	}
+
+	test_num_checked++;
+	return length;
+}
+
+
+static void test_check_ring(){
+	XAxiDma_BdRing * ring = &test_rx_ring;
+
+	HOST_TEST_CHECK((ring->FreeCnt + ring->PreCnt + ring->HwCnt + ring->PostCnt) == ring->AllCnt,
+	                "ring counts %d / %d / %d / %d", ring->FreeCnt, ring->PreCnt, ring->HwCnt, ring->PostCnt);
+}
+
+
+int main(){
+	XAxiDma_Bd * bd_ptr;
+	u32          i;
+	u32          n;
+	u32          idle;
+
+	srand(1);
+
+	//-------------------------------------------
+	// Rx BD ring, set up as eth_init_dma() does
+	//
+	test_rx_ring.ChanBase       = ADDR32(test_dma_regs);
+	test_rx_ring.IsRxChannel    = 1;
+	test_rx_ring.DataWidth      = 4;                               // 32-bit stream, as XAxiDma_CfgInitialize() sets it
+	test_rx_ring.MaxTransferLen = 0x7FFFFF;
+
+	HOST_TEST_CHECK(XAxiDma_BdRingCreate(&test_rx_ring, ADDR32(test_rx_bds), ADDR32(test_rx_bds),
+	                                     WLAN_EXP_IP_UDP_BD_ALIGNMENT, TEST_NUM_RX_BDS) == XST_SUCCESS, "ring create failed");
+
+	// NOTE:  XAxiDma_BdRingClone() is not used; it copies through a BD on the stack, above 4 GB on the
+	//     host. Cloning a cleared template leaves the BDs as XAxiDma_BdRingCreate() does.
+
+	HOST_TEST_CHECK(XAxiDma_BdRingAlloc(&test_rx_ring, TEST_NUM_RX_BDS, &bd_ptr) == XST_SUCCESS, "ring alloc failed");
+
+	for (i = 0; i < TEST_NUM_RX_BDS; i++) {
+		XAxiDma_Bd * curr_bd_ptr = bd_ptr;
+
+		for (n = 0; n < i; n++) curr_bd_ptr = XAxiDma_BdRingNext(&test_rx_ring, curr_bd_ptr);
+
+		HOST_TEST_CHECK(XAxiDma_BdSetBufAddr(curr_bd_ptr, ADDR32(test_rx_buffers[i])) == XST_SUCCESS, "BD %u set buffer failed", i);
+		HOST_TEST_CHECK(XAxiDma_BdSetLength(curr_bd_ptr, WLAN_EXP_IP_UDP_ETH_BUF_SIZE, test_rx_ring.MaxTransferLen) == XST_SUCCESS, "BD %u set length failed", i);
+		XAxiDma_BdSetCtrl(curr_bd_ptr, 0);
+		XAxiDma_BdSetId(curr_bd_ptr, ADDR32(test_rx_buffers[i]));
+	}
+
+	HOST_TEST_CHECK(XAxiDma_BdRingToHw(&test_rx_ring, TEST_NUM_RX_BDS, bd_ptr) == XST_SUCCESS, "ring to hw failed");
+
+	eth_device[TEST_ETH_DEV_NUM].initialized     = 1;
+	eth_device[TEST_ETH_DEV_NUM].dma_rx_ring_ptr = &test_rx_ring;
+	memcpy(eth_device[TEST_ETH_DEV_NUM].hw_addr, test_node_addr, ETH_ADDR_LEN);
+
+	if (host_test_num_failures) return HOST_TEST_RESULT("eth_recv");
+
+	//-------------------------------------------
+	// Random bursts of DMA completions and receives
+	//
+	for (idle = 0; test_num_written < TEST_NUM_FRAMES; ) {
+		n = rand() % (TEST_NUM_RX_BDS + 1);
+		for (i = 0; i < n; i++) idle = test_dma_complete_bd() ? 0 : (idle + 1);
+
+		n = rand() % (WLAN_EXP_IP_UDP_RXBD_BATCH_CNT + 2);
+		for (i = 0; i < n; i++) test_recv();
+
+		test_check_ring();
+
+		// The DMA engine has had no free BD for a long time
+		HOST_TEST_CHECK(idle < TEST_STALL_DMA_ATTEMPTS, "ring stalled after %u frames", test_num_written);
+
+		if (host_test_num_failures) break;
+	}
+
+	//-------------------------------------------
+	// Drain:  every frame for the node must still arrive and every BD return to hardware
+	//
+	for (idle = 0; (idle < (2 * TEST_NUM_RX_BDS)) && !host_test_num_failures; ) {
+		idle = (test_recv() == 0) ? (idle + 1) : 0;
+	}
+
+	test_skip_library_frames();
+
+	HOST_TEST_CHECK(test_num_checked == test_num_written, "%u of %u frames accounted for", test_num_checked, test_num_written);
+	HOST_TEST_CHECK(test_rx_ring.HwCnt == TEST_NUM_RX_BDS, "%d of %d BDs returned to hardware", test_rx_ring.HwCnt, TEST_NUM_RX_BDS);
+	test_check_ring();
+
+	return HOST_TEST_RESULT("eth_recv");
+}
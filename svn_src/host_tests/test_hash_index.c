@@ -0,0 +1,172 @@
+/** @file test_hash_index.c
+ *  @brief Host Test - Hash Index
+ *
+ *  Runs randomized insert / remove / find cycles on a hash_index_t keyed by MAC
+ *  address, as used for the station_info address index, and compares every
+ *  lookup against a linear search of the entries. The table is driven up to
+ *  its full load (one bucket less than the number of buckets) so that long
+ *  probe runs and wrap-around at the end of the table are exercised by the
+ *  backward-shift deletion.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_hash_index.h"
+
+
+#define TEST_HASH_NUM_BITS                                 9
+#define TEST_HASH_NUM_BUCKETS                              (1 << TEST_HASH_NUM_BITS)
+#define TEST_NUM_ENTRIES                                   (TEST_HASH_NUM_BUCKETS - 1)
+#define TEST_NUM_OPS                                       2000000
+
+typedef struct {
+	u8  addr[6];
+	u8  in_use;
+} test_entry_t;
+
+static test_entry_t test_entries[TEST_NUM_ENTRIES];
+static u16          test_buckets[TEST_HASH_NUM_BUCKETS];
+static hash_index_t test_hash;
+
+
+static u32 test_entry_bucket(u32 index){
+	return hash_index_addr_bucket(test_entries[index].addr, TEST_HASH_NUM_BITS);
+}
+
+// Lookup through the hash index, as station_info_hash_find() does
+static int test_hash_find(u8* addr){
+	u32 bucket = hash_index_addr_bucket(addr, TEST_HASH_NUM_BITS);
+	u32 value;
+
+	while ((value = hash_index_probe(&test_hash, &bucket)) != 0) {
+		if (memcmp(test_entries[value - 1].addr, addr, 6) == 0) {
+			return value - 1;
+		}
+	}
+	return -1;
+}
+
+// Reference lookup
+static int test_linear_find(u8* addr){
+	u32 i;
+
+	for (i = 0; i < TEST_NUM_ENTRIES; i++) {
+		if (test_entries[i].in_use && (memcmp(test_entries[i].addr, addr, 6) == 0)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Keys share an OUI and differ in a few low bytes so that home buckets collide
+static void test_random_addr(u8* addr){
+	addr[0] = 0x40;
+	addr[1] = 0xD8;
+	addr[2] = 0x55;
+	addr[3] = 0x04;
+	addr[4] = rand() & 0x03;
+	addr[5] = rand() & 0xFF;
+}
+
+// Every indexed entry must be reachable from its home bucket and every in-use entry indexed once
+static void test_check_table(){
+	u32 bucket;
+	u32 b;
+	u32 num_indexed = 0;
+	u32 num_in_use  = 0;
+	u32 i;
+
+	for (bucket = 0; bucket < TEST_HASH_NUM_BUCKETS; bucket++) {
+		if (test_buckets[bucket] == 0) continue;
+
+		num_indexed++;
+		i = test_buckets[bucket] - 1;
+
+		HOST_TEST_CHECK(test_entries[i].in_use, "bucket %u indexes unused entry %u", bucket, i);
+
+		for (b = test_entry_bucket(i); b != bucket; b = (b + 1) & (TEST_HASH_NUM_BUCKETS - 1)) {
+			HOST_TEST_CHECK(test_buckets[b] != 0, "entry %u in bucket %u is cut off from its home bucket", i, bucket);
+		}
+	}
+
+	for (i = 0; i < TEST_NUM_ENTRIES; i++) {
+		num_in_use += test_entries[i].in_use;
+	}
+
+	HOST_TEST_CHECK(num_indexed == num_in_use, "%u buckets used for %u entries", num_indexed, num_in_use);
+}
+
+
+int main(){
+	u32 op;
+	u32 i;
+	int found;
+	int expected;
+	u8  addr[6];
+
+	srand(1);
+
+	hash_index_init(&test_hash, test_buckets, TEST_HASH_NUM_BITS, test_entry_bucket);
+
+	for (op = 0; op < TEST_NUM_OPS; op++) {
+		test_random_addr(addr);
+
+		found    = test_hash_find(addr);
+		expected = test_linear_find(addr);
+
+		HOST_TEST_CHECK(found == expected, "op %u: find returned %d, expected %d", op, found, expected);
+
+		if (expected >= 0) {
+			// Remove the entry half of the time it is found
+			if (rand() & 1) {
+				hash_index_remove(&test_hash, expected);
+				test_entries[expected].in_use = 0;
+			}
+		} else {
+			// Insert into a free entry; when the table is full, replace a random entry
+			for (i = 0; i < TEST_NUM_ENTRIES; i++) {
+				if (!test_entries[i].in_use) break;
+			}
+
+			if (i == TEST_NUM_ENTRIES) {
+				i = rand() % TEST_NUM_ENTRIES;
+				hash_index_remove(&test_hash, i);
+			}
+
+			memcpy(test_entries[i].addr, addr, 6);
+			test_entries[i].in_use = 1;
+			hash_index_insert(&test_hash, i);
+		}
+
+		if ((op % 4096) == 0) {
+			test_check_table();
+		}
+
+		// A broken index can leave no empty bucket, which would stall the next insert
+		if (host_test_num_failures) break;
+	}
+
+	test_check_table();
+
+	// Removing an entry that is not indexed must leave the table untouched
+	for (i = 0; i < TEST_NUM_ENTRIES; i++) {
+		if (!test_entries[i].in_use) {
+			test_random_addr(test_entries[i].addr);
+			hash_index_remove(&test_hash, i);
+			break;
+		}
+	}
+	test_check_table();
+
+	return HOST_TEST_RESULT("hash_index");
+}
@@ -0,0 +1,189 @@
+/** @file test_ip_udp_checksum.c
+ *  @brief Host Test - wlan_exp IP / UDP Checksums
+ *
+ *  Checks the word-wide checksum routines of the wlan_exp IP/UDP library
+ *  against a byte-wise RFC 1071 reference:
+ *      - ipv4_compute_checksum() over random sizes and alignments
+ *      - ipv4_checksum_add() over data split into even-sized pieces
+ *      - udp_update_checksum() on packets whose data follows the header in
+ *        buffers of odd and even sizes, verified over the whole packet
+ *
+ *  This test is built with WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM enabled.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "xil_io.h"
+#include "wlan_exp_ip_udp.h"
+#include "wlan_exp_ip_udp_internal.h"
+
+
+#define TEST_NUM_CHECKSUMS                                 300000
+#define TEST_NUM_UDP_PACKETS                               50000
+#define TEST_MAX_SIZE                                      2048
+#define TEST_MAX_UDP_BUFFERS                               4
+
+
+// Byte-wise RFC 1071 sum of big endian 16-bit words (odd length padded with zero)
+static u32 test_ref_sum(u32 sum, const u8* data, u32 size){
+	u32 i;
+
+	for (i = 0; (i + 1) < size; i += 2) {
+		sum += ((u32)data[i] << 8) | data[i + 1];
+	}
+
+	if (size & 0x1) {
+		sum += (u32)data[size - 1] << 8;
+	}
+
+	return sum;
+}
+
+static u16 test_ref_finish(u32 sum){
+	while (sum >> 16) {
+		sum = (sum >> 16) + (sum & 0xFFFF);
+	}
+	return (u16)~sum;
+}
+
+static void test_random_fill(u8* data, u32 size){
+	u32 i;
+
+	for (i = 0; i < size; i++) {
+		data[i] = rand();
+	}
+
+	// Runs of 0xFF make the carries matter
+	if ((rand() & 0x7) == 0) {
+		memset(data, 0xFF, size);
+	}
+}
+
+
+static void test_ipv4_checksum(){
+	static u8 mem[TEST_MAX_SIZE + 16] __attribute__ ((aligned(8)));
+
+	u32 n;
+	u32 size;
+	u32 split;
+	u32 align;
+	u8* data;
+	u16 expected;
+	u16 actual;
+
+	for (n = 0; n < TEST_NUM_CHECKSUMS; n++) {
+		size  = rand() % (TEST_MAX_SIZE + 1);
+		align = rand() & 0x7;
+		data  = mem + align;
+
+		test_random_fill(data, size);
+
+		expected = test_ref_finish(test_ref_sum(0, data, size));
+		actual   = ipv4_compute_checksum(data, size);
+
+		HOST_TEST_CHECK(actual == expected, "size %u, align %u: 0x%04x != 0x%04x", size, align, actual, expected);
+
+		// Same sum in two pieces; all but the last piece must have an even size
+		split  = (size == 0) ? 0 : ((rand() % (size + 1)) & ~0x1);
+		actual = ipv4_checksum_finish(ipv4_checksum_add(ipv4_checksum_add(0, data, split), data + split, size - split));
+
+		HOST_TEST_CHECK(actual == expected, "size %u, align %u, split %u: 0x%04x != 0x%04x", size, align, split, actual, expected);
+	}
+}
+
+
+static void test_udp_checksum(){
+	static u8                     mem[sizeof(wlan_exp_ip_udp_header) + 64 + 8] __attribute__ ((aligned(8)));
+	static u8                     buffer_mem[TEST_MAX_UDP_BUFFERS][TEST_MAX_SIZE + 8] __attribute__ ((aligned(8)));
+	static u8                     packet[sizeof(udp_header) + WLAN_EXP_IP_UDP_DELIM_LEN + 64 + (TEST_MAX_UDP_BUFFERS * TEST_MAX_SIZE)];
+
+	wlan_exp_ip_udp_header      * header;
+	wlan_exp_ip_udp_buffer        buffers[TEST_MAX_UDP_BUFFERS];
+	wlan_exp_ip_udp_buffer      * buffer_ptrs[TEST_MAX_UDP_BUFFERS];
+
+	u32 n;
+	u32 i;
+	u32 header_size;
+	u32 num_buffers;
+	u32 udp_length;
+	u32 offset;
+	u32 sum;
+	u8  pseudo[12];
+
+	// The IP/UDP header is 2 bytes into a 32-bit word in a real buffer (see WLAN_EXP_IP_UDP_ETH_RX_BUF_ALIGNMENT)
+	header = (wlan_exp_ip_udp_header*)(mem + 2);
+
+	for (n = 0; n < TEST_NUM_UDP_PACKETS; n++) {
+		bzero(header, sizeof(wlan_exp_ip_udp_header));
+
+		header->ip_hdr.src_ip_addr  = rand();
+		header->ip_hdr.dest_ip_addr = rand();
+		header->udp_hdr.src_port    = rand();
+		header->udp_hdr.dest_port   = rand();
+
+		// Data directly after the header (eg a transport header) and then the buffers
+		header_size = rand() % 64;
+		test_random_fill(((u8*)header) + sizeof(wlan_exp_ip_udp_header), header_size);
+
+		num_buffers = rand() % (TEST_MAX_UDP_BUFFERS + 1);
+		udp_length  = UDP_HEADER_LEN + WLAN_EXP_IP_UDP_DELIM_LEN + header_size;
+
+		for (i = 0; i < num_buffers; i++) {
+			buffers[i].data = buffer_mem[i] + (rand() & 0x7);
+			buffers[i].size = rand() % (TEST_MAX_SIZE + 1);
+			buffer_ptrs[i]  = &buffers[i];
+
+			test_random_fill(buffers[i].data, buffers[i].size);
+			udp_length += buffers[i].size;
+		}
+
+		header->udp_hdr.length = Xil_Htons(udp_length);
+
+		udp_update_checksum(header, header_size, buffer_ptrs, num_buffers);
+
+		HOST_TEST_CHECK(header->udp_hdr.checksum != 0, "packet %u: checksum of zero was not sent as 0xFFFF", n);
+
+		// Flatten the UDP packet as it goes on the wire
+		offset = UDP_HEADER_LEN + WLAN_EXP_IP_UDP_DELIM_LEN + header_size;
+		memcpy(packet, &(header->udp_hdr), offset);
+
+		for (i = 0; i < num_buffers; i++) {
+			memcpy(packet + offset, buffers[i].data, buffers[i].size);
+			offset += buffers[i].size;
+		}
+
+		// Pseudo header:  source / destination address, zero, protocol, UDP length
+		memcpy(&pseudo[0], &(header->ip_hdr.src_ip_addr), 4);
+		memcpy(&pseudo[4], &(header->ip_hdr.dest_ip_addr), 4);
+		pseudo[8]  = 0;
+		pseudo[9]  = IP_PROTOCOL_UDP;
+		pseudo[10] = (udp_length >> 8) & 0xFF;
+		pseudo[11] = udp_length & 0xFF;
+
+		// A receiver sums everything including the checksum and must get all ones
+		sum = test_ref_sum(test_ref_sum(0, pseudo, sizeof(pseudo)), packet, udp_length);
+
+		HOST_TEST_CHECK(test_ref_finish(sum) == 0, "packet %u: header_size %u, %u buffers: receiver sum 0x%04x",
+		                n, header_size, num_buffers, test_ref_finish(sum));
+	}
+}
+
+
+int main(){
+	srand(1);
+
+	test_ipv4_checksum();
+	test_udp_checksum();
+
+	return HOST_TEST_RESULT("ip_udp_checksum");
+}
@@ -0,0 +1,58 @@
+/** @file test_phy_txtime.c
+ *  @brief Host Test - Table-driven Tx Time Lookups
+ *
+ *  Checks wlan_phy_txtime_lookup() and wlan_phy_num_payload_syms_lookup()
+ *  against wlan_ofdm_calc_txtime() and wlan_ofdm_calc_num_payload_syms() for
+ *  all 16 N_DBPS values (8 MCS x NONHT / HTMF), all 3 sampling rates and every
+ *  u16 length. Lengths up to WLAN_PHY_TXTIME_MAX_TABLE_LENGTH go through the
+ *  table; longer lengths check the fallback.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include "host_test.h"
+
+#include "wlan_mac_common.h"
+#include "wlan_phy_util.h"
+#include "wlan_mac_low.h"
+
+
+int main(){
+	const phy_samp_rate_t samp_rates[] = {PHY_10M, PHY_20M, PHY_40M};
+	const u8              phy_modes[]  = {PHY_MODE_NONHT, PHY_MODE_HTMF};
+
+	u32 i, j;
+	u32 length;
+	u8  mcs;
+	u16 expected;
+	u16 actual;
+
+	for (i = 0; i < sizeof(samp_rates)/sizeof(samp_rates[0]); i++) {
+		wlan_phy_txtime_table_update(samp_rates[i]);
+
+		for (j = 0; j < sizeof(phy_modes)/sizeof(phy_modes[0]); j++) {
+			for (mcs = 0; mcs < WLAN_PHY_TXTIME_NUM_MCS; mcs++) {
+				for (length = 0; length <= 0xFFFF; length++) {
+					expected = wlan_ofdm_calc_num_payload_syms(length, mcs, phy_modes[j]);
+					actual   = wlan_phy_num_payload_syms_lookup(length, mcs, phy_modes[j]);
+
+					HOST_TEST_CHECK(actual == expected, "num_payload_syms: rate %d, phy_mode %d, mcs %d, length %u: %u != %u",
+					                samp_rates[i], phy_modes[j], mcs, length, actual, expected);
+
+					expected = wlan_ofdm_calc_txtime(length, mcs, phy_modes[j], samp_rates[i]);
+					actual   = wlan_phy_txtime_lookup(length, mcs, phy_modes[j]);
+
+					HOST_TEST_CHECK(actual == expected, "txtime: rate %d, phy_mode %d, mcs %d, length %u: %u != %u",
+					                samp_rates[i], phy_modes[j], mcs, length, actual, expected);
+				}
+			}
+		}
+	}
+
+	return HOST_TEST_RESULT("phy_txtime");
+}
@@ -0,0 +1,124 @@
+/** @file test_rx_pkt_buf_ring.c
+ *  @brief Host Test - Rx Packet Buffer Ring
+ *
+ *  Two-thread stress test of the Rx packet buffer SPSC ring. A producer thread
+ *  (CPU Low) writes a sequence number into each buffer it publishes and a
+ *  consumer thread (CPU High) checks that every sequence number arrives once,
+ *  in order, in the buffer it was written to. The reboot paths are checked
+ *  separately: rx_pkt_buf_ring_init() must keep a valid ring and
+ *  rx_pkt_buf_ring_reset() must release every published buffer.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "host_test.h"
+
+#include "wlan_mac_common.h"
+#include "wlan_mac_pkt_buf_util.h"
+
+
+#define TEST_NUM_BUFFERS                                   300000
+
+static rx_pkt_buf_ring_t test_ring;
+static volatile u32      test_pkt_bufs[NUM_RX_PKT_BUFS];     // Stands in for the buffer contents
+
+
+static void* test_producer(void* arg){
+	u32 seq;
+	int pkt_buf;
+
+	for (seq = 0; seq < TEST_NUM_BUFFERS; seq++) {
+		while ((pkt_buf = rx_pkt_buf_ring_producer_peek(&test_ring)) == -1) {
+			sched_yield();
+		}
+
+		test_pkt_bufs[pkt_buf] = seq;
+		rx_pkt_buf_ring_producer_push(&test_ring);
+	}
+	return NULL;
+}
+
+static void* test_consumer(void* arg){
+	u32 seq;
+	int pkt_buf;
+
+	for (seq = 0; seq < TEST_NUM_BUFFERS; seq++) {
+		while ((pkt_buf = rx_pkt_buf_ring_consumer_peek(&test_ring)) == -1) {
+			sched_yield();
+		}
+
+		HOST_TEST_CHECK(pkt_buf == (int)(seq % NUM_RX_PKT_BUFS), "buffer %u consumed from pkt_buf %d", seq, pkt_buf);
+		HOST_TEST_CHECK(test_pkt_bufs[pkt_buf] == seq, "pkt_buf %d holds %u, expected %u", pkt_buf, test_pkt_bufs[pkt_buf], seq);
+
+		// Scribble over the buffer before it is released; the producer must rewrite it
+		test_pkt_bufs[pkt_buf] = 0xFFFFFFFF;
+		rx_pkt_buf_ring_consumer_pop(&test_ring);
+	}
+	return NULL;
+}
+
+
+int main(){
+	pthread_t producer;
+	pthread_t consumer;
+	u32 i;
+
+	//-------------------------------------------
+	// Concurrent producer / consumer
+	//
+	rx_pkt_buf_ring_init(&test_ring);
+
+	HOST_TEST_CHECK(rx_pkt_buf_ring_consumer_peek(&test_ring) == -1, "new ring is not empty");
+
+	pthread_create(&consumer, NULL, test_consumer, NULL);
+	pthread_create(&producer, NULL, test_producer, NULL);
+
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+
+	HOST_TEST_CHECK(test_ring.head == TEST_NUM_BUFFERS, "head is %u", test_ring.head);
+	HOST_TEST_CHECK(test_ring.tail == TEST_NUM_BUFFERS, "tail is %u", test_ring.tail);
+
+	//-------------------------------------------
+	// Full ring
+	//
+	for (i = 0; i < NUM_RX_PKT_BUFS; i++) {
+		HOST_TEST_CHECK(rx_pkt_buf_ring_producer_peek(&test_ring) != -1, "ring full after %u buffers", i);
+		rx_pkt_buf_ring_producer_push(&test_ring);
+	}
+	HOST_TEST_CHECK(rx_pkt_buf_ring_producer_peek(&test_ring) == -1, "producer can overrun a full ring");
+
+	//-------------------------------------------
+	// CPU Low reboot keeps the published buffers
+	//
+	rx_pkt_buf_ring_init(&test_ring);
+	HOST_TEST_CHECK((test_ring.head - test_ring.tail) == NUM_RX_PKT_BUFS, "CPU Low reboot dropped published buffers");
+
+	//-------------------------------------------
+	// CPU High reboot releases them
+	//
+	rx_pkt_buf_ring_reset(&test_ring);
+	HOST_TEST_CHECK(rx_pkt_buf_ring_consumer_peek(&test_ring) == -1, "reset left published buffers");
+	HOST_TEST_CHECK(rx_pkt_buf_ring_producer_peek(&test_ring) == (int)(test_ring.head % NUM_RX_PKT_BUFS), "reset did not free the ring");
+
+	//-------------------------------------------
+	// A corrupt ring is reinitialized and ignored by the consumer until then
+	//
+	test_ring.tail = test_ring.head + 1;
+	rx_pkt_buf_ring_init(&test_ring);
+	HOST_TEST_CHECK((test_ring.head == 0) && (test_ring.tail == 0), "corrupt ring was not reinitialized");
+
+	test_ring.magic = 0;
+	test_ring.head  = 1;
+	HOST_TEST_CHECK(rx_pkt_buf_ring_consumer_peek(&test_ring) == -1, "consumer used an uninitialized ring");
+
+	return HOST_TEST_RESULT("rx_pkt_buf_ring");
+}
@@ -0,0 +1,456 @@
+/** @file test_station_delta.c
+ *  @brief Host Test - Station Info Delta Query
+ *
+ *  Keeps a host copy of the station table up to date with the
+ *  CMDID_NODE_GET_STATION_INFO_DELTA responses of process_station_delta_cmd()
+ *  while the station info module is driven with random station updates, counts
+ *  resets, aging, evictions and resets of the station list. Stations also
+ *  change between the packets of a response, as they do when Tx / Rx
+ *  interrupts run during a transfer.
+ *
+ *  After every query that ran without such changes, the host copy must match
+ *  a full snapshot of station_info_list: the same stations with the same info
+ *  and counts. The test also checks the framing of each response: byte
+ *  offsets, packet sizes, the entry count and the generation range of every
+ *  entry.
+ *
+ *  This test is linked with -no-pie: the station info pools are placed at
+ *  32-bit addresses given by platform_high_dev_info, which point at static
+ *  memory in the test.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+#include "xil_io.h"
+#include "wlan_platform_high.h"
+#include "wlan_mac_high.h"
+#include "wlan_mac_dl_list.h"
+#include "wlan_mac_network_info.h"
+#include "wlan_mac_station_info.h"
+#include "wlan_exp_common.h"
+#include "wlan_exp_node.h"
+#include "wlan_exp_ip_udp.h"
+
+
+#define TEST_NUM_QUERIES                                   20000
+#define TEST_NUM_ADDRS                                     300         ///< More addresses than station_info_t structs, so stations are evicted
+#define TEST_NUM_ACTIVE_ADDRS                              100         ///< Addresses of Tx / Rx outside crowded phases
+#define TEST_MAX_OPS_PER_QUERY                             64
+#define TEST_MAX_OPS_PER_CROWDED_QUERY                     256
+#define TEST_MAX_RESP_WORDS                                363
+#define TEST_MIN_RESP_WORDS                                60          ///< Room for the header and one entry
+#define TEST_MAX_BUFFER_SIZE                               (64 * 1024)
+
+// Response layout (wlan_exp_station_delta_hdr_t / wlan_exp_station_delta_t in wlan_exp_node.c)
+#define TEST_DELTA_HDR_SIZE                                16
+#define TEST_DELTA_SIZE                                    208
+#define TEST_DELTA_RECORD_OFFSET                           8           ///< Counts and info, after the generation
+#define TEST_DELTA_RECORD_SIZE                             (TEST_DELTA_SIZE - TEST_DELTA_RECORD_OFFSET)
+#define TEST_RECORD_TIMESTAMP_SIZE                         8           ///< Query time at the start of the counts; not compared
+#define TEST_RECORD_INFO_OFFSET                            128         ///< wlan_exp_station_info_t, which starts with the address
+
+// Defined in wlan_exp_node.c
+u32  process_station_delta_cmd(int socket_index, void* from, cmd_resp* response,
+                               u32* cmd_args_32, cmd_resp_hdr* resp_hdr, u32* resp_args_32, u32 max_resp_len);
+void copy_station_info_to_dest(void* source, void* dest, u8* mac_addr);
+void copy_counts_txrx_to_dest(void* source, void* dest, u8* mac_addr);
+
+// Defined in wlan_mac_station_info.c
+void station_info_timestamp_check();
+void station_info_reset_all_counts_txrx();
+
+// Defined by wlan_mac_high.c, which is not linked into this test
+platform_high_dev_info_t      platform_high_dev_info;
+
+
+//-----------------------------------------------
+// Memory for the station info pools
+//
+static u8                     test_aux_bram[64 * 1024] __attribute__ ((aligned(64)));
+static u8                     test_dram[32 * 1024 * 1024] __attribute__ ((aligned(64)));
+
+static u64                    test_time;
+static u8                     test_addrs[TEST_NUM_ADDRS][MAC_ADDR_LEN];
+static u32                    test_num_addrs;             // Addresses of Tx / Rx in this phase
+static u32                    test_num_evictions;
+static u32                    test_num_aged;
+
+
+//-----------------------------------------------
+// Host copy of the station table
+//     - Records are the counts and info of a wlan_exp_station_delta_t with the timestamp zeroed
+//
+typedef struct {
+	u8  record[TEST_DELTA_RECORD_SIZE];
+} test_record_t;
+
+typedef struct {
+	test_record_t records[TEST_NUM_ADDRS];
+	u32           num_records;
+} test_table_t;
+
+static test_table_t           test_host_table;
+static test_table_t           test_snapshot;
+static u32                    test_host_generation;
+
+
+//-----------------------------------------------
+// Response of a query, as the host receives it
+//
+static u8                     test_buffer[TEST_MAX_BUFFER_SIZE];
+static u32                    test_buffer_num_bytes;
+static u32                    test_buffer_total_bytes;
+static u32                    test_num_pkts;
+
+static cmd_resp_hdr           test_resp_hdr;
+static u32                    test_resp_args[TEST_MAX_RESP_WORDS + 8];
+static wlan_exp_ip_udp_buffer test_resp_buffer;
+static u32                    test_max_resp_len;
+static u32                    test_changes_in_transfer;   // Stations may change between packets
+static u32                    test_num_changes;           // Station changes made between packets
+
+
+//-----------------------------------------------
+// Stubs
+//
+volatile u64 get_system_time_usec(){
+	return test_time;
+}
+
+interrupt_state_t wlan_mac_high_interrupt_stop(){
+	return INTERRUPTS_DISABLED;
+}
+
+int wlan_mac_high_interrupt_restore_state(interrupt_state_t new_interrupt_state){
+	return 0;
+}
+
+void* wlan_mac_high_malloc(u32 size){
+	return malloc(size);
+}
+
+void wlan_mac_high_free(void* addr){
+	free(addr);
+}
+
+
+//-----------------------------------------------
+// Station changes
+//
+static void test_station_change(){
+	station_info_t* station_info;
+	dl_list*        station_info_list = station_info_get_list();
+	u32             num_stations      = station_info_list->length;
+	u8*             addr;
+	u32             is_new;
+	u32             n                 = rand() % 10000;
+
+	if (n < 9900) {
+		// Tx / Rx with a station
+		addr         = test_addrs[rand() % test_num_addrs];
+		is_new       = (station_info_find_by_addr(addr, NULL) == NULL);
+		station_info = station_info_create(addr);
+
+		if (station_info != NULL) {
+			station_info->latest_txrx_timestamp = test_time;
+			station_info->latest_rx_seq         = rand() & 0xFFF;
+#if WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
+			station_info->txrx_counts.data.rx_num_packets++;
+			station_info->txrx_counts.data.rx_num_bytes += rand() % 1500;
+#endif
+			// A new station in a full list replaces the oldest one
+			if (is_new && (station_info_list->length == num_stations)) test_num_evictions++;
+		}
+	} else if (n < 9960) {
+		// Let stations age out
+		test_time += rand() % (STATION_INFO_TIMEOUT_USEC / 4);
+		station_info_timestamp_check();
+
+		test_num_aged += num_stations - station_info_list->length;
+	} else if (n < 9979) {
+		txrx_counts_zero_all();
+	} else if (n < 9998) {
+		station_info_reset_all_counts_txrx();
+	} else {
+		station_info_reset_all();
+	}
+}
+
+static void test_random_changes(u32 max_ops){
+	u32 i;
+	u32 num_ops = rand() % (max_ops + 1);
+
+	for (i = 0; i < num_ops; i++) {
+		test_station_change();
+	}
+}
+
+
+//-----------------------------------------------
+// Host table
+//
+static int test_table_find(test_table_t* table, u8* addr){
+	u32 i;
+
+	for (i = 0; i < table->num_records; i++) {
+		if (memcmp(&(table->records[i].record[TEST_RECORD_INFO_OFFSET]), addr, MAC_ADDR_LEN) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void test_table_update(test_table_t* table, u8* record){
+	int index = test_table_find(table, &record[TEST_RECORD_INFO_OFFSET]);
+
+	if (index < 0) {
+		HOST_TEST_CHECK(table->num_records < TEST_NUM_ADDRS, "host table is full");
+		if (table->num_records >= TEST_NUM_ADDRS) return;
+
+		index = table->num_records++;
+	}
+
+	memcpy(table->records[index].record, record, TEST_DELTA_RECORD_SIZE);
+	bzero(table->records[index].record, TEST_RECORD_TIMESTAMP_SIZE);
+}
+
+// Full snapshot of station_info_list, as CMDID_COUNTS_GET_TXRX and CMDID_NODE_GET_STATION_INFO_LIST return it
+static void test_take_snapshot(){
+	dl_list*        station_info_list = station_info_get_list();
+	dl_entry*       curr_dl_entry     = station_info_list->first;
+	station_info_t* curr_station_info;
+	u8              record[TEST_DELTA_RECORD_SIZE];
+
+	test_snapshot.num_records = 0;
+
+	while (curr_dl_entry != NULL) {
+		curr_station_info = (station_info_t*)(curr_dl_entry->data);
+
+		copy_counts_txrx_to_dest(curr_station_info, &record[0], curr_station_info->addr);
+		copy_station_info_to_dest(curr_station_info, &record[TEST_RECORD_INFO_OFFSET], curr_station_info->addr);
+
+		HOST_TEST_CHECK(test_table_find(&test_snapshot, curr_station_info->addr) < 0, "station listed twice");
+		test_table_update(&test_snapshot, record);
+
+		curr_dl_entry = dl_entry_next(curr_dl_entry);
+	}
+}
+
+static void test_compare_snapshot(u32 query){
+	u32 i;
+	int index;
+
+	test_take_snapshot();
+
+	HOST_TEST_CHECK(test_host_table.num_records == test_snapshot.num_records, "query %u: host has %u stations, node has %u",
+	                query, test_host_table.num_records, test_snapshot.num_records);
+
+	for (i = 0; i < test_snapshot.num_records; i++) {
+		index = test_table_find(&test_host_table, &(test_snapshot.records[i].record[TEST_RECORD_INFO_OFFSET]));
+
+		HOST_TEST_CHECK((index >= 0) &&
+		                (memcmp(test_host_table.records[index].record, test_snapshot.records[i].record, TEST_DELTA_RECORD_SIZE) == 0),
+		                "query %u: station %u of the snapshot is %s on the host", query, i, (index < 0) ? "missing" : "stale");
+		if (host_test_num_failures) return;
+	}
+}
+
+
+//-----------------------------------------------
+// Transport
+//     - Called by send_early_resp() for every packet of the response
+//
+void transport_send(int socket_index, struct sockaddr* to, wlan_exp_ip_udp_buffer** buffers, u32 num_buffers){
+	u32 bytes_remaining = Xil_Ntohl(test_resp_args[2]);
+	u32 start_byte      = Xil_Ntohl(test_resp_args[3]);
+	u32 size            = Xil_Ntohl(test_resp_args[4]);
+
+	if (test_num_pkts == 0) test_buffer_total_bytes = bytes_remaining;
+
+	HOST_TEST_CHECK(Xil_Ntohs(test_resp_hdr.num_args) == 5, "response with %u args", Xil_Ntohs(test_resp_hdr.num_args));
+	HOST_TEST_CHECK(Xil_Ntohs(test_resp_hdr.length) == (5 * sizeof(u32) + size), "response length %u for %u bytes",
+	                Xil_Ntohs(test_resp_hdr.length), size);
+	HOST_TEST_CHECK(start_byte == test_buffer_num_bytes, "packet %u starts at byte %u, expected %u", test_num_pkts, start_byte, test_buffer_num_bytes);
+	HOST_TEST_CHECK(bytes_remaining == (test_buffer_total_bytes - start_byte), "packet %u: %u bytes remaining, expected %u",
+	                test_num_pkts, bytes_remaining, test_buffer_total_bytes - start_byte);
+	HOST_TEST_CHECK((size > 0) && (size <= (test_max_resp_len * 4)), "packet %u of %u bytes, max_resp_len %u words", test_num_pkts, size, test_max_resp_len);
+
+	// Packets are filled:  each one but the last leaves no room for another entry
+	HOST_TEST_CHECK((size == bytes_remaining) || ((size + TEST_DELTA_SIZE) > (test_max_resp_len * 4)),
+	                "packet %u of %u bytes has room for another entry", test_num_pkts, size);
+
+	if ((start_byte + size) <= TEST_MAX_BUFFER_SIZE) {
+		memcpy(&test_buffer[start_byte], &test_resp_args[5], size);
+	}
+
+	test_buffer_num_bytes += size;
+	test_num_pkts++;
+
+	// Tx / Rx interrupts between packets
+	if (test_changes_in_transfer && (rand() & 1)) {
+		test_num_changes++;
+		test_station_change();
+	}
+}
+
+
+//-----------------------------------------------
+// Query
+//
+static u32 test_query(u32 query, u32 since, u32* flags){
+	cmd_resp response;
+	u32      cmd_args[3];
+	u32      num_entries;
+	u32      num_stations;
+	u32      generation;
+	u32      entry_generation;
+	u32      i;
+	u8     * entry;
+
+	cmd_args[0] = Xil_Htonl(rand());
+	cmd_args[1] = Xil_Htonl(0);
+	cmd_args[2] = Xil_Htonl(since);
+
+	test_resp_hdr.cmd      = CMDID_NODE_GET_STATION_INFO_DELTA;
+	test_resp_hdr.length   = 0;
+	test_resp_hdr.num_args = 0;
+
+	test_resp_buffer.data   = (u8*)&test_resp_hdr;
+	test_resp_buffer.offset = (u8*)&test_resp_hdr;
+	test_resp_buffer.length = 0;
+	test_resp_buffer.size   = 0;
+
+	response.flags  = 0;
+	response.buffer = &test_resp_buffer;
+	response.header = &test_resp_hdr;
+	response.args   = test_resp_args;
+
+	test_buffer_num_bytes   = 0;
+	test_buffer_total_bytes = 0;
+	test_num_pkts           = 0;
+	test_max_resp_len       = TEST_MIN_RESP_WORDS + (rand() % (TEST_MAX_RESP_WORDS - TEST_MIN_RESP_WORDS + 1));
+
+	// The number of stations in the header is the list length before any change during the transfer
+	num_stations = station_info_get_list()->length;
+
+	HOST_TEST_CHECK(process_station_delta_cmd(0, NULL, &response, cmd_args, &test_resp_hdr, test_resp_args, test_max_resp_len) == RESP_SENT,
+	                "query %u: no response sent", query);
+
+	HOST_TEST_CHECK(test_resp_args[0] == cmd_args[0], "query %u: buffer ID not returned", query);
+	HOST_TEST_CHECK(test_buffer_num_bytes == test_buffer_total_bytes, "query %u: %u of %u bytes sent", query, test_buffer_num_bytes, test_buffer_total_bytes);
+	HOST_TEST_CHECK((test_buffer_num_bytes >= TEST_DELTA_HDR_SIZE) && (test_buffer_num_bytes <= TEST_MAX_BUFFER_SIZE),
+	                "query %u: response of %u bytes", query, test_buffer_num_bytes);
+	if (host_test_num_failures) return since;
+
+	generation  = ((u32*)test_buffer)[0];
+	num_entries = ((u32*)test_buffer)[2];
+	*flags      = ((u32*)test_buffer)[3];
+
+	HOST_TEST_CHECK(((u32*)test_buffer)[1] == num_stations, "query %u: header lists %u stations, node has %u", query, ((u32*)test_buffer)[1], num_stations);
+	HOST_TEST_CHECK(test_buffer_num_bytes == (TEST_DELTA_HDR_SIZE + (num_entries * TEST_DELTA_SIZE)),
+	                "query %u: %u bytes for %u entries", query, test_buffer_num_bytes, num_entries);
+	HOST_TEST_CHECK(generation >= since || (*flags & CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL),
+	                "query %u: generation went back from %u to %u", query, since, generation);
+	if (host_test_num_failures) return since;
+
+	// A full response replaces the host's table
+	if (*flags & CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL) {
+		test_host_table.num_records = 0;
+		since = 0;
+	}
+
+	for (i = 0; i < num_entries; i++) {
+		entry            = &test_buffer[TEST_DELTA_HDR_SIZE + (i * TEST_DELTA_SIZE)];
+		entry_generation = ((u32*)entry)[0];
+
+		// Generation 0:  the station was removed during the transfer
+		if (entry_generation == 0) continue;
+
+		HOST_TEST_CHECK((entry_generation > since) && (entry_generation <= generation),
+		                "query %u: entry %u of generation %u outside (%u, %u]", query, i, entry_generation, since, generation);
+
+		test_table_update(&test_host_table, &entry[TEST_DELTA_RECORD_OFFSET]);
+	}
+
+	return generation;
+}
+
+
+int main(){
+	u32 query;
+	u32 i;
+	u32 flags         = 0;
+	u32 num_full      = 0;
+	u32 num_in_change = 0;
+
+	srand(1);
+
+	platform_high_dev_info.aux_bram_baseaddr = (u32)(unsigned long)test_aux_bram;
+	platform_high_dev_info.aux_bram_size     = sizeof(test_aux_bram);
+	platform_high_dev_info.dram_baseaddr     = (u32)(unsigned long)test_dram;
+	platform_high_dev_info.dram_size         = sizeof(test_dram);
+
+	HOST_TEST_CHECK((STATION_INFO_BUFFER_HIGH - platform_high_dev_info.dram_baseaddr) < sizeof(test_dram), "station info pool outside the test DRAM");
+	HOST_TEST_CHECK((STATION_INFO_DL_ENTRY_MEM_HIGH - platform_high_dev_info.aux_bram_baseaddr) < sizeof(test_aux_bram), "station info entries outside the test BRAM");
+	if (host_test_num_failures) return HOST_TEST_RESULT("station_delta");
+
+	for (i = 0; i < TEST_NUM_ADDRS; i++) {
+		test_addrs[i][0] = 0x40;
+		test_addrs[i][1] = 0xD8;
+		test_addrs[i][2] = 0x55;
+		test_addrs[i][3] = 0x04;
+		test_addrs[i][4] = i >> 8;
+		test_addrs[i][5] = i;
+	}
+
+	test_time = 1;
+	station_info_init();
+
+	test_host_generation = 0;
+
+	for (query = 0; (query < TEST_NUM_QUERIES) && !host_test_num_failures; query++) {
+		// Now and then a crowded phase with more stations than fit, which evicts the oldest ones
+		if ((rand() % 32) == 0) {
+			test_num_addrs = TEST_NUM_ADDRS;
+			test_random_changes(TEST_MAX_OPS_PER_CROWDED_QUERY);
+		} else {
+			test_num_addrs = TEST_NUM_ACTIVE_ADDRS;
+			test_random_changes(TEST_MAX_OPS_PER_QUERY);
+		}
+
+		// A host that restarts queries from 0; a node that restarted and is behind the host's generation
+		if ((rand() % 64) == 0) test_host_generation = 0;
+		if ((rand() % 64) == 0) test_host_generation += 1000000;
+
+		test_changes_in_transfer = rand() & 1;
+		test_num_changes         = 0;
+
+		test_host_generation = test_query(query, test_host_generation, &flags);
+
+		if (flags & CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL) num_full++;
+
+		// Stations that changed during the transfer are picked up by the next query
+		if (test_num_changes == 0) {
+			test_compare_snapshot(query);
+		} else {
+			num_in_change++;
+		}
+	}
+
+	HOST_TEST_CHECK(num_full < (TEST_NUM_QUERIES / 4), "%u of %u queries returned every station", num_full, TEST_NUM_QUERIES);
+	HOST_TEST_CHECK(num_in_change > (TEST_NUM_QUERIES / 8), "only %u queries saw stations change during the transfer", num_in_change);
+	HOST_TEST_CHECK(test_num_evictions > 1000, "only %u stations evicted", test_num_evictions);
+	HOST_TEST_CHECK(test_num_aged > 1000, "only %u stations aged out", test_num_aged);
+
+	return HOST_TEST_RESULT("station_delta");
+}
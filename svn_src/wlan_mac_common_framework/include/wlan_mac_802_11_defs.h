@@ -146,5 +146,22 @@ typedef struct qos_control{
 	u16 control;
 } qos_control;
 
+//IEEE 802.11-2012 section 8.2.4.5.9:
+//QoS control bit 7 indicates the frame body is an A-MSDU
+#define QOS_CONTROL_AMSDU_PRESENT	0x0080
+
+//IEEE 802.11-2012 section 8.3.2.2:
+//Each A-MSDU subframe is this header, the MSDU and 0-3 bytes of padding so the
+//next subframe starts on a 4-byte boundary. The length is big-endian and covers
+//only the MSDU.
+typedef struct amsdu_subframe_header{
+	u8 da[6];
+	u8 sa[6];
+	u16 length;
+} amsdu_subframe_header;
+ASSERT_TYPE_SIZE(amsdu_subframe_header, 14);
+
+#define AMSDU_SUBFRAME_PAD(x)	((4 - ((x) & 0x3)) & 0x3)
+
 
 #endif /* WLAN_MAC_802_11_H */
@@ -66,6 +66,7 @@
 #define IPC_MBOX_LOW_PARAM                                 16
 #define IPC_MBOX_LOW_RANDOM_SEED                           17
 #define IPC_MBOX_SET_RADIO_TX_POWER	   				       18
+#define IPC_MBOX_BATCH                                     19
 
 
 //-----------------------------------------------
@@ -83,6 +84,17 @@
 #define IPC_MBOX_NO_MSG_AVAIL                             -2
 
 
+//-----------------------------------------------
+// IPC_MBOX_BATCH defines
+//     - The payload of an IPC_MBOX_BATCH message is a sequence of complete IPC
+//       messages, each one a header word (as written by write_mailbox_msg())
+//       followed by its payload words. arg0 is the number of messages in the batch.
+//     - Messages are only appended to a batch if they fit in
+//       MAILBOX_BUFFER_MAX_NUM_WORDS words together with the rest of the batch.
+//
+#define IPC_MBOX_BATCH_MAX_NUM_WORDS                       MAILBOX_BUFFER_MAX_NUM_WORDS
+
+
 //-----------------------------------------------
 // IPC_MBOX_MEM_READ_WRITE arg0 defines
 //
@@ -126,4 +138,10 @@ int           read_mailbox_msg(wlan_ipc_msg_t* msg);
 int           write_mailbox_msg(wlan_ipc_msg_t* msg);
 int           send_msg(u16 msg_id, u8 arg, u8 num_words, u32* payload);
 
+int           write_mailbox_msg_batched(wlan_ipc_msg_t* msg);
+int           flush_mailbox_batch();
+int           is_mailbox_msg_avail();
+int           is_mailbox_batch_pending();
+int           get_mailbox_batch_msg(wlan_ipc_msg_t* batch, u32* offset, wlan_ipc_msg_t* msg);
+
 #endif /* WLAN_MAC_MAILBOX_UTIL_H_ */
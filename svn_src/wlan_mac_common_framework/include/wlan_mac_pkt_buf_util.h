@@ -291,6 +291,37 @@ ASSERT_TYPE_SIZE(rx_frame_info_t, 336);
 #define RX_FRAME_INFO_UNEXPECTED_RESPONSE						 0x8
 
 
+//-----------------------------------------------
+// Rx packet buffer ring
+//     - When RX_PKT_BUF_RING_ENABLE is 1, ownership of the Rx packet buffers is
+//       passed with a single-producer / single-consumer ring instead of the
+//       pkt_buf mutex. Both CPUs must be compiled with the same value.
+//     - CPU Low fills buffer (head % NUM_RX_PKT_BUFS) and then increments head.
+//       CPU High processes buffer (tail % NUM_RX_PKT_BUFS) and then increments
+//       tail. Each index is only written by one CPU, so CPU Low can fill ahead
+//       while CPU High holds buffers without either CPU waiting on the mutex.
+//     - The buffers published by CPU Low are [tail, head). CPU Low may fill the
+//       buffer at head while (head - tail) < NUM_RX_PKT_BUFS.
+//     - The ring is placed at the end of the last Rx packet buffer, past the
+//       end of any reception.
+//
+#define RX_PKT_BUF_RING_ENABLE                             0
+#define RX_PKT_BUF_RING_MAGIC                              0x52494E47
+
+typedef struct rx_pkt_buf_ring_t{
+    volatile u32             magic;                        ///< RX_PKT_BUF_RING_MAGIC once CPU Low has initialized the ring
+    volatile u32             head;                         ///< # of buffers published by CPU Low (written by CPU Low only)
+    u32                      reserved0[6];
+    volatile u32             tail;                         ///< # of buffers released by CPU High (written by CPU High only)
+    u32                      reserved1[7];
+} rx_pkt_buf_ring_t;
+ASSERT_TYPE_SIZE(rx_pkt_buf_ring_t, 64);
+
+#define RX_PKT_BUF_RING_ADDR(baseaddr)                    (CALC_PKT_BUF_ADDR(baseaddr, (NUM_RX_PKT_BUFS - 1)) + PKT_BUF_SIZE - sizeof(rx_pkt_buf_ring_t))
+
+CASSERT((PHY_RX_PKT_BUF_MPDU_OFFSET + MAX_PKT_SIZE_B) <= (PKT_BUF_SIZE - sizeof(rx_pkt_buf_ring_t)), rx_pkt_buf_ring_placement_check);
+
+
 /*************************** Function Prototypes *****************************/
 
 int init_pkt_buf();
@@ -309,4 +340,14 @@ int unlock_rx_pkt_buf(u8 pkt_buf_ind);
 int get_rx_pkt_buf_status(u8 pkt_buf_ind, u32* locked, u32 *owner);
 
 
+// RX packet buffer ring functions
+rx_pkt_buf_ring_t* get_rx_pkt_buf_ring();
+void rx_pkt_buf_ring_init(rx_pkt_buf_ring_t* ring);
+void rx_pkt_buf_ring_reset(rx_pkt_buf_ring_t* ring);
+int  rx_pkt_buf_ring_producer_peek(rx_pkt_buf_ring_t* ring);
+void rx_pkt_buf_ring_producer_push(rx_pkt_buf_ring_t* ring);
+int  rx_pkt_buf_ring_consumer_peek(rx_pkt_buf_ring_t* ring);
+void rx_pkt_buf_ring_consumer_pop(rx_pkt_buf_ring_t* ring);
+
+
 #endif /* WLAN_MAC_IPC_UTIL_H_ */
@@ -16,6 +16,7 @@
 
 #include "stdlib.h"
 #include "stdio.h"
+#include "string.h"
 
 #include "xstatus.h"
 #include "xparameters.h"
@@ -33,6 +34,11 @@
 
 static XMbox ipc_mailbox;
 
+// Messages waiting to be sent as a single IPC_MBOX_BATCH message
+static u32 ipc_batch_payload[IPC_MBOX_BATCH_MAX_NUM_WORDS];
+static u8  ipc_batch_num_words;
+static u8  ipc_batch_num_msgs;
+
 static platform_common_dev_info_t platform_common_dev_info;
 
 
@@ -62,6 +68,9 @@ XMbox* init_mailbox() {
     mbox_config_ptr = XMbox_LookupConfig(platform_common_dev_info.mailbox_dev_id);
     XMbox_CfgInitialize(&ipc_mailbox, mbox_config_ptr, mbox_config_ptr->BaseAddress);
 
+    ipc_batch_num_words = 0;
+    ipc_batch_num_msgs  = 0;
+
     return &ipc_mailbox;
 }
 
@@ -78,6 +87,9 @@ XMbox* init_mailbox() {
  * This function is blocking and each message write is atomic in the sense that
  * it will not be interrupted.
  *
+ * Any messages waiting in the batch are sent first so that the other CPU sees
+ * all messages in the order they were written.
+ *
  * @param   msg              - Pointer to IPC message structure to write
  *
  * @return  int              - Status:
@@ -99,6 +111,11 @@ int write_mailbox_msg(wlan_ipc_msg_t* msg) {
     interrupt_state_t     prev_interrupt_state;
     prev_interrupt_state = wlan_mac_high_interrupt_stop();
 #endif
+    // Send any batched messages ahead of this one
+    if (ipc_batch_num_msgs > 0) {
+        flush_mailbox_batch();
+    }
+
     // Write msg header (first 32b word)
     XMbox_WriteBlocking(&ipc_mailbox, (u32*)msg, 4);
 
@@ -146,6 +163,163 @@ int send_msg(u16 msg_id, u8 arg, u8 num_words, u32* payload) {
 }
 
 
+/*****************************************************************************/
+/**
+ * Write IPC message to batch
+ *
+ * This function will append an IPC message to the batch of messages that is sent
+ * to the other CPU as a single IPC_MBOX_BATCH message. Coalescing notifications
+ * this way means the other CPU reads them all in one mailbox interrupt. If the
+ * message does not fit in the batch, the batch is sent first.
+ *
+ * The batch is sent by flush_mailbox_batch() or by the next write_mailbox_msg().
+ * The caller is responsible for flushing the batch in a timely manner.
+ *
+ * @param   msg              - Pointer to IPC message structure to write
+ *
+ * @return  int              - Status:
+ *                                 IPC_MBOX_SUCCESS - Message added to batch
+ *                                 IPC_MBOX_INVALID_MSG - Message invalid
+ *****************************************************************************/
+int write_mailbox_msg_batched(wlan_ipc_msg_t* msg) {
+    // Check that msg points to a valid IPC message
+    if (((msg->msg_id) & IPC_MBOX_MSG_ID_DELIM) != IPC_MBOX_MSG_ID_DELIM) {
+        return IPC_MBOX_INVALID_MSG;
+    }
+
+    // Messages that can never fit in a batch are sent on their own
+    if ((1 + (msg->num_payload_words)) > IPC_MBOX_BATCH_MAX_NUM_WORDS) {
+        return write_mailbox_msg(msg);
+    }
+
+#if WLAN_COMPILE_FOR_CPU_HIGH
+    interrupt_state_t     prev_interrupt_state;
+    prev_interrupt_state = wlan_mac_high_interrupt_stop();
+#endif
+    if ((ipc_batch_num_words + 1 + (msg->num_payload_words)) > IPC_MBOX_BATCH_MAX_NUM_WORDS) {
+        flush_mailbox_batch();
+    }
+
+    // Copy msg header (first 32b word) and payload
+    memcpy(&(ipc_batch_payload[ipc_batch_num_words]), msg, 4);
+    ipc_batch_num_words++;
+
+    if ((msg->num_payload_words) > 0) {
+        memcpy(&(ipc_batch_payload[ipc_batch_num_words]), msg->payload_ptr, 4 * (msg->num_payload_words));
+        ipc_batch_num_words += msg->num_payload_words;
+    }
+
+    ipc_batch_num_msgs++;
+
+#if WLAN_COMPILE_FOR_CPU_HIGH
+    wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+#endif
+    return IPC_MBOX_SUCCESS;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Flush IPC message batch
+ *
+ * This function will send any messages added by write_mailbox_msg_batched() to
+ * the other CPU. A batch holding a single message is sent as that message.
+ *
+ * @return  int              - Status:
+ *                                 IPC_MBOX_SUCCESS - Batch sent successfully (or batch was empty)
+ *                                 IPC_MBOX_INVALID_MSG - Message invalid
+ *****************************************************************************/
+int flush_mailbox_batch() {
+    wlan_ipc_msg_t ipc_msg;
+    int status;
+
+    if (ipc_batch_num_msgs == 0) {
+        return IPC_MBOX_SUCCESS;
+    }
+
+    if (ipc_batch_num_msgs == 1) {
+        // No need for the batch header
+        memcpy(&ipc_msg, &(ipc_batch_payload[0]), 4);
+        ipc_msg.payload_ptr       = &(ipc_batch_payload[1]);
+    } else {
+        ipc_msg.msg_id            = IPC_MBOX_MSG_ID(IPC_MBOX_BATCH);
+        ipc_msg.num_payload_words = ipc_batch_num_words;
+        ipc_msg.arg0              = ipc_batch_num_msgs;
+        ipc_msg.payload_ptr       = ipc_batch_payload;
+    }
+
+    // Empty the batch before writing so write_mailbox_msg() does not flush it again
+    ipc_batch_num_words = 0;
+    ipc_batch_num_msgs  = 0;
+
+    status = write_mailbox_msg(&ipc_msg);
+
+    return status;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Check for pending IPC work
+ *
+ * These checks let a polling loop skip the mailbox when there is nothing to
+ * read and nothing batched to send.
+ *
+ * @return  int              - 1 if a message is waiting / a batch is pending
+ *                             0 otherwise
+ *****************************************************************************/
+int is_mailbox_msg_avail() {
+    return (XMbox_IsEmpty(&ipc_mailbox) == 0);
+}
+
+int is_mailbox_batch_pending() {
+    return (ipc_batch_num_msgs > 0);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Get IPC message from batch
+ *
+ * This function will extract the next message from the payload of a received
+ * IPC_MBOX_BATCH message. The payload_ptr of the extracted message points into
+ * the payload of the batch.
+ *
+ * @param   batch            - Pointer to received IPC_MBOX_BATCH message
+ * @param   offset           - Word offset of next message in the batch payload (start at 0)
+ * @param   msg              - Pointer to IPC message structure to fill in
+ *
+ * @return  int              - Status:
+ *                                 IPC_MBOX_SUCCESS      - Message extracted
+ *                                 IPC_MBOX_NO_MSG_AVAIL - No more messages in the batch
+ *                                 IPC_MBOX_INVALID_MSG  - Batch payload invalid
+ *****************************************************************************/
+int get_mailbox_batch_msg(wlan_ipc_msg_t* batch, u32* offset, wlan_ipc_msg_t* msg) {
+
+    if (*offset >= (batch->num_payload_words)) {
+        return IPC_MBOX_NO_MSG_AVAIL;
+    }
+
+    memcpy(msg, &(batch->payload_ptr[*offset]), 4);
+
+    // Check that the message is valid and does not run past the end of the batch
+    if ((((msg->msg_id) & IPC_MBOX_MSG_ID_DELIM) != IPC_MBOX_MSG_ID_DELIM) ||
+        ((*offset + 1 + (msg->num_payload_words)) > (batch->num_payload_words))) {
+        *offset = batch->num_payload_words;
+        return IPC_MBOX_INVALID_MSG;
+    }
+
+    msg->payload_ptr = &(batch->payload_ptr[*offset + 1]);
+    *offset += 1 + (msg->num_payload_words);
+
+    return IPC_MBOX_SUCCESS;
+}
+
+
+
 /*****************************************************************************/
 /**
  * Read IPC message
@@ -20,6 +20,14 @@
 #include "wlan_platform_common.h"
 #include "wlan_mac_pkt_buf_util.h"
 
+/*************************** Constant Definitions ****************************/
+
+// Keep the compiler from moving packet buffer accesses across a ring index update
+//     NOTE:  Both CPUs access the packet buffers through uncached, in-order AXI
+//         ports, so ordering the accesses in the compiled code is sufficient.
+//
+#define RX_PKT_BUF_RING_BARRIER()                          __asm__ __volatile__ ("" ::: "memory")
+
 /*********************** Global Variable Definitions *************************/
 
 /*************************** Variable Definitions ****************************/
@@ -197,3 +205,126 @@ int get_rx_pkt_buf_status(u8 pkt_buf_ind, u32 * locked, u32 * owner){
     return PKT_BUF_MUTEX_SUCCESS;
 }
 
+
+
+/************** Rx Pkt Buffer Ring *********************/
+
+/*****************************************************************************/
+/**
+ * @brief Get the Rx packet buffer ring
+ *
+ * @return  rx_pkt_buf_ring_t*   - Pointer to the ring in the Rx packet buffer memory
+ *
+ *****************************************************************************/
+rx_pkt_buf_ring_t* get_rx_pkt_buf_ring(){
+    return (rx_pkt_buf_ring_t*)RX_PKT_BUF_RING_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Initialize the Rx packet buffer ring (CPU Low)
+ *
+ * An initialized ring is left as-is so that CPU Low can reboot without losing
+ * the buffers it has already published.
+ *
+ * @param   ring             - Pointer to the ring
+ *
+ *****************************************************************************/
+void rx_pkt_buf_ring_init(rx_pkt_buf_ring_t* ring){
+    if ((ring->magic == RX_PKT_BUF_RING_MAGIC) && ((ring->head - ring->tail) <= NUM_RX_PKT_BUFS)) {
+        return;
+    }
+
+    // Invalidate the ring while the indexes are set so that CPU High does not use them
+    ring->magic = 0;
+    RX_PKT_BUF_RING_BARRIER();
+
+    ring->head  = 0;
+    ring->tail  = 0;
+    RX_PKT_BUF_RING_BARRIER();
+
+    ring->magic = RX_PKT_BUF_RING_MAGIC;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Release all published buffers without processing them (CPU High)
+ *
+ * @param   ring             - Pointer to the ring
+ *
+ *****************************************************************************/
+void rx_pkt_buf_ring_reset(rx_pkt_buf_ring_t* ring){
+    if (ring->magic == RX_PKT_BUF_RING_MAGIC) {
+        ring->tail = ring->head;
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Rx packet buffer ring producer (CPU Low)
+ *
+ * rx_pkt_buf_ring_producer_peek() returns the index of the buffer to fill next,
+ * or -1 if CPU High has not released it yet. Once the buffer has been filled
+ * (including rx_frame_info), rx_pkt_buf_ring_producer_push() passes it to CPU High.
+ *
+ * @param   ring             - Pointer to the ring
+ *
+ *****************************************************************************/
+int rx_pkt_buf_ring_producer_peek(rx_pkt_buf_ring_t* ring){
+    u32 head = ring->head;
+
+    if ((head - ring->tail) >= NUM_RX_PKT_BUFS) {
+        return -1;
+    }
+
+    // Buffer contents must not be written before the tail that released them was read
+    RX_PKT_BUF_RING_BARRIER();
+
+    return (head % NUM_RX_PKT_BUFS);
+}
+
+void rx_pkt_buf_ring_producer_push(rx_pkt_buf_ring_t* ring){
+    // Buffer contents must be complete before they are published
+    RX_PKT_BUF_RING_BARRIER();
+
+    ring->head = ring->head + 1;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Rx packet buffer ring consumer (CPU High)
+ *
+ * rx_pkt_buf_ring_consumer_peek() returns the index of the oldest buffer published
+ * by CPU Low, or -1 if there is none. Once the buffer has been processed,
+ * rx_pkt_buf_ring_consumer_pop() returns it to CPU Low.
+ *
+ * @param   ring             - Pointer to the ring
+ *
+ *****************************************************************************/
+int rx_pkt_buf_ring_consumer_peek(rx_pkt_buf_ring_t* ring){
+    u32 tail = ring->tail;
+
+    if ((ring->magic != RX_PKT_BUF_RING_MAGIC) || (ring->head == tail)) {
+        return -1;
+    }
+
+    // Buffer contents must not be read before the head that published them
+    RX_PKT_BUF_RING_BARRIER();
+
+    return (tail % NUM_RX_PKT_BUFS);
+}
+
+void rx_pkt_buf_ring_consumer_pop(rx_pkt_buf_ring_t* ring){
+    // Buffer contents must not be accessed after they are released
+    RX_PKT_BUF_RING_BARRIER();
+
+    ring->tail = ring->tail + 1;
+}
@@ -37,6 +37,7 @@
 //
 #define CMDID_NODE_AP_CONFIG                                         0x100000
 #define CMDID_NODE_AP_SET_AUTHENTICATION_ADDR_FILTER                 0x100001
+#define CMDID_NODE_AP_TX_QUEUE_SCHED                                 0x100002
 
 #define CMD_PARAM_NODE_AP_CONFIG_FLAG_DTIM_MULTICAST_BUFFER          0x00000001
 
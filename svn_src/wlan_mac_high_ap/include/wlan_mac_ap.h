@@ -28,6 +28,8 @@ enum scan_state_t;
 struct bss_config_t;
 struct tx_queue_buffer_t;
 struct tx_frame_info_t;
+struct wlan_mac_low_tx_details_t;
+struct tx_low_entry;
 //-----------------------------------------------
 // Enable the WLAN UART Menu
 #define WLAN_USE_UART_MENU
@@ -55,6 +57,22 @@ struct tx_frame_info_t;
 #define QID_TO_AID(x)                                    ((x) - 1)
 
 
+//-----------------------------------------------
+// Tx queue scheduling policies for poll_tx_queues()
+#define TX_QUEUE_SCHED_ROUND_ROBIN                         0         /// One MPDU per station queue per round
+#define TX_QUEUE_SCHED_AIRTIME_DRR                         1         /// Deficit round robin over estimated airtime
+
+// Airtime deficit round robin
+//     - A station queue is served while its deficit is positive. A backlogged
+//       queue that has used up its deficit is granted AIRTIME_DRR_QUANTUM_USEC
+//       and waits for the next round.
+//     - Tx reports charge the airtime of each attempt (PPDU + SIFS + ACK) to
+//       the station. The deficit is floored at -AIRTIME_DRR_MAX_DEBT_USEC.
+#define AIRTIME_DRR_QUANTUM_USEC                           1000
+#define AIRTIME_DRR_MAX_DEBT_USEC                          20000
+#define AIRTIME_DRR_ACK_USEC                               44        /// SIFS + 24 Mbps ACK at 20 MSps
+
+
 //-----------------------------------------------
 // Timing Parameters
 
@@ -93,6 +111,10 @@ void update_tim_tag_all(u32 sched_id);
 void poll_tx_queues();
 void purge_all_data_tx_queue();
 
+void set_tx_queue_sched_policy(u8 policy);
+u8   get_tx_queue_sched_policy();
+void mpdu_tx_low_done(struct tx_frame_info_t* tx_frame_info, struct station_info_t* station_info, struct wlan_mac_low_tx_details_t* tx_low_details, struct tx_low_entry* tx_low_event_log_entry);
+
 void enable_associations();
 void disable_associations();
 void remove_inactive_station_infos();
@@ -31,6 +31,7 @@
 #include "wlan_mac_ap.h"
 #include "wlan_mac_network_info.h"
 #include "wlan_mac_station_info.h"
+#include "wlan_mac_queue.h"
 
 #include "xil_io.h"
 
@@ -308,6 +309,9 @@ int wlan_exp_process_node_cmd(u32 cmd_id, int socket_index, void * from, cmd_res
 					gl_dtim_mcast_buffer_enable	= 0;
 					wlan_mac_high_enable_mcast_buffering(gl_dtim_mcast_buffer_enable);
 				}
+
+				// Multicast frames buffered until DTIM must not be dropped by AQM
+				queue_set_aqm_enable(MCAST_QID, (gl_dtim_mcast_buffer_enable == 0));
 			}
 
             // Send response of status
@@ -319,6 +323,53 @@ int wlan_exp_process_node_cmd(u32 cmd_id, int socket_index, void * from, cmd_res
         break;
 
 
+        //---------------------------------------------------------------------
+        case CMDID_NODE_AP_TX_QUEUE_SCHED: {
+            // Set / Get the Tx queue scheduling policy
+            //
+            // Message format:
+            //     cmd_args_32[0]   Command:
+            //                          - Write       (CMD_PARAM_WRITE_VAL)
+            //                          - Read        (CMD_PARAM_READ_VAL)
+            //     cmd_args_32[1]   Policy (TX_QUEUE_SCHED_*)
+            //
+            // Response format:
+            //     resp_args_32[0]  Status (CMD_PARAM_SUCCESS/CMD_PARAM_ERROR)
+            //     resp_args_32[1]  Policy
+            //
+            u32 status  = CMD_PARAM_SUCCESS;
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+            u32 policy  = Xil_Ntohl(cmd_args_32[1]);
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    if ((policy == TX_QUEUE_SCHED_ROUND_ROBIN) || (policy == TX_QUEUE_SCHED_AIRTIME_DRR)) {
+                        wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "AP: Tx queue scheduling policy = %d\n", policy);
+                        set_tx_queue_sched_policy(policy);
+                    } else {
+                        status = CMD_PARAM_ERROR;
+                    }
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(get_tx_queue_sched_policy());
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
         //---------------------------------------------------------------------
         case CMDID_NODE_AP_SET_AUTHENTICATION_ADDR_FILTER: {
             // Allow / Disallow wireless authentications
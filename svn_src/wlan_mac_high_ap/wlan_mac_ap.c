@@ -87,9 +87,13 @@ network_info_t* active_network_info;
 dl_list authenticated_unassociated_stations;
 
 // Tx queue variables;
-static u32 max_queue_size;
 volatile u8 pause_data_queue;
 
+// Tx queue scheduling
+static u8 tx_queue_sched_policy;
+static station_info_entry_t* airtime_drr_next_entry;
+static s32 airtime_deficit[MAX_NUM_ASSOC + 1];              // Indexed by station ID
+
 // MAC address
 static u8 wlan_mac_addr[MAC_ADDR_LEN];
 
@@ -112,6 +116,9 @@ platform_common_dev_info_t platform_common_dev_info;
 
 /*************************** Functions Prototypes ****************************/
 
+static dl_entry* dequeue_station_queue(station_info_entry_t* station_info_entry);
+static dl_entry* airtime_drr_dequeue();
+
 #if WLAN_SW_CONFIG_ENABLE_WLAN_EXP
 int  wlan_exp_process_user_cmd(u32 cmd_id, int socket_index, void * from, cmd_resp * command, cmd_resp * response, u32 max_resp_len);
 #endif
@@ -123,7 +130,11 @@ int main(){
 	// Initialize Microblaze --
 	//  these functions should be called before anything
 	//  else is executed
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+	Xil_DCacheEnable();
+#else
 	Xil_DCacheDisable();
+#endif
 	Xil_ICacheDisable();
 	microblaze_enable_exceptions();
 
@@ -155,10 +166,15 @@ int main(){
 
 	// Before any queue entries are used, calculate the maximum number of
 	// allowed enqueues based on the number that are free
-	max_queue_size = min( queue_num_free(), MAX_TX_QUEUE_LEN );
+	queue_set_default_max_length(min( queue_num_free(), MAX_TX_QUEUE_LEN ));
+
+	// Management frames (e.g. association responses) must not be dropped by AQM
+	queue_set_aqm_enable(MANAGEMENT_QID, 0);
 
 	pause_data_queue = 0;
 
+	set_tx_queue_sched_policy(TX_QUEUE_SCHED_ROUND_ROBIN);
+
 	gl_cpu_low_supports_dtim_mcast = 0;
 
 	//Set a sane default for the TIM tag byte offset
@@ -198,6 +214,7 @@ int main(){
 	wlan_mac_high_set_uart_rx_callback((void*)uart_rx);
 	wlan_mac_high_set_poll_tx_queues_callback((void*)poll_tx_queues);
 	wlan_mac_high_set_mpdu_dequeue_callback((void*)mpdu_dequeue);
+	wlan_mac_high_set_mpdu_tx_low_done_callback((void*)mpdu_tx_low_done);
 #if WLAN_SW_CONFIG_ENABLE_LTG
 	wlan_mac_ltg_sched_set_callback((void*)ltg_event);
 #endif //WLAN_SW_CONFIG_ENABLE_LTG
@@ -286,6 +303,9 @@ int main(){
 	gl_dtim_mcast_buffer_enable	= 1;
 	wlan_mac_high_enable_mcast_buffering(gl_dtim_mcast_buffer_enable);
 
+	// Multicast frames buffered until DTIM must not be dropped by AQM
+	queue_set_aqm_enable(MCAST_QID, (gl_dtim_mcast_buffer_enable == 0));
+
     // Print AP information to the terminal
 
     xil_printf("WLAN MAC AP boot complete: \n");
@@ -649,7 +669,8 @@ void update_tim_tag_all(u32 sched_id){
  * 	   response frames.
  * 	2) Data frames will be dequeued round-robin for each associated station. If DTIM multicast
  * 	   buffering is disabled, the multicast queue will be treated like an associated station in
- * 	   this policy.
+ * 	   this policy. With TX_QUEUE_SCHED_AIRTIME_DRR, station queues are instead served by
+ * 	   airtime_drr_dequeue().
  *
  *****************************************************************************/
 #define NUM_QUEUE_GROUPS 2
@@ -664,6 +685,7 @@ void poll_tx_queues(){
 	u32 i;
 
 	int num_pkt_bufs_avail;
+	int num_pkt_bufs_avail_init;
 	int poll_loop_cnt;
 
 	// Remember the next group to poll between calls to this function
@@ -687,12 +709,13 @@ void poll_tx_queues(){
 
 	// First handle the general packet buffer group
 	num_pkt_bufs_avail = wlan_mac_num_tx_pkt_buf_available(PKT_BUF_GROUP_GENERAL);
+	num_pkt_bufs_avail_init = num_pkt_bufs_avail;
 
-	// This loop will (at most) check every queue twice
+	// This loop will (at most) check every queue once per available packet buffer
 	//  This handles the case of a single non-empty queue needing to supply packets
-	//  for both GENERAL packet buffers
+	//  for every available GENERAL packet buffer
 	poll_loop_cnt = 0;
-	while((num_pkt_bufs_avail > 0) && (poll_loop_cnt < (2*NUM_QUEUE_GROUPS))) {
+	while((num_pkt_bufs_avail > 0) && (poll_loop_cnt < (num_pkt_bufs_avail_init*NUM_QUEUE_GROUPS))) {
 		poll_loop_cnt++;
 		curr_queue_group = next_queue_group;
 
@@ -718,6 +741,17 @@ void poll_tx_queues(){
 				continue;
 			}
 
+			if(tx_queue_sched_policy == TX_QUEUE_SCHED_AIRTIME_DRR) {
+				tx_queue_buffer_entry = airtime_drr_dequeue();
+				if(tx_queue_buffer_entry) {
+					// Update the packet buffer group
+					((tx_queue_buffer_t*)(tx_queue_buffer_entry->data))->queue_info.pkt_buf_group = PKT_BUF_GROUP_GENERAL;
+					transmit_checkin(tx_queue_buffer_entry);
+					num_pkt_bufs_avail--;
+				}
+				continue;
+			}
+
 			for(i = 0; i < (active_network_info->members.length + 1); i++) {
 				// Resume polling data queues from where we stopped on the previous call
 				curr_station_info_entry = next_station_info_entry;
@@ -757,7 +791,7 @@ void poll_tx_queues(){
 
 						if((curr_station_info->ps_state & STATION_INFO_PS_STATE_DOZE) == 0) {
 
-							tx_queue_buffer_entry = dequeue_from_head(STATION_ID_TO_QUEUE_ID(curr_station_info_entry->id));
+							tx_queue_buffer_entry = dequeue_station_queue(curr_station_info_entry);
 							if(tx_queue_buffer_entry) {
 								// Update the packet buffer group
 								((tx_queue_buffer_t*)(tx_queue_buffer_entry->data))->queue_info.pkt_buf_group = PKT_BUF_GROUP_GENERAL;
@@ -800,11 +834,204 @@ void poll_tx_queues(){
 		}
 	}
 
+	// Hand off the last MPDU dequeued above once its copy is finished
+	wlan_mac_high_mpdu_transmit_complete();
+
 	wlan_mac_high_interrupt_restore_state(curr_interrupt_state);
 }
 
 
 
+/*****************************************************************************/
+/**
+ * @brief Dequeue from the Tx queue of an associated station
+ *
+ * HT stations must be able to receive A-MSDUs, so frames queued for them are
+ * aggregated with dequeue_amsdu_from_head().
+ *
+ * @param  station_info_entry_t* station_info_entry
+ *     - Station whose queue to dequeue from
+ * @return dl_entry*
+ *     - Dequeued entry or NULL if the queue is empty
+ *****************************************************************************/
+static dl_entry* dequeue_station_queue(station_info_entry_t* station_info_entry){
+	station_info_t* station_info = (station_info_t*)(station_info_entry->data);
+
+	if(station_info->capabilities & STATION_INFO_CAPABILITIES_HT_CAPABLE) {
+		return dequeue_amsdu_from_head(STATION_ID_TO_QUEUE_ID(station_info_entry->id), queue_get_amsdu_max_length());
+	} else {
+		return dequeue_from_head(STATION_ID_TO_QUEUE_ID(station_info_entry->id));
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Select the next data frame with the airtime deficit round robin policy
+ *
+ * Rounds visit each associated station in turn. The multicast queue supplies one
+ * frame at the start of every round (unless DTIM multicast buffering is enabled),
+ * independent of the deficits. A station with a positive deficit keeps its turn
+ * until its deficit is used up by Tx reports; a backlogged station without
+ * deficit is granted AIRTIME_DRR_QUANTUM_USEC and the turn passes on. Since the
+ * deficit is floored, some station with queued frames is served within
+ * (AIRTIME_DRR_MAX_DEBT_USEC / AIRTIME_DRR_QUANTUM_USEC) + 1 rounds.
+ *
+ * Must be called with interrupts stopped.
+ *
+ * @return dl_entry*
+ *     - Dequeued entry or NULL if all data queues are empty
+ *****************************************************************************/
+static dl_entry* airtime_drr_dequeue(){
+	dl_entry* tx_queue_buffer_entry;
+	station_info_entry_t* curr_station_info_entry;
+	station_info_t* curr_station_info;
+	s32* deficit;
+	u32 num_visits;
+	u32 max_visits;
+	u8 backlogged = 1;
+
+	max_visits = (active_network_info->members.length + 1) * ((AIRTIME_DRR_MAX_DEBT_USEC / AIRTIME_DRR_QUANTUM_USEC) + 2);
+
+	for(num_visits = 0; num_visits < max_visits; num_visits++) {
+		curr_station_info_entry = airtime_drr_next_entry;
+
+		if(curr_station_info_entry == NULL) {
+			// Start of a round
+			if(backlogged == 0) {
+				// No station had queued frames in the previous round
+				return NULL;
+			}
+			backlogged = 0;
+			airtime_drr_next_entry = (station_info_entry_t*)(active_network_info->members.first);
+
+			if((gl_dtim_mcast_buffer_enable && gl_cpu_low_supports_dtim_mcast) == 0) {
+				tx_queue_buffer_entry = dequeue_from_head(MCAST_QID);
+				if(tx_queue_buffer_entry) { return tx_queue_buffer_entry; }
+			}
+			continue;
+		}
+
+		curr_station_info = (station_info_t*)(curr_station_info_entry->data);
+
+		if(station_info_is_member(&active_network_info->members, curr_station_info) == 0) {
+			// The station was removed from the BSS - restart the round
+			airtime_drr_next_entry = NULL;
+			continue;
+		}
+
+		if(curr_station_info_entry->id < (MAX_NUM_ASSOC + 1)) {
+			deficit = &(airtime_deficit[curr_station_info_entry->id]);
+		} else {
+			deficit = NULL;
+		}
+
+		if((curr_station_info->ps_state & STATION_INFO_PS_STATE_DOZE) ||
+		   (queue_num_queued(STATION_ID_TO_QUEUE_ID(curr_station_info_entry->id)) == 0)) {
+			// Idle stations do not accumulate deficit
+			if(deficit && (*deficit > 0)) { *deficit = 0; }
+			tx_queue_buffer_entry = NULL;
+		} else {
+			backlogged = 1;
+
+			if(deficit && (*deficit <= 0)) {
+				*deficit += AIRTIME_DRR_QUANTUM_USEC;
+				tx_queue_buffer_entry = NULL;
+			} else {
+				tx_queue_buffer_entry = dequeue_station_queue(curr_station_info_entry);
+				if(tx_queue_buffer_entry) {
+					// Keep the turn until the deficit is used up
+					return tx_queue_buffer_entry;
+				}
+			}
+		}
+
+		// Pass the turn to the next station
+		if(curr_station_info_entry == (station_info_entry_t*)(active_network_info->members.last)) {
+			airtime_drr_next_entry = NULL;
+		} else {
+			airtime_drr_next_entry = dl_entry_next(curr_station_info_entry);
+		}
+	}
+
+	return NULL;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Set / get the Tx queue scheduling policy
+ *
+ * Changing the policy restarts the airtime deficit round robin with all
+ * deficits cleared.
+ *
+ * @param  u8 policy
+ *     - TX_QUEUE_SCHED_ROUND_ROBIN or TX_QUEUE_SCHED_AIRTIME_DRR
+ *****************************************************************************/
+void set_tx_queue_sched_policy(u8 policy){
+	interrupt_state_t curr_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	tx_queue_sched_policy  = policy;
+	airtime_drr_next_entry = NULL;
+	bzero(airtime_deficit, sizeof(airtime_deficit));
+
+	wlan_mac_high_interrupt_restore_state(curr_interrupt_state);
+}
+
+u8 get_tx_queue_sched_policy(){
+	return tx_queue_sched_policy;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Callback for each low-level transmission attempt
+ *
+ * With the airtime deficit round robin policy, the airtime of each attempt
+ * to an associated station is charged to that station.
+ *
+ * @param  tx_frame_info_t* tx_frame_info
+ *     - Tx frame info of the packet buffer
+ * @param  station_info_t* station_info
+ *     - Receiver of the attempt (may be NULL)
+ * @param  wlan_mac_low_tx_details_t* tx_low_details
+ *     - Details of the attempt from CPU Low
+ * @param  tx_low_entry* tx_low_event_log_entry
+ *     - Log entry of the attempt (may be NULL)
+ *****************************************************************************/
+void mpdu_tx_low_done(tx_frame_info_t* tx_frame_info, station_info_t* station_info, wlan_mac_low_tx_details_t* tx_low_details, tx_low_entry* tx_low_event_log_entry){
+	u32 airtime = 0;
+	s32* deficit;
+
+	if((tx_queue_sched_policy != TX_QUEUE_SCHED_AIRTIME_DRR) || (station_info == NULL) || (active_network_info == NULL)) return;
+	if((station_info->ID == 0) || (station_info->ID > MAX_NUM_ASSOC)) return;
+	if(station_info_is_member(&active_network_info->members, station_info) == 0) return;
+
+	switch(tx_low_details->tx_details_type) {
+		case TX_DETAILS_RTS_ONLY:
+		case TX_DETAILS_RTS_MPDU:
+			// RTS + SIFS + CTS
+			airtime += wlan_mac_high_calc_txtime(sizeof(mac_header_80211_RTS) + WLAN_PHY_FCS_NBYTES, tx_low_details->phy_params_ctrl.mcs,
+			                                     PHY_MODE_NONHT, tx_frame_info->phy_samp_rate) + AIRTIME_DRR_ACK_USEC;
+			if(tx_low_details->tx_details_type == TX_DETAILS_RTS_ONLY) break;
+			// fall through - an RTS_MPDU attempt also sent the MPDU
+		case TX_DETAILS_MPDU:
+			airtime += wlan_mac_high_calc_txtime(tx_frame_info->length, tx_low_details->phy_params_mpdu.mcs, tx_low_details->phy_params_mpdu.phy_mode,
+			                                     tx_frame_info->phy_samp_rate) + AIRTIME_DRR_ACK_USEC;
+		break;
+		default:
+		break;
+	}
+
+	deficit  = &(airtime_deficit[station_info->ID]);
+	*deficit = max(*deficit - (s32)airtime, -AIRTIME_DRR_MAX_DEBT_USEC);
+}
+
+
+
 /*****************************************************************************/
 /**
  * @brief Purges all packets from all Tx queues
@@ -929,7 +1156,7 @@ void ltg_event(u32 id, void* callback_arg){
 		do{
 			continue_loop = 0;
 
-			if(queue_num_queued(queue_sel) < max_queue_size){
+			if(queue_is_full(queue_sel) == 0){
 				// Checkout 1 element from the queue;
 				curr_tx_queue_element = queue_checkout();
 				if(curr_tx_queue_element != NULL){
@@ -1007,7 +1234,7 @@ int ethernet_receive(dl_entry* curr_tx_queue_element, u8* eth_dest, u8* eth_src,
 	// Determine how to send the packet
 	if( wlan_addr_mcast(eth_dest) ) {
 		// Send the multicast packet
-		if(queue_num_queued(MCAST_QID) < max_queue_size){
+		if(queue_is_full(MCAST_QID) == 0){
 
 			// Send the pre-encapsulated Ethernet frame over the wireless interface
 			//     NOTE:  The queue element has already been provided, so we do not need to check if it is NULL
@@ -1047,7 +1274,7 @@ int ethernet_receive(dl_entry* curr_tx_queue_element, u8* eth_dest, u8* eth_src,
 			station_info = (station_info_t*)(entry->data);
 
 			// Send the unicast packet
-			if(queue_num_queued(STATION_ID_TO_QUEUE_ID(entry->id)) < max_queue_size){
+			if(queue_is_full(STATION_ID_TO_QUEUE_ID(entry->id)) == 0){
 
 				// Send the pre-encapsulated Ethernet frame over the wireless interface
 				//     NOTE:  The queue element has already been provided, so we do not need to check if it is NULL
@@ -1258,6 +1485,9 @@ u32 mpdu_rx_process(void* pkt_buf_addr, station_info_t* station_info, rx_common_
 				poll_tx_queues();
 			}
 
+			// Frames for a dozing station are held on purpose; keep that time out of AQM
+			queue_set_aqm_enable(STATION_ID_TO_QUEUE_ID(station_info->ID), ((station_info->ps_state & STATION_INFO_PS_STATE_DOZE) == 0));
+
 			// Update station information
 			rx_frame_info->additional_info                    = (u32)station_info;
 
@@ -1879,6 +2109,14 @@ u32  deauthenticate_station( station_info_t* station_info ) {
 	// TODO:  (Optional) Log association state change
 	//
 
+	// Reset the airtime scheduling state of this STA
+	if(aid <= MAX_NUM_ASSOC) {
+		airtime_deficit[aid] = 0;
+	}
+	if((airtime_drr_next_entry != NULL) && (airtime_drr_next_entry->data == station_info)) {
+		airtime_drr_next_entry = NULL;
+	}
+
 	// Remove this STA from association list
 
 	station_info_remove(&active_network_info->members, station_info->addr);
@@ -2199,6 +2437,7 @@ u32	configure_bss(bss_config_t* bss_config, u32 update_mask){
 			}
 			if (update_mask & BSS_FIELD_MASK_SSID) {
 				strncpy(active_network_info->bss_config.ssid, bss_config->ssid, SSID_LEN_MAX);
+				wlan_mac_high_update_network_info_SSID(active_network_info);
 				update_beacon_template = 1;
 			}
 			if (update_mask & BSS_FIELD_MASK_BEACON_INTERVAL) {
@@ -20,6 +20,7 @@
 
 // WLAN includes
 #include "wlan_platform_common.h"
+#include "wlan_platform_high.h"
 #include "wlan_mac_event_log.h"
 #include "wlan_mac_entries.h"
 #include "wlan_mac_ap.h"
@@ -28,6 +29,7 @@
 #include "wlan_mac_network_info.h"
 #include "wlan_mac_station_info.h"
 #include "wlan_mac_high.h"
+#include "wlan_mac_high_mailbox_util.h"
 #include "wlan_mac_queue.h"
 #include "wlan_mac_dl_list.h"
 
@@ -167,6 +169,20 @@ void uart_rx(u8 rxByte){
 					wlan_mac_high_display_mallinfo();
 				break;
 
+				// ----------------------------------------
+				// 'i' - Display IPC receive, Ethernet Tx and scheduler execution counts
+				//
+				case ASCII_i:
+					wlan_mac_high_print_ipc_rx_counts();
+					wlan_mac_schedule_print_exec_monitor();
+#if WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
+					wlan_platform_ethernet_print_tx_counts();
+#endif //WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+					wlan_mac_high_print_pkt_proc_benchmark();
+#endif
+				break;
+
 			}
 		break;
 
@@ -198,6 +198,13 @@ extern const char   * print_type_queue;
 #define GROUP_USER                                         0x20
 
 
+// **********************************************************************
+// Command / Response flags (see cmd_resp)
+//
+#define CMD_RESP_FLAG_BROADCAST                            0x00000001
+#define CMD_RESP_FLAG_DEFER                                0x00000002
+
+
 
 /*********************** Global Structure Definitions ************************/
 // 
@@ -219,6 +226,7 @@ typedef struct cmd_resp_hdr{
 typedef struct cmd_resp{
     u32                      flags;                        // Flags for the command / response
                                                            //     [0] - Is the packet broadcast?  WLAN_EXP_TRUE / WLAN_EXP_FALSE
+                                                           //     [1] - Did the host ask for the command to be deferred?
     void                   * buffer;                       // In general, assumed to be a (wlan_exp_ip_udp_buffer *)
     cmd_resp_hdr           * header;
     u32                    * args;
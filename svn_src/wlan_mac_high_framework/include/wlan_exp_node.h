@@ -45,6 +45,11 @@
 #define CMD_PARAM_NODE_CONFIG_RESET_ALL                    0xFFFFFFFF
 
 #define CMDID_NODE_TEMPERATURE                             0x000005
+#define CMDID_NODE_CMD_STATUS                              0x000006
+
+#define CMD_PARAM_NODE_CMD_JOB_IDLE                        0x00000000
+#define CMD_PARAM_NODE_CMD_JOB_RUNNING                     0x00000001
+#define CMD_PARAM_NODE_CMD_JOB_DONE                        0x00000002
 
 
 //-----------------------------------------------
@@ -62,6 +67,7 @@
 #define CMDID_NODE_LOW_TO_HIGH_FILTER                      0x001016
 #define CMDID_NODE_RANDOM_SEED                             0x001017
 #define CMDID_NODE_WLAN_MAC_ADDR                           0x001018
+#define CMDID_NODE_TX_RATE_SELECTION                       0x001019
 #define CMDID_NODE_LOW_PARAM                               0x001020
 
 #define CMD_PARAM_WRITE_VAL                                0x00000000
@@ -141,6 +147,7 @@
 #define CMDID_LOG_ADD_EXP_INFO_ENTRY                       0x003004
 
 #define CMDID_LOG_ENABLE_ENTRY                             0x003006
+#define CMDID_LOG_STREAM                                   0x003007
 
 #define CMD_PARAM_LOG_GET_ALL_ENTRIES                      0xFFFFFFFF
 
@@ -150,6 +157,9 @@
 #define CMD_PARAM_LOG_CONFIG_FLAG_TXRX_MPDU                0x00000008
 #define CMD_PARAM_LOG_CONFIG_FLAG_TXRX_CTRL                0x00000010
 
+#define CMD_PARAM_LOG_STREAM_ENABLE                        0x00000001
+#define CMD_PARAM_LOG_STREAM_DISABLE                       0x00000000
+
 
 //-----------------------------------------------
 // Counts Commands
@@ -164,6 +174,8 @@
 // Queue Commands
 //
 #define CMDID_QUEUE_TX_DATA_PURGE_ALL                      0x005000
+#define CMDID_QUEUE_TX_AMSDU_MAX_LENGTH                    0x005001
+#define CMDID_QUEUE_TX_PKT_BUF_DEPTH                       0x005002
 
 
 //-----------------------------------------------
@@ -171,6 +183,8 @@
 //
 #define CMDID_NODE_SCAN_PARAM                              0x006000
 #define CMDID_NODE_SCAN                                    0x006001
+#define CMDID_NODE_SCAN_ADAPTIVE                           0x006002
+#define CMDID_NODE_SCAN_STATS                              0x006003
 
 #define CMD_PARAM_NODE_SCAN_ENABLE                         0x00000001
 #define CMD_PARAM_NODE_SCAN_DISABLE                        0x00000000
@@ -182,6 +196,9 @@
 #define CMDID_NODE_GET_BSS_MEMBERS                         0x007001
 #define CMDID_NODE_GET_BSS_INFO                            0x007002
 #define CMDID_NODE_GET_STATION_INFO_LIST                   0x007003
+#define CMDID_NODE_GET_STATION_INFO_DELTA                  0x007004
+
+#define CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL             0x00000001          // Response lists every station; replaces the host's table
 
 #define CMDID_NODE_DISASSOCIATE                            0x007010
 #define CMDID_NODE_ASSOCIATE                               0x007011
@@ -195,6 +212,8 @@
 #define CMDID_DEV_MEM_HIGH                                 0xFFF000
 #define CMDID_DEV_MEM_LOW                                  0xFFF001
 #define CMDID_DEV_EEPROM                                   0xFFF002
+#define CMDID_DEV_SLAB_STATS                               0xFFF003
+#define CMDID_DEV_SCHED_EXEC_MONITOR                       0xFFF004
 
 
 // ****************************************************************************
@@ -340,6 +359,13 @@ void node_info_set_max_counts     (u32 max_counts);
 
 u32  node_get_serial_number       (void);
 
+#if WLAN_SW_CONFIG_ENABLE_LOGGING
+void node_log_stream_poll         (u32 eth_dev_num);
+#endif
+
+int  node_cmd_job_start           (int socket_index, u32 cmd_id, function_ptr_t step, u32 arg, u32 * job_id);
+void node_cmd_job_poll            (u32 eth_dev_num);
+
 #endif //WLAN_SW_CONFIG_ENABLE_WLAN_EXP
 
 
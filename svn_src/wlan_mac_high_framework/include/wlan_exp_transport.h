@@ -89,6 +89,9 @@
 #define TRANSPORT_NUM_ETH_DEVICES                          WLAN_EXP_IP_UDP_NUM_ETH_DEVICES
 #define TRANSPORT_ETH_DEV_INITIALIZED                      1
 
+// Maximum number of received packets processed by a single transport_poll()
+#define TRANSPORT_POLL_MAX_NUM_PKTS                        4
+
 // Ethernet A constants
 #define TRANSPORT_ETH_A                                    ETH_A_MAC
 
@@ -151,6 +154,7 @@
 
 // Transport header flags (16 bits)
 #define TRANSPORT_HDR_ROBUST_FLAG                          0x0001
+#define TRANSPORT_HDR_DEFER_FLAG                           0x0002            // Host asks for a deferred command (see node_cmd_job_start())
 #define TRANSPORT_HDR_NODE_NOT_READY_FLAG                  0x8000
 
 // Transport header dest_id values
@@ -54,6 +54,18 @@
 
 #define WLAN_PROCESS_ETH_RX_RETURN_IS_ENQUEUED	0x0000001
 
+//-----------------------------------------------
+// Portal frame classes
+//     - Only ARP and DHCP frames need inspection or rewriting beyond the mapping
+//       between the Ethernet and 802.11 headers; all other IPv4 frames take the fast path
+//
+typedef enum eth_frame_class_t{
+    ETH_FRAME_CLASS_UNSUPPORTED,
+    ETH_FRAME_CLASS_IP,
+    ETH_FRAME_CLASS_ARP,
+    ETH_FRAME_CLASS_DHCP
+} eth_frame_class_t;
+
 
 /*********************** Global Structure Definitions ************************/
 
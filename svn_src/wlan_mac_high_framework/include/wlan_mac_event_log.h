@@ -90,6 +90,19 @@ typedef struct entry_header{
 } entry_header;
 
 
+//-----------------------------------------------
+// Log Cursor
+//   - Read position of a consumer that follows the log through wraps (eg log streaming)
+//   - num_wraps is the value of the log wrap count that index belongs to
+//   - num_resets is the value of the log reset count when the cursor was last positioned
+//
+typedef struct event_log_cursor_t{
+    u32 index;
+    u32 num_wraps;
+    u32 num_resets;
+} event_log_cursor_t;
+
+
 
 /*************************** Function Prototypes *****************************/
 
@@ -108,6 +121,9 @@ u32       event_log_get_next_entry_index( void );
 u32       event_log_get_oldest_entry_index( void );
 u32       event_log_get_num_wraps( void );
 u32       event_log_get_flags( void );
+
+void      event_log_cursor_init( event_log_cursor_t* cursor );
+u32       event_log_cursor_get_size( event_log_cursor_t* cursor, u32* overrun );
 void*     event_log_get_next_empty_entry( u16 entry_type, u16 entry_size );
 
 void      print_event_log( u32 num_events );
@@ -0,0 +1,118 @@
+/** @file wlan_mac_hash_index.h
+ *  @brief Hash Index
+ *
+ *  This contains code for open addressed hash indexes over arrays of entries.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+/***************************** Include Files *********************************/
+
+
+/*************************** Constant Definitions ****************************/
+#ifndef WLAN_MAC_HASH_INDEX_H_
+#define WLAN_MAC_HASH_INDEX_H_
+
+#include "xil_types.h"
+
+
+//-----------------------------------------------
+// Hash index defines
+//     - Each bucket holds the index of an entry plus one, so 0 marks an empty bucket
+//     - Collisions are resolved by linear probing. An index must have more buckets
+//       than entries so that every probe ends at an empty bucket.
+//     - Removal uses backward-shift deletion rather than tombstones so that probe
+//       lengths do not grow as entries are replaced
+//
+#define HASH_INDEX_MULTIPLIER                              0x9E3779B1  ///< 2^32 / golden ratio
+
+
+/*********************** Global Structure Definitions ************************/
+
+/********************************************************************
+ * @brief Hash Index
+ *
+ * The entries themselves are owned by the caller. The index only needs to be
+ * able to find the home bucket of the entry at a given array index.
+ *
+ ********************************************************************/
+typedef struct hash_index_t{
+	u16*     buckets;                          ///< Array of (1 << num_bits) buckets
+	u32      num_bits;                         ///< log2 of the number of buckets
+	u32    (*entry_bucket)(u32 index);         ///< Home bucket of the entry at index
+} hash_index_t;
+
+
+/*************************** Function Prototypes *****************************/
+
+void hash_index_init(hash_index_t* hash, u16* buckets, u32 num_bits, u32 (*entry_bucket)(u32 index));
+void hash_index_insert(hash_index_t* hash, u32 index);
+void hash_index_remove(hash_index_t* hash, u32 index);
+
+
+/**
+ * @brief Hash Index Bucket
+ *
+ * Multiplicative hash of a 32-bit key into num_bits bits. The key should place
+ * its most variable bits high since the product is taken from the top bits.
+ *
+ * @param  u32 key                  - Key to hash
+ * @param  u32 num_bits             - log2 of the number of buckets
+ *
+ * @return u32                      - Home bucket for the key
+ */
+static inline u32 hash_index_bucket(u32 key, u32 num_bits){
+	return (key * HASH_INDEX_MULTIPLIER) >> (32 - num_bits);
+}
+
+/**
+ * @brief Hash Index MAC Address Bucket
+ *
+ * Folds a 6-byte MAC address into a key. The low bytes of a MAC address carry
+ * most of the entropy (the high bytes are the OUI), so they are placed in the
+ * upper bits of the key.
+ *
+ * @param  u8* addr                 - Address to hash
+ * @param  u32 num_bits             - log2 of the number of buckets
+ *
+ * @return u32                      - Home bucket for the address
+ */
+static inline u32 hash_index_addr_bucket(u8* addr, u32 num_bits){
+	u32 key;
+
+	key = (((u32)addr[5] << 24) | ((u32)addr[4] << 16) | ((u32)addr[3] << 8) | (u32)addr[2]) ^ (((u32)addr[1] << 8) | (u32)addr[0]);
+
+	return hash_index_bucket(key, num_bits);
+}
+
+/**
+ * @brief Hash Index Probe
+ *
+ * Steps a lookup along the probe run that starts at the home bucket of the key.
+ * The caller compares each returned entry against its key, so lookups do not go
+ * through a callback:
+ *
+ *     bucket = <home bucket of key>;
+ *     while((value = hash_index_probe(hash, &bucket)) != 0){
+ *         if(<entry (value - 1) matches key>) ...
+ *     }
+ *
+ * @param  hash_index_t* hash       - Hash index to probe
+ * @param  u32* bucket              - Bucket to read; advanced to the next bucket of the run
+ *
+ * @return u32                      - Entry index + 1 stored in the bucket, 0 at the end of the run
+ */
+static inline u32 hash_index_probe(hash_index_t* hash, u32* bucket){
+	u32 value = hash->buckets[*bucket];
+
+	*bucket = (*bucket + 1) & ((1 << hash->num_bits) - 1);
+
+	return value;
+}
+
+#endif /* WLAN_MAC_HASH_INDEX_H_ */
@@ -21,6 +21,10 @@
 #include "wlan_common_types.h"
 #include "wlan_high_types.h"
 
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+#include "xil_cache.h"
+#endif
+
 // Forward declarations
 struct mac_header_80211_common;
 struct wlan_ipc_msg_t;
@@ -205,6 +209,51 @@ struct station_info_t;
 #define MAC_RX_CALLBACK_RETURN_FLAG_NO_COUNTS					0x00000002
 #define MAC_RX_CALLBACK_RETURN_FLAG_NO_LOG_ENTRY				0x00000004
 
+//-----------------------------------------------
+// MPDU Transmit Return Values
+//     - TX_HANDOFF_PENDING means the CDMA copy into the Tx packet buffer is still in
+//       flight and the Tx queue element is checked in by wlan_mac_high_mpdu_transmit_complete()
+//
+#define TX_HANDOFF_COMPLETE										0
+#define TX_HANDOFF_PENDING										1
+
+//-----------------------------------------------
+// Tx packet buffer pipeline depth
+//     - Maximum number of Tx packet buffers of a group that CPU Low may own at once
+//     - The GENERAL depth can be changed at run time (1 to NUM_TX_PKT_BUF_MPDU) with
+//       wlan_mac_high_set_tx_pkt_buf_depth()
+//     - The GENERAL default keeps the original ping-pong behavior; the inter-frame gap at
+//       depth 2 vs. 4 has not been measured, so a deeper default is not justified yet
+//
+#define TX_PKT_BUF_GENERAL_DEPTH_DEFAULT						2
+#define TX_PKT_BUF_DTIM_MCAST_DEPTH								3
+
+//-----------------------------------------------
+// Data cache maintenance around DMA transfers
+//     - Flush before a DMA engine reads memory written by the CPU; invalidate before the
+//       CPU reads memory written by a DMA engine
+//     - Also flush a DMA destination before the DMA is armed. On the MicroBlaze a flush writes
+//       back and invalidates, so no dirty line can later be evicted over the data the DMA
+//       wrote, and lines the destination only partly covers keep the CPU's writes
+//     - These compile to nothing unless WLAN_SW_CONFIG_ENABLE_DCACHE is set
+//
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+#define wlan_mac_high_dcache_flush(addr, size)                  Xil_DCacheFlushRange((u32)(addr), (size))
+#define wlan_mac_high_dcache_invalidate(addr, size)             Xil_DCacheInvalidateRange((u32)(addr), (size))
+#else
+#define wlan_mac_high_dcache_flush(addr, size)
+#define wlan_mac_high_dcache_invalidate(addr, size)
+#endif
+
+//-----------------------------------------------
+// Packet processing benchmark
+//     - If 1, CPU High records the time it spends processing each wireless reception
+//       and each Ethernet reception. Comparing the averages printed by
+//       wlan_mac_high_print_pkt_proc_benchmark() for builds with WLAN_SW_CONFIG_ENABLE_DCACHE
+//       set to 0 and 1 measures the per-packet benefit of the data cache.
+//
+#define WLAN_MAC_HIGH_PKT_PROC_BENCHMARK						0
+
 
 
 /************************** Global Type Definitions **************************/
@@ -214,6 +263,18 @@ typedef enum interrupt_state_t{
 	INTERRUPTS_ENABLED
 } interrupt_state_t;
 
+typedef enum pkt_proc_benchmark_t{
+	PKT_PROC_BENCHMARK_WLAN_RX,
+	PKT_PROC_BENCHMARK_ETH_RX,
+	PKT_PROC_BENCHMARK_NUM_TYPES
+} pkt_proc_benchmark_t;
+
+typedef struct pkt_proc_times_t{
+	u32		num_pkts;
+	u32		max_usec;
+	u64		sum_usec;
+} pkt_proc_times_t;
+
 
 /******************** Global Structure/Enum Definitions **********************/
 
@@ -261,7 +322,15 @@ int                wlan_mac_high_right_shift_test();
 int                wlan_mac_high_cdma_start_transfer(void* dest, void* src, u32 size);
 void               wlan_mac_high_cdma_finish_transfer();
 
-void               wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf);
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+void               wlan_mac_high_pkt_proc_benchmark_record(pkt_proc_benchmark_t type, u64 start_usec);
+void               wlan_mac_high_print_pkt_proc_benchmark();
+#endif
+
+int                wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf);
+void               wlan_mac_high_mpdu_transmit_complete();
+void               wlan_mac_high_set_tx_pipeline(u8 enable);
+u8                 wlan_mac_high_get_tx_pipeline();
 
 void               wlan_mac_high_setup_tx_header(struct mac_header_80211_common* header, u8* addr_1, u8* addr_3);
 
@@ -286,12 +355,15 @@ int                wlan_mac_high_write_low_param(u32 num_words, u32* payload);
 void               wlan_mac_high_request_low_state();
 int 			   wlan_mac_high_is_cpu_low_initialized();
 int                wlan_mac_num_tx_pkt_buf_available(pkt_buf_group_t pkt_buf_group);
+int                wlan_mac_high_set_tx_pkt_buf_depth(u8 depth);
+u8                 wlan_mac_high_get_tx_pkt_buf_depth();
 int                wlan_mac_high_get_empty_tx_packet_buffer();
 u8                 wlan_mac_high_is_pkt_ltg(void* mac_payload, u16 length);
 
 int                wlan_mac_high_configure_beacon_tx_template(struct mac_header_80211_common* tx_header_common_ptr, struct network_info_t* network_info, tx_params_t* tx_params_ptr, u8 flags);
 int                wlan_mac_high_update_beacon_tx_params(tx_params_t* tx_params_ptr);
 tx_params_t		   wlan_mac_sanitize_tx_params(struct station_info_t* station_info, tx_params_t* tx_params);
+u16                wlan_mac_high_calc_txtime(u16 length, u8 mcs, u8 phy_mode, u8 phy_samp_rate);
 
 
 
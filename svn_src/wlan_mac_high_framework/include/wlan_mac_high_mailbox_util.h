@@ -2,9 +2,25 @@
 #define WLAN_MAC_HIGH_MAILBOX_UTIL_H_
 
 #include "xintc.h"
+#include "xil_types.h"
+
+//-----------------------------------------------
+// IPC receive counts
+//     - A message carried in an IPC_MBOX_BATCH message counts once in num_msgs
+//
+typedef struct ipc_rx_counts_t{
+	u32 num_interrupts;                  ///< # of mailbox receive interrupts
+	u32 num_msgs;                        ///< # of messages processed
+	u32 num_batches;                     ///< # of IPC_MBOX_BATCH messages received
+	u32 max_msgs_per_interrupt;          ///< Largest # of messages processed in one interrupt
+} ipc_rx_counts_t;
 
 void wlan_mac_high_init_mailbox();
-void wlan_mac_high_ipc_rx();
+u32  wlan_mac_high_ipc_rx();
+
+ipc_rx_counts_t* wlan_mac_high_get_ipc_rx_counts();
+void wlan_mac_high_reset_ipc_rx_counts();
+void wlan_mac_high_print_ipc_rx_counts();
 
 int setup_mailbox_interrupt(XIntc* intc);
 void mailbox_int_handler(void* callback_ref);
@@ -40,4 +40,9 @@
 
 #define WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE	1		//Top-level switch for compiling Ethernet bridging functionality.
 
+#define WLAN_SW_CONFIG_ENABLE_DCACHE        0       //Top-level switch for running CPU High with the data cache enabled. Every DMA
+                                                    // transfer that touches DRAM (CDMA, Ethernet and wlan_exp IP/UDP) then does
+                                                    // the matching cache flush / invalidate. Requires a hardware design whose
+                                                    // MicroBlaze D-cache address range covers only DRAM.
+
 #endif /* WLAN_MAC_HIGH_SW_CONFIG_H_ */
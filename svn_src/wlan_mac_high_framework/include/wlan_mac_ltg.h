@@ -39,6 +39,10 @@ struct mac_header_80211_common;
 #define LTG_START_ALL                   0xFFFFFFFF
 #define LTG_STOP_ALL                    0xFFFFFFFF
 
+//Maximum number of LTGs that can exist at once. LTG structs are allocated from
+//fixed-size slab caches (see wlan_mac_slab.h).
+#define LTG_MAX_NUM_LTGS                16
+
 
 //In spirit, tg_schedule is derived from dl_entry. Since C
 //lacks a formal notion of inheritance, we adopt a popular
@@ -145,5 +149,7 @@ dl_entry* ltg_sched_find_tg_schedule(u32 id);
 // WLAN Exp function to LTG -- users may call these directly or modify if needed
 void* ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size);
 void* ltg_payload_deserialize(u32 * src, u32 * ret_type, u32 * ret_size);
+void ltg_sched_params_free(void* params);
+void ltg_payload_free(void* payload);
 
 #endif /* WLAN_MAC_LTG_H_ */
@@ -31,6 +31,17 @@
 #define NETWORK_INFO_TIMEOUT_USEC                              600000000
 
 
+//-----------------------------------------------
+// BSSID / SSID hash indexes over the flat network_info_list
+//     - The BSSID index uses open addressing with linear probing; the SSID index
+//       chains every entry with the same SSID hash
+//     - Must be a power of 2 and larger than the number of network_info_entry_t
+//       structs placed in BSS_INFO_DL_ENTRY_MEM
+//
+#define NETWORK_INFO_HASH_NUM_BUCKETS                      256
+#define NETWORK_INFO_HASH_NUM_BITS                         8
+
+
 //-----------------------------------------------
 // Field size defines
 //
@@ -135,7 +146,7 @@ struct network_info_entry_t{
 	network_info_entry_t* prev;
 	network_info_t*       data;
 	u8			    	  bssid[6];
-	u16			          padding;
+	u16			          ssid_hash;
 };
 ASSERT_TYPE_SIZE(network_info_entry_t, 20);
 
@@ -152,8 +163,9 @@ void network_info_rx_process(void* pkt_buf_addr);
 void print_network_info();
 void network_info_timestamp_check();
 
-dl_list* wlan_mac_high_find_network_info_SSID(char* ssid);
+network_info_entry_t* wlan_mac_high_find_network_info_SSID(char* ssid, network_info_entry_t* prev_entry);
 network_info_entry_t* wlan_mac_high_find_network_info_BSSID(u8* bssid);
+void wlan_mac_high_update_network_info_SSID(network_info_t* info);
 
 network_info_t* wlan_mac_high_create_network_info(u8* bssid, char* ssid, u8 chan);
 void wlan_mac_high_reset_network_list();
@@ -131,6 +131,8 @@ int wlan_create_association_response_frame(void* pkt_buf, struct mac_header_8021
 
 int wlan_create_reassoc_assoc_req_frame(void* pkt_buf, u8 frame_control_1, struct mac_header_80211_common* common, struct network_info_t* network_info);
 int wlan_create_data_frame(void* pkt_buf, struct mac_header_80211_common* common, u8 flags);
+int wlan_create_amsdu_frame(void* pkt_buf, u32 length);
+int wlan_append_amsdu_subframe(void* pkt_buf, u32 length, void* mpdu_buf, u32 mpdu_length, u32 max_length);
 int wlan_create_rts_frame(void* pkt_buf_addr, u8* address_ra, u8* address_ta, u16 duration);
 int wlan_create_cts_frame(void* pkt_buf_addr, u8* address_ra, u16 duration);
 int wlan_create_ack_frame(void* pkt_buf_addr, u8* address_ra);
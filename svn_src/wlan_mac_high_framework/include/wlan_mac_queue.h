@@ -43,12 +43,68 @@ typedef struct tx_queue_buffer_t{
 #define TX_QUEUE_BUFFER_FLAGS_FILL_UNIQ_SEQ		0x0004
 
 
+//-----------------------------------------------
+// Queue length limits
+//     - A queue with a max_length of QUEUE_MAX_LENGTH_DEFAULT uses the value
+//       set by queue_set_default_max_length()
+//
+#define QUEUE_MAX_LENGTH_DEFAULT                           0
+#define QUEUE_MAX_LENGTH_UNLIMITED                         0xFFFF
+
+//-----------------------------------------------
+// Queue IDs
+//     - Queue IDs must be less than QUEUE_MAX_NUM_QUEUES. The tx_queue_t
+//       structs are allocated from a slab cache in TX_QUEUE_DL_ENTRY_MEM.
+//
+#define QUEUE_MAX_NUM_QUEUES                               64
+
+//-----------------------------------------------
+// Active queue management (CoDel)
+//     - A queue enters the dropping state once the sojourn time of its head
+//       packet has stayed above QUEUE_AQM_TARGET_USEC for QUEUE_AQM_INTERVAL_USEC.
+//       While dropping, the n-th drop is QUEUE_AQM_INTERVAL_USEC / sqrt(n) after the
+//       previous one.
+//     - The sojourn time is measured from queue_info.enqueue_timestamp
+//
+#define QUEUE_AQM_TARGET_USEC                              5000
+#define QUEUE_AQM_INTERVAL_USEC                            100000
+
+
+//-----------------------------------------------
+// A-MSDU aggregation
+//     - dequeue_amsdu_from_head() packs data frames queued back-to-back for the
+//       same receiver into one A-MSDU so that they share a single medium access
+//       and ACK. The frame must fit in one Tx queue buffer and in the receiver's
+//       PHY Rx length limit, which for this design is MAX_PKT_SIZE_B.
+//     - Approximate airtime per MSDU at HT MCS 7 (20 MHz, 2.4 GHz, CWmin 15,
+//       24 Mbps ACK), as DIFS + mean backoff + PPDU + SIFS + ACK over the number
+//       of MSDUs:
+//           TCP ACK (40 B IP):   182 us alone;  31 per A-MSDU:  13 us each
+//           512 B IP packet:     238 us alone;   3 per A-MSDU: 125 us each
+//       1500 B IP packets do not fit two to an A-MSDU and are sent as before.
+//
+#define QUEUE_AMSDU_MAX_LENGTH_DEFAULT                     MAX_PKT_SIZE_B
+
+
+typedef struct tx_queue_t{
+	dl_list			list;
+	u16				max_length;                   // Maximum number of entries (or QUEUE_MAX_LENGTH_DEFAULT)
+	u8				aqm_enable;
+	u8				aqm_dropping;                 // Queue is in the CoDel dropping state
+	u32				aqm_count;                    // Number of drops in the current dropping state
+	u32				aqm_lastcount;                // aqm_count when the previous dropping state ended
+	u64				aqm_first_above_time;         // Time at which the sojourn time may start dropping
+	u64				aqm_drop_next;                // Time of the next drop in the dropping state
+} tx_queue_t;
+
+
 /*************************** Function Prototypes *****************************/
 
 void                queue_init();
 
-void                enqueue_after_tail(u16 queue_sel, dl_entry* tqe);
+int                 enqueue_after_tail(u16 queue_sel, dl_entry* tqe);
 dl_entry* 			dequeue_from_head(u16 queue_sel);
+dl_entry* 			dequeue_amsdu_from_head(u16 queue_sel, u32 max_length);
 void 				transmit_checkin(dl_entry* tx_queue_buffer_entry);
 void 	    		queue_set_state_change_callback(function_ptr_t callback);
 
@@ -64,4 +120,13 @@ u32                 queue_total_size();
 
 void                purge_queue(u16 queue_sel);
 
+void                queue_set_default_max_length(u16 max_length);
+void                queue_set_max_length(u16 queue_sel, u16 max_length);
+u16                 queue_get_max_length(u16 queue_sel);
+u8                  queue_is_full(u16 queue_sel);
+void                queue_set_aqm_enable(u16 queue_sel, u8 enable);
+
+void                queue_set_amsdu_max_length(u32 max_length);
+u32                 queue_get_amsdu_max_length();
+
 #endif /* WLAN_MAC_QUEUE_H_ */
@@ -0,0 +1,101 @@
+/** @file wlan_mac_rate_selection.h
+ *  @brief Rate Selection
+ *
+ *  This contains code for per-station adaptive Tx rate selection.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+/***************************** Include Files *********************************/
+
+
+/*************************** Constant Definitions ****************************/
+#ifndef WLAN_MAC_RATE_SELECTION_H_
+#define WLAN_MAC_RATE_SELECTION_H_
+
+#include "xil_types.h"
+#include "wlan_common_types.h"
+
+//-----------------------------------------------
+// Rate selection schemes
+//
+#define RATE_SELECTION_SCHEME_STATIC                       0         ///< Always use tx_params_data as configured
+#define RATE_SELECTION_SCHEME_MINSTREL                     1         ///< EWMA throughput-optimal MCS with lookaround sampling
+
+//-----------------------------------------------
+// Minstrel parameters
+//     - Statistics are folded into the EWMA once per update interval. The
+//       EWMA weight of the newest interval is 1/(2^RATE_SELECTION_EWMA_SHIFT).
+//     - Counters for a rate are carried over to the next interval until they
+//       cover at least RATE_SELECTION_MIN_ATTEMPTS attempts. Retries stop at the
+//       first success, so a ratio taken over only a few frames overestimates
+//       the success probability of a lossy rate.
+//     - One out of every RATE_SELECTION_SAMPLE_INTERVAL unicast data frames is
+//       sent at a sampling rate instead of the current best-throughput rate.
+//
+#define RATE_SELECTION_NUM_RATES                           8
+#define RATE_SELECTION_UPDATE_INTERVAL_USEC                100000
+#define RATE_SELECTION_EWMA_SHIFT                          2
+#define RATE_SELECTION_MIN_ATTEMPTS                        16
+#define RATE_SELECTION_SAMPLE_INTERVAL                     10
+#define RATE_SELECTION_PROB_SCALE                          4096      ///< Probability of 1.0
+#define RATE_SELECTION_PROB_MIN                            (RATE_SELECTION_PROB_SCALE / 10)
+#define RATE_SELECTION_PROB_UNKNOWN                        0xFFFF    ///< No attempts have been made at this rate
+
+
+/*********************** Global Structure Definitions ************************/
+
+/********************************************************************
+ * @brief Per-Rate Statistics
+ *
+ * Attempt / success counters for the current update interval along with the
+ * EWMA success probability and expected throughput derived from previous
+ * intervals.
+ *
+ ********************************************************************/
+typedef struct rate_selection_stats_t{
+    u16        attempts;                    ///< # of MPDU attempts in this interval
+    u16        successes;                   ///< # of acknowledged MPDU attempts in this interval
+    u16        prob;                        ///< EWMA success probability (RATE_SELECTION_PROB_SCALE = 1.0)
+    u16        throughput;                  ///< Expected goodput (in kbps)
+} rate_selection_stats_t;
+
+/********************************************************************
+ * @brief Rate Selection Information
+ *
+ * This structure contains information about the rate selection scheme.
+ *
+ ********************************************************************/
+typedef struct rate_selection_info_t{
+    u16                      rate_selection_scheme;
+    u8                       phy_mode;                              ///< PHY mode the statistics apply to
+    u8                       max_tp_mcs;                            ///< MCS with the best expected throughput
+    u8                       max_tp2_mcs;                           ///< MCS with the second best expected throughput
+    u8                       max_prob_mcs;                          ///< MCS with the best success probability
+    u8                       sample_mcs;                            ///< Next MCS to sample
+    u8                       sample_countdown;                      ///< Frames until the next sampling frame
+    u64                      last_update_timestamp;                 ///< System time of the last statistics update
+    rate_selection_stats_t   stats[RATE_SELECTION_NUM_RATES];       ///< Per-MCS statistics
+} rate_selection_info_t;
+ASSERT_TYPE_SIZE(rate_selection_info_t, 80);
+
+
+// Forward declarations -- these must be defined elsewhere
+struct wlan_mac_low_tx_details_t;
+
+
+/*************************** Function Prototypes *****************************/
+
+void rate_selection_init_info(rate_selection_info_t* rate_info, u16 scheme, phy_tx_params_t* phy_params);
+
+void rate_selection_txreport_process(rate_selection_info_t* rate_info, struct wlan_mac_low_tx_details_t* wlan_mac_low_tx_details);
+void rate_selection_apply(rate_selection_info_t* rate_info, phy_tx_params_t* phy_params);
+
+void rate_selection_print(rate_selection_info_t* rate_info);
+
+#endif
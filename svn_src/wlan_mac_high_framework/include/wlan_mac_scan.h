@@ -28,6 +28,28 @@
 #define DEFAULT_SCAN_PROBE_TX_INTERVAL_USEC                20000
 #define DEFAULT_SCAN_TIME_PER_CHANNEL_USEC                 150000
 
+// Adaptive Dwell Parameters
+//     When min_dwell_usec is non-zero, the scan checks for activity on the current
+//     channel every min_dwell_usec:
+//       - A channel with no receptions (PHY activity or responses) in the last
+//         min_dwell_usec is left immediately
+//       - A channel with beacons / probe responses arriving is kept past
+//         time_per_channel_usec, up to max_dwell_usec
+//     A min_dwell_usec of 0 keeps the fixed time_per_channel_usec dwell.
+//
+#define DEFAULT_SCAN_MIN_DWELL_USEC                        0
+#define DEFAULT_SCAN_MAX_DWELL_USEC                        300000
+
+// Scan flags
+//
+#define SCAN_FLAG_ORDER_BY_NETWORK_INFO                    0x00000001         ///< Visit channels with the most recent network_info hits first
+
+#define DEFAULT_SCAN_FLAGS                                 0
+
+// Window for counting network_info hits when ordering channels
+//
+#define SCAN_CHANNEL_ORDER_WINDOW_USEC                     60000000
+
 
 
 /*********************** Global Structure Definitions ************************/
@@ -38,9 +60,26 @@ typedef struct scan_parameters_t{
     u8*       channel_vec;
     u32       channel_vec_len;
     char*     ssid;
+    u32       min_dwell_usec;
+    u32       max_dwell_usec;
+    u32       flags;
 } scan_parameters_t;
 
 
+// Scan statistics
+//     Accumulated over all scans since boot or the last wlan_mac_scan_reset_stats()
+//
+typedef struct scan_stats_t{
+    u32       num_channels_visited;          ///< # of channel dwells started
+    u32       num_early_exits;               ///< # of dwells ended before time_per_channel_usec
+    u32       num_extensions;                ///< # of dwells extended past time_per_channel_usec
+    u32       num_rx;                        ///< # of receptions on the scan channel
+    u32       num_responses;                 ///< # of beacons / probe responses on the scan channel
+    u32       last_full_scan_usec;           ///< Duration of the most recent pass through the channel list
+    u64       total_dwell_usec;              ///< Total time spent on scan channels
+} scan_stats_t;
+
+
 // Scan FSM states
 typedef enum scan_state_t{
     SCAN_IDLE,
@@ -66,5 +105,10 @@ void wlan_mac_scan_resume();
 u32  wlan_mac_scan_is_scanning();
 int  wlan_mac_scan_get_num_scans();
 
+void wlan_mac_scan_rx_notify(void* pkt_buf_addr);
+
+scan_stats_t* wlan_mac_scan_get_stats();
+void wlan_mac_scan_reset_stats();
+
 
 #endif
@@ -55,6 +55,24 @@
 // Defined Reserved Schedule IDs
 #define SCHEDULE_FAILURE                                   0xFFFFFFFF
 
+// Schedule slots
+//     - All schedules are allocated from a fixed pool of SCHEDULE_NUM_SLOTS slots.
+//       The low SCHEDULE_SLOT_BITS bits of a schedule ID are the slot index so
+//       an ID can be resolved without searching.
+//
+#define SCHEDULE_SLOT_BITS                                 5
+#define SCHEDULE_NUM_SLOTS                                 (1 << SCHEDULE_SLOT_BITS)
+#define SCHEDULE_SLOT_MASK                                 (SCHEDULE_NUM_SLOTS - 1)
+
+// Value of wlan_sched.heap_index for a schedule that is not in a scheduler heap
+#define SCHEDULE_HEAP_INDEX_NONE                           0xFF
+
+// Scheduler execution monitor histogram
+//     - Bin N counts intervals between scheduler executions in [2^N, 2^(N+1)) usec.
+//       Bin 0 also holds intervals of 0 usec and the last bin holds all longer intervals.
+//
+#define SCHEDULE_EXEC_MONITOR_NUM_BINS                     24
+
 
 //-----------------------------------------------
 // Macros
@@ -72,22 +90,30 @@ struct dl_entry;
 typedef struct wlan_sched{
     u32            id;
     u8			   enabled;
+    u8             scheduler_sel;
+    u8             heap_index;
+    u8             reserved0;
     u32            delay_us;
     u32            num_calls;
     u64            target_us;
     function_ptr_t callback;
 } wlan_sched;
 
+// Per-scheduler state
+//     - Enabled schedules are kept in a binary min-heap ordered by target_us so
+//       that the timer interrupt only has to look at the schedules that expired.
+//       The heap holds slot indices.
+//
 typedef struct wlan_sched_state_t{
-	dl_list		enabled_list;
-	struct dl_entry*	next;
+	u8			heap[SCHEDULE_NUM_SLOTS];
+	u32			heap_length;
+	u32			num_enabled;                  // Schedules in the heap plus any popped for execution
 } wlan_sched_state_t;
 
 
 /*************************** Function Prototypes *****************************/
 
 int     		wlan_mac_schedule_init();
-dl_entry *    	wlan_mac_schedule_find(dl_list* sched_list, u32 id);
 int     	 	wlan_mac_schedule_setup_interrupt(XIntc* intc);
 
 u32      		wlan_mac_schedule_event_repeated(u8 scheduler_sel, u32 delay, u32 num_calls, void(*callback)());
@@ -95,4 +121,8 @@ dl_entry* 		wlan_mac_schedule_disable_id(u8 scheduler_sel, u32 sched_id);
 int 			wlan_mac_schedule_enable(u8 scheduler_sel, dl_entry* sched_entry);
 void     		wlan_mac_remove_schedule(u8 scheduler_sel, u32 id);
 
+u32     		wlan_mac_schedule_get_exec_monitor_hist(u32* hist, u32 max_bins);
+void     		wlan_mac_schedule_reset_exec_monitor();
+void     		wlan_mac_schedule_print_exec_monitor();
+
 #endif /* WLAN_MAC_SCHEDULE_H_ */
@@ -0,0 +1,76 @@
+/** @file wlan_mac_slab.h
+ *  @brief Slab Allocator
+ *
+ *  This contains code for fixed-size object caches.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+/***************************** Include Files *********************************/
+
+
+/*************************** Constant Definitions ****************************/
+#ifndef WLAN_MAC_SLAB_H_
+#define WLAN_MAC_SLAB_H_
+
+#include "xil_types.h"
+
+
+//-----------------------------------------------
+// Slab cache defines
+//     - The memory for a cache is reserved when the cache is initialized and
+//       is never returned, so the heap does not fragment as objects come and go.
+//     - Every initialized cache is registered so that its statistics can be
+//       retrieved (see CMDID_DEV_SLAB_STATS)
+//
+#define SLAB_MAX_NUM_CACHES                                8
+#define SLAB_CACHE_NAME_MAXLEN                             11
+
+#define SLAB_CACHE_STATS_NUM_WORDS                         9         ///< u32 words per cache in CMDID_DEV_SLAB_STATS
+
+
+/*********************** Global Structure Definitions ************************/
+
+/********************************************************************
+ * @brief Slab Cache
+ *
+ * A cache of num_objs objects of obj_size bytes. Free objects are tracked
+ * with a stack of object indexes, so allocating and freeing are O(1) and
+ * the contents of a free object are left untouched.
+ *
+ ********************************************************************/
+typedef struct slab_cache_t{
+	char       name[SLAB_CACHE_NAME_MAXLEN+1];
+	u8*        mem;                         ///< Memory holding the objects
+	u16*       free_stack;                  ///< Indexes of free objects
+	u32        obj_size;                    ///< Size of each object (in bytes)
+	u16        num_objs;                    ///< Number of objects in the cache
+	u16        num_free;                    ///< Number of objects in free_stack
+	u16        max_used;                    ///< Largest number of objects in use at once
+	u16        reserved0;
+	u32        num_allocs;                  ///< # of successful allocations
+	u32        num_alloc_fails;             ///< # of allocations that failed because the cache was empty
+} slab_cache_t;
+
+
+/*************************** Function Prototypes *****************************/
+
+int            slab_cache_init(slab_cache_t* cache, char* name, void* mem, u32 obj_size, u16 num_objs);
+
+void*          slab_alloc(slab_cache_t* cache);
+void*          slab_calloc(slab_cache_t* cache);
+void           slab_free(slab_cache_t* cache, void* obj);
+u8             slab_contains(slab_cache_t* cache, void* obj);
+
+u32            slab_get_num_caches();
+slab_cache_t*  slab_get_cache(u32 index);
+u32            slab_get_stats(slab_cache_t* cache, u32* buffer);
+void           slab_reset_stats();
+void           slab_print_stats();
+
+#endif /* WLAN_MAC_SLAB_H_ */
@@ -20,6 +20,7 @@
 #include "xil_types.h"
 #include "wlan_common_types.h"
 #include "wlan_high_types.h"
+#include "wlan_mac_rate_selection.h"
 
 
 /*************************** Constant Definitions ****************************/
@@ -32,6 +33,14 @@
 //
 #define STATION_INFO_TIMEOUT_USEC                           600000000
 
+//-----------------------------------------------
+// Address hash index over the flat station_info_list
+//     - Open addressing with linear probing; must be a power of 2 and larger than
+//       the number of station_info_entry_t structs placed in STATION_INFO_DL_ENTRY_MEM
+//
+#define STATION_INFO_HASH_NUM_BUCKETS                       512
+#define STATION_INFO_HASH_NUM_BITS                          9
+
 /********************************************************************
  * @brief Tx/Rx Counts Sub-structure
  *
@@ -73,17 +82,18 @@ ASSERT_TYPE_SIZE(station_txrx_counts_t, 112);
 
 
 /********************************************************************
- * @brief Rate Selection Information
+ * @brief Station Tx Queue Drop Counts
  *
- * This structure contains information about the rate selection scheme.
+ * This struct counts MPDUs for a station that were removed from a Tx queue
+ * without being transmitted.
  *
  ********************************************************************/
-typedef struct rate_selection_info_t{
-    u16 rate_selection_scheme;
-    u8	reserved[6];
-} rate_selection_info_t;
+typedef struct station_queue_drops_t{
+    u32        num_full;                    ///< # of MPDUs dropped because the Tx queue was at its maximum length
+    u32        num_aqm;                     ///< # of MPDUs dropped by active queue management
+} station_queue_drops_t;
+ASSERT_TYPE_SIZE(station_queue_drops_t, 8);
 
-#define RATE_SELECTION_SCHEME_STATIC                       0
 
 /********************************************************************
  * @brief Station Information Structure
@@ -118,13 +128,16 @@ typedef struct station_info_t{
     station_txrx_counts_t		txrx_counts;                        			/* Tx/Rx Counts */
 #endif
     rate_selection_info_t		rate_info;
+    station_queue_drops_t       queue_drops;                                    /* Tx queue drop counts */
+    u32                         generation;                                     /* Generation of the latest change (see station_info_advance_generation()) */
+    u32                         reserved1;
 } station_info_t;
 #if WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
-ASSERT_TYPE_SIZE(station_info_t, 192);
-#define STATION_INFO_T_PORTABLE_SIZE (sizeof(station_info_t) - sizeof(station_txrx_counts_t) - sizeof(rate_selection_info_t) )
+ASSERT_TYPE_SIZE(station_info_t, 280);
+#define STATION_INFO_T_PORTABLE_SIZE (sizeof(station_info_t) - sizeof(station_txrx_counts_t) - sizeof(rate_selection_info_t) - sizeof(station_queue_drops_t) - (2 * sizeof(u32)) )
 #else
-ASSERT_TYPE_SIZE(station_info_t, 80);
-#define STATION_INFO_T_PORTABLE_SIZE (sizeof(station_info_t) - sizeof(rate_selection_info_t) )
+ASSERT_TYPE_SIZE(station_info_t, 168);
+#define STATION_INFO_T_PORTABLE_SIZE (sizeof(station_info_t) - sizeof(rate_selection_info_t) - sizeof(station_queue_drops_t) - (2 * sizeof(u32)) )
 #endif
 
 
@@ -196,6 +209,10 @@ void 			 station_info_clear(station_info_t* station_info);
 
 struct dl_list*  		 station_info_get_list();
 
+u32              station_info_advance_generation();
+u32              station_info_get_removal_generation();
+station_info_t*  station_info_find_changed(u32* index, u32 since, u32 until);
+
 station_info_entry_t* station_info_find_by_id(u32 id, struct dl_list* list);
 station_info_entry_t* station_info_find_by_addr(u8* addr, struct dl_list* list);
 
@@ -208,4 +225,8 @@ tx_params_t		 wlan_mac_get_default_tx_params(default_tx_param_sel_t default_tx_p
 void		 	 wlan_mac_set_default_tx_params(default_tx_param_sel_t default_tx_param_sel, tx_params_t* tx_params);
 void 			 wlan_mac_reapply_default_tx_params();
 
+u16              station_info_get_default_rate_selection_scheme();
+void             station_info_set_default_rate_selection_scheme(u16 scheme);
+void             station_info_set_rate_selection_scheme(station_info_t* station_info, u16 scheme);
+
 #endif
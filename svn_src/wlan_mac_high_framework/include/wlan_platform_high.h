@@ -33,6 +33,7 @@ typedef struct platform_high_dev_info_t{
 	u32		timer_dev_id;
 	u32		timer_int_id;
 	u32		timer_freq;
+	u32		cpu_freq;
 	u32		cdma_dev_id;
 	u32 	mailbox_int_id;
 	u32		wlan_exp_eth_mac_dev_id;
@@ -63,6 +64,9 @@ int wlan_platform_wlan_exp_eth_init(XAxiEthernet* eth_ptr);
 // Functions implemented in files other than wlan_platform_high.c
 #if WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
 int wlan_platform_ethernet_send(u8* pkt_ptr, u32 length);
+void wlan_platform_ethernet_tx_batch_start();
+int wlan_platform_ethernet_tx_batch_end();
+void wlan_platform_ethernet_print_tx_counts();
 #endif //WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
 
 #endif /* WLAN_PLATFORM_HIGH_H_ */
@@ -553,10 +553,14 @@ int                     eth_read_phy_reg(u32 eth_dev_num, u32 phy_addr, u32 reg_
 int                     eth_write_phy_reg(u32 eth_dev_num, u32 phy_addr, u32 reg_addr, u16 reg_value);
 
 int                     eth_get_num_tx_descriptors();
+int                     eth_get_num_free_tx_descriptors(u32 eth_dev_num);
 
 // IP functions
 void                    ipv4_update_header(ipv4_header * header, u32 dest_ip_addr, u16 ip_length, u8 protocol);
 
+// UDP functions
+void                    udp_update_checksum(wlan_exp_ip_udp_header * header, u32 header_size, wlan_exp_ip_udp_buffer ** buffers, u32 num_buffers);
+
 // ARP functions
 void                    arp_send_request(u32 eth_dev_num, u8 * target_haddr, u8 * target_paddr);
 void                    arp_send_announcement(u32 eth_dev_num);
@@ -564,6 +568,8 @@ void                    arp_send_announcement(u32 eth_dev_num);
 int                     arp_update_cache(u32 eth_dev_num, u8 * hw_addr, u8 * ip_addr);
 int                     arp_get_hw_addr(u32 eth_dev_num, u8 * hw_addr, u8 * ip_addr);
 
+void                    arp_set_time_callback(u64(*callback)());
+
 // Socket functions
 int                     socket_socket(int domain, int type, int protocol);
 int                     socket_bind_eth(int socket_index, u32 eth_dev_num, u16 port);
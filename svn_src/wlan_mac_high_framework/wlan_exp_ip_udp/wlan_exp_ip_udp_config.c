@@ -113,6 +113,11 @@ void eth_init_device_info(u32 eth_dev_num) {
             eth_device[eth_dev_num].dma_tx_ring_ptr        = NULL;
             eth_device[eth_dev_num].dma_tx_bd_ptr          = NULL;
             eth_device[eth_dev_num].dma_tx_bd_cnt          = 0;
+            eth_device[eth_dev_num].rx_batch_bd_ptr        = NULL;
+            eth_device[eth_dev_num].rx_batch_next_bd_ptr   = NULL;
+            eth_device[eth_dev_num].rx_batch_cnt           = 0;
+            eth_device[eth_dev_num].rx_batch_processed_cnt = 0;
+            eth_device[eth_dev_num].rx_batch_free_cnt      = 0;
             eth_device[eth_dev_num].padding                = 0;
             eth_device[eth_dev_num].num_recv_buffers       = 0;
             eth_device[eth_dev_num].recv_buffers           = NULL;
@@ -135,6 +140,11 @@ void eth_init_device_info(u32 eth_dev_num) {
             eth_device[eth_dev_num].dma_tx_ring_ptr        = (void *) XAxiDma_GetTxRing(&ETH_1_dma_instance);
             eth_device[eth_dev_num].dma_tx_bd_ptr          = &ETH_1_tx_bd_space;
             eth_device[eth_dev_num].dma_tx_bd_cnt          = WLAN_EXP_IP_UDP_ETH_1_TXBD_CNT;
+            eth_device[eth_dev_num].rx_batch_bd_ptr        = NULL;
+            eth_device[eth_dev_num].rx_batch_next_bd_ptr   = NULL;
+            eth_device[eth_dev_num].rx_batch_cnt           = 0;
+            eth_device[eth_dev_num].rx_batch_processed_cnt = 0;
+            eth_device[eth_dev_num].rx_batch_free_cnt      = 0;
             eth_device[eth_dev_num].padding                = 0;
             eth_device[eth_dev_num].num_recv_buffers       = WLAN_EXP_IP_UDP_ETH_1_NUM_RECV_BUF;
             eth_device[eth_dev_num].recv_buffers           = ETH_1_recv_buffers;
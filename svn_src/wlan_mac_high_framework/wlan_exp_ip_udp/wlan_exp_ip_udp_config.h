@@ -25,9 +25,29 @@
 // Define global DMA constants
 #define WLAN_EXP_IP_UDP_TXBD_CNT                     10                                 // Number of TX buffer descriptors (per instance)
 
+// Max number of RX buffer descriptors taken from hardware at once
+//     NOTE:  Keep this below the number of receive buffers so the DMA always has descriptors to receive into
+#define WLAN_EXP_IP_UDP_RXBD_BATCH_CNT               4
+
+// Compute UDP checksums on transmitted packets
+//     NOTE:  Costs a read of every payload byte by the processor; the IP header checksum is always computed
+#ifndef WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM
+#define WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM              0
+#endif
+
 // Define UDP connections
 #define WLAN_EXP_IP_UDP_NUM_SOCKETS                  5                                  // Number of UDP sockets (global pool)
-#define WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES              10                                 // Number of ARP entries (global pool)
+#define WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES              16                                 // Number of ARP entries (global pool; max 255)
+
+// ARP cache hash index
+//     NOTE:  Number of buckets must be a power of 2 and larger than the number of ARP entries
+#define WLAN_EXP_IP_UDP_ARP_HASH_NUM_BUCKETS         64
+#define WLAN_EXP_IP_UDP_ARP_HASH_NUM_BITS            6
+
+// Time an ARP entry can go unused before it expires (0 = never expire)
+//     NOTE:  Keep this longer than the ARP timeout of the hosts.  The library never sends ARP requests on its own,
+//            so it relies on a host with a stale cache to ARP for the node before sending to it.
+#define WLAN_EXP_IP_UDP_ARP_TIMEOUT_USEC             600000000
 
 // Define global Ethernet constants
 #define WLAN_EXP_IP_UDP_ETH_BUF_SIZE                 ((9014 + 31) & 0xFFFFFFE0)         // Align parameter to a 32 byte boundary
@@ -51,7 +71,7 @@
 
 // Ethernet device 1
 #define WLAN_EXP_IP_UDP_ETH_1_DEFAULT_SPEED          1000
-#define WLAN_EXP_IP_UDP_ETH_1_NUM_RECV_BUF           3
+#define WLAN_EXP_IP_UDP_ETH_1_NUM_RECV_BUF           8
 #define WLAN_EXP_IP_UDP_ETH_1_RXBD_CNT               WLAN_EXP_IP_UDP_ETH_1_NUM_RECV_BUF     // Number of RX descriptors to use
 #define WLAN_EXP_IP_UDP_ETH_1_TXBD_CNT               WLAN_EXP_IP_UDP_TXBD_CNT               // Number of TX descriptors to use
 #define WLAN_EXP_IP_UDP_ETH_1_RXBD_SPACE_BYTES      (XAxiDma_BdRingMemCalc(WLAN_EXP_IP_UDP_BD_ALIGNMENT, WLAN_EXP_IP_UDP_ETH_1_RXBD_CNT))
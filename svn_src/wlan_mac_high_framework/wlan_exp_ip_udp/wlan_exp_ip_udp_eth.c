@@ -22,6 +22,8 @@
 #include "wlan_exp_ip_udp.h"
 #include "wlan_exp_ip_udp_internal.h"
 #include "wlan_platform_high.h"
+#include "wlan_mac_high_sw_config.h"
+#include "wlan_mac_high.h"
 
 
 /*************************** Constant Definitions ****************************/
@@ -300,6 +302,9 @@ int eth_init_dma(u32 eth_dev_num, u32 verbose) {
         XAxiDma_BdSetCtrl(bd_ptr, 0);
         XAxiDma_BdSetId(bd_ptr, (u32)(recv_buffers[i].data));
 
+        // Make sure no dirty line of the buffer can be evicted over the frame the DMA writes
+        wlan_mac_high_dcache_flush(recv_buffers[i].data, WLAN_EXP_IP_UDP_ETH_BUF_SIZE);
+
         bd_ptr = (XAxiDma_Bd*)XAxiDma_BdRingNext(dma_rx_ring_ptr, bd_ptr);
     }
 
@@ -643,6 +648,9 @@ int eth_send_frame(u32 eth_dev_num, wlan_exp_ip_udp_socket* socket, wlan_exp_ip_
         // Get the buffer address / size
         buffer_addr = (u32) buffers_to_process[i]->data;
         buffer_size = buffers_to_process[i]->size;
+
+        // The DMA reads the buffer directly from memory, bypassing the data cache
+        wlan_mac_high_dcache_flush(buffer_addr, buffer_size);
     
         // Set the descriptor address to the start of the buffer
         status = XAxiDma_BdSetBufAddr(bd_ptr, buffer_addr);
@@ -839,6 +847,11 @@ int eth_process_tx_descriptors(u32 eth_dev_num, XAxiDma_BdRing * dma_tx_ring_ptr
  * This function is non-blocking and will have populated the wlan_exp_ip_udp_buffer if 
  * the return value is greater than 0 (ie > 0).
  *
+ * Completed RX buffer descriptors are taken from hardware in batches of up to
+ * WLAN_EXP_IP_UDP_RXBD_BATCH_CNT.  Each call returns the next frame in the batch
+ * that has data for the caller; frames that are fully handled by the library
+ * (eg ARP) or are not intended for the node are freed internally and skipped.
+ *
  * @param   eth_dev_num - Ethernet device to receive Ethernet frame on
  * @param   eth_frame   - Mango wlan_exp IP/UDP Buffer to populate with Ethernet data
  *
@@ -846,15 +859,18 @@ int eth_process_tx_descriptors(u32 eth_dev_num, XAxiDma_BdRing * dma_tx_ring_ptr
  *                            0 if there is no packet received
  *                            WLAN_EXP_IP_UDP_FAILURE if there was a library failure
  *
+ * @note    The caller must free a frame with data (eth_free_recv_buffers()) before
+ *          calling this function again.
+ *
  ******************************************************************************/
 int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
 
     int                      status;
 
-    int                      processed_bd_count  = 0;
     int                      size                = 0;
     int                      length              = 0;
 
+    ethernet_device        * eth_dev;
     XAxiDma_BdRing         * dma_rx_ring_ptr;
     XAxiDma_Bd             * bd_ptr;
     ethernet_header        * header;
@@ -874,8 +890,10 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
     // Check the Ethernet device (optional - this is checked in many other places; removing for performance reasons)
     // if (eth_check_device(eth_dev_num) != XST_SUCCESS) { return WLAN_EXP_IP_UDP_FAILURE; }
 
+    eth_dev = &(eth_device[eth_dev_num]);
+
     // Get the RX Buffer Descriptor Ring pointer
-    dma_rx_ring_ptr = (XAxiDma_BdRing *)(eth_device[eth_dev_num].dma_rx_ring_ptr);
+    dma_rx_ring_ptr = (XAxiDma_BdRing *)(eth_dev->dma_rx_ring_ptr);
 
     // Check to see that the HW is started
     //     - If it is not started, we must have gotten an error somewhere, so we need to reset and restart the DMA
@@ -894,18 +912,36 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
         }
     }
     
-    // See if we have any data to process
-    //     NOTE:  We will only process one buffer descriptor at a time in this function call
-    processed_bd_count = XAxiDma_BdRingFromHw(dma_rx_ring_ptr, 0x1, &bd_ptr);
+    // If every frame of the previous batch has been freed, then take the next batch of completed
+    // buffer descriptors from hardware
+    //     NOTE:  Frames must be freed in order, so a new batch is not started while the caller still
+    //         holds a frame from the current batch.
+    //
+    if (eth_dev->rx_batch_free_cnt == eth_dev->rx_batch_cnt) {
+        eth_dev->rx_batch_cnt           = XAxiDma_BdRingFromHw(dma_rx_ring_ptr, WLAN_EXP_IP_UDP_RXBD_BATCH_CNT, &bd_ptr);
+        eth_dev->rx_batch_bd_ptr        = (void *) bd_ptr;
+        eth_dev->rx_batch_next_bd_ptr   = (void *) bd_ptr;
+        eth_dev->rx_batch_processed_cnt = 0;
+        eth_dev->rx_batch_free_cnt      = 0;
+    }
+
+    // Process frames until one has data for the caller or the batch is empty
+    while ((length == 0) && (eth_dev->rx_batch_processed_cnt < eth_dev->rx_batch_cnt)) {
 
-    // If we have data, then we need process the buffer
-    if (processed_bd_count > 0) {
+        // Get the next buffer descriptor in the batch
+        bd_ptr = (XAxiDma_Bd *)(eth_dev->rx_batch_next_bd_ptr);
+
+        eth_dev->rx_batch_next_bd_ptr    = (void *) XAxiDma_BdRingNext(dma_rx_ring_ptr, bd_ptr);
+        eth_dev->rx_batch_processed_cnt += 1;
 
         // Get the status of the buffer descriptor
         status = XAxiDma_BdGetSts(bd_ptr);
 
         if ((status & XAXIDMA_BD_STS_ALL_ERR_MASK) || (!(status & XAXIDMA_BD_STS_COMPLETE_MASK))) {
             eth_print_err_msg(eth_dev_num, WLAN_EXP_IP_UDP_ETH_ERROR_CODE, ETH_ERROR_CODE_DMA_RX_ERROR, &status, 1);
+
+            // Free the buffer descriptor so the rest of the batch can be returned to hardware
+            eth_free_recv_buffers(eth_dev_num, (void *) bd_ptr, 0x1);
             return WLAN_EXP_IP_UDP_FAILURE;
         } else {
             size = (XAxiDma_BdRead(bd_ptr, XAXIDMA_BD_USR4_OFFSET)) & 0x0000FFFF;
@@ -913,6 +949,9 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
 
         // Get the address of the buffer data
         data = (u8 *)XAxiDma_BdGetId(bd_ptr);                        // BD ID was set to the base address of the buffer
+
+        // The DMA wrote the frame directly to memory; discard any stale cached copy
+        wlan_mac_high_dcache_invalidate(data, size);
         
         // Strip off the FCS (or CRC) from the received frame
         size -= 4;
@@ -944,7 +983,7 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
             temp_32_0  = temp_ptr_0[0];
             temp_16_0  = temp_ptr_0[1] & 0x0000FFFF;
 
-            temp_ptr_1 = (u32 *) eth_device[eth_dev_num].hw_addr;
+            temp_ptr_1 = (u32 *) eth_dev->hw_addr;
             temp_32_1  = temp_ptr_1[0];
             temp_16_1  = temp_ptr_1[1] & 0x0000FFFF;
 
@@ -989,9 +1028,11 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
                 // Ethernet frame not intended for node, need to free buffer descriptor
                 eth_free_recv_buffers(eth_dev_num, eth_frame->descriptor, 0x1);
             }
+        } else {
+            // Empty Ethernet frame, need to free buffer descriptor
+            eth_free_recv_buffers(eth_dev_num, eth_frame->descriptor, 0x1);
         }
     }
-    // }
 
     return length;
 }
@@ -1002,6 +1043,10 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
 /**
  * Free receive buffer so they can be used again
  *
+ * Buffers are counted against the current receive batch (see eth_recv_frame()).
+ * Once every buffer in the batch has been freed, the whole batch is freed and
+ * all free buffer descriptors are returned to hardware in one ring operation.
+ *
  * @param   eth_dev_num      - Ethernet device number
  * @param   descriptors      - Pointer to receive buffer descriptor to be freed
  * @param   num_descriptors  - Number of buffers to be freed
@@ -1010,26 +1055,45 @@ int eth_recv_frame(u32 eth_dev_num, wlan_exp_ip_udp_buffer* eth_frame) {
  *                                 XST_SUCCESS - Command completed successfully
  *                                 XST_FAILURE - There was an error in the command
  *
+ * @note    Buffers must be freed in the order they were received.
+ *
  *****************************************************************************/
 int eth_free_recv_buffers(u32 eth_dev_num, void * descriptors, u32 num_descriptors) {
 
     int                      status;
+    u32                      i;
     u32                      free_bd_cnt;
 
+    ethernet_device        * eth_dev;
     XAxiDma_BdRing         * dma_rx_ring_ptr;
     XAxiDma_Bd             * bd_ptr;
+    XAxiDma_Bd             * curr_bd_ptr;
  
     // Check the Ethernet device
     if (eth_check_device(eth_dev_num) == XST_FAILURE) { return XST_FAILURE; }
 
+    eth_dev = &(eth_device[eth_dev_num]);
+
+    // Check that we are not freeing more buffers than have been received
+    if ((eth_dev->rx_batch_free_cnt + num_descriptors) > eth_dev->rx_batch_processed_cnt) {
+        status = XST_FAILURE;
+        eth_print_err_msg(eth_dev_num, WLAN_EXP_IP_UDP_ETH_ERROR_CODE, ETH_ERROR_CODE_DMA_RX_BD_RING_FREE, &status, 1);
+        return XST_FAILURE;
+    }
+
+    eth_dev->rx_batch_free_cnt += num_descriptors;
+
+    // Wait for the rest of the batch
+    if (eth_dev->rx_batch_free_cnt < eth_dev->rx_batch_cnt) { return XST_SUCCESS; }
+
     // Get DMA info from Ethernet device structure
-    dma_rx_ring_ptr   = (XAxiDma_BdRing *) eth_device[eth_dev_num].dma_rx_ring_ptr;
+    dma_rx_ring_ptr   = (XAxiDma_BdRing *) eth_dev->dma_rx_ring_ptr;
     
-    // Cast the buffer descriptor pointer
-    bd_ptr = (XAxiDma_Bd *)(descriptors);
+    // Get the first buffer descriptor of the batch
+    bd_ptr = (XAxiDma_Bd *)(eth_dev->rx_batch_bd_ptr);
 
     // Free processed RX descriptors for future receptions
-    status = XAxiDma_BdRingFree(dma_rx_ring_ptr, num_descriptors, bd_ptr);
+    status = XAxiDma_BdRingFree(dma_rx_ring_ptr, eth_dev->rx_batch_cnt, bd_ptr);
 
     if (status != XST_SUCCESS) {
         eth_print_err_msg(eth_dev_num, WLAN_EXP_IP_UDP_ETH_ERROR_CODE, ETH_ERROR_CODE_DMA_RX_BD_RING_FREE, &status, 1);
@@ -1046,6 +1110,15 @@ int eth_free_recv_buffers(u32 eth_dev_num, void * descriptors, u32 num_descripto
         return XST_FAILURE;
     }
 
+    // Make sure no dirty line of a buffer can be evicted over the frame the DMA writes
+    //     NOTE:  BD ID was set to the base address of the buffer
+    curr_bd_ptr = bd_ptr;
+
+    for (i = 0; i < free_bd_cnt; i++) {
+        wlan_mac_high_dcache_flush(XAxiDma_BdGetId(curr_bd_ptr), WLAN_EXP_IP_UDP_ETH_BUF_SIZE);
+        curr_bd_ptr = (XAxiDma_Bd*)XAxiDma_BdRingNext(dma_rx_ring_ptr, curr_bd_ptr);
+    }
+
     status = XAxiDma_BdRingToHw(dma_rx_ring_ptr, free_bd_cnt, bd_ptr);
 
     if (status != XST_SUCCESS) {
@@ -1259,6 +1332,51 @@ int eth_get_num_tx_descriptors() {
 
 
 
+/*****************************************************************************/
+/**
+ * Get the number of free TX buffer descriptors
+ *
+ * Reclaims any TX descriptors the DMA has finished with and then returns the
+ * number that can be allocated without eth_send_frame() blocking.  This allows
+ * callers that stream data to apply backpressure instead of waiting on the ring.
+ *
+ * @param   eth_dev_num       - Ethernet device number
+ *
+ * @return  int               - Number of free TX buffer descriptors
+ *                                 WLAN_EXP_IP_UDP_FAILURE - There was an error in the command
+ *
+ *****************************************************************************/
+int eth_get_num_free_tx_descriptors(u32 eth_dev_num) {
+
+    int                      int_status;
+    int                      bd_count;
+    XAxiDma_BdRing         * dma_tx_ring_ptr;
+
+    // Check the Ethernet device
+    if (eth_check_device(eth_dev_num) != XST_SUCCESS) {
+        return WLAN_EXP_IP_UDP_FAILURE;
+    }
+
+    // Try to disable the interrupts through the callback
+    int_status = interrupt_disable_callback();
+
+    dma_tx_ring_ptr = (XAxiDma_BdRing *) eth_device[eth_dev_num].dma_tx_ring_ptr;
+
+    // Process any completed BDs
+    bd_count = eth_process_tx_descriptors(eth_dev_num, dma_tx_ring_ptr);
+
+    if (bd_count != WLAN_EXP_IP_UDP_FAILURE) {
+        bd_count = XAxiDma_BdRingGetFreeCnt(dma_tx_ring_ptr);
+    }
+
+    // Re-enable the interrupts
+    interrupt_enable_callback(int_status);
+
+    return bd_count;
+}
+
+
+
 /*****************************************************************************/
 /**
  * Initialize the Ethernet Header
@@ -57,6 +57,10 @@ wlan_exp_ip_udp_socket           ETH_sockets[WLAN_EXP_IP_UDP_NUM_SOCKETS];
 //     NOTE:  There is only a single ARP table for all Ethernet devices.
 //
 arp_cache_entry              ETH_arp_cache[WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES];
+u16                          ETH_arp_hash[WLAN_EXP_IP_UDP_ARP_HASH_NUM_BUCKETS];          // Entry index + 1 (0 = empty bucket)
+hash_index_t                 ETH_arp_hash_index;                                          // Index of ETH_arp_cache over ETH_arp_hash
+u8                           ETH_arp_lru_head;                                            // Most recently used entry
+u8                           ETH_arp_lru_tail;                                            // Least recently used entry
 
 
 /*************************** Function Prototypes *****************************/
@@ -135,6 +139,9 @@ void socket_init_sockets() {
 void arp_init_cache() {
     u32 i;
 
+    // Initialize ARP hash index
+    hash_index_init(&ETH_arp_hash_index, ETH_arp_hash, WLAN_EXP_IP_UDP_ARP_HASH_NUM_BITS, arp_hash_entry_bucket);
+
     // Initialize ARP table
     for (i = 0; i < WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES; i++) {
         // Zero out the entry
@@ -142,7 +149,14 @@ void arp_init_cache() {
         
         // Set the Ethernet device to the invalid Ethernet device
         ETH_arp_cache[i].eth_dev_num = WLAN_EXP_IP_UDP_INVALID_ETH_DEVICE;
+
+        // Link all the (unused) entries in to the LRU list
+        ETH_arp_cache[i].lru_prev    = (i == 0) ? ARP_CACHE_NULL_INDEX : (i - 1);
+        ETH_arp_cache[i].lru_next    = ((i + 1) == WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES) ? ARP_CACHE_NULL_INDEX : (i + 1);
     }
+
+    ETH_arp_lru_head = 0;
+    ETH_arp_lru_tail = WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES - 1;
 }
 
 
@@ -14,6 +14,7 @@
 // Mango wlan_exp IP/UDP Library includes
 #include "wlan_exp_ip_udp_config.h"
 #include "wlan_exp_ip_udp_device.h"
+#include "wlan_mac_hash_index.h"
 
 
 /*************************** Constant Definitions ****************************/
@@ -38,6 +39,8 @@
 #define ARP_TABLE_UNUSED                                   0                   // ARP Table Entry is not in use
 #define ARP_TABLE_USED                                     1                   // ARP Table Entry is in use
 
+#define ARP_CACHE_NULL_INDEX                               0xFF                // End of the ARP cache LRU list
+
 
 // **********************************************************************
 // Mango wlan_exp IP/UDP Library Socket Defines
@@ -78,6 +81,17 @@ typedef struct  {
     void                   * dma_rx_ring_ptr;                                  // Pointer to RX ring
     void                   * dma_rx_bd_ptr;                                    // Pointer to RX buffer descriptor
     int                      dma_rx_bd_cnt;                                    // Number of RX buffer descriptors
+
+    // Batch of RX buffer descriptors taken from hardware by eth_recv_frame()
+    //   NOTE:  The AXI DMA requires RX descriptors to be freed in the order they were taken from
+    //          hardware, so the batch is returned to hardware in one ring operation once every
+    //          frame in the batch has been freed.
+    //
+    void                   * rx_batch_bd_ptr;                                  // First buffer descriptor of the batch
+    void                   * rx_batch_next_bd_ptr;                             // Next buffer descriptor to process
+    int                      rx_batch_cnt;                                     // Number of buffer descriptors in the batch
+    int                      rx_batch_processed_cnt;                           // Number of buffer descriptors processed
+    int                      rx_batch_free_cnt;                                // Number of buffer descriptors freed
     
     void                   * dma_tx_ring_ptr;                                  // Pointer to TX ring
     void                   * dma_tx_bd_ptr;                                    // Pointer to TX buffer descriptor
@@ -106,12 +120,17 @@ typedef struct  {
 //
 
 // ARP Table entry
+//     NOTE:  Entries are indexed by a hash of (eth_dev_num, paddr) and kept on a list ordered from most
+//            to least recently used.  Unused entries are kept at the least recently used end of the list.
+//
 typedef struct arp_cache_entry{
     u32                      eth_dev_num;                                      // Ethernet device
-    u32                      age;                                              // Age of the entry
+    u64                      timestamp;                                        // Time of the last use of the entry (usec)
     u16                      state;                                            // State of the entry
     u8                       haddr[ETH_ADDR_LEN];                              // Hardware address
     u8                       paddr[IP_ADDR_LEN];                               // Protocol address
+    u8                       lru_prev;                                         // Index of the next more recently used entry
+    u8                       lru_next;                                         // Index of the next less recently used entry
 } arp_cache_entry;
 
 
@@ -122,6 +141,11 @@ typedef struct arp_cache_entry{
 typedef int (*eth_int_disable_func_ptr_t)();
 typedef int (*eth_int_enable_func_ptr_t)(int);
 
+// **********************************************************************
+// ARP Time Function pointer
+//
+typedef u64 (*arp_time_func_ptr_t)();
+
 
 
 /*********************** Global Variable Definitions *************************/
@@ -132,6 +156,13 @@ extern wlan_exp_ip_udp_buffer    ETH_send_buffers[WLAN_EXP_IP_UDP_ETH_NUM_SEND_B
 extern u8                    ETH_dummy_frame[ETH_MIN_FRAME_LEN];
 extern wlan_exp_ip_udp_socket    ETH_sockets[WLAN_EXP_IP_UDP_NUM_SOCKETS];
 extern arp_cache_entry       ETH_arp_cache[WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES];
+extern u16                   ETH_arp_hash[WLAN_EXP_IP_UDP_ARP_HASH_NUM_BUCKETS];
+extern hash_index_t          ETH_arp_hash_index;
+extern u8                    ETH_arp_lru_head;
+extern u8                    ETH_arp_lru_tail;
+
+extern volatile eth_int_enable_func_ptr_t     interrupt_enable_callback;
+extern volatile eth_int_disable_func_ptr_t    interrupt_disable_callback;
 
 
 /*************************** Function Prototypes *****************************/
@@ -154,6 +185,8 @@ void                    ipv4_init_header(ipv4_header * header, u8 * src_ip_addr)
 // void                 ipv4_update_header(ipv4_header * header, u32 dest_ip_addr, u16 ip_length, u8 protocol);   // Defined in wlan_exp_ip_udp.h
 
 u16                     ipv4_compute_checksum(u8 * data, u32 size);
+u32                     ipv4_checksum_add(u32 sum, void * data, u32 size);
+u16                     ipv4_checksum_finish(u32 sum);
 
 // UDP functions
 int                     udp_process_packet(u32 eth_dev_num, wlan_exp_ip_udp_buffer * packet);
@@ -166,6 +199,8 @@ int                     arp_process_packet(u32 eth_dev_num, wlan_exp_ip_udp_buff
 
 void                    arp_send_reply(u32 eth_dev_num, wlan_exp_ip_udp_buffer * arp_request);
 
+u32                     arp_hash_entry_bucket(u32 index);
+
 // IMCP functions
 int                     imcp_process_packet(u32 eth_dev_num, wlan_exp_ip_udp_buffer * packet);
 
@@ -31,6 +31,8 @@
 
 u16           ipv4_id_counter = 0;
 
+volatile arp_time_func_ptr_t    arp_time_callback = NULL;                      // ARP entry timestamp callback
+
 
 
 /*************************** Function Prototypes *****************************/
@@ -39,6 +41,15 @@ void arp_reply(u32 eth_dev_num, wlan_exp_ip_udp_buffer * arp_request);
 
 void imcp_echo_reply(u32 eth_dev_num, wlan_exp_ip_udp_buffer * echo_request);
 
+static inline u32 arp_hash_addr(u32 eth_dev_num, u8 * ip_addr);
+static int  arp_hash_find(u32 eth_dev_num, u8 * ip_addr);
+
+static void arp_lru_remove(u32 index);
+static void arp_lru_add_head(u32 index);
+static void arp_lru_add_tail(u32 index);
+
+static u64  arp_get_time();
+
 
 /******************************** Functions **********************************/
 
@@ -269,22 +280,122 @@ void ipv4_update_header(ipv4_header * header, u32 dest_ip_addr, u16 ip_length, u
  *
  *****************************************************************************/
 u16 ipv4_compute_checksum(u8 * data, u32 size) {
+    return ipv4_checksum_finish(ipv4_checksum_add(0, data, size));
+}
 
-    u32   i;
-    u32   sum  = 0;
-    u16   word = 0;
-   
-    // Sum all 16-bit words in the header (big-endian)
-    for (i = 0; i < size; i = i + 2) {
-        word = ((data[i] << 8) & 0xFF00) + (data[i+1] & 0x00FF);
-        sum  = sum + ((u32) word);
+
+
+/*****************************************************************************/
+/**
+ * Add data to a partial IP Checksum
+ *
+ * Accumulates the ones' complement sum of the data's 16-bit words on to a partial
+ * sum so that a checksum can be computed over several non-contiguous pieces of
+ * data (eg a UDP pseudo header followed by the payload buffers).
+ *
+ * @param   sum             - Partial sum from a previous call (0 to start a new sum)
+ * @param   data            - Pointer to the data
+ * @param   size            - Size of the data (in bytes)
+ *
+ * @return  u32             - Partial sum (16-bit) to pass to the next call or to ipv4_checksum_finish()
+ *
+ * @note    The data is summed in native byte order as 32-bit words.  Carries are collected
+ *          in the upper half of a 64-bit accumulator and folded once at the end instead of
+ *          after every addition.  Since the ones' complement sum is independent of byte
+ *          order (RFC 1071), ipv4_checksum_finish() only has to swap the final 16-bit result.
+ *
+ * @note    An odd size pads the last byte with zero.  If data is split across calls, every
+ *          piece except the last must have an even size (see udp_update_checksum() for
+ *          pieces that start at an odd offset).
+ *
+ *****************************************************************************/
+u32 ipv4_checksum_add(u32 sum, void * data, u32 size) {
+
+    u8    * bytes     = (u8 *) data;
+    u32   * words;
+    u64     acc       = sum;
+    u16     half      = 0;
+    u32     num_words;
+    u32     i;
+
+    if ((((u32) bytes) & 0x1) == 0) {
+        // Step up to a 32-bit boundary with a single 16-bit access
+        if (((((u32) bytes) & 0x2) != 0) && (size >= 2)) {
+            acc   += *((u16 *) bytes);
+            bytes += 2;
+            size  -= 2;
+        }
+
+        // Sum all 32-bit words
+        words     = (u32 *) bytes;
+        num_words = size >> 2;
+
+        for (i = 0; (i + 4) <= num_words; i += 4) {
+            acc += words[i];
+            acc += words[i + 1];
+            acc += words[i + 2];
+            acc += words[i + 3];
+        }
+
+        for ( ; i < num_words; i++) {
+            acc += words[i];
+        }
+
+        bytes += (num_words << 2);
+        size  &= 0x3;
+
+        // Remaining 16-bit word
+        if (size >= 2) {
+            acc   += *((u16 *) bytes);
+            bytes += 2;
+            size  -= 2;
+        }
+    } else {
+        // Data is not 16-bit aligned; build each word from bytes in memory order
+        for ( ; size >= 2; size -= 2) {
+            ((u8 *) &half)[0] = bytes[0];
+            ((u8 *) &half)[1] = bytes[1];
+            acc   += half;
+            bytes += 2;
+        }
+    }
+
+    // Last byte is the first byte of a 16-bit word padded with zero
+    if (size != 0) {
+        half             = 0;
+        ((u8 *) &half)[0] = bytes[0];
+        acc             += half;
     }
 
+    // Fold the carries back in:  64-bit -> 32-bit -> 16-bit "end around carry"
+    acc = (acc >> 32) + (acc & 0xFFFFFFFF);
+    acc = (acc >> 32) + (acc & 0xFFFFFFFF);
+    sum = (u32) acc;
+    sum = (sum >> 16) + (sum & 0x0000FFFF);
+    sum = (sum >> 16) + (sum & 0x0000FFFF);
+
+    return sum;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Finish a partial IP Checksum
+ *
+ * @param   sum             - Partial sum from ipv4_checksum_add()
+ *
+ * @return  u16             - Checksum value (same byte order as ipv4_compute_checksum())
+ *
+ *****************************************************************************/
+u16 ipv4_checksum_finish(u32 sum) {
+
     // 1's complement 16-bit sum, formed by "end around carry" of 32-bit 2's complement sum
-    sum = ((sum & 0xFFFF0000) >> 16) + (sum & 0x0000FFFF);
+    sum = (sum >> 16) + (sum & 0x0000FFFF);
+    sum = (sum >> 16) + (sum & 0x0000FFFF);
 
     // Return the 1's complement of 1's complement 16-bit sum
-    return (~sum);
+    return (~Xil_Ntohs((u16) sum));
 }
 
  
@@ -390,16 +501,91 @@ void udp_update_header(udp_header * header, u16 dest_port, u16 udp_length) {
     header->dest_port = dest_port;
     header->length    = Xil_Htons(udp_length);
    
-    // Currently, the Mango wlan_exp IP/UDP Library does not use the UDP checksum capabilities.  This is primarily
+    // By default, the Mango wlan_exp IP/UDP Library does not use the UDP checksum capabilities.  This is primarily
     // due to the amount of time required to compute the checksum.  Also, given that communication 
     // between hosts and nodes is, in general, fairly localized, there is not as much of a need for 
-    // the data integrity check that the UDP checksum provides.
+    // the data integrity check that the UDP checksum provides.  The checksum is filled in by
+    // udp_update_checksum() if WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM is enabled.
     //
     header->checksum  = UDP_NO_CHECKSUM;
 }
 
 
 
+/*****************************************************************************/
+/**
+ * Update the UDP checksum
+ *
+ * Computes the UDP checksum over the pseudo header, the UDP header and all data
+ * that follows the UDP header in a single pass.  The IP header must already
+ * contain the source / destination addresses and the UDP header must contain the
+ * final length (ie call after udp_update_header() / ipv4_update_header()).
+ *
+ * @param   header           - Pointer to the IP/UDP header
+ * @param   header_size      - Number of bytes directly following the IP/UDP header that are part of the packet
+ * @param   buffers          - Array of buffers that follow the header data
+ * @param   num_buffers      - Number of buffers in the array
+ *
+ * @return  None
+ *
+ * @note    If WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM is disabled, then this sets the checksum
+ *          to UDP_NO_CHECKSUM without touching the data.
+ *
+ *****************************************************************************/
+void udp_update_checksum(wlan_exp_ip_udp_header * header, u32 header_size, wlan_exp_ip_udp_buffer ** buffers, u32 num_buffers) {
+
+#if WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM
+    u32                      i;
+    u32                      sum;
+    u32                      partial;
+    u32                      offset;
+    u32                      ip_addr[2];
+    u16                      checksum;
+
+    header->udp_hdr.checksum = 0;
+
+    // Pseudo header:  source / destination IP address, protocol, UDP length (all big endian)
+    ip_addr[0] = header->ip_hdr.src_ip_addr;
+    ip_addr[1] = header->ip_hdr.dest_ip_addr;
+
+    sum  = ipv4_checksum_add(0, ip_addr, sizeof(ip_addr));
+    sum += Xil_Htons(IP_PROTOCOL_UDP);
+    sum += header->udp_hdr.length;
+
+    // UDP header, delimiter and any header data that follows
+    offset = UDP_HEADER_LEN + WLAN_EXP_IP_UDP_DELIM_LEN + header_size;
+    sum    = ipv4_checksum_add(sum, (u8 *) &(header->udp_hdr), offset);
+
+    // Buffers
+    //     NOTE:  A buffer that starts at an odd offset within the packet has its bytes in the
+    //         opposite half of each 16-bit word, so its partial sum is byte swapped (RFC 1071).
+    //
+    for (i = 0; i < num_buffers; i++) {
+        partial = ipv4_checksum_add(0, buffers[i]->data, buffers[i]->size);
+
+        if (offset & 0x1) {
+            partial = ((partial << 8) & 0xFF00) | ((partial >> 8) & 0x00FF);
+        }
+
+        sum    += partial;
+        offset += buffers[i]->size;
+    }
+
+    checksum = ipv4_checksum_finish(sum);
+
+    // A computed checksum of zero is transmitted as all ones (RFC 768)
+    if (checksum == 0) {
+        checksum = 0xFFFF;
+    }
+
+    header->udp_hdr.checksum = Xil_Htons(checksum);
+#else
+    header->udp_hdr.checksum = UDP_NO_CHECKSUM;
+#endif
+}
+
+
+
 /**********************************************************************************************************************/
 /**
  * @brief ARP Functions 
@@ -682,35 +868,63 @@ void arp_send_announcement(u32 eth_dev_num) {
  *          Since both addresses are (u8 *), the compiler cannot tell them apart 
  *          which makes it easy to get them reversed.
  *
+ * @note    A successful lookup counts as a use of the entry (ie it moves the entry to
+ *          the head of the LRU list and restarts its timeout).  An entry that has not
+ *          been used for WLAN_EXP_IP_UDP_ARP_TIMEOUT_USEC is removed from the cache.
+ *
  *****************************************************************************/
 int arp_get_hw_addr(u32 eth_dev_num, u8 * hw_addr, u8 * ip_addr) {
 
-    int                      i, j;
+    int                      i;
+    int                      index;
+    int                      int_status;
+    int                      status     = XST_FAILURE;
+    u64                      timestamp;
+    arp_cache_entry        * entry;
 
-    // Look through the ARP table
-    for (i = 0; i < WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES; i++) {
-    
-        // If an entry is in use, then check the IP address
-        if (ETH_arp_cache[i].state == ARP_TABLE_USED) {
-        
-            // If the IP address / eth_dev_num matches, then copy the hardware address
-            if ((ETH_arp_cache[i].paddr[0] == ip_addr[0]) && 
-                (ETH_arp_cache[i].paddr[1] == ip_addr[1]) && 
-                (ETH_arp_cache[i].paddr[2] == ip_addr[2]) && 
-                (ETH_arp_cache[i].paddr[3] == ip_addr[3]) &&
-                (ETH_arp_cache[i].eth_dev_num == eth_dev_num)) {
-                
-                // Copy the hardware address 
-                for (j = 0; j < ETH_ADDR_LEN; j++) {
-                    hw_addr[j] = ETH_arp_cache[i].haddr[j];
-                }
-                
-                return XST_SUCCESS;
+    // Lookups can happen in interrupt context (eg asynchronous messages), so the cache
+    // must not change underneath the lookup
+    int_status = interrupt_disable_callback();
+
+    index = arp_hash_find(eth_dev_num, ip_addr);
+
+    if (index >= 0) {
+        entry     = &(ETH_arp_cache[index]);
+        timestamp = arp_get_time();
+
+        // Remove the entry if it has timed out
+        if ((WLAN_EXP_IP_UDP_ARP_TIMEOUT_USEC != 0) &&
+            ((timestamp - entry->timestamp) > WLAN_EXP_IP_UDP_ARP_TIMEOUT_USEC)) {
+
+            hash_index_remove(&ETH_arp_hash_index, index);
+
+            entry->state       = ARP_TABLE_UNUSED;
+            entry->eth_dev_num = WLAN_EXP_IP_UDP_INVALID_ETH_DEVICE;
+
+            arp_lru_remove(index);
+            arp_lru_add_tail(index);
+
+        } else {
+            // Copy the hardware address 
+            for (i = 0; i < ETH_ADDR_LEN; i++) {
+                hw_addr[i] = entry->haddr[i];
             }
+
+            // Mark the entry as most recently used
+            entry->timestamp = timestamp;
+
+            if (ETH_arp_lru_head != index) {
+                arp_lru_remove(index);
+                arp_lru_add_head(index);
+            }
+
+            status = XST_SUCCESS;
         }
     }
 
-    return XST_FAILURE;
+    interrupt_enable_callback(int_status);
+
+    return status;
 }
 
 
@@ -729,101 +943,199 @@ int arp_get_hw_addr(u32 eth_dev_num, u8 * hw_addr, u8 * ip_addr) {
  *                             XST_SUCCESS - Command completed successfully
  *                             XST_FAILURE - There was an error in the command
  *
- * @note    This function assumes that both socket and buffer are valid.
+ * @note    If the address is not in the cache, then the entry at the tail of the LRU
+ *          list is used.  Since unused and timed out entries are kept at the tail of
+ *          the list, a used entry is only replaced when the cache is full (LRU
+ *          replacement policy).
  *
  *****************************************************************************/
 int arp_update_cache(u32 eth_dev_num, u8 * hw_addr, u8 * ip_addr) {
 
-    int                      i, j;
-    int                      first_unused_entry = -1;
-    int                      oldest_entry       = -1;
-    int                      entry_age          = -1;
-    int                      entry_to_use       = -1;
-    
-    // Look through the ARP table:
-    //     - Check that current IP address to see if entry already exists for the Ethernet device;
-    //       - Update the hw address
-    //       - Set age to zero
-    //     - Update the age of all entries that are being used
-    //     - Record the first unused entry
-    //     - Record the oldest entry
-    //
-    for (i = 0; i < WLAN_EXP_IP_UDP_NUM_ARP_ENTRIES; i++) {
-        if (ETH_arp_cache[i].state == ARP_TABLE_USED) {
+    int                      i;
+    int                      index;
+    int                      int_status;
+    arp_cache_entry        * entry;
 
-            // If this entry is older than the current oldest, then record it and update the age
-            if (entry_age < ETH_arp_cache[i].age) {
-                oldest_entry = i;
-                entry_age    = ETH_arp_cache[i].age;
-            }
-        
-            // Update the age of the used entry        
-            ETH_arp_cache[i].age += 1;
-
-            // If the IP address / eth_dev_num matches, then copy the hardware address
-            if ((ETH_arp_cache[i].paddr[0] == ip_addr[0]) &&
-                (ETH_arp_cache[i].paddr[1] == ip_addr[1]) &&
-                (ETH_arp_cache[i].paddr[2] == ip_addr[2]) &&
-                (ETH_arp_cache[i].paddr[3] == ip_addr[3]) &&
-                (ETH_arp_cache[i].eth_dev_num == eth_dev_num)) {
-        
-                // Copy the hardware address 
-                for (j = 0; j < ETH_ADDR_LEN; j++) {
-                    ETH_arp_cache[i].haddr[j] = hw_addr[j];
-                }
-
-                // Set age to zero
-                ETH_arp_cache[i].age = 0;
-                
-                // We are done updating the table
-                return XST_SUCCESS;
-            }
-        
-        } else {
-            // Record first unused entry
-            if (first_unused_entry < 0) {
-                first_unused_entry = i;
-            }
-        }
-    }    
+    int_status = interrupt_disable_callback();
 
-    // If we reach, here we need to add the entry to the table
-    //     - If there is an unused entry, then we should use that
-    //     - If there are no unused entries, then we should use the oldest entry (LRU replacement policy)
-    //
-    if (first_unused_entry != -1) {
-        entry_to_use = first_unused_entry;
-        
-        // Mark unused entry as used
-        ETH_arp_cache[entry_to_use].state = ARP_TABLE_USED;
-    } else {
-        entry_to_use = oldest_entry;
-    }
+    index = arp_hash_find(eth_dev_num, ip_addr);
+
+    // If the address is not in the cache, then reuse the entry at the tail of the LRU list
+    if (index < 0) {
+        index = ETH_arp_lru_tail;
+        entry = &(ETH_arp_cache[index]);
+
+        // Remove the old address from the index before it is overwritten
+        if (entry->state == ARP_TABLE_USED) {
+            hash_index_remove(&ETH_arp_hash_index, index);
+        }
 
-    // Copy the IP / HW addresses and eth_dev_num to entry
-    if (entry_to_use != -1) {
         // Copy IP address
         for (i = 0; i < IP_ADDR_LEN; i++) {
-            ETH_arp_cache[entry_to_use].paddr[i] = ip_addr[i];
-        }
-    
-        // Copy HW address    
-        for (i = 0; i < ETH_ADDR_LEN; i++) {
-            ETH_arp_cache[entry_to_use].haddr[i] = hw_addr[i];
+            entry->paddr[i] = ip_addr[i];
         }
-        
+
         // Copy Ethernet device
-        ETH_arp_cache[entry_to_use].eth_dev_num = eth_dev_num;
-    
-    } else {
-        return XST_FAILURE;
+        entry->eth_dev_num = eth_dev_num;
+        entry->state       = ARP_TABLE_USED;
+
+        hash_index_insert(&ETH_arp_hash_index, index);
+    }
+
+    entry = &(ETH_arp_cache[index]);
+
+    // Copy HW address
+    for (i = 0; i < ETH_ADDR_LEN; i++) {
+        entry->haddr[i] = hw_addr[i];
+    }
+
+    // Mark the entry as most recently used
+    entry->timestamp = arp_get_time();
+
+    if (ETH_arp_lru_head != index) {
+        arp_lru_remove(index);
+        arp_lru_add_head(index);
     }
 
+    interrupt_enable_callback(int_status);
+
     return XST_SUCCESS;
 }
 
 
 
+/*****************************************************************************/
+/**
+ * Set the ARP time callback
+ *
+ * @param   void * callback  - Pointer to a function that returns the current time (usec)
+ *
+ * @return  None
+ *
+ * @note    Until the callback is set, all entries have the same timestamp and so
+ *          entries never time out.
+ *
+ *****************************************************************************/
+void arp_set_time_callback(u64(*callback)()) {
+    arp_time_callback = (arp_time_func_ptr_t) callback;
+}
+
+
+static u64 arp_get_time() {
+    if (arp_time_callback == NULL) {
+        return 0;
+    }
+
+    return arp_time_callback();
+}
+
+
+
+/*****************************************************************************/
+/**
+ * ARP cache hash index
+ *
+ * ETH_arp_hash_index is a hash_index_t over ETH_arp_cache (see wlan_mac_hash_index.h).
+ * Since there are always more buckets than entries, a probe always ends at an
+ * empty bucket.
+ *
+ *****************************************************************************/
+static inline u32 arp_hash_addr(u32 eth_dev_num, u8 * ip_addr) {
+    u32 key;
+
+    // The host part of the address is in the last byte for the small subnets used
+    // by experiments, so a multiplicative hash is used to spread it across the bits
+    key = (((u32)ip_addr[0] << 24) | ((u32)ip_addr[1] << 16) | ((u32)ip_addr[2] << 8) | (u32)ip_addr[3]) ^ (eth_dev_num << 24);
+
+    return hash_index_bucket(key, WLAN_EXP_IP_UDP_ARP_HASH_NUM_BITS);
+}
+
+
+u32 arp_hash_entry_bucket(u32 index) {
+    return arp_hash_addr(ETH_arp_cache[index].eth_dev_num, ETH_arp_cache[index].paddr);
+}
+
+
+static int arp_hash_find(u32 eth_dev_num, u8 * ip_addr) {
+    u32               bucket = arp_hash_addr(eth_dev_num, ip_addr);
+    u32               value;
+    arp_cache_entry * entry;
+
+    while ((value = hash_index_probe(&ETH_arp_hash_index, &bucket)) != 0) {
+        entry = &(ETH_arp_cache[value - 1]);
+
+        if ((entry->paddr[0]    == ip_addr[0]) &&
+            (entry->paddr[1]    == ip_addr[1]) &&
+            (entry->paddr[2]    == ip_addr[2]) &&
+            (entry->paddr[3]    == ip_addr[3]) &&
+            (entry->eth_dev_num == eth_dev_num)) {
+            return (value - 1);
+        }
+    }
+
+    return -1;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * ARP cache LRU list
+ *
+ * Doubly linked list (by entry index) from the most recently used entry (head)
+ * to the least recently used entry (tail).  All entries are always on the list.
+ *
+ *****************************************************************************/
+static void arp_lru_remove(u32 index) {
+    arp_cache_entry * entry = &(ETH_arp_cache[index]);
+
+    if (entry->lru_prev != ARP_CACHE_NULL_INDEX) {
+        ETH_arp_cache[entry->lru_prev].lru_next = entry->lru_next;
+    } else {
+        ETH_arp_lru_head = entry->lru_next;
+    }
+
+    if (entry->lru_next != ARP_CACHE_NULL_INDEX) {
+        ETH_arp_cache[entry->lru_next].lru_prev = entry->lru_prev;
+    } else {
+        ETH_arp_lru_tail = entry->lru_prev;
+    }
+}
+
+
+static void arp_lru_add_head(u32 index) {
+    arp_cache_entry * entry = &(ETH_arp_cache[index]);
+
+    entry->lru_prev = ARP_CACHE_NULL_INDEX;
+    entry->lru_next = ETH_arp_lru_head;
+
+    if (ETH_arp_lru_head != ARP_CACHE_NULL_INDEX) {
+        ETH_arp_cache[ETH_arp_lru_head].lru_prev = index;
+    } else {
+        ETH_arp_lru_tail = index;
+    }
+
+    ETH_arp_lru_head = index;
+}
+
+
+static void arp_lru_add_tail(u32 index) {
+    arp_cache_entry * entry = &(ETH_arp_cache[index]);
+
+    entry->lru_prev = ETH_arp_lru_tail;
+    entry->lru_next = ARP_CACHE_NULL_INDEX;
+
+    if (ETH_arp_lru_tail != ARP_CACHE_NULL_INDEX) {
+        ETH_arp_cache[ETH_arp_lru_tail].lru_next = index;
+    } else {
+        ETH_arp_lru_head = index;
+    }
+
+    ETH_arp_lru_tail = index;
+}
+
+
+
 
 /**********************************************************************************************************************/
 /**
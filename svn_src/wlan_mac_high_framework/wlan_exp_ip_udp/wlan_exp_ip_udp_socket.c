@@ -232,6 +232,9 @@ int socket_sendto(int socket_index, struct sockaddr * to, wlan_exp_ip_udp_buffer
     //
     ipv4_update_header(&(socket->hdr->ip_hdr), dest_ip_addr, ip_length, IP_PROTOCOL_UDP);
 
+    // Update the UDP checksum (requires the final IP addresses and UDP length)
+    udp_update_checksum(socket->hdr, 0, buffers, num_buffers);
+
     // Update the Ethernet header
     //     NOTE:  dest_hw_addr must be big-endian; ethertype must be little-endian
     //
@@ -30,11 +30,13 @@
 #include "wlan_mac_event_log.h"
 #include "wlan_mac_entries.h"
 #include "wlan_mac_ltg.h"
+#include "wlan_mac_slab.h"
 #include "wlan_mac_schedule.h"
 #include "wlan_mac_scan.h"
 #include "wlan_mac_network_info.h"
 #include "wlan_mac_station_info.h"
 #include "wlan_mac_eth_util.h"
+#include "wlan_mac_queue.h"
 #include "wlan_mac_high.h"
 #include "wlan_mac_common.h"
 #include "wlan_mac_dl_list.h"
@@ -74,6 +76,38 @@
 #define WLAN_EXP_ETH_BUFFER_ALIGNMENT 0x40 // Buffer alignment (64 byte boundary)
 
 
+// Log streaming
+//
+// When log streaming is enabled, node_log_stream_poll() pushes newly written event log data to the
+// host from the transport poll.  Stream packets use a separate header ring so that a host request
+// serviced by transfer_log_data() cannot overwrite a stream header that is still queued for DMA.
+//
+//     1)  A packet is only queued when the Tx ring has WLAN_EXP_LOG_STREAM_TXBD_PER_PKT free descriptors
+//         (header, data and worst case minimum frame padding).  Each packet in flight holds at least 2 TX BDs,
+//         so 8 buffers cover up to 17 TX BDs (checked when the stream is started).
+//     2)  Less than a full packet of data is held for WLAN_EXP_LOG_STREAM_FLUSH_USEC so that full size
+//         packets are sent while the log is busy.
+//
+#define WLAN_EXP_LOG_STREAM_NUM_BUFFER 0x08 // Number of header buffers allocated
+#define WLAN_EXP_LOG_STREAM_TXBD_PER_PKT 3 // TX BDs required before a packet is queued
+#define WLAN_EXP_LOG_STREAM_FLUSH_USEC 10000 // Time a partial packet is held (in usec)
+
+
+// Deferred commands
+//
+// When the host sets TRANSPORT_HDR_DEFER_FLAG on a command that supports it, the node acknowledges the
+// command with a job ID and finishes the work from node_cmd_job_poll(), one step per transport poll.  Only
+// one job runs at a time; the host polls CMDID_NODE_CMD_STATUS for completion.
+//
+//     1)  A deferred log transfer sends at most WLAN_EXP_CMD_JOB_MAX_PKTS_PER_POLL packets per step and
+//         only while the Tx ring has WLAN_EXP_LOG_STREAM_TXBD_PER_PKT free descriptors, so it never waits
+//         on the Tx ring with interrupts disabled.
+//     2)  Deferred log transfers use their own header ring, sized like the log stream header ring.
+//
+#define WLAN_EXP_CMD_JOB_NUM_BUFFER 0x08 // Number of header buffers allocated
+#define WLAN_EXP_CMD_JOB_MAX_PKTS_PER_POLL 4 // Maximum number of packets sent per step
+
+
 /*********************** Global Variable Definitions *************************/
 
 // Declared in wlan_mac_high.c
@@ -134,6 +168,88 @@ typedef struct wlan_exp_station_txrx_counts_t{
 } wlan_exp_station_txrx_counts_t;
 ASSERT_TYPE_SIZE(wlan_exp_station_txrx_counts_t, 128);
 
+//-----------------------------------------------
+// wlan_exp Station Info Delta
+//
+//     Only used to communicate with WLAN Exp Host.  A CMDID_NODE_GET_STATION_INFO_DELTA
+//     buffer is one wlan_exp_station_delta_hdr_t followed by num_entries wlan_exp_station_delta_t.
+//
+typedef struct wlan_exp_station_delta_hdr_t{
+    u32                                 generation;                // Generation to pass in the next query
+    u32                                 num_stations;              // Number of stations tracked by the node
+    u32                                 num_entries;               // Number of wlan_exp_station_delta_t that follow
+    u32                                 flags;                     // CMD_PARAM_STATION_INFO_DELTA_FLAG_*
+} wlan_exp_station_delta_hdr_t;
+ASSERT_TYPE_SIZE(wlan_exp_station_delta_hdr_t, 16);
+
+typedef struct wlan_exp_station_delta_t{
+    u32                                 generation;                // Generation of the latest change (0 = station was removed; ignore)
+    u32                                 reserved;
+    wlan_exp_station_txrx_counts_t      counts;                    // Same format as CMDID_COUNTS_GET_TXRX
+    wlan_exp_station_info_t             info;                      // Same format as CMDID_NODE_GET_STATION_INFO_LIST
+} wlan_exp_station_delta_t;
+ASSERT_TYPE_SIZE(wlan_exp_station_delta_t, 208);
+
+#if WLAN_SW_CONFIG_ENABLE_LOGGING
+//-----------------------------------------------
+// wlan_exp Log Streaming State
+//
+typedef struct log_stream_t{
+    u8                  enable;                    // Is streaming enabled?
+    u8                  reserved0;
+    u16                 reserved1;
+    u32                 prev_wrap_config;          // Log wrap configuration to restore when the stream stops
+    int                 socket_index;              // Socket used to send stream packets
+    u32                 eth_dev_num;               // Ethernet device of the socket
+    u32                 dest_ip_addr;              // Destination IP address (big endian)
+    u32                 bytes_per_pkt;             // Maximum number of log bytes per packet
+    u32                 header_length;             // Length of the pre-built packet header
+    u32                 header_offset;             // Offset of the next header in ETH_log_stream_header_buffer
+    u64                 partial_start_usec;        // Time a partial packet of data was first seen (0 if none)
+    event_log_cursor_t  cursor;                    // Next log byte to stream
+    u64                 num_bytes;                 // Number of log bytes streamed
+    u32                 num_pkts;                  // Number of packets streamed
+    u32                 num_backpressure;          // Number of polls stopped because the Tx ring was full
+    u32                 num_overruns;              // Number of times the log overwrote bytes before they were streamed
+    u8                  header[WLAN_EXP_ETH_BUFFER_SIZE];  // Pre-built packet header (see log_data_header_init())
+} log_stream_t;
+
+//-----------------------------------------------
+// wlan_exp Deferred Log Transfer State
+//
+typedef struct log_transfer_job_t{
+    int                 socket_index;              // Socket used to send the data
+    u32                 dest_ip_addr;              // Destination IP address (big endian)
+    u32                 curr_index;                // Next log byte to send
+    u32                 end_index;                 // Log index after the last byte to send
+    u32                 bytes_per_pkt;             // Maximum number of log bytes per packet
+    u32                 header_length;             // Length of the pre-built packet header
+    u32                 header_offset;             // Offset of the next header in ETH_cmd_job_header_buffer
+    u32                 status;                    // CMD_PARAM_SUCCESS unless a packet could not be sent
+    u8                  header[WLAN_EXP_ETH_BUFFER_SIZE];  // Pre-built packet header (see log_data_header_init())
+} log_transfer_job_t;
+#endif
+
+//-----------------------------------------------
+// wlan_exp Deferred Command State
+//
+typedef struct node_cmd_job_t{
+    u8                  state;                     // CMD_PARAM_NODE_CMD_JOB_*
+    u8                  reserved0;
+    u16                 reserved1;
+    u32                 id;                        // Job ID returned to the host (0 = no job has been started)
+    u32                 cmd_id;                    // Command that started the job
+    u32                 status;                    // Status of the command once the job is done
+    u32                 eth_dev_num;               // Ethernet device whose poll runs the job
+    u32                 num_steps;                 // Number of steps run
+    u32                 work_done;                 // Progress of the job (command specific units)
+    u32                 work_total;                // Total work of the job (0 if unknown)
+    u64                 start_usec;                // System time the job was started
+    u64                 end_usec;                  // System time the job was done
+    function_ptr_t      step;                      // int step(u32 arg, u32* status)
+    u32                 arg;                       // Argument for step
+} node_cmd_job_t;
+
 /*************************** Functions Prototypes ****************************/
 
 typedef dl_entry* (*list_search_func_ptr)(u8 *);
@@ -148,6 +264,18 @@ void ltg_cleanup(u32 id, void* callback_arg);
 void          transfer_log_data(u32 socket_index, void * from,
                                 void* resp_buffer_data, u32 eth_dev_num, u32 max_resp_len,
                                 u32 id, u32 flags, u32 start_index, u32 size);
+u32           log_data_header_init(u8* header, u32 socket_index, void* resp_buffer_data, u32 eth_dev_num,
+                                   u32 dest_ip_addr, u16 dest_port, u32 id, u32 flags);
+void          log_data_header_update(u8* header, u8* header_addr, u32 dest_ip_addr,
+                                     u32 bytes_remaining, u32 curr_index, wlan_exp_ip_udp_buffer* data_buffer);
+
+int           node_log_stream_start(int socket_index, void* from, void* resp_buffer_data, u32 max_resp_len,
+                                    u32 id, u32 flags, u16 dest_port);
+void          node_log_stream_stop();
+
+int           node_log_transfer_start(int socket_index, void* from, void* resp_buffer_data, u32 max_resp_len,
+                                      u32 id, u32 flags, u32 start_index, u32 size, u32* job_id);
+int           node_log_transfer_step(u32 arg, u32* status);
 
 u32           process_buffer_cmds(int socket_index, void* from, cmd_resp* command, cmd_resp* response,
                                   cmd_resp_hdr* cmd_hdr, u32* cmd_args_32,
@@ -159,6 +287,9 @@ u32           process_buffer_cmds(int socket_index, void* from, cmd_resp* comman
                                   void (*copy_source_to_dest)(void*, void*, u8*),
                                   void (*zero_dest)(void*));
 
+u32           process_station_delta_cmd(int socket_index, void* from, cmd_resp* response,
+                                        u32* cmd_args_32, cmd_resp_hdr* resp_hdr, u32* resp_args_32, u32 max_resp_len);
+
 dl_entry*     find_station_info(u8* mac_addr);
 void          zero_station_info(void* dest);
 void          copy_station_info_to_dest(void* source, void* dest, u8* mac_addr);
@@ -193,6 +324,23 @@ static function_ptr_t wlan_exp_process_node_cmd_callback;
 //
 u8     ETH_header_buffer[WLAN_EXP_ETH_NUM_BUFFER * WLAN_EXP_ETH_BUFFER_SIZE] __attribute__ ((aligned(WLAN_EXP_ETH_BUFFER_ALIGNMENT))) __attribute__ ((section (".wlan_exp_eth_buffers")));
 
+#if WLAN_SW_CONFIG_ENABLE_LOGGING
+// Allocate Ethernet Header buffer for log streaming (see WLAN_EXP_LOG_STREAM_NUM_BUFFER)
+u8     ETH_log_stream_header_buffer[WLAN_EXP_LOG_STREAM_NUM_BUFFER * WLAN_EXP_ETH_BUFFER_SIZE] __attribute__ ((aligned(WLAN_EXP_ETH_BUFFER_ALIGNMENT))) __attribute__ ((section (".wlan_exp_eth_buffers")));
+
+// Log streaming state
+static log_stream_t               log_stream;
+
+// Allocate Ethernet Header buffer for deferred log transfers (see WLAN_EXP_CMD_JOB_NUM_BUFFER)
+u8     ETH_cmd_job_header_buffer[WLAN_EXP_CMD_JOB_NUM_BUFFER * WLAN_EXP_ETH_BUFFER_SIZE] __attribute__ ((aligned(WLAN_EXP_ETH_BUFFER_ALIGNMENT))) __attribute__ ((section (".wlan_exp_eth_buffers")));
+
+// Deferred log transfer state
+static log_transfer_job_t         log_transfer_job;
+#endif
+
+// Deferred command state
+static node_cmd_job_t             node_cmd_job;
+
 
 /******************************** Functions **********************************/
 
@@ -935,6 +1083,46 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
         break;
 
 
+        //---------------------------------------------------------------------
+        case CMDID_NODE_CMD_STATUS: {
+            // Get the status of the most recent deferred command
+            //
+            // Response format:
+            //     resp_args_32[0]     Job ID (0 = no command has been deferred)
+            //     resp_args_32[1]     Command ID that started the job
+            //     resp_args_32[2]     State:
+            //                             - CMD_PARAM_NODE_CMD_JOB_IDLE
+            //                             - CMD_PARAM_NODE_CMD_JOB_RUNNING
+            //                             - CMD_PARAM_NODE_CMD_JOB_DONE
+            //     resp_args_32[3]     Status of the command (valid once the job is done)
+            //     resp_args_32[4]     Work done (command specific; bytes for CMDID_LOG_GET_ENTRIES)
+            //     resp_args_32[5]     Total work (0 if unknown)
+            //     resp_args_32[6]     Number of steps run
+            //     resp_args_32[7]     Run time of the job (in usec)
+            //
+            u64 end_usec;
+
+            if (node_cmd_job.state == CMD_PARAM_NODE_CMD_JOB_RUNNING) {
+                end_usec = get_system_time_usec();
+            } else {
+                end_usec = node_cmd_job.end_usec;
+            }
+
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.id);
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.cmd_id);
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.state);
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.status);
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.work_done);
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.work_total);
+            resp_args_32[resp_index++] = Xil_Htonl(node_cmd_job.num_steps);
+            resp_args_32[resp_index++] = Xil_Htonl((u32)(end_usec - node_cmd_job.start_usec));
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
 //-----------------------------------------------------------------------------
 // Log Commands
 //-----------------------------------------------------------------------------
@@ -1107,6 +1295,12 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
             //   only transfer those events.  It will not any new events that are added to the log while
             //   we are transferring the current log as well as transfer any events after a wrap.
             //
+            // Deferred (TRANSPORT_HDR_DEFER_FLAG):
+            //     The node responds immediately and sends the buffer packets from node_cmd_job_poll()
+            //     - resp_args_32[0] - CMD_PARAM_SUCCESS
+            //                       - CMD_PARAM_ERROR (another command is still deferred)
+            //     - resp_args_32[1] - Job ID (see CMDID_NODE_CMD_STATUS)
+            //
             u32 id = Xil_Ntohl(cmd_args_32[0]);
             u32 flags = Xil_Ntohl(cmd_args_32[1]);
             u32 start_index = Xil_Ntohl(cmd_args_32[2]);
@@ -1118,13 +1312,111 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
                 size = evt_log_size;
             }
 
-            // Transfer data to host
-            transfer_log_data(socket_index, from,
-                              (void *)(((wlan_exp_ip_udp_buffer *)(response->buffer))->data),
-                              eth_dev_num, max_resp_len,
-                              id, flags, start_index, size);
+            if ((command->flags) & CMD_RESP_FLAG_DEFER) {
+                u32 status = CMD_PARAM_SUCCESS;
+                u32 job_id = 0;
+
+                if (node_log_transfer_start(socket_index, from,
+                                            (void *)(((wlan_exp_ip_udp_buffer *)(response->buffer))->data),
+                                            max_resp_len, id, flags, start_index, size, &job_id) != XST_SUCCESS) {
+                    status = CMD_PARAM_ERROR;
+                }
+
+                resp_args_32[resp_index++] = Xil_Htonl(status);
+                resp_args_32[resp_index++] = Xil_Htonl(job_id);
+
+                resp_hdr->length  += (resp_index * sizeof(u32));
+                resp_hdr->num_args = resp_index;
+            } else {
+                // Transfer data to host
+                transfer_log_data(socket_index, from,
+                                  (void *)(((wlan_exp_ip_udp_buffer *)(response->buffer))->data),
+                                  eth_dev_num, max_resp_len,
+                                  id, flags, start_index, size);
+
+                resp_sent = RESP_SENT;
+            }
+#endif //WLAN_SW_CONFIG_ENABLE_LOGGING
+        }
+        break;
+
+
+        //---------------------------------------------------------------------
+        case CMDID_LOG_STREAM: {
+#if WLAN_SW_CONFIG_ENABLE_LOGGING
+            // Start / Stop / Get status of log streaming
+            //
+            // Message format:
+            //     cmd_args_32[0]      Command:
+            //                             - Write       (CMD_PARAM_WRITE_VAL)
+            //                             - Read        (CMD_PARAM_READ_VAL)
+            //     cmd_args_32[1]      Enable:
+            //                             - CMD_PARAM_LOG_STREAM_ENABLE
+            //                             - CMD_PARAM_LOG_STREAM_DISABLE
+            //     cmd_args_32[2]      Buffer ID placed in every stream packet
+            //     cmd_args_32[3]      Buffer flags placed in every stream packet
+            //     cmd_args_32[4]      Destination UDP port (0 = port the command was sent from)
+            //                           NOTE:  Stream packets are always sent to the IP address of the host
+            //                                  that sent the command
+            //
+            // Response format:
+            //     resp_args_32[0]     Status
+            //     resp_args_32[1]     Enabled
+            //     resp_args_32[2]     Log index of the next byte to stream
+            //     resp_args_32[3]     Number of log bytes streamed (upper 32 bits)
+            //     resp_args_32[4]     Number of log bytes streamed (lower 32 bits)
+            //     resp_args_32[5]     Number of packets streamed
+            //     resp_args_32[6]     Number of polls stopped because the Tx ring was full
+            //     resp_args_32[7]     Number of times the log overwrote bytes before they were streamed
+            //
+            //   Stream packets use the buffer format of CMDID_LOG_GET_ENTRIES where bytes_remaining
+            //   is the number of bytes that were ready to stream when the packet was sent.
+            //
+            u32 status         = CMD_PARAM_SUCCESS;
+            u32 msg_cmd        = Xil_Ntohl(cmd_args_32[0]);
+            u32 enable         = Xil_Ntohl(cmd_args_32[1]);
+            u32 id             = Xil_Ntohl(cmd_args_32[2]);
+            u32 flags          = Xil_Ntohl(cmd_args_32[3]);
+            u32 dest_port      = Xil_Ntohl(cmd_args_32[4]);
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    if (enable == CMD_PARAM_LOG_STREAM_ENABLE) {
+                        if ((dest_port > 0xFFFF) ||
+                            (node_log_stream_start(socket_index, from,
+                                                   (void *)(((wlan_exp_ip_udp_buffer *)(response->buffer))->data),
+                                                   max_resp_len, id, flags, dest_port) != XST_SUCCESS)) {
+                            status = CMD_PARAM_ERROR;
+                        }
+                    } else if (enable == CMD_PARAM_LOG_STREAM_DISABLE) {
+                        node_log_stream_stop();
+                    } else {
+                        wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log, "Unknown log stream enable: %d\n", enable);
+                        status = CMD_PARAM_ERROR;
+                    }
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(log_stream.enable);
+            resp_args_32[resp_index++] = Xil_Htonl(log_stream.cursor.index);
+            resp_args_32[resp_index++] = Xil_Htonl((u32)(log_stream.num_bytes >> 32));
+            resp_args_32[resp_index++] = Xil_Htonl((u32)(log_stream.num_bytes & 0xFFFFFFFF));
+            resp_args_32[resp_index++] = Xil_Htonl(log_stream.num_pkts);
+            resp_args_32[resp_index++] = Xil_Htonl(log_stream.num_backpressure);
+            resp_args_32[resp_index++] = Xil_Htonl(log_stream.num_overruns);
 
-            resp_sent = RESP_SENT;
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
 #endif //WLAN_SW_CONFIG_ENABLE_LOGGING
         }
         break;
@@ -1270,21 +1562,21 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
                     }
 
                     // Free the memory allocated for the params (ltg_callback_arg will be freed later)
-                    wlan_mac_high_free(params);
+                    ltg_sched_params_free(params);
                 } else {
                     status = CMD_PARAM_ERROR + CMD_PARAM_LTG_ERROR;
                     wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_ltg, "Could not create LTG\n");
 
                     // Free the memory allocated in the deserialize
-                    wlan_mac_high_free(params);
-                    wlan_mac_high_free(ltg_callback_arg);
+                    ltg_sched_params_free(params);
+                    ltg_payload_free(ltg_callback_arg);
                 }
             } else {
                 status = CMD_PARAM_ERROR + CMD_PARAM_LTG_ERROR;
 
                 // Free the memory allocated in the deserialize
-                if (ltg_callback_arg != NULL) { wlan_mac_high_free(ltg_callback_arg); }
-                if (params           != NULL) { wlan_mac_high_free(params); }
+                if (ltg_callback_arg != NULL) { ltg_payload_free(ltg_callback_arg); }
+                if (params           != NULL) { ltg_sched_params_free(params); }
 
                 wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_ltg, "Could not allocate memory for CMDID_LTG_CONFIG\n");
             }
@@ -2101,6 +2393,83 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
         break;
 
 
+        //---------------------------------------------------------------------
+        case CMDID_NODE_TX_RATE_SELECTION: {
+            // NODE_TX_RATE_SELECTION Packet Format:
+            //   - cmd_args_32[0]      - Command
+            //   - cmd_args_32[1]      - Rate selection scheme (RATE_SELECTION_SCHEME_*)
+            //   - cmd_args_32[2]      - Update default scheme for new unicast stations
+            //   - cmd_args_32[3]      - Address selection (CMD_PARAM_TXPARAM_ADDR_*)
+            //   - cmd_args_32[4:5]    - MAC address (CMD_PARAM_TXPARAM_ADDR_SINGLE only)
+            //
+            // Response Packet Format:
+            //   - resp_args_32[0]     - Status
+            //   - resp_args_32[1]     - Default rate selection scheme
+            //
+            u8 mac_addr[MAC_ADDR_LEN];
+            u32 status = CMD_PARAM_SUCCESS;
+
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+            u32 scheme = Xil_Ntohl(cmd_args_32[1]);
+            u32 update_default = Xil_Ntohl(cmd_args_32[2]);
+            u32 addr_sel = Xil_Ntohl(cmd_args_32[3]);
+
+            int iter;
+            dl_list* station_info_list;
+            station_info_entry_t* station_info_entry;
+            station_info_t* station_info;
+
+            if( msg_cmd == CMD_PARAM_WRITE_VAL ){
+                if ((scheme != RATE_SELECTION_SCHEME_STATIC) && (scheme != RATE_SELECTION_SCHEME_MINSTREL)) {
+                    status = CMD_PARAM_ERROR;
+                } else {
+                    if (update_default) {
+                        station_info_set_default_rate_selection_scheme(scheme);
+                    }
+
+                    switch (addr_sel) {
+                        default:
+                        case CMD_PARAM_TXPARAM_ADDR_ALL_MULTICAST:
+                            // Multicast frames are always sent at a static rate
+                            status = CMD_PARAM_ERROR;
+                        break;
+                        case CMD_PARAM_TXPARAM_ADDR_NONE:
+                        break;
+                        case CMD_PARAM_TXPARAM_ADDR_ALL:
+                        case CMD_PARAM_TXPARAM_ADDR_ALL_UNICAST:
+                            station_info_list  = station_info_get_list();
+                            station_info_entry = (station_info_entry_t*)(station_info_list->first);
+                            iter = (station_info_list->length)+1;
+                            while(station_info_entry && ((iter--) > 0)){
+                                station_info_set_rate_selection_scheme(station_info_entry->data, scheme);
+                                station_info_entry = (station_info_entry_t*)dl_entry_next((dl_entry*)station_info_entry);
+                            }
+                        break;
+                        case CMD_PARAM_TXPARAM_ADDR_SINGLE:
+                            wlan_exp_get_mac_addr(&((u32 *)cmd_args_32)[4], &mac_addr[0]);
+                            station_info = station_info_create(&mac_addr[0]);
+                            if (station_info) {
+                                station_info_set_rate_selection_scheme(station_info, scheme);
+                            } else {
+                                status = CMD_PARAM_ERROR;
+                            }
+                        break;
+                    }
+                }
+            } else if( msg_cmd != CMD_PARAM_READ_VAL ){
+                status = CMD_PARAM_ERROR;
+            }
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(station_info_get_default_rate_selection_scheme());
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
         //---------------------------------------------------------------------
         case CMDID_NODE_TX_ANT_MODE: {
             u8 mac_addr[MAC_ADDR_LEN];
@@ -2468,6 +2837,128 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
         break;
 
 
+        //---------------------------------------------------------------------
+        case CMDID_NODE_SCAN_ADAPTIVE: {
+            // Set / Get the adaptive dwell parameters of the active scan
+            //
+            // Message format:
+            //     cmd_args_32[0]    Command:
+            //                           - Write       (NODE_WRITE_VAL)
+            //                           - Read        (NODE_READ_VAL)
+            //     cmd_args_32[1]    Min dwell (in microseconds; 0 disables the adaptive dwell)
+            //     cmd_args_32[2]    Max dwell (in microseconds)
+            //     cmd_args_32[3]    Scan flags
+            //
+            // Response format:
+            //     resp_args_32[0]   Status
+            //     resp_args_32[1]   Min dwell (in microseconds)
+            //     resp_args_32[2]   Max dwell (in microseconds)
+            //     resp_args_32[3]   Scan flags
+            //
+            volatile scan_parameters_t* scan_params = wlan_mac_scan_get_parameters();
+            u32 is_scanning;
+            u32 status = CMD_PARAM_SUCCESS;
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    // The dwell check interval is only set when a scan starts
+                    is_scanning = wlan_mac_scan_is_scanning();
+
+                    if (is_scanning) {
+                        wlan_mac_scan_stop();
+                    }
+
+                    scan_params->min_dwell_usec = Xil_Ntohl(cmd_args_32[1]);
+                    scan_params->max_dwell_usec = Xil_Ntohl(cmd_args_32[2]);
+                    scan_params->flags          = Xil_Ntohl(cmd_args_32[3]);
+
+                    wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "Set Scan Adaptive Dwell: min = %d us, max = %d us, flags = 0x%08x\n",
+                                    scan_params->min_dwell_usec, scan_params->max_dwell_usec, scan_params->flags);
+
+                    if (is_scanning) {
+                        wlan_mac_scan_start();
+                    }
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_params->min_dwell_usec);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_params->max_dwell_usec);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_params->flags);
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
+        //---------------------------------------------------------------------
+        case CMDID_NODE_SCAN_STATS: {
+            // Read / reset the scan statistics
+            //
+            // Message format:
+            //     cmd_args_32[0]    Command:
+            //                           - Write       (NODE_WRITE_VAL) - Reset statistics
+            //                           - Read        (NODE_READ_VAL)
+            //
+            // Response format:
+            //     resp_args_32[0]   Status
+            //     resp_args_32[1]   Number of channels visited
+            //     resp_args_32[2]   Number of early channel exits
+            //     resp_args_32[3]   Number of dwell extensions
+            //     resp_args_32[4]   Number of receptions on scan channels
+            //     resp_args_32[5]   Number of beacons / probe responses on scan channels
+            //     resp_args_32[6]   Duration of the last full scan (in microseconds)
+            //     resp_args_32[7]   Total dwell time - MSB (in microseconds)
+            //     resp_args_32[8]   Total dwell time - LSB
+            //
+            scan_stats_t* scan_stats;
+            u32 status = CMD_PARAM_SUCCESS;
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    wlan_mac_scan_reset_stats();
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            scan_stats = wlan_mac_scan_get_stats();
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_stats->num_channels_visited);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_stats->num_early_exits);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_stats->num_extensions);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_stats->num_rx);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_stats->num_responses);
+            resp_args_32[resp_index++] = Xil_Htonl(scan_stats->last_full_scan_usec);
+            resp_args_32[resp_index++] = Xil_Htonl((u32)(scan_stats->total_dwell_usec >> 32));
+            resp_args_32[resp_index++] = Xil_Htonl((u32)(scan_stats->total_dwell_usec & 0xFFFFFFFF));
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
 //-----------------------------------------------------------------------------
 // Association Commands
 //-----------------------------------------------------------------------------
@@ -2566,6 +3057,32 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
         break;
 
 
+        //---------------------------------------------------------------------
+        case CMDID_NODE_GET_STATION_INFO_DELTA: {
+            // NODE_GET_STATION_INFO_DELTA Packet Format:
+            //   - cmd_args_32[0]   - buffer id
+            //   - cmd_args_32[1]   - flags
+            //   - cmd_args_32[2]   - generation (0 = all stations; otherwise the generation from the previous response)
+            //
+            // Always returns a valid WLAN Exp Buffer (either 1 or more packets)
+            //   - buffer_id       - uint32  - buffer_id
+            //   - flags           - uint32  - flags
+            //   - bytes_remaining - uint32  - Number of bytes remaining in the transfer
+            //   - start_byte      - uint32  - Byte index of the first byte in this packet
+            //   - size            - uint32  - Number of payload bytes in this packet
+            //   - byte[]          - uint8[] - wlan_exp_station_delta_hdr_t followed by wlan_exp_station_delta_t entries
+            //
+            // Only stations that were created or updated (Tx / Rx / counts reset) since the generation
+            // are returned.  If a station was removed since the generation, every station is returned
+            // and CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL is set in the header flags; the host should
+            // then replace its table with the response.
+            //
+            resp_sent = process_station_delta_cmd(socket_index, from, response,
+                                                  cmd_args_32, resp_hdr, resp_args_32, max_resp_len);
+        }
+        break;
+
+
         //---------------------------------------------------------------------
         case CMDID_NODE_GET_BSS_INFO: {
             // NODE_GET_BSS_INFO Packet Format:
@@ -2640,42 +3157,129 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
         break;
 
 
-//-----------------------------------------------------------------------------
-// Memory Access Commands - For developer use only
-//-----------------------------------------------------------------------------
-
-
         //---------------------------------------------------------------------
-        case CMDID_DEV_MEM_HIGH: {
-            // Read/write memory in CPU High
+        case CMDID_QUEUE_TX_AMSDU_MAX_LENGTH: {
+            // Set / Get the maximum length of A-MSDUs built from the Tx queues
             //
-            // Write Message format:
-            //     cmd_args_32[0]      Command == CMD_PARAM_WRITE_VAL
-            //     cmd_args_32[1]      Address
-            //     cmd_args_32[2]      Length (number of u32 words to write)
-            //     cmd_args_32[3:]     Values to write (integral number of u32 words)
-            // Response format:
-            //     resp_args_32[0]     Status
+            // Message format:
+            //     cmd_args_32[0]      Command:
+            //                             - Write       (CMD_PARAM_WRITE_VAL)
+            //                             - Read        (CMD_PARAM_READ_VAL)
+            //     cmd_args_32[1]      Maximum MPDU length in bytes (0 disables A-MSDU aggregation)
             //
-            // Read Message format:
-            //     cmd_args_32[0]      Command == CMD_PARAM_READ_VAL
-            //     cmd_args_32[1]      Address
-            //     cmd_args_32[2]      Length (number of u32 words to read)
             // Response format:
             //     resp_args_32[0]     Status
-            //     resp_args_32[1]     Length (number of u32 values)
-            //     resp_args_32[2:]    Memory values (length u32 values)
+            //     resp_args_32[1]     Maximum MPDU length in bytes
             //
-            u32 mem_idx;
-            u32 status = CMD_PARAM_SUCCESS;
-            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
-            u32 mem_addr = Xil_Ntohl(cmd_args_32[1]);
-            u32 mem_length = Xil_Ntohl(cmd_args_32[2]);
-            u32 use_default_resp = WLAN_EXP_TRUE;
+            u32 status         = CMD_PARAM_SUCCESS;
+            u32 msg_cmd        = Xil_Ntohl(cmd_args_32[0]);
+            u32 max_length     = Xil_Ntohl(cmd_args_32[1]);
 
             switch (msg_cmd) {
                 case CMD_PARAM_WRITE_VAL:
-                    wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "Write CPU High Mem\n");
+                    queue_set_amsdu_max_length(max_length);
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(queue_get_amsdu_max_length());
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
+        //---------------------------------------------------------------------
+        case CMDID_QUEUE_TX_PKT_BUF_DEPTH: {
+            // Set / Get the number of GENERAL Tx packet buffers CPU Low may own at once
+            //
+            // Message format:
+            //     cmd_args_32[0]      Command:
+            //                             - Write       (CMD_PARAM_WRITE_VAL)
+            //                             - Read        (CMD_PARAM_READ_VAL)
+            //     cmd_args_32[1]      Pipeline depth (1 to the number of MPDU Tx packet buffers)
+            //
+            // Response format:
+            //     resp_args_32[0]     Status
+            //     resp_args_32[1]     Pipeline depth
+            //
+            u32 status         = CMD_PARAM_SUCCESS;
+            u32 msg_cmd        = Xil_Ntohl(cmd_args_32[0]);
+            u32 depth          = Xil_Ntohl(cmd_args_32[1]);
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    if ((depth > 0xFF) || (wlan_mac_high_set_tx_pkt_buf_depth(depth) != 0)) {
+                        wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Invalid Tx packet buffer depth: %d\n", depth);
+                        status = CMD_PARAM_ERROR;
+                    }
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            // Send response
+            resp_args_32[resp_index++] = Xil_Htonl(status);
+            resp_args_32[resp_index++] = Xil_Htonl(wlan_mac_high_get_tx_pkt_buf_depth());
+
+            resp_hdr->length  += (resp_index * sizeof(u32));
+            resp_hdr->num_args = resp_index;
+        }
+        break;
+
+
+//-----------------------------------------------------------------------------
+// Memory Access Commands - For developer use only
+//-----------------------------------------------------------------------------
+
+
+        //---------------------------------------------------------------------
+        case CMDID_DEV_MEM_HIGH: {
+            // Read/write memory in CPU High
+            //
+            // Write Message format:
+            //     cmd_args_32[0]      Command == CMD_PARAM_WRITE_VAL
+            //     cmd_args_32[1]      Address
+            //     cmd_args_32[2]      Length (number of u32 words to write)
+            //     cmd_args_32[3:]     Values to write (integral number of u32 words)
+            // Response format:
+            //     resp_args_32[0]     Status
+            //
+            // Read Message format:
+            //     cmd_args_32[0]      Command == CMD_PARAM_READ_VAL
+            //     cmd_args_32[1]      Address
+            //     cmd_args_32[2]      Length (number of u32 words to read)
+            // Response format:
+            //     resp_args_32[0]     Status
+            //     resp_args_32[1]     Length (number of u32 values)
+            //     resp_args_32[2:]    Memory values (length u32 values)
+            //
+            u32 mem_idx;
+            u32 status = CMD_PARAM_SUCCESS;
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+            u32 mem_addr = Xil_Ntohl(cmd_args_32[1]);
+            u32 mem_length = Xil_Ntohl(cmd_args_32[2]);
+            u32 use_default_resp = WLAN_EXP_TRUE;
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "Write CPU High Mem\n");
                     wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "  Addr: 0x%08x\n", mem_addr);
                     wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "  Len:  %d\n", mem_length);
 
@@ -2843,6 +3447,137 @@ int process_node_cmd(int socket_index, void* from, cmd_resp* command, cmd_resp*
         break;
 
 
+        //---------------------------------------------------------------------
+        case CMDID_DEV_SLAB_STATS: {
+            // Read / reset the statistics of the slab caches
+            //
+            // Write Message format:
+            //     cmd_args_32[0]      Command == CMD_PARAM_WRITE_VAL (resets max used / alloc counts)
+            // Response format:
+            //     resp_args_32[0]     Status
+            //
+            // Read Message format:
+            //     cmd_args_32[0]      Command == CMD_PARAM_READ_VAL
+            // Response format:
+            //     resp_args_32[0]     Status
+            //     resp_args_32[1]     Number of caches
+            //     resp_args_32[2:]    Cache statistics (SLAB_CACHE_STATS_NUM_WORDS u32 words per
+            //                         cache; the name in the first 3 words is not byte swapped)
+            //
+            u32 i;
+            u32 j;
+            u32 num_caches;
+            u32 stats[SLAB_CACHE_STATS_NUM_WORDS];
+            u32 status = CMD_PARAM_SUCCESS;
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+            u32 use_default_resp = WLAN_EXP_TRUE;
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    slab_reset_stats();
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                    num_caches = slab_get_num_caches();
+
+                    if ((2 + (num_caches * SLAB_CACHE_STATS_NUM_WORDS)) <= max_resp_len) {
+                        use_default_resp = WLAN_EXP_FALSE;
+
+                        resp_args_32[resp_index++] = Xil_Htonl(status);
+                        resp_args_32[resp_index++] = Xil_Htonl(num_caches);
+
+                        for (i = 0; i < num_caches; i++) {
+                            slab_get_stats(slab_get_cache(i), stats);
+
+                            for (j = 0; j < SLAB_CACHE_STATS_NUM_WORDS; j++) {
+                                resp_args_32[resp_index++] = (j < 3) ? stats[j] : Xil_Htonl(stats[j]);
+                            }
+                        }
+
+                        resp_hdr->length  += (resp_index * sizeof(u32));
+                        resp_hdr->num_args = resp_index;
+                    } else {
+                        wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "CMDID_DEV_SLAB_STATS response longer than %d words\n", max_resp_len);
+                        status = CMD_PARAM_ERROR;
+                    }
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            if (use_default_resp) {
+                // Send default response
+                resp_args_32[resp_index++] = Xil_Htonl(status);
+                resp_hdr->length  += (resp_index * sizeof(u32));
+                resp_hdr->num_args = resp_index;
+            }
+        }
+        break;
+
+
+        //---------------------------------------------------------------------
+        case CMDID_DEV_SCHED_EXEC_MONITOR: {
+            // Read / reset the histogram of the time between scheduler executions
+            //
+            // Write Message format:
+            //     cmd_args_32[0]      Command == CMD_PARAM_WRITE_VAL (resets the histogram)
+            // Response format:
+            //     resp_args_32[0]     Status
+            //
+            // Read Message format:
+            //     cmd_args_32[0]      Command == CMD_PARAM_READ_VAL
+            // Response format:
+            //     resp_args_32[0]     Status
+            //     resp_args_32[1]     Number of bins (0 if the monitor is not compiled in)
+            //     resp_args_32[2:]    Bin N counts the times between executions in [2^N, 2^(N+1)) usec
+            //
+            u32 i;
+            u32 num_bins;
+            u32 hist[SCHEDULE_EXEC_MONITOR_NUM_BINS];
+            u32 status = CMD_PARAM_SUCCESS;
+            u32 msg_cmd = Xil_Ntohl(cmd_args_32[0]);
+            u32 use_default_resp = WLAN_EXP_TRUE;
+
+            switch (msg_cmd) {
+                case CMD_PARAM_WRITE_VAL:
+                    wlan_mac_schedule_reset_exec_monitor();
+                break;
+
+                case CMD_PARAM_READ_VAL:
+                    use_default_resp = WLAN_EXP_FALSE;
+
+                    num_bins = wlan_mac_schedule_get_exec_monitor_hist(hist, SCHEDULE_EXEC_MONITOR_NUM_BINS);
+
+                    resp_args_32[resp_index++] = Xil_Htonl(status);
+                    resp_args_32[resp_index++] = Xil_Htonl(num_bins);
+
+                    for (i = 0; i < num_bins; i++) {
+                        resp_args_32[resp_index++] = Xil_Htonl(hist[i]);
+                    }
+
+                    resp_hdr->length  += (resp_index * sizeof(u32));
+                    resp_hdr->num_args = resp_index;
+                break;
+
+                default:
+                    wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_node, "Unknown command for 0x%6x: %d\n", cmd_id, msg_cmd);
+                    status = CMD_PARAM_ERROR;
+                break;
+            }
+
+            if (use_default_resp) {
+                // Send default response
+                resp_args_32[resp_index++] = Xil_Htonl(status);
+                resp_hdr->length  += (resp_index * sizeof(u32));
+                resp_hdr->num_args = resp_index;
+            }
+        }
+        break;
+
+
 //-----------------------------------------------------------------------------
 // Child Commands
 //-----------------------------------------------------------------------------
@@ -3081,6 +3816,158 @@ u32 process_buffer_cmds(int socket_index, void* from, cmd_resp* command, cmd_res
 }
 
 
+/*****************************************************************************/
+/**
+ * Process the station info delta command
+ *
+ * Returns a WLAN Exp Buffer with the stations that changed since the generation
+ * in the command.  Entries are packed back-to-back so that each packet carries as
+ * many entries as fit in max_resp_len.
+ *
+ * @param   socket_index     -- Index of socket to send data
+ * @param   from             -- Socket address structure of host from which command was received
+ * @param   response         -- Response
+ * @param   cmd_args_32      -- Command arguments
+ * @param   resp_hdr         -- Response header
+ * @param   resp_args_32     -- Response arguments
+ * @param   max_resp_len     -- Maximum number of u32 words allowed in response
+ *
+ * @return  RESP_SENT
+ *
+ * @note    The generation is advanced before the stations are walked, so a station that
+ *     changes during the transfer is also returned by the next query.  The number of
+ *     entries is counted up front; if a counted station is removed before it is copied,
+ *     its entry is zeroed (generation 0).
+ *
+ * @note    Removed stations cannot be listed, so if any station was removed since the
+ *     generation in the command (including during the previous transfer) all stations
+ *     are returned and the response is flagged CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL.
+ *     The same happens if the generation in the command is newer than the current one.
+ *
+ *****************************************************************************/
+u32 process_station_delta_cmd(int socket_index, void* from, cmd_resp* response,
+                              u32* cmd_args_32, cmd_resp_hdr* resp_hdr, u32* resp_args_32, u32 max_resp_len) {
+
+    u32 resp_index = 5; // There will always be 5 return args for a buffer
+
+    u32 j;
+    u32 since;
+    u32 until;
+    u32 flags;
+    u32 pool_index;
+
+    u32 size;
+    u32 transfer_size;
+    u32 curr_index;
+    u32 bytes_remaining;
+
+    u32 total_entries;
+    u32 entries_sent;
+    u32 entry_per_pkt;
+    u32 transfer_entry_num;
+
+    u8* curr_dest;
+    station_info_t* curr_station_info;
+    wlan_exp_station_delta_hdr_t* delta_hdr;
+    wlan_exp_station_delta_t* delta;
+
+    since = Xil_Ntohl(cmd_args_32[2]);
+    until = station_info_advance_generation();
+    flags = 0;
+
+    // A removal newer than the host's generation may have been followed by an add,
+    // which the station count alone would hide; send every station instead.  A generation
+    // from the future (e.g. from before a node reset) is just as unusable.
+    if ((since == 0) || (since > until) || (station_info_get_removal_generation() > since)) {
+        since = 0;
+        flags = CMD_PARAM_STATION_INFO_DELTA_FLAG_FULL;
+    }
+
+    // Count the changed stations
+    //     NOTE:  Stations that change from here on are newer than until, so the count can only shrink
+    total_entries = 0;
+    pool_index    = 0;
+
+    while (station_info_find_changed(&pool_index, since, until) != NULL) {
+        total_entries++;
+    }
+
+    size = sizeof(wlan_exp_station_delta_hdr_t) + (total_entries * sizeof(wlan_exp_station_delta_t));
+
+    wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node, "Getting %d changed station info entries (%d bytes)\n", total_entries, size);
+
+    // Set response header arguments that do not change per packet
+    resp_args_32[0]    = cmd_args_32[0];
+    resp_args_32[1]    = cmd_args_32[1];
+    resp_hdr->num_args = resp_index;
+
+    entries_sent    = 0;
+    bytes_remaining = size;
+    curr_index      = 0;
+    pool_index      = 0;
+
+    // Iterate through all the packets
+    while (bytes_remaining > 0) {
+        curr_dest     = (u8*) &resp_args_32[resp_index];
+        transfer_size = 0;
+
+        // The first packet starts with the delta header
+        if (curr_index == 0) {
+            delta_hdr = (wlan_exp_station_delta_hdr_t*) curr_dest;
+
+            delta_hdr->generation   = until;
+            delta_hdr->num_stations = station_info_get_list()->length;
+            delta_hdr->num_entries  = total_entries;
+            delta_hdr->flags        = flags;
+
+            transfer_size += sizeof(wlan_exp_station_delta_hdr_t);
+        }
+
+        // Fill the rest of the packet with entries
+        entry_per_pkt      = ((max_resp_len * 4) - transfer_size) / sizeof(wlan_exp_station_delta_t);
+        transfer_entry_num = min(entry_per_pkt, (total_entries - entries_sent));
+
+        for (j = 0; j < transfer_entry_num; j++) {
+            delta             = (wlan_exp_station_delta_t*)(curr_dest + transfer_size);
+            curr_station_info = station_info_find_changed(&pool_index, since, until);
+
+            if (curr_station_info != NULL) {
+                delta->generation = curr_station_info->generation;
+                delta->reserved   = 0;
+
+                copy_counts_txrx_to_dest(curr_station_info, &(delta->counts), curr_station_info->addr);
+                copy_station_info_to_dest(curr_station_info, &(delta->info), curr_station_info->addr);
+            } else {
+                // The station was removed after it was counted
+                bzero(delta, sizeof(wlan_exp_station_delta_t));
+            }
+
+            transfer_size += sizeof(wlan_exp_station_delta_t);
+        }
+
+        entries_sent += transfer_entry_num;
+
+        // Set response args that change per packet
+        resp_args_32[2] = Xil_Htonl(bytes_remaining);
+        resp_args_32[3] = Xil_Htonl(curr_index);
+        resp_args_32[4] = Xil_Htonl(transfer_size);
+
+        // Set the response header fields that change per packet
+        resp_hdr->length = (resp_index * sizeof(u32)) + transfer_size;
+
+        // Send the packet
+        send_early_resp(socket_index, from, response->header, response->buffer);
+
+        // Update our current address and bytes remaining
+        curr_index      += transfer_size;
+        bytes_remaining -= transfer_size;
+    }
+
+    return RESP_SENT;
+}
+
+
+
 #if WLAN_SW_CONFIG_ENABLE_LOGGING
 /*****************************************************************************/
 /**
@@ -3152,21 +4039,11 @@ void transfer_log_data(u32 socket_index, void* from,
     wlan_exp_ip_udp_buffer header_buffer;
     wlan_exp_ip_udp_buffer data_buffer;
     wlan_exp_ip_udp_buffer* resp_array[2];
-    u8 tmp_header[100]; // NOTE:  Size must be larger than entire header.
+    u8 tmp_header[WLAN_EXP_ETH_BUFFER_SIZE];
 
-    wlan_exp_ip_udp_header* tx_eth_ip_udp_header;
-    transport_header* tx_transport_header;
-    cmd_resp_hdr* tx_resp_header;
-    u32* tx_resp_args;
-
-    u32 header_length;
-    u16 ip_length;
-    u16 udp_length;
     u32 transfer_length;
-    u16 data_length;
     u32 total_hdr_length;
 
-    u8 dest_hw_addr[MAC_ADDR_LEN];
     u32 dest_ip_addr;
     u16 dest_port;
 
@@ -3191,24 +4068,137 @@ void transfer_log_data(u32 socket_index, void* from,
     resp_array[0] = (wlan_exp_ip_udp_buffer *)&header_buffer;    // Contains all header information
     resp_array[1] = (wlan_exp_ip_udp_buffer *)&data_buffer;      // Contains log entry data
 
-    // Set up temporary pointers to the header data
-    //     NOTE:  The memory space for the temporary header must be large enough for the entire header.
-    //
-    tx_eth_ip_udp_header = (wlan_exp_ip_udp_header *)(&tmp_header[0]);
-    tx_transport_header = (transport_header   *)(&tmp_header[sizeof(wlan_exp_ip_udp_header)]);
-    tx_resp_header = (cmd_resp_hdr       *)(&tmp_header[sizeof(wlan_exp_ip_udp_header) + sizeof(transport_header)]);
-    tx_resp_args = (u32                *)(&tmp_header[sizeof(wlan_exp_ip_udp_header) + sizeof(transport_header) + sizeof(cmd_resp_hdr)]);
-
-    // Set up temporary variables with the length values of the header
-    ip_length = WLAN_EXP_IP_UDP_DELIM_LEN + UDP_HEADER_LEN + IP_HEADER_LEN_BYTES;
-    udp_length = WLAN_EXP_IP_UDP_DELIM_LEN + UDP_HEADER_LEN;
-    header_length = sizeof(transport_header) + sizeof(cmd_resp_hdr) + WLAN_EXP_BUFFER_HEADER_SIZE;
-    total_hdr_length = sizeof(wlan_exp_ip_udp_header) + header_length;
-
     // Get values out of the socket address structure
     dest_ip_addr = ((struct sockaddr_in*)from)->sin_addr.s_addr;    // NOTE:  Value big endian
     dest_port = ((struct sockaddr_in*)from)->sin_port;
 
+    // Pre-process the parts of the header that are the same for every packet
+    total_hdr_length = log_data_header_init(tmp_header, socket_index, resp_buffer_data, eth_dev_num,
+                                            dest_ip_addr, dest_port, id, flags);
+
+    // Initialize header buffer size/length (see above for description)
+    header_buffer.length = total_hdr_length;
+    header_buffer.size = total_hdr_length;
+
+    // Set address for the Ethernet header in DMA accessible memory
+    header_base_addr = ETH_header_buffer;             // Use the buffer allocated above
+    header_offset = 0;
+    header_buffer_size = WLAN_EXP_ETH_BUFFER_SIZE * WLAN_EXP_ETH_NUM_BUFFER;
+
+
+#ifdef _DEBUG_
+    xil_printf("EVENT LOG: Get Log Data \n");
+    xil_printf("    start_index      = 0x%8x\n", start_index);
+    xil_printf("    size             = %10d\n",  size);
+    xil_printf("    num_pkts         = %10d\n",  num_pkts);
+#endif
+
+
+    // Iterate through all the packets
+    for (i = 0; i < num_pkts; i++) {
+
+        // Get the next address
+        header_addr = (u8 *)(((u32)header_base_addr) + header_offset);
+        next_index  = curr_index + bytes_per_pkt;
+
+        // Compute the transfer size (use the full buffer unless you run out of space)
+        if (next_index > end_index) {
+            transfer_length = end_index - curr_index;
+        } else {
+            transfer_length = bytes_per_pkt;
+        }
+
+        // Transfer data
+        //     NOTE:  This selects the "do not copy data" option and instead provides
+        //         a wlan_exp IP/UDP buffer to transfer the data.
+        //
+        num_bytes = event_log_get_data(curr_index, transfer_length, &data_buffer, 0);
+
+        // Check that we copied everything
+        if (num_bytes == transfer_length) {
+
+            // Update the per packet header fields and copy the completed header to DMA accessible memory
+            log_data_header_update(tmp_header, header_addr, dest_ip_addr, bytes_remaining, curr_index, &data_buffer);
+
+            // Set the header buffer data / offset
+            header_buffer.data   = (u8 *)header_addr;
+            header_buffer.offset = (u8 *)header_addr;
+
+            // Check the interrupt status; Disable interrupts if enabled
+            //     NOTE:  This is done inside the Eth send function
+            // prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+            // Send the Ethernet packet
+            //   NOTE:  In an effort to reduce overhead (ie improve performance), the "raw"
+            //       socket_sendto method is used which transmits the provided buffers "as is"
+            //       (ie there are no header updates or other modifications to the buffer data).
+            //       Also, we have consolidated all the headers into a single buffer so that a
+            //       Ethernet packet only requires two Transmit Buffer Descriptors (TX BDs).
+            //
+            status = socket_sendto_raw(socket_index, resp_array, 0x2);
+
+            // Restore interrupts
+            //     NOTE:  This is done inside the Eth send function
+            // wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+            // Check that the packet was sent correctly
+            if (status == WLAN_EXP_IP_UDP_FAILURE) {
+                wlan_exp_printf(WLAN_EXP_PRINT_WARNING, print_type_event_log,
+                            "Issue sending log entry packet to host.\n");
+            }
+        } else {
+            wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
+                            "Tried to get %d bytes, but only received %d @ 0x%x \n", transfer_length, num_bytes, curr_index );
+        }
+
+        // Update our current address and bytes remaining
+        curr_index       = next_index;
+        bytes_remaining -= transfer_length;
+        header_offset    = (header_offset + WLAN_EXP_ETH_BUFFER_SIZE) % header_buffer_size;
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Initialize Log Data Header
+ *
+ * Pulls the socket header and the response headers into local memory and fills
+ * in every field that is the same for all packets of a log data transfer.  See
+ * transfer_log_data() for the layout of the header.
+ *
+ * @param   header           -- Local header memory (at least WLAN_EXP_ETH_BUFFER_SIZE bytes)
+ * @param   socket_index     -- Index of socket to send data
+ * @param   resp_buffer_data -- Address of the response data buffer (ie address of response transport header)
+ * @param   eth_dev_num      -- Ethernet device number to send data
+ * @param   dest_ip_addr     -- Destination IP address (big endian)
+ * @param   dest_port        -- Destination UDP port (big endian)
+ * @param   id               -- Buffer ID for transfer
+ * @param   flags            -- Buffer flags for transfer
+ *
+ * @return  u32              -- Total length of the header in bytes
+ *
+ *****************************************************************************/
+u32 log_data_header_init(u8* header, u32 socket_index, void* resp_buffer_data, u32 eth_dev_num,
+                         u32 dest_ip_addr, u16 dest_port, u32 id, u32 flags) {
+
+    wlan_exp_ip_udp_header* tx_eth_ip_udp_header;
+    transport_header* tx_transport_header;
+    cmd_resp_hdr* tx_resp_header;
+    u32* tx_resp_args;
+
+    u32 header_length;
+    u8 dest_hw_addr[MAC_ADDR_LEN];
+
+    // Set up temporary pointers to the header data
+    tx_eth_ip_udp_header = (wlan_exp_ip_udp_header *)(&header[0]);
+    tx_transport_header = (transport_header   *)(&header[sizeof(wlan_exp_ip_udp_header)]);
+    tx_resp_header = (cmd_resp_hdr       *)(&header[sizeof(wlan_exp_ip_udp_header) + sizeof(transport_header)]);
+    tx_resp_args = (u32                *)(&header[sizeof(wlan_exp_ip_udp_header) + sizeof(transport_header) + sizeof(cmd_resp_hdr)]);
+
+    header_length = sizeof(transport_header) + sizeof(cmd_resp_hdr) + WLAN_EXP_BUFFER_HEADER_SIZE;
+
     // Get hardware address of the destination
     arp_get_hw_addr(eth_dev_num, dest_hw_addr, (u8 *)(&dest_ip_addr));
 
@@ -3219,10 +4209,6 @@ void transfer_log_data(u32 socket_index, void* from,
     memcpy((void *)tx_eth_ip_udp_header, (void *)socket_get_wlan_exp_ip_udp_header(socket_index), sizeof(wlan_exp_ip_udp_header));
     memcpy((void *)tx_transport_header, resp_buffer_data, header_length);
 
-    // Initialize header buffer size/length (see above for description)
-    header_buffer.length = total_hdr_length;
-    header_buffer.size = total_hdr_length;
-
     //
     // NOTE:  In order to make large transfers more efficient, most of the response packet can be
     //   pre-processed such that the wlan_exp IP/UDP library has to do only the minimal amount of
@@ -3260,114 +4246,549 @@ void transfer_log_data(u32 socket_index, void* from,
     tx_eth_ip_udp_header->udp_hdr.dest_port = dest_port;
     tx_eth_ip_udp_header->udp_hdr.checksum = UDP_NO_CHECKSUM;
 
-    // Set address for the Ethernet header in DMA accessible memory
-    header_base_addr = ETH_header_buffer;             // Use the buffer allocated above
-    header_offset = 0;
-    header_buffer_size = WLAN_EXP_ETH_BUFFER_SIZE * WLAN_EXP_ETH_NUM_BUFFER;
+    return (sizeof(wlan_exp_ip_udp_header) + header_length);
+}
 
 
-#ifdef _DEBUG_
-    xil_printf("EVENT LOG: Get Log Data \n");
-    xil_printf("    start_index      = 0x%8x\n", start_index);
-    xil_printf("    size             = %10d\n",  size);
-    xil_printf("    num_pkts         = %10d\n",  num_pkts);
-#endif
 
+/*****************************************************************************/
+/**
+ * Update Log Data Header
+ *
+ * Fills in the fields of a header from log_data_header_init() that change per
+ * packet and copies the completed header to DMA accessible memory.
+ *
+ * @param   header           -- Local header memory initialized by log_data_header_init()
+ * @param   header_addr      -- DMA accessible address for the completed header
+ * @param   dest_ip_addr     -- Destination IP address (big endian)
+ * @param   bytes_remaining  -- Number of bytes remaining in the transfer (including this packet)
+ * @param   curr_index       -- Log index of the first byte in this packet
+ * @param   data_buffer      -- Buffer with the log data for this packet (from event_log_get_data())
+ *
+ * @return  None
+ *
+ *****************************************************************************/
+void log_data_header_update(u8* header, u8* header_addr, u32 dest_ip_addr,
+                            u32 bytes_remaining, u32 curr_index, wlan_exp_ip_udp_buffer* data_buffer) {
 
-    // Iterate through all the packets
-    for (i = 0; i < num_pkts; i++) {
+    wlan_exp_ip_udp_header* tx_eth_ip_udp_header;
+    transport_header* tx_transport_header;
+    cmd_resp_hdr* tx_resp_header;
+    u32* tx_resp_args;
 
-        // Get the next address
-        header_addr = (u8 *)(((u32)header_base_addr) + header_offset);
-        next_index  = curr_index + bytes_per_pkt;
+    u32 header_length;
+    u16 ip_length;
+    u16 udp_length;
+    u16 data_length;
+    u32 transfer_length = data_buffer->size;
 
-        // Compute the transfer size (use the full buffer unless you run out of space)
-        if (next_index > end_index) {
-            transfer_length = end_index - curr_index;
+    // Set up temporary pointers to the header data
+    tx_eth_ip_udp_header = (wlan_exp_ip_udp_header *)(&header[0]);
+    tx_transport_header = (transport_header   *)(&header[sizeof(wlan_exp_ip_udp_header)]);
+    tx_resp_header = (cmd_resp_hdr       *)(&header[sizeof(wlan_exp_ip_udp_header) + sizeof(transport_header)]);
+    tx_resp_args = (u32                *)(&header[sizeof(wlan_exp_ip_udp_header) + sizeof(transport_header) + sizeof(cmd_resp_hdr)]);
+
+    // Set up temporary variables with the length values of the header
+    ip_length = WLAN_EXP_IP_UDP_DELIM_LEN + UDP_HEADER_LEN + IP_HEADER_LEN_BYTES;
+    udp_length = WLAN_EXP_IP_UDP_DELIM_LEN + UDP_HEADER_LEN;
+    header_length = sizeof(transport_header) + sizeof(cmd_resp_hdr) + WLAN_EXP_BUFFER_HEADER_SIZE;
+
+    data_length = transfer_length + header_length;
+
+    // Set response args that change per packet
+    tx_resp_args[2] = Xil_Htonl(bytes_remaining);
+    tx_resp_args[3] = Xil_Htonl(curr_index);
+    tx_resp_args[4] = Xil_Htonl(transfer_length);
+
+    // Set the response header fields that change per packet
+    tx_resp_header->length = Xil_Ntohs(transfer_length + WLAN_EXP_BUFFER_HEADER_SIZE);
+
+    // Populate transport header fields with per packet data
+    tx_transport_header->length = Xil_Htons(data_length + WLAN_EXP_IP_UDP_DELIM_LEN);
+
+    // Update the UDP header
+    //     NOTE:  Requires dest_port to be big-endian; udp_length to be little-endian
+    //     NOTE:  Adapted from the function:
+    //                udp_update_header(&(eth_ip_udp_header->udp_hdr), dest_port, (udp_length + data_length));
+    //
+    tx_eth_ip_udp_header->udp_hdr.length = Xil_Htons(udp_length + data_length);
+
+    // Update the IPv4 header
+    //     NOTE:  Requires dest_ip_addr to be big-endian; ip_length to be little-endian
+    //     NOTE:  We did not break this function apart like the other header updates b/c the IP ID counter is
+    //            maintained in the library and we did not want to violate that.
+    //
+    ipv4_update_header(&(tx_eth_ip_udp_header->ip_hdr), dest_ip_addr, (ip_length + data_length), IP_PROTOCOL_UDP);
+
+    // Update the UDP checksum over the header and the log data
+    //     NOTE:  This only reads the log data if WLAN_EXP_IP_UDP_TX_UDP_CHECKSUM is enabled
+    //
+    udp_update_checksum(tx_eth_ip_udp_header, header_length, &data_buffer, 1);
+
+    // Copy the completed header to DMA accessible memory
+    memcpy((void *)header_addr, (void *)header, (sizeof(wlan_exp_ip_udp_header) + header_length));
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Start Log Streaming
+ *
+ * Starts pushing event log data to the host from node_log_stream_poll(),
+ * beginning with the oldest entry in the log.  Every packet uses the same buffer
+ * format as CMDID_LOG_GET_ENTRIES with bytes_remaining set to the number of
+ * bytes that were ready to stream when the packet was sent.
+ *
+ * @param   socket_index     -- Index of socket to send data
+ * @param   from             -- Socket address structure of host from which command was received
+ * @param   resp_buffer_data -- Address of the response data buffer (ie address of response transport header)
+ * @param   max_resp_len     -- Maximum number of u32 words allowed in response
+ * @param   id               -- Buffer ID for the stream
+ * @param   flags            -- Buffer flags for the stream
+ * @param   dest_port        -- Destination UDP port (0 = port the command was sent from)
+ *
+ * @return  int              -- Status of the command:
+ *                                 XST_SUCCESS - Command completed successfully
+ *                                 XST_FAILURE - There was an error in the command
+ *
+ * @note    Streaming lets the host drain the log as it is written, so the log is
+ *     set to wrap rather than fill and stop logging.  The previous wrap setting is
+ *     restored by node_log_stream_stop().
+ *
+ *****************************************************************************/
+int node_log_stream_start(int socket_index, void* from, void* resp_buffer_data, u32 max_resp_len,
+                          u32 id, u32 flags, u16 dest_port) {
+
+    // The header ring must be deeper than the number of stream packets the Tx ring can hold
+    //   (see WLAN_EXP_LOG_STREAM_NUM_BUFFER)
+    if (eth_get_num_tx_descriptors() > ((2 * (WLAN_EXP_LOG_STREAM_NUM_BUFFER - 1)) + WLAN_EXP_LOG_STREAM_TXBD_PER_PKT)) {
+        wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
+                        "Log stream needs more than %d header buffers\n", WLAN_EXP_LOG_STREAM_NUM_BUFFER);
+        return XST_FAILURE;
+    }
+
+    // Restart an active stream with the new configuration
+    node_log_stream_stop();
+
+    log_stream.socket_index  = socket_index;
+    log_stream.eth_dev_num   = socket_get_eth_dev_num(socket_index);
+    log_stream.dest_ip_addr  = ((struct sockaddr_in*)from)->sin_addr.s_addr;    // NOTE:  Value big endian
+
+    if (dest_port == 0) {
+        dest_port = ((struct sockaddr_in*)from)->sin_port;                       // NOTE:  Value big endian
+    } else {
+        dest_port = Xil_Htons(dest_port);
+    }
+
+    log_stream.header_length = log_data_header_init(log_stream.header, socket_index, resp_buffer_data, log_stream.eth_dev_num,
+                                                    log_stream.dest_ip_addr, dest_port, id, flags);
+
+    log_stream.bytes_per_pkt      = ((max_resp_len) * 4) - WLAN_EXP_BUFFER_HEADER_SIZE;
+    log_stream.header_offset      = 0;
+    log_stream.partial_start_usec = 0;
+
+    log_stream.num_bytes          = 0;
+    log_stream.num_pkts           = 0;
+    log_stream.num_backpressure   = 0;
+    log_stream.num_overruns       = 0;
+
+    // Let the log wrap while streaming
+    if (event_log_get_flags() & CMD_PARAM_LOG_CONFIG_FLAG_WRAP) {
+        log_stream.prev_wrap_config = EVENT_LOG_WRAP_ENABLE;
+    } else {
+        log_stream.prev_wrap_config = EVENT_LOG_WRAP_DISABLE;
+    }
+
+    event_log_config_wrap(EVENT_LOG_WRAP_ENABLE);
+
+    event_log_cursor_init(&(log_stream.cursor));
+
+    log_stream.enable = 1;
+
+    return XST_SUCCESS;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Stop Log Streaming
+ *
+ * @param   None
+ *
+ * @return  None
+ *
+ * @note    Packets already handed to the Ethernet DMA will still be sent.
+ *
+ *****************************************************************************/
+void node_log_stream_stop() {
+
+    if (log_stream.enable) {
+        log_stream.enable = 0;
+
+        event_log_config_wrap(log_stream.prev_wrap_config);
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Poll Log Streaming
+ *
+ * Sends any event log data that has been written since the last poll.  A packet
+ * is only queued if the Ethernet Tx ring can take it without blocking; otherwise
+ * the remaining data waits for the next poll so that command processing is not
+ * held up behind the stream.
+ *
+ * @param   eth_dev_num      -- Ethernet device number being polled
+ *
+ * @return  None
+ *
+ * @note    Less than a full packet of data is held for WLAN_EXP_LOG_STREAM_FLUSH_USEC
+ *     so that full size packets are sent while the log is busy.
+ *
+ *****************************************************************************/
+void node_log_stream_poll(u32 eth_dev_num) {
+
+    u32 i;
+    int status;
+    int num_free_bds;
+
+    u32 size;
+    u32 overrun;
+    u32 transfer_length;
+    u32 num_bytes;
+    u64 curr_time;
+
+    wlan_exp_ip_udp_buffer header_buffer;
+    wlan_exp_ip_udp_buffer data_buffer;
+    wlan_exp_ip_udp_buffer* resp_array[2];
+    u8* header_addr;
+
+    if ((log_stream.enable == 0) || (log_stream.eth_dev_num != eth_dev_num)) { return; }
+
+    // Get the free space in the Tx ring once per poll
+    num_free_bds = eth_get_num_free_tx_descriptors(eth_dev_num);
+
+    resp_array[0] = (wlan_exp_ip_udp_buffer *)&header_buffer;
+    resp_array[1] = (wlan_exp_ip_udp_buffer *)&data_buffer;
+
+    header_buffer.length = log_stream.header_length;
+    header_buffer.size   = log_stream.header_length;
+
+    // Send at most one pass through the header ring per poll
+    for (i = 0; i < WLAN_EXP_LOG_STREAM_NUM_BUFFER; i++) {
+
+        size = event_log_cursor_get_size(&(log_stream.cursor), &overrun);
+
+        if (overrun) {
+            log_stream.num_overruns++;
+            wlan_exp_printf(WLAN_EXP_PRINT_WARNING, print_type_event_log,
+                            "Log stream overrun; resuming at oldest entry (index 0x%x)\n", log_stream.cursor.index);
+            size = event_log_cursor_get_size(&(log_stream.cursor), &overrun);
+        }
+
+        if (size == 0) {
+            log_stream.partial_start_usec = 0;
+            break;
+        }
+
+        if (size >= log_stream.bytes_per_pkt) {
+            transfer_length = log_stream.bytes_per_pkt;
         } else {
-            transfer_length = bytes_per_pkt;
+            curr_time = get_system_time_usec();
+
+            if (log_stream.partial_start_usec == 0) {
+                log_stream.partial_start_usec = curr_time;
+            }
+
+            if ((curr_time - log_stream.partial_start_usec) < WLAN_EXP_LOG_STREAM_FLUSH_USEC) { break; }
+
+            transfer_length = size;
         }
 
-        data_length = transfer_length + header_length;
+        // Backpressure from the Tx ring
+        if (num_free_bds < WLAN_EXP_LOG_STREAM_TXBD_PER_PKT) {
+            log_stream.num_backpressure++;
+            break;
+        }
 
-        // Set response args that change per packet
-        tx_resp_args[2] = Xil_Htonl(bytes_remaining);
-        tx_resp_args[3] = Xil_Htonl(curr_index);
-        tx_resp_args[4] = Xil_Htonl(transfer_length);
+        num_bytes = event_log_get_data(log_stream.cursor.index, transfer_length, &data_buffer, 0);
 
-        // Set the response header fields that change per packet
-        tx_resp_header->length = Xil_Ntohs(transfer_length + WLAN_EXP_BUFFER_HEADER_SIZE);
+        if (num_bytes != transfer_length) {
+            wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
+                            "Tried to get %d bytes, but only received %d @ 0x%x \n", transfer_length, num_bytes, log_stream.cursor.index);
+            break;
+        }
 
-        // Populate transport header fields with per packet data
-        tx_transport_header->length = Xil_Htons(data_length + WLAN_EXP_IP_UDP_DELIM_LEN);
+        header_addr = (u8 *)(((u32)ETH_log_stream_header_buffer) + log_stream.header_offset);
 
-        // Update the UDP header
-        //     NOTE:  Requires dest_port to be big-endian; udp_length to be little-endian
-        //     NOTE:  Adapted from the function:
-        //                udp_update_header(&(eth_ip_udp_header->udp_hdr), dest_port, (udp_length + data_length));
-        //
-        tx_eth_ip_udp_header->udp_hdr.length = Xil_Htons(udp_length + data_length);
+        log_data_header_update(log_stream.header, header_addr, log_stream.dest_ip_addr,
+                               size, log_stream.cursor.index, &data_buffer);
 
-        // Update the IPv4 header
-        //     NOTE:  Requires dest_ip_addr to be big-endian; ip_length to be little-endian
-        //     NOTE:  We did not break this function apart like the other header updates b/c the IP ID counter is
-        //            maintained in the library and we did not want to violate that.
-        //
-        ipv4_update_header(&(tx_eth_ip_udp_header->ip_hdr), dest_ip_addr, (ip_length + data_length), IP_PROTOCOL_UDP);
+        header_buffer.data   = header_addr;
+        header_buffer.offset = header_addr;
 
-        // Copy the completed header to DMA accessible BRAM
-        memcpy((void *)header_addr, (void *)tmp_header, total_hdr_length);
+        status = socket_sendto_raw(log_stream.socket_index, resp_array, 0x2);
 
-        // Set the header buffer data / offset
-        header_buffer.data   = (u8 *)header_addr;
-        header_buffer.offset = (u8 *)header_addr;
+        if (status == WLAN_EXP_IP_UDP_FAILURE) {
+            wlan_exp_printf(WLAN_EXP_PRINT_WARNING, print_type_event_log,
+                            "Issue sending log stream packet to host.\n");
+            break;
+        }
 
-        // Transfer data
-        //     NOTE:  This selects the "do not copy data" option and instead provides
-        //         a wlan_exp IP/UDP buffer to transfer the data.
-        //
-        num_bytes = event_log_get_data(curr_index, transfer_length, &data_buffer, 0);
+        // Update the stream state
+        log_stream.cursor.index      += transfer_length;
+        log_stream.header_offset      = (log_stream.header_offset + WLAN_EXP_ETH_BUFFER_SIZE) % (WLAN_EXP_ETH_BUFFER_SIZE * WLAN_EXP_LOG_STREAM_NUM_BUFFER);
+        log_stream.partial_start_usec = 0;
+        log_stream.num_bytes         += transfer_length;
+        log_stream.num_pkts          += 1;
+
+        num_free_bds                 -= WLAN_EXP_LOG_STREAM_TXBD_PER_PKT;
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Start Deferred Log Transfer
+ *
+ * Deferred version of transfer_log_data().  The packets are the same, but they
+ * are sent by node_log_transfer_step() from the transport poll.
+ *
+ * @param   socket_index     -- Index of socket to send data
+ * @param   from             -- Socket address structure of host from which command was received
+ * @param   resp_buffer_data -- Address of the response data buffer (ie address of response transport header)
+ * @param   max_resp_len     -- Maximum number of u32 words allowed in response
+ * @param   id               -- Buffer ID for transfer
+ * @param   flags            -- Buffer flags for transfer
+ * @param   start_index      -- Start index of the transfer
+ * @param   size             -- Size (in bytes) of the transfer
+ * @param   job_id           -- Set to the job ID of the transfer
+ *
+ * @return  int              -- Status of the command:
+ *                                 XST_SUCCESS - Command completed successfully
+ *                                 XST_FAILURE - There was an error in the command
+ *
+ *****************************************************************************/
+int node_log_transfer_start(int socket_index, void* from, void* resp_buffer_data, u32 max_resp_len,
+                            u32 id, u32 flags, u32 start_index, u32 size, u32* job_id) {
+
+    u32 eth_dev_num = socket_get_eth_dev_num(socket_index);
+
+    // The header ring must be deeper than the number of packets the Tx ring can hold
+    //   (see WLAN_EXP_LOG_STREAM_NUM_BUFFER)
+    if (eth_get_num_tx_descriptors() > ((2 * (WLAN_EXP_CMD_JOB_NUM_BUFFER - 1)) + WLAN_EXP_LOG_STREAM_TXBD_PER_PKT)) {
+        wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
+                        "Deferred log transfer needs more than %d header buffers\n", WLAN_EXP_CMD_JOB_NUM_BUFFER);
+        return XST_FAILURE;
+    }
+
+    if (node_cmd_job_start(socket_index, CMDID_LOG_GET_ENTRIES, (function_ptr_t)node_log_transfer_step, 0, job_id) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    log_transfer_job.socket_index  = socket_index;
+    log_transfer_job.dest_ip_addr  = ((struct sockaddr_in*)from)->sin_addr.s_addr;    // NOTE:  Value big endian
+
+    log_transfer_job.header_length = log_data_header_init(log_transfer_job.header, socket_index, resp_buffer_data, eth_dev_num,
+                                                          log_transfer_job.dest_ip_addr, ((struct sockaddr_in*)from)->sin_port, id, flags);
+
+    log_transfer_job.curr_index    = start_index;
+    log_transfer_job.end_index     = start_index + size;
+    log_transfer_job.bytes_per_pkt = ((max_resp_len) * 4) - WLAN_EXP_BUFFER_HEADER_SIZE;
+    log_transfer_job.header_offset = 0;
+    log_transfer_job.status        = CMD_PARAM_SUCCESS;
+
+    node_cmd_job.work_total        = size;
+
+    return XST_SUCCESS;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Deferred Log Transfer Step
+ *
+ * Sends the next packets of a deferred log transfer.  Like node_log_stream_poll(),
+ * a packet is only queued if the Ethernet Tx ring can take it without blocking.
+ *
+ * @param   arg              -- Unused
+ * @param   status           -- Set to the status of the transfer when it is done
+ *
+ * @return  int              -- CMD_PARAM_NODE_CMD_JOB_RUNNING or CMD_PARAM_NODE_CMD_JOB_DONE
+ *
+ *****************************************************************************/
+int node_log_transfer_step(u32 arg, u32* status) {
+
+    u32 i;
+    int send_status;
+    int num_free_bds;
+
+    u32 bytes_remaining;
+    u32 transfer_length;
+    u32 num_bytes;
+
+    wlan_exp_ip_udp_buffer header_buffer;
+    wlan_exp_ip_udp_buffer data_buffer;
+    wlan_exp_ip_udp_buffer* resp_array[2];
+    u8* header_addr;
+
+    // Get the free space in the Tx ring once per step
+    num_free_bds = eth_get_num_free_tx_descriptors(node_cmd_job.eth_dev_num);
+
+    resp_array[0] = (wlan_exp_ip_udp_buffer *)&header_buffer;
+    resp_array[1] = (wlan_exp_ip_udp_buffer *)&data_buffer;
+
+    header_buffer.length = log_transfer_job.header_length;
+    header_buffer.size   = log_transfer_job.header_length;
+
+    for (i = 0; i < WLAN_EXP_CMD_JOB_MAX_PKTS_PER_POLL; i++) {
+
+        if (log_transfer_job.curr_index >= log_transfer_job.end_index) { break; }
+
+        // Backpressure from the Tx ring
+        if (num_free_bds < WLAN_EXP_LOG_STREAM_TXBD_PER_PKT) { break; }
+
+        bytes_remaining = log_transfer_job.end_index - log_transfer_job.curr_index;
+        transfer_length = min(log_transfer_job.bytes_per_pkt, bytes_remaining);
+
+        num_bytes = event_log_get_data(log_transfer_job.curr_index, transfer_length, &data_buffer, 0);
 
-        // Check that we copied everything
         if (num_bytes == transfer_length) {
+            header_addr = (u8 *)(((u32)ETH_cmd_job_header_buffer) + log_transfer_job.header_offset);
 
-            // Check the interrupt status; Disable interrupts if enabled
-            //     NOTE:  This is done inside the Eth send function
-            // prev_interrupt_state = wlan_mac_high_interrupt_stop();
+            log_data_header_update(log_transfer_job.header, header_addr, log_transfer_job.dest_ip_addr,
+                                   bytes_remaining, log_transfer_job.curr_index, &data_buffer);
 
-            // Send the Ethernet packet
-            //   NOTE:  In an effort to reduce overhead (ie improve performance), the "raw"
-            //       socket_sendto method is used which transmits the provided buffers "as is"
-            //       (ie there are no header updates or other modifications to the buffer data).
-            //       Also, we have consolidated all the headers into a single buffer so that a
-            //       Ethernet packet only requires two Transmit Buffer Descriptors (TX BDs).
-            //
-            status = socket_sendto_raw(socket_index, resp_array, 0x2);
+            header_buffer.data   = header_addr;
+            header_buffer.offset = header_addr;
 
-            // Restore interrupts
-            //     NOTE:  This is done inside the Eth send function
-            // wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+            send_status = socket_sendto_raw(log_transfer_job.socket_index, resp_array, 0x2);
 
-            // Check that the packet was sent correctly
-            if (status == WLAN_EXP_IP_UDP_FAILURE) {
+            if (send_status == WLAN_EXP_IP_UDP_FAILURE) {
                 wlan_exp_printf(WLAN_EXP_PRINT_WARNING, print_type_event_log,
-                            "Issue sending log entry packet to host.\n");
+                                "Issue sending log entry packet to host.\n");
+                log_transfer_job.status = CMD_PARAM_ERROR;
             }
+
+            log_transfer_job.header_offset = (log_transfer_job.header_offset + WLAN_EXP_ETH_BUFFER_SIZE) % (WLAN_EXP_ETH_BUFFER_SIZE * WLAN_EXP_CMD_JOB_NUM_BUFFER);
+            num_free_bds                  -= WLAN_EXP_LOG_STREAM_TXBD_PER_PKT;
         } else {
             wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_event_log,
-                            "Tried to get %d bytes, but only received %d @ 0x%x \n", transfer_length, num_bytes, curr_index );
+                            "Tried to get %d bytes, but only received %d @ 0x%x \n", transfer_length, num_bytes, log_transfer_job.curr_index);
+            log_transfer_job.status = CMD_PARAM_ERROR;
         }
 
-        // Update our current address and bytes remaining
-        curr_index       = next_index;
-        bytes_remaining -= transfer_length;
-        header_offset    = (header_offset + WLAN_EXP_ETH_BUFFER_SIZE) % header_buffer_size;
+        // Skip the packet on an error, the same as transfer_log_data()
+        log_transfer_job.curr_index += transfer_length;
+        node_cmd_job.work_done      += transfer_length;
     }
+
+    if (log_transfer_job.curr_index >= log_transfer_job.end_index) {
+        *status = log_transfer_job.status;
+        return CMD_PARAM_NODE_CMD_JOB_DONE;
+    }
+
+    return CMD_PARAM_NODE_CMD_JOB_RUNNING;
 }
 #endif //WLAN_SW_CONFIG_ENABLE_LOGGING
 
 
 
+/*****************************************************************************/
+/**
+ * Start Deferred Command
+ *
+ * Records a job that node_cmd_job_poll() runs one step at a time from the
+ * transport poll.  A command that was sent with TRANSPORT_HDR_DEFER_FLAG uses
+ * this to acknowledge the host right away with the job ID; the host then polls
+ * CMDID_NODE_CMD_STATUS until the job is done.
+ *
+ * @param   socket_index     -- Index of socket the command was received on
+ * @param   cmd_id           -- Command ID that is deferred
+ * @param   step             -- int step(u32 arg, u32* status) that does the next part of the
+ *                              command and returns CMD_PARAM_NODE_CMD_JOB_RUNNING or
+ *                              CMD_PARAM_NODE_CMD_JOB_DONE (with the command status in *status)
+ * @param   arg              -- Argument for step
+ * @param   job_id           -- Set to the job ID
+ *
+ * @return  int              -- Status of the command:
+ *                                 XST_SUCCESS - Command completed successfully
+ *                                 XST_FAILURE - Another job is still running
+ *
+ * @note    The step function runs in the main context, the same as command processing.
+ *
+ *****************************************************************************/
+int node_cmd_job_start(int socket_index, u32 cmd_id, function_ptr_t step, u32 arg, u32* job_id) {
+
+    if (node_cmd_job.state == CMD_PARAM_NODE_CMD_JOB_RUNNING) {
+        wlan_exp_printf(WLAN_EXP_PRINT_WARNING, print_type_node,
+                        "Cannot defer command 0x%06x; job %d (command 0x%06x) is running\n", cmd_id, node_cmd_job.id, node_cmd_job.cmd_id);
+        return XST_FAILURE;
+    }
+
+    // Job ID 0 means no job has been started
+    node_cmd_job.id++;
+
+    if (node_cmd_job.id == 0) { node_cmd_job.id = 1; }
+
+    node_cmd_job.cmd_id      = cmd_id;
+    node_cmd_job.status      = CMD_PARAM_SUCCESS;
+    node_cmd_job.eth_dev_num = socket_get_eth_dev_num(socket_index);
+    node_cmd_job.num_steps   = 0;
+    node_cmd_job.work_done   = 0;
+    node_cmd_job.work_total  = 0;
+    node_cmd_job.start_usec  = get_system_time_usec();
+    node_cmd_job.end_usec    = 0;
+    node_cmd_job.step        = step;
+    node_cmd_job.arg         = arg;
+    node_cmd_job.state       = CMD_PARAM_NODE_CMD_JOB_RUNNING;
+
+    *job_id = node_cmd_job.id;
+
+    return XST_SUCCESS;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Poll Deferred Command
+ *
+ * Runs one step of the deferred command, if there is one.
+ *
+ * @param   eth_dev_num      -- Ethernet device number being polled
+ *
+ * @return  None
+ *
+ *****************************************************************************/
+void node_cmd_job_poll(u32 eth_dev_num) {
+
+    u32 status;
+
+    if ((node_cmd_job.state != CMD_PARAM_NODE_CMD_JOB_RUNNING) || (node_cmd_job.eth_dev_num != eth_dev_num)) { return; }
+
+    status = CMD_PARAM_SUCCESS;
+
+    node_cmd_job.num_steps++;
+
+    if (node_cmd_job.step(node_cmd_job.arg, &status) == CMD_PARAM_NODE_CMD_JOB_DONE) {
+        node_cmd_job.status   = status;
+        node_cmd_job.end_usec = get_system_time_usec();
+        node_cmd_job.state    = CMD_PARAM_NODE_CMD_JOB_DONE;
+
+        wlan_exp_printf(WLAN_EXP_PRINT_INFO, print_type_node,
+                        "Deferred command 0x%06x done (job %d, status 0x%08x)\n", node_cmd_job.cmd_id, node_cmd_job.id, status);
+    }
+}
+
+
+
 /*****************************************************************************/
 /**
  * Helper functions for node_process_buffer_cmds
@@ -3695,7 +5116,9 @@ u32  node_get_serial_number ( void ) { return node_info.serial_number; }
  *
  *****************************************************************************/
 void ltg_cleanup(u32 id, void* callback_arg){
-    wlan_mac_high_free(callback_arg);
+#if WLAN_SW_CONFIG_ENABLE_LTG
+    ltg_payload_free(callback_arg);
+#endif
 }
 
 
@@ -130,6 +130,9 @@ int transport_init(u32 eth_dev_num, void* node_info, u8* ip_addr, u8* hw_addr, u
     eth_set_interrupt_enable_callback((void *)wlan_mac_high_interrupt_restore_state);
     eth_set_interrupt_disable_callback((void *)wlan_mac_high_interrupt_stop);
 
+    // Set the ARP time callback so unused ARP entries time out
+    arp_set_time_callback((void *)get_system_time_usec);
+
     // Initialize the transport_eth_dev_info structure for the Ethernet device
     transport_eth_dev_info_init(eth_dev_num, (wlan_exp_node_info *)node_info, ip_addr, hw_addr, unicast_port, broadcast_port);
 
@@ -263,20 +266,27 @@ void transport_close(u32 eth_dev_num) {
  *
  * @note    Buffers are managed by the wlan_exp UDP transport driver
  *
+ * @note    Up to TRANSPORT_POLL_MAX_NUM_PKTS packets are processed so that a burst of
+ *          host commands does not take one main loop pass per packet.
+ *
  *****************************************************************************/
 void transport_poll(u32 eth_dev_num) {
 
+    u32 i;
     int recv_bytes;
     int socket_index;
     wlan_exp_ip_udp_buffer recv_buffer;
     wlan_exp_ip_udp_buffer* send_buffer;
     struct sockaddr from;
 
-    // Check the socket to see if there is data
-    recv_bytes = socket_recvfrom_eth(eth_dev_num, &socket_index, &from, &recv_buffer);
+    for (i = 0; i < TRANSPORT_POLL_MAX_NUM_PKTS; i++) {
+
+        // Check the socket to see if there is data
+        recv_bytes = socket_recvfrom_eth(eth_dev_num, &socket_index, &from, &recv_buffer);
+
+        // Stop when there is no more data
+        if (recv_bytes <= 0) { break; }
 
-    // If we have received data, then we need to process it
-    if (recv_bytes > 0) {
         // Allocate a send buffer from the transport driver
         send_buffer = socket_alloc_send_buffer();
 
@@ -287,6 +297,14 @@ void transport_poll(u32 eth_dev_num) {
         socket_free_recv_buffer(socket_index, &recv_buffer);
         socket_free_send_buffer(send_buffer);
     }
+
+#if WLAN_SW_CONFIG_ENABLE_LOGGING
+    // Push any new event log data if log streaming is enabled
+    node_log_stream_poll(eth_dev_num);
+#endif
+
+    // Run the next step of a deferred command
+    node_cmd_job_poll(eth_dev_num);
 }
 
 
@@ -363,11 +381,16 @@ void transport_receive(u32 eth_dev_num, int socket_index, struct sockaddr* from,
 
             // Set the receive flags
             //     [0] - Is the packet broadcast?  WLAN_EXP_TRUE / WLAN_EXP_FALSE
+            //     [1] - Did the host ask for the command to be deferred?
             //
             if (dest_id == TRANSPORT_BROADCAST_DEST_ID) {
                 recv_flags |= 0x00000001;
             }
 
+            if (flags & TRANSPORT_HDR_DEFER_FLAG) {
+                recv_flags |= CMD_RESP_FLAG_DEFER;
+            }
+
             // Form outgoing Transport header for any outgoing packet in response to this message
             //     NOTE:  The u16/u32 fields here will be endian swapped in transport_send
             //     NOTE:  The length field of the header will be set in transport_send
@@ -27,7 +27,9 @@
 #include "string.h"
 
 #include "wlan_platform_high.h"
+#include "wlan_platform_common.h"
 #include "wlan_mac_common.h"
+#include "wlan_mac_high.h"
 #include "wlan_mac_eth_util.h"
 #include "wlan_mac_dl_list.h"
 #include "wlan_mac_queue.h"
@@ -75,6 +77,9 @@ void     print_bd_high_water_mark() { xil_printf("BD HWM = %d\n", bd_high_water_
 /******************************** Functions **********************************/
 
 int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_ptr, u32 eth_rx_len);
+static int _wlan_msdu_eth_send(void* mpdu, u8* da, u8* sa, void* msdu, u32 msdu_length);
+static inline eth_frame_class_t _wlan_eth_classify(u16 type, void* payload);
+static void _wlan_dhcp_scrape_hostname(void* mpdu, dhcp_packet* dhcp);
 
 /*****************************************************************************/
 /**
@@ -161,6 +166,10 @@ u32 wlan_process_eth_rx(void* eth_rx_buf, u32 eth_rx_len) {
     u8 eth_dest[6];
     u8 eth_src[6];
 
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+    u64 start_usec = get_system_time_usec();
+#endif
+
 #if PERF_MON_ETH_PROCESS_RX
     wlan_mac_set_dbg_hdr_out(0x4);
 #endif
@@ -205,6 +214,10 @@ u32 wlan_process_eth_rx(void* eth_rx_buf, u32 eth_rx_len) {
     wlan_mac_clear_dbg_hdr_out(0x4);
 #endif
 
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+    wlan_mac_high_pkt_proc_benchmark_record(PKT_PROC_BENCHMARK_ETH_RX, start_usec);
+#endif
+
     return return_value;
 }
 
@@ -265,6 +278,7 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
     dhcp_packet* dhcp;
     llc_header_t* llc_hdr;
     u32 mpdu_tx_len;
+    eth_frame_class_t frame_class;
 
     // Calculate actual wireless Tx len (eth payload - eth header + wireless header)
     mpdu_tx_len = eth_rx_len - sizeof(ethernet_header_t) + sizeof(llc_header_t) + sizeof(mac_header_80211) + WLAN_PHY_FCS_NBYTES;
@@ -273,6 +287,14 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
     eth_hdr = (ethernet_header_t*)eth_start_ptr;
     llc_hdr = (llc_header_t*)(mpdu_start_ptr + sizeof(mac_header_80211));
 
+    // Decide up front whether the packet needs anything beyond header mapping
+    frame_class = _wlan_eth_classify(eth_hdr->ethertype, (void*)eth_hdr + sizeof(ethernet_header_t));
+
+    if (frame_class == ETH_FRAME_CLASS_UNSUPPORTED) {
+        // Unknown/unsupported EtherType; don't process the Eth frame
+        return 0;
+    }
+
     // Copy the src/dest addresses from the received Eth packet to temp space
     memcpy(eth_src, eth_hdr->src_mac_addr, 6);
     memcpy(eth_dest, eth_hdr->dest_mac_addr, 6);
@@ -282,6 +304,7 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
     llc_hdr->ssap          = LLC_SNAP;
     llc_hdr->control_field = LLC_CNTRL_UNNUMBERED;
     bzero((void *)(llc_hdr->org_code), 3); //Org Code 0x000000: Encapsulated Ethernet
+    llc_hdr->type          = (frame_class == ETH_FRAME_CLASS_ARP) ? LLC_TYPE_ARP : LLC_TYPE_IP;
 
     switch(eth_encap_mode) {
     	default:
@@ -289,21 +312,7 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
     	break;
         // ------------------------------------------------
         case APPLICATION_ROLE_AP:
-            switch(eth_hdr->ethertype) {
-                case ETH_TYPE_ARP:
-                    llc_hdr->type = LLC_TYPE_ARP;
-                    arp = (arp_ipv4_packet_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
-                break;
-
-                case ETH_TYPE_IP:
-                    llc_hdr->type = LLC_TYPE_IP;
-                break;
-
-                default:
-                    // Unknown/unsupported EtherType; don't process the Eth frame
-                    return 0;
-                break;
-            }
+            // No rewriting needed
         break;
 
         // ------------------------------------------------
@@ -313,55 +322,40 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
             memcpy(eth_sta_mac_addr, eth_src, 6);
             memcpy(eth_src, get_mac_hw_addr_wlan(), 6);
 
-            switch(eth_hdr->ethertype) {
-                case ETH_TYPE_ARP:
-                    llc_hdr->type = LLC_TYPE_ARP;
-
+            switch(frame_class) {
+                case ETH_FRAME_CLASS_ARP:
                     // Overwrite ARP request source MAC address field with the station's wireless MAC address.
                     arp = (arp_ipv4_packet_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
                     memcpy(arp->sender_haddr, get_mac_hw_addr_wlan(), 6);
                 break;
 
-                case ETH_TYPE_IP:
-                    llc_hdr->type = LLC_TYPE_IP;
-
-                    // Check if IPv4 packet is a DHCP Discover in a UDP frame
+                case ETH_FRAME_CLASS_DHCP:
+                    // A DHCP packet contains the source hardware address deep inside the packet (in
+                    // addition to its usual location in the Eth header). For STA encapsulation, we
+                    // need to overwrite this address with the MAC addr of the wireless station.
                     ip_hdr = (ipv4_header_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
+                    udp    = (udp_header_t*)((void*)ip_hdr + 4*((u8)(ip_hdr->version_ihl) & 0xF));
+
+                    // Disable the checksum since this will change the bytes in the packet
+                    udp->checksum = 0;
+
+                    dhcp = (dhcp_packet*)((void*)udp + sizeof(udp_header_t));
 
-                    if (ip_hdr->protocol == IPV4_PROT_UDP) {
-                        udp = (udp_header_t*)((void*)ip_hdr + 4*((u8)(ip_hdr->version_ihl) & 0xF));
-
-                        // Check if this is a DHCP Discover packet, which contains the source hardware
-                        // address deep inside the packet (in addition to its usual location in the Eth
-                        // header). For STA encapsulation, we need to overwrite this address with the
-                        // MAC addr of the wireless station.
-                        if ((Xil_Ntohs(udp->src_port) == UDP_SRC_PORT_BOOTPC) ||
-                            (Xil_Ntohs(udp->src_port) == UDP_SRC_PORT_BOOTPS)) {
-
-                            // Disable the checksum since this will change the bytes in the packet
-                            udp->checksum = 0;
-
-                            dhcp = (dhcp_packet*)((void*)udp + sizeof(udp_header_t));
-
-                            if (Xil_Ntohl(dhcp->magic_cookie) == DHCP_MAGIC_COOKIE) {
-                                // Assert the DHCP Discover's BROADCAST flag; this signals to any DHCP
-                                // severs that their responses should be sent to the broadcast address.
-                                // This is necessary for the DHCP response to propagate back through the
-                                // wired-wireless portal at the AP, through the STA Rx MAC filters, back
-                                // out the wireless-wired portal at the STA, and finally into the DHCP
-                                // listener at the wired device
-                                dhcp->flags = Xil_Htons(DHCP_BOOTP_FLAGS_BROADCAST);
-
-                            } // END is DHCP valid
-                        } // END is DHCP
-                    } // END is UDP
+                    if (Xil_Ntohl(dhcp->magic_cookie) == DHCP_MAGIC_COOKIE) {
+                        // Assert the DHCP Discover's BROADCAST flag; this signals to any DHCP
+                        // severs that their responses should be sent to the broadcast address.
+                        // This is necessary for the DHCP response to propagate back through the
+                        // wired-wireless portal at the AP, through the STA Rx MAC filters, back
+                        // out the wireless-wired portal at the STA, and finally into the DHCP
+                        // listener at the wired device
+                        dhcp->flags = Xil_Htons(DHCP_BOOTP_FLAGS_BROADCAST);
+                    }
                 break;
 
                 default:
-                    // Unknown/unsupported EtherType; don't process the Eth frame
-                    return 0;
+                    // Header mapping only
                 break;
-            } //END switch(pkt type)
+            }
         break;
     } // END switch(encap mode)
 
@@ -392,6 +386,9 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
  * hostname, it never makes state decisions based on its value. The hostname can be
  * bogus or missing without affecting the behavior of the AP.
  *
+ * QoS data receptions whose QoS control field flags an A-MSDU are split into
+ * their subframes and each MSDU is sent as a separate Ethernet packet.
+ *
  * @param u8* mpdu
  *  - Pointer to the first byte of the packet received from the wireless interface
  * @param u32 length
@@ -401,43 +398,148 @@ int wlan_eth_encap(u8* mpdu_start_ptr, u8* eth_dest, u8* eth_src, u8* eth_start_
  *     malformed or unrecognized LLC header
 */
 int wlan_mpdu_eth_send(void* mpdu, u16 length, u8 pre_llc_offset) {
+    mac_header_80211* rx80211_hdr;
+    amsdu_subframe_header* subframe_hdr;
+    u8* amsdu_start;
+    u8* amsdu_end;
+    u8* subframe_ptr;
+
     int status;
-    u8* eth_mid_ptr;
+    u8 da[6];
+    u8 sa[6];
+    u32 msdu_length;
 
-    rx_frame_info_t* rx_frame_info;
+    u32 min_pkt_len = sizeof(mac_header_80211) + sizeof(llc_header_t);
 
-    mac_header_80211* rx80211_hdr;
-    llc_header_t* llc_hdr;
+    if(gl_portal_en == 0) return 0;
 
+    if(length < (min_pkt_len + pre_llc_offset + WLAN_PHY_FCS_NBYTES)){
+        xil_printf("Error in wlan_mpdu_eth_send: length of %d is too small... must be at least %d\n", length, min_pkt_len + pre_llc_offset + WLAN_PHY_FCS_NBYTES);
+        return -1;
+    }
+
+    rx80211_hdr = (mac_header_80211*)((void *)mpdu);
+
+    if ((pre_llc_offset == sizeof(qos_control)) &&
+        ((((qos_control*)((void*)mpdu + sizeof(mac_header_80211)))->control) & QOS_CONTROL_AMSDU_PRESENT)) {
+        // The payload is an A-MSDU - de-encapsulate and send each subframe
+        //     The DA / SA of each MSDU are in its subframe header
+        //     All subframes are handed to the Ethernet DMA together as one batch
+        status       = 0;
+        amsdu_start  = (u8*)mpdu + sizeof(mac_header_80211) + sizeof(qos_control);
+        amsdu_end    = (u8*)mpdu + length - WLAN_PHY_FCS_NBYTES;
+        subframe_ptr = amsdu_start;
+
+        wlan_platform_ethernet_tx_batch_start();
+
+        while ((subframe_ptr + sizeof(amsdu_subframe_header)) <= amsdu_end) {
+            subframe_hdr = (amsdu_subframe_header*)subframe_ptr;
+            msdu_length  = Xil_Ntohs(subframe_hdr->length);
+
+            if ((subframe_ptr + sizeof(amsdu_subframe_header) + msdu_length) > amsdu_end) {
+                xil_printf("Error in wlan_mpdu_eth_send: A-MSDU subframe of length %d overruns the MPDU\n", msdu_length);
+                status = -1;
+                break;
+            }
+
+            memcpy(da, subframe_hdr->da, 6);
+            memcpy(sa, subframe_hdr->sa, 6);
+
+            if (_wlan_msdu_eth_send(mpdu, da, sa, subframe_ptr + sizeof(amsdu_subframe_header), msdu_length) != 0) {
+                status = -1;
+            }
+
+            subframe_ptr += sizeof(amsdu_subframe_header) + msdu_length;
+            subframe_ptr += AMSDU_SUBFRAME_PAD(subframe_ptr - amsdu_start);
+        }
+
+        if (wlan_platform_ethernet_tx_batch_end() != 0) {
+            status = -1;
+        }
+
+        return status;
+    }
+
+    // Map the 802.11 header address fields to the DA / SA of the MSDU
+    //     AP:   (da == wlan.addr3) and (sa == wlan.addr2)
+    //     STA:  (da == wlan.addr1) and (sa == wlan.addr3)
+    //     IBSS: (da == wlan.addr1) and (sa == wlan.addr2)
+    switch(eth_encap_mode) {
+        default:
+            return 0;
+        break;
+        case APPLICATION_ROLE_AP:
+            memcpy(da, rx80211_hdr->address_3, 6);
+            memcpy(sa, rx80211_hdr->address_2, 6);
+        break;
+        case APPLICATION_ROLE_STA:
+            memcpy(da, rx80211_hdr->address_1, 6);
+            memcpy(sa, rx80211_hdr->address_3, 6);
+        break;
+        case APPLICATION_ROLE_IBSS:
+            memcpy(da, rx80211_hdr->address_1, 6);
+            memcpy(sa, rx80211_hdr->address_2, 6);
+        break;
+    }
+
+    return _wlan_msdu_eth_send(mpdu, da, sa, (u8*)mpdu + sizeof(mac_header_80211) + pre_llc_offset,
+                               length - sizeof(mac_header_80211) - pre_llc_offset - WLAN_PHY_FCS_NBYTES);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief De-encapsulates one MSDU and transmits it via Ethernet
+ *
+ * Helper for wlan_mpdu_eth_send(), called once per MSDU of the reception.
+ *
+ * @param void* mpdu
+ *  - Pointer to the first byte of the packet received from the wireless interface
+ * @param u8* da, sa
+ *  - Copies of the destination / source address of the MSDU
+ * @param void* msdu
+ *  - Pointer to the LLC header of the MSDU
+ * @param u32 msdu_length
+ *  - Length (in bytes) of the MSDU, including the LLC header
+ *
+ * @return 0 for successful de-encapsulation, -1 otherwise
+*/
+static int _wlan_msdu_eth_send(void* mpdu, u8* da, u8* sa, void* msdu, u32 msdu_length) {
+    int status;
+
+    llc_header_t* llc_hdr;
     ethernet_header_t* eth_hdr;
     ipv4_header_t* ip_hdr;
     udp_header_t* udp;
-
     arp_ipv4_packet_t* arp;
-    dhcp_packet* dhcp;
 
-    u8 continue_loop;
-    u8 is_dhcp_req = 0;
-
-    u8 addr_cache[6];
+    eth_frame_class_t frame_class;
     u32 len_to_send;
 
-    u32 min_pkt_len = sizeof(mac_header_80211) + sizeof(llc_header_t);
-
-    if(gl_portal_en == 0) return 0;
-
-    if(length < (min_pkt_len + pre_llc_offset + WLAN_PHY_FCS_NBYTES)){
-        xil_printf("Error in wlan_mpdu_eth_send: length of %d is too small... must be at least %d\n", length, min_pkt_len + pre_llc_offset + WLAN_PHY_FCS_NBYTES);
+    if(msdu_length < sizeof(llc_header_t)){
+        xil_printf("Error in wlan_mpdu_eth_send: MSDU length of %d is too small... must be at least %d\n", msdu_length, sizeof(llc_header_t));
         return -1;
     }
 
     // Get helper pointers to various byte offsets in the packet payload
-    rx80211_hdr = (mac_header_80211*)((void *)mpdu);
-    llc_hdr     = (llc_header_t*)((void *)mpdu + sizeof(mac_header_80211) + pre_llc_offset);
-    eth_hdr     = (ethernet_header_t*)((void *)mpdu + sizeof(mac_header_80211) + sizeof(llc_header_t) + pre_llc_offset - sizeof(ethernet_header_t));
+    //     NOTE:  The Ethernet header overwrites the 14 bytes before the end of the LLC header, which
+    //         may hold the 802.11 addresses (or A-MSDU subframe header) da and sa were read from.
+    //         Callers must pass copies of the addresses. The ETHER_TYPE field of the Ethernet header
+    //         occupies the same bytes as the LLC type, which already holds the same value.
+    llc_hdr     = (llc_header_t*)(msdu);
+    eth_hdr     = (ethernet_header_t*)((void *)msdu + sizeof(llc_header_t) - sizeof(ethernet_header_t));
+
+    // Decide up front whether the packet needs anything beyond header mapping
+    frame_class = _wlan_eth_classify(llc_hdr->type, (void*)llc_hdr + sizeof(llc_header_t));
+
+    if (frame_class == ETH_FRAME_CLASS_UNSUPPORTED) {
+        // Invalid or unsupported Eth type; give up and return
+        return -1;
+    }
 
     // Calculate length of de-encapsulated Ethernet packet
-    len_to_send = length - min_pkt_len - pre_llc_offset - WLAN_PHY_FCS_NBYTES + sizeof(ethernet_header_t);
+    len_to_send = msdu_length - sizeof(llc_header_t) + sizeof(ethernet_header_t);
 
     // Perform de-encapsulation of wireless packet
     switch(eth_encap_mode) {
@@ -446,185 +548,175 @@ int wlan_mpdu_eth_send(void* mpdu, u16 length, u8 pre_llc_offset) {
     	break;
         // ------------------------------------------------
         case APPLICATION_ROLE_AP:
-            // Map the 802.11 header address fields to Ethernet header address fields
-            //     For AP de-encapsulation, (eth.dest == wlan.addr3) and (eth.src == wlan.addr2)
-            memmove(eth_hdr->dest_mac_addr, rx80211_hdr->address_3, 6);
-            memmove(eth_hdr->src_mac_addr,  rx80211_hdr->address_2, 6);
-
-            // Set the ETHER_TYPE field in the Ethernet header
-            switch(llc_hdr->type){
-                case LLC_TYPE_ARP:
-                    eth_hdr->ethertype = ETH_TYPE_ARP;
-                break;
-
-                case LLC_TYPE_IP:
-                    eth_hdr->ethertype = ETH_TYPE_IP;
-
-                    // Check if this is a DHCP discover packet in a UDP packet
-                    //     If so, extract the hostname field from the DHCP discover payload and
-                    //         update the corresponding STA association table entry
-                    //     This hostname is purely for convenience- the hostname is easier to
-                    //          recognize than the STA MAC address. The hostname can be blank
-                    //          without affecting any AP functionality.
-                    ip_hdr = (ipv4_header_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
-
-                    if (ip_hdr->protocol == IPV4_PROT_UDP) {
-                        udp = (udp_header_t*)((void*)ip_hdr + 4*((u8)(ip_hdr->version_ihl) & 0xF));
-
-                        if ((Xil_Ntohs(udp->src_port) == UDP_SRC_PORT_BOOTPC) ||
-                            (Xil_Ntohs(udp->src_port) == UDP_SRC_PORT_BOOTPS)) {
-                            dhcp = (dhcp_packet*)((void*)udp + sizeof(udp_header_t));
-
-                            if (Xil_Ntohl(dhcp->magic_cookie) == DHCP_MAGIC_COOKIE) {
-                                eth_mid_ptr = (u8*)((void*)dhcp + sizeof(dhcp_packet));
-
-                                // Iterate over all tagged parameters in the DHCP request, looking for the hostname parameter
-                                //     NOTE:  Stop after 20 tagged parameters (handles case of mal-formed DHCP packets missing END tag)
-                                continue_loop = 20;
-
-                                while(continue_loop) {
-                                    continue_loop--;
-                                    switch(eth_mid_ptr[0]) {
-
-                                        case DHCP_OPTION_TAG_TYPE:
-                                            if((eth_mid_ptr[2] == DHCP_OPTION_TYPE_DISCOVER) ||
-                                               (eth_mid_ptr[2] == DHCP_OPTION_TYPE_REQUEST)) {
-                                                    is_dhcp_req = 1;
-                                            }
-                                        break;
-
-                                        case DHCP_HOST_NAME:
-                                            if (is_dhcp_req) {
-                                                // Look backwards from the MPDU payload to find the wireless Rx pkt metadata (the rx_frame_info struct)
-                                                rx_frame_info = (rx_frame_info_t*)((u8*)mpdu  - PHY_RX_PKT_BUF_MPDU_OFFSET);
-
-                                                if ((void*)(rx_frame_info->additional_info) != NULL) {
-                                                    // rx_frame_info has pointer to STA entry in association table - fill in that entry's hostname field
-
-                                                    // Zero out the hostname field of the station_info
-                                                    //     NOTE: This will effectively Null-terminate the string
-                                                    bzero(((station_info_t*)(rx_frame_info->additional_info))->hostname, STATION_INFO_HOSTNAME_MAXLEN+1);
-
-                                                    // Copy the string from the DHCP payload into the hostname field
-                                                    memcpy(((station_info_t*)(rx_frame_info->additional_info))->hostname,
-                                                            &(eth_mid_ptr[2]),
-                                                            min(STATION_INFO_HOSTNAME_MAXLEN, eth_mid_ptr[1]));
-                                                }
-                                            }
-                                        break;
-
-                                        case DHCP_OPTION_END:
-                                            continue_loop = 0;
-                                        break;
-                                    } // END switch(DHCP tag type)
-
-                                    // Increment by size of current tagged parameter
-                                    eth_mid_ptr += (2+eth_mid_ptr[1]);
-
-                                } // END iterate over DHCP tags
-                            }  // END is DHCP_MAGIC_COOKIE correct?
-                        } // END is DHCP?
-                    } // END is UDP?
-                break; // END case(IP packet)
-
-                default:
-                    // Invalid or unsupported Eth type; give up and return
-                    return -1;
-                break;
-            } // END switch(LLC type)
+            // Map the 802.11 addresses to Ethernet header address fields
+            memcpy(eth_hdr->dest_mac_addr, da, 6);
+            memcpy(eth_hdr->src_mac_addr,  sa, 6);
+
+            // If this is a DHCP packet, extract the hostname field from the DHCP payload and
+            //     update the corresponding STA association table entry
+            //     This hostname is purely for convenience- the hostname is easier to
+            //     recognize than the STA MAC address. The hostname can be blank
+            //     without affecting any AP functionality.
+            if (frame_class == ETH_FRAME_CLASS_DHCP) {
+                ip_hdr = (ipv4_header_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
+                udp    = (udp_header_t*)((void*)ip_hdr + 4*((u8)(ip_hdr->version_ihl) & 0xF));
+
+                _wlan_dhcp_scrape_hostname(mpdu, (dhcp_packet*)((void*)udp + sizeof(udp_header_t)));
+            }
         break;
 
         // ------------------------------------------------
         case APPLICATION_ROLE_STA:
-            if (wlan_addr_eq(rx80211_hdr->address_3, get_mac_hw_addr_wlan())) {
+            if (wlan_addr_eq(sa, get_mac_hw_addr_wlan())) {
                 // This case handles the behavior of an AP reflecting a station-sent broadcast
                 // packet back out over the air.  Without this filtering, a station would forward
                 // the packet it just transmitted back to its wired interface.  This messes up
                 // DHCP and ARP behavior on the connected PC.
                 return -1;
             }
+            // Fall through - the remaining de-encapsulation matches IBSS
 
-            // Make temp copy of the 802.11 header address 3 field
-            memcpy(addr_cache, rx80211_hdr->address_3, 6);
-
+        // ------------------------------------------------
+        case APPLICATION_ROLE_IBSS:
             // If this packet is addressed to this STA, use the wired device's MAC address as the Eth dest address
-            if (wlan_addr_eq(rx80211_hdr->address_1, get_mac_hw_addr_wlan())) {
+            if(wlan_addr_eq(da, get_mac_hw_addr_wlan())) {
                 memcpy(eth_hdr->dest_mac_addr, eth_sta_mac_addr, 6);
             } else {
-                memmove(eth_hdr->dest_mac_addr, rx80211_hdr->address_1, 6);
+                memcpy(eth_hdr->dest_mac_addr, da, 6);
             }
 
-            // Insert the Eth source, from the 802.11 header address 1 field
-            memcpy(eth_hdr->src_mac_addr, addr_cache, 6);
+            // Insert the Eth source
+            memcpy(eth_hdr->src_mac_addr, sa, 6);
 
-            switch(llc_hdr->type){
-                case LLC_TYPE_ARP:
-                    eth_hdr->ethertype = ETH_TYPE_ARP;
+            if (frame_class == ETH_FRAME_CLASS_ARP) {
+                // If the ARP packet is addressed to this STA wireless address, replace the ARP dest address
+                // with the connected wired device's MAC address
+                arp = (arp_ipv4_packet_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
+                if (wlan_addr_eq(arp->target_haddr, get_mac_hw_addr_wlan())) {
+                    memcpy(arp->target_haddr, eth_sta_mac_addr, 6);
+                }
+            }
+        break;
+    }
 
-                    // If the ARP packet is addressed to this STA wireless address, replace the ARP dest address
-                    // with the connected wired device's MAC address
-                    arp = (arp_ipv4_packet_t *)((void*)eth_hdr + sizeof(ethernet_header_t));
-                    if (wlan_addr_eq(arp->target_haddr, get_mac_hw_addr_wlan())) {
-                        memcpy(arp->target_haddr, eth_sta_mac_addr, 6);
-                    }
-                break;
+    status = wlan_platform_ethernet_send((u8*)eth_hdr, len_to_send);
+    if (status != 0) { xil_printf("Error in wlan_platform_ethernet_send! Err = %d\n", status); return -1; }
 
-                case ETH_TYPE_IP:
-                    eth_hdr->ethertype = ETH_TYPE_IP;
-                    ip_hdr = (ipv4_header_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
-                break;
+    return 0;
+}
 
-                default:
-                    // Invalid or unsupported Eth type; give up and return
-                    return -1;
-                break;
-            }
-        break;
 
-        // ------------------------------------------------
-        case APPLICATION_ROLE_IBSS:
-            // Make temp copy of the 802.11 header address 2 field
-            memcpy(addr_cache, rx80211_hdr->address_2, 6);
 
-            // If this packet is addressed to this STA, use the wired device's MAC address as the Eth dest address
-            if(wlan_addr_eq(rx80211_hdr->address_1, get_mac_hw_addr_wlan())) {
-                memcpy(eth_hdr->dest_mac_addr, eth_sta_mac_addr, 6);
-            } else {
-                memmove(eth_hdr->dest_mac_addr, rx80211_hdr->address_1, 6);
-            }
+/*****************************************************************************/
+/**
+ * @brief Classifies a packet crossing the Ethernet / 802.11 portal
+ *
+ * Decides with a fixed number of compares, independent of the packet contents,
+ * whether a packet needs any inspection or rewriting beyond header mapping. Only
+ * ARP packets and IPv4 / UDP packets from a BOOTP port (DHCP) do.
+ *
+ * @param u16 type
+ *  - ETHER_TYPE field, as stored in the Ethernet or LLC header
+ * @param void* payload
+ *  - Pointer to the first byte after the Ethernet or LLC header
+ *
+ * @return eth_frame_class_t
+ */
+static inline eth_frame_class_t _wlan_eth_classify(u16 type, void* payload) {
+    ipv4_header_t* ip_hdr;
+    udp_header_t* udp;
 
-            // Insert the Eth source, from the 802.11 header address 2 field
-            memcpy(eth_hdr->src_mac_addr, addr_cache, 6);
+    if (type == ETH_TYPE_IP) {
+        ip_hdr = (ipv4_header_t*)payload;
 
-            switch(llc_hdr->type){
-                case LLC_TYPE_ARP:
-                    eth_hdr->ethertype = ETH_TYPE_ARP;
+        if (ip_hdr->protocol != IPV4_PROT_UDP) {
+            return ETH_FRAME_CLASS_IP;
+        }
 
-                    // If the ARP packet is addressed to this STA wireless address, replace the ARP dest address
-                    // with the connected wired device's MAC address
-                    arp = (arp_ipv4_packet_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
-                    if (wlan_addr_eq(arp->target_haddr, get_mac_hw_addr_wlan())) {
-                        memcpy(arp->target_haddr, eth_sta_mac_addr, 6);
-                    }
-                break;
+        udp = (udp_header_t*)((void*)ip_hdr + 4*((u8)(ip_hdr->version_ihl) & 0xF));
 
-                case ETH_TYPE_IP:
-                    eth_hdr->ethertype = ETH_TYPE_IP;
-                    ip_hdr = (ipv4_header_t*)((void*)eth_hdr + sizeof(ethernet_header_t));
-                break;
+        // UDP_SRC_PORT_BOOTPS and UDP_SRC_PORT_BOOTPC are consecutive; one unsigned compare covers both
+        if ((u16)(Xil_Ntohs(udp->src_port) - UDP_SRC_PORT_BOOTPS) <= (UDP_SRC_PORT_BOOTPC - UDP_SRC_PORT_BOOTPS)) {
+            return ETH_FRAME_CLASS_DHCP;
+        }
 
-                default:
-                    // Invalid or unsupported Eth type; give up and return
-                    return -1;
-                break;
-            }
-        break;
+        return ETH_FRAME_CLASS_IP;
     }
 
-    status = wlan_platform_ethernet_send((u8*)eth_hdr, len_to_send);
-    if (status != 0) { xil_printf("Error in wlan_platform_ethernet_send! Err = %d\n", status); return -1; }
+    if (type == ETH_TYPE_ARP) {
+        return ETH_FRAME_CLASS_ARP;
+    }
 
-    return 0;
+    return ETH_FRAME_CLASS_UNSUPPORTED;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Copies the hostname of a DHCP Discover / Request into the sender's station_info
+ *
+ * @param void* mpdu
+ *  - Pointer to the first byte of the packet received from the wireless interface
+ * @param dhcp_packet* dhcp
+ *  - Pointer to the DHCP payload of the packet
+ */
+static void _wlan_dhcp_scrape_hostname(void* mpdu, dhcp_packet* dhcp) {
+    rx_frame_info_t* rx_frame_info;
+    u8* eth_mid_ptr;
+    u8 continue_loop;
+    u8 is_dhcp_req = 0;
+
+    if (Xil_Ntohl(dhcp->magic_cookie) != DHCP_MAGIC_COOKIE) {
+        return;
+    }
+
+    eth_mid_ptr = (u8*)((void*)dhcp + sizeof(dhcp_packet));
+
+    // Iterate over all tagged parameters in the DHCP request, looking for the hostname parameter
+    //     NOTE:  Stop after 20 tagged parameters (handles case of mal-formed DHCP packets missing END tag)
+    continue_loop = 20;
+
+    while(continue_loop) {
+        continue_loop--;
+        switch(eth_mid_ptr[0]) {
+
+            case DHCP_OPTION_TAG_TYPE:
+                if((eth_mid_ptr[2] == DHCP_OPTION_TYPE_DISCOVER) ||
+                   (eth_mid_ptr[2] == DHCP_OPTION_TYPE_REQUEST)) {
+                        is_dhcp_req = 1;
+                }
+            break;
+
+            case DHCP_HOST_NAME:
+                if (is_dhcp_req) {
+                    // Look backwards from the MPDU payload to find the wireless Rx pkt metadata (the rx_frame_info struct)
+                    rx_frame_info = (rx_frame_info_t*)((u8*)mpdu  - PHY_RX_PKT_BUF_MPDU_OFFSET);
+
+                    if ((void*)(rx_frame_info->additional_info) != NULL) {
+                        // rx_frame_info has pointer to STA entry in association table - fill in that entry's hostname field
+
+                        // Zero out the hostname field of the station_info
+                        //     NOTE: This will effectively Null-terminate the string
+                        bzero(((station_info_t*)(rx_frame_info->additional_info))->hostname, STATION_INFO_HOSTNAME_MAXLEN+1);
+
+                        // Copy the string from the DHCP payload into the hostname field
+                        memcpy(((station_info_t*)(rx_frame_info->additional_info))->hostname,
+                                &(eth_mid_ptr[2]),
+                                min(STATION_INFO_HOSTNAME_MAXLEN, eth_mid_ptr[1]));
+                    }
+                }
+            break;
+
+            case DHCP_OPTION_END:
+                continue_loop = 0;
+            break;
+        } // END switch(DHCP tag type)
+
+        // Increment by size of current tagged parameter
+        eth_mid_ptr += (2+eth_mid_ptr[1]);
+
+    } // END iterate over DHCP tags
 }
 
 void wlan_eth_portal_en(u8 enable){
@@ -67,6 +67,8 @@
 
 /*************************** Constant Definitions ****************************/
 
+// Index of the first entry allocated after the log wraps (ie just past the node_info entry)
+#define EVENT_LOG_WRAP_INDEX                               (sizeof(entry_header) + sizeof(node_info_entry))
 
 
 /*********************** Global Variable Definitions *************************/
@@ -85,6 +87,7 @@ static volatile u32 log_size;             // Size of the log in bytes
 static volatile u32 log_oldest_address; // Pointer to the oldest entry
 static volatile u32 log_next_address;   // Pointer to the next entry
 static volatile u32 log_num_wraps;      // Number of times the log has wrapped
+static volatile u32 log_num_resets;     // Number of times the log has been reset (lets log cursors notice a reset)
 
 // Log config variables
 static volatile u8 log_wrap_enabled;      // Will the log wrap or stop; By default wrapping is DISABLED
@@ -109,6 +112,8 @@ static volatile u8 allocation_mutex;
 void event_log_move_oldest_address(u32 end_address);
 void event_log_increment_oldest_address(u64 end_address, u32 size);
 int  event_log_get_next_empty_address(u32 size, u32* address);
+void event_log_cursor_move_to_oldest(event_log_cursor_t* cursor);
+static inline u8 event_log_oldest_in_previous_pass();
 
 
 /******************************** Functions **********************************/
@@ -212,6 +217,7 @@ void event_log_reset(){
     log_oldest_address   = log_start_address;
     log_next_address     = log_start_address;
     log_num_wraps        = 0;
+    log_num_resets      += 1;
 
     log_empty            = 1;
     log_full             = 0;
@@ -519,6 +525,149 @@ u32  event_log_get_flags(void) {
     return ((log_wrap_enabled & 0x1) << 1) + (event_logging_enabled & 0x1);
 }
 
+
+
+/*****************************************************************************/
+/**
+ * Initialize a log cursor to the oldest entry in the log
+ *
+ * @param   cursor           - Pointer to the cursor
+ *
+ * @return  None
+ *
+ *****************************************************************************/
+void event_log_cursor_init(event_log_cursor_t* cursor) {
+    interrupt_state_t prev_interrupt_state;
+
+    prev_interrupt_state = wlan_mac_high_interrupt_stop();
+    event_log_cursor_move_to_oldest(cursor);
+    wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Get the number of contiguous bytes that can be read at a log cursor
+ *
+ *   The cursor is moved to the start of the next pass through the log once it
+ * has read everything up to the soft end address of a wrapped log.  If the log
+ * has overwritten bytes the cursor has not read yet, the cursor is moved to the
+ * oldest entry and overrun is set.  If the log was reset, the cursor is moved
+ * to the start of the log.
+ *
+ *   Bytes of the previous pass through the log are only readable while they are
+ * at or after the oldest entry; once the log has moved the oldest entry past the
+ * cursor (or back to the start of the log ahead of the next wrap) they are lost.
+ *
+ *   The caller advances the cursor by adding the number of bytes it consumed
+ * to cursor->index.
+ *
+ * @param   cursor           - Pointer to the cursor
+ * @param   overrun          - Pointer to overrun flag (set to 1 if unread bytes were lost)
+ *
+ * @return  u32              - Number of bytes that can be read starting at cursor->index
+ *
+ *****************************************************************************/
+u32  event_log_cursor_get_size(event_log_cursor_t* cursor, u32* overrun) {
+    interrupt_state_t prev_interrupt_state;
+    u32 size = 0;
+    u32 next_index;
+    u32 oldest_index;
+    u32 soft_end_index;
+    u32 num_wraps;
+
+    *overrun = 0;
+
+    // The log is modified from interrupt context so take a consistent snapshot
+    prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+    next_index     = log_next_address - log_start_address;
+    oldest_index   = log_oldest_address - log_start_address;
+    soft_end_index = log_soft_end_address - log_start_address;
+    num_wraps      = log_num_wraps;
+
+    // The log was reset underneath the cursor
+    //     NOTE:  The wrap count alone cannot show this, since a reset before the first wrap leaves it at 0
+    if (cursor->num_resets != log_num_resets) {
+        cursor->index      = 0;
+        cursor->num_wraps  = num_wraps;
+        cursor->num_resets = log_num_resets;
+    }
+
+    // Follow the log across the wrap once everything before the soft end has been read
+    if (((cursor->num_wraps + 1) == num_wraps) && (cursor->index >= soft_end_index)) {
+        cursor->index     = EVENT_LOG_WRAP_INDEX;
+        cursor->num_wraps = num_wraps;
+    }
+
+    if (cursor->num_wraps == num_wraps) {
+        // Cursor is on the same pass as the log (index can only be past next_index when the log is full)
+        if (next_index > cursor->index) {
+            size = next_index - cursor->index;
+        }
+    } else if (((cursor->num_wraps + 1) == num_wraps) && (next_index <= cursor->index) &&
+               event_log_oldest_in_previous_pass() && (oldest_index <= cursor->index)) {
+        // Log has wrapped but has not reached the cursor yet
+        size = soft_end_index - cursor->index;
+    } else {
+        // Log has overwritten unread bytes
+        *overrun = 1;
+        event_log_cursor_move_to_oldest(cursor);
+    }
+
+    wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+    return size;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Move a log cursor to the oldest entry in the log
+ *
+ * @param   cursor           - Pointer to the cursor
+ *
+ * @return  None
+ *
+ * @note    Caller must prevent the log from being modified (ie stop interrupts)
+ *
+ *****************************************************************************/
+void event_log_cursor_move_to_oldest(event_log_cursor_t* cursor) {
+
+    cursor->index      = log_oldest_address - log_start_address;
+    cursor->num_wraps  = log_num_wraps;
+    cursor->num_resets = log_num_resets;
+
+    if (event_log_oldest_in_previous_pass()) {
+        cursor->num_wraps -= 1;
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Check whether the oldest entry belongs to the previous pass through the log
+ *
+ * @param   None
+ *
+ * @return  u8               - 1 if the log has wrapped (or is full) and the oldest
+ *                             entry is ahead of the next entry; 0 otherwise
+ *
+ * @note    Uses the same wrap check as event_log_get_next_empty_address().  Caller
+ *          must prevent the log from being modified (ie stop interrupts)
+ *
+ *****************************************************************************/
+static inline u8 event_log_oldest_in_previous_pass() {
+    return (log_full ||
+            !((log_next_address > log_oldest_address) ||
+              ((log_next_address == log_start_address) && (log_oldest_address == log_start_address))));
+}
+
+
+
 /*****************************************************************************/
 /**
  * Move the oldest address past the end_address while still being aligned
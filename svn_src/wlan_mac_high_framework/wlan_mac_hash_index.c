@@ -0,0 +1,115 @@
+/** @file wlan_mac_hash_index.c
+ *  @brief Hash Index
+ *
+ *  This contains code for open addressed hash indexes over arrays of entries.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+/***************************** Include Files *********************************/
+
+#include "string.h"
+#include "xil_types.h"
+
+#include "wlan_mac_hash_index.h"
+
+
+/******************************** Functions **********************************/
+
+/*****************************************************************************/
+/**
+ * @brief Initialize a hash index
+ *
+ * @param  hash_index_t* hash       - Hash index to initialize
+ * @param  u16* buckets             - Array of (1 << num_bits) buckets
+ * @param  u32 num_bits             - log2 of the number of buckets
+ * @param  entry_bucket             - Returns the home bucket of the entry at an array index
+ *
+ * @return None
+ *
+ *****************************************************************************/
+void hash_index_init(hash_index_t* hash, u16* buckets, u32 num_bits, u32 (*entry_bucket)(u32 index)){
+	hash->buckets      = buckets;
+	hash->num_bits     = num_bits;
+	hash->entry_bucket = entry_bucket;
+
+	bzero(buckets, (1 << num_bits) * sizeof(u16));
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Insert an entry into a hash index
+ *
+ * @param  hash_index_t* hash       - Hash index
+ * @param  u32 index                - Array index of the entry (its key must already be set)
+ *
+ * @return None
+ *
+ *****************************************************************************/
+void hash_index_insert(hash_index_t* hash, u32 index){
+	u32 mask   = (1 << hash->num_bits) - 1;
+	u32 bucket = hash->entry_bucket(index);
+
+	while(hash->buckets[bucket] != 0){
+		bucket = (bucket + 1) & mask;
+	}
+
+	hash->buckets[bucket] = (u16)(index + 1);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Remove an entry from a hash index
+ *
+ * Later members of the probe run are shifted back into the hole, so no
+ * tombstones are left behind.
+ *
+ * @param  hash_index_t* hash       - Hash index
+ * @param  u32 index                - Array index of the entry (its key must still hold the indexed value)
+ *
+ * @return None
+ *
+ *****************************************************************************/
+void hash_index_remove(hash_index_t* hash, u32 index){
+	u32 mask   = (1 << hash->num_bits) - 1;
+	u32 bucket = hash->entry_bucket(index);
+	u32 next_bucket;
+	u32 home_bucket;
+	u16 value  = (u16)(index + 1);
+
+	while(hash->buckets[bucket] != value){
+		if(hash->buckets[bucket] == 0){
+			// Entry is not indexed
+			return;
+		}
+		bucket = (bucket + 1) & mask;
+	}
+
+	// Pull later members of the probe run back into the hole
+	next_bucket = bucket;
+	while(1){
+		next_bucket = (next_bucket + 1) & mask;
+
+		if(hash->buckets[next_bucket] == 0) break;
+
+		home_bucket = hash->entry_bucket(hash->buckets[next_bucket] - 1);
+
+		// The entry may only move to the hole if its home bucket is not
+		// cyclically inside (bucket, next_bucket]
+		if(((next_bucket - home_bucket) & mask) >= ((next_bucket - bucket) & mask)){
+			hash->buckets[bucket] = hash->buckets[next_bucket];
+			bucket = next_bucket;
+		}
+	}
+
+	hash->buckets[bucket] = 0;
+}
@@ -44,6 +44,7 @@
 #include "wlan_exp_node.h"
 #include "wlan_mac_scan.h"
 #include "wlan_mac_high_mailbox_util.h"
+#include "wlan_mac_slab.h"
 
 /*********************** Global Variable Definitions *************************/
 
@@ -67,6 +68,15 @@ platform_common_dev_info_t platform_common_dev_info;
 XIntc InterruptController; ///< Interrupt Controller instance
 XAxiCdma cdma_inst; ///< Central DMA instance
 
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+static void* cdma_dest;  ///< Destination of the most recent CDMA transfer; invalidated in the D-cache once the transfer completes
+static u32   cdma_size;  ///< Size of the most recent CDMA transfer (0 if nothing to invalidate)
+#endif
+
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+static pkt_proc_times_t pkt_proc_times[PKT_PROC_BENCHMARK_NUM_TYPES]; ///< Per-packet processing times
+#endif
+
 // Callback function pointers
 volatile function_ptr_t press_pb_0_callback;   ///< User callback for pressing pushbutton 0
 volatile function_ptr_t release_pb_0_callback; ///< User callback for releasing pushbutton 0
@@ -111,6 +121,25 @@ static volatile u8 cpu_low_reg_read_buffer_status;
 // Interrupt State
 static volatile interrupt_state_t interrupt_state;
 
+// Pipelined Tx handoff
+//     The CDMA has no interrupt, so copy completion is tracked per Tx packet buffer in
+//     software. A buffer is handed off to CPU_LOW the next time the CDMA is known to be idle.
+static u8        tx_pipeline_enable;                              ///< Overlap the CDMA copy of an MPDU with the dequeue of the next one
+static u32       tx_pkt_buf_copy_pending;                         ///< Bitmask of Tx packet buffers waiting for their CDMA copy to be handed off
+static dl_entry* tx_pkt_buf_copy_entry[NUM_TX_PKT_BUF_MPDU];      ///< Tx queue element being copied into each pending Tx packet buffer
+
+// Tx packet buffer ownership
+//     Maintained at every CPU High state transition of the MPDU packet buffers so that
+//     wlan_mac_num_tx_pkt_buf_available() does not have to read every buffer's state.
+//     CPU Low can return a buffer to TX_PKT_BUF_HIGH_CTRL on its own in error / reboot
+//     cases. Those cases (and a slow timer, for the error paths CPU Low does not report)
+//     request a resync, and the masks are rebuilt from the buffer states the next time
+//     they say nothing is available.
+static u8        tx_pkt_buf_general_depth;                        ///< Max # of GENERAL Tx packet buffers owned by CPU_LOW
+static u32       tx_pkt_buf_empty_mask;                           ///< Bitmask of TX_PKT_BUF_HIGH_CTRL buffers not yet claimed
+static u32       tx_pkt_buf_group_mask[2];                        ///< Bitmask of buffers owned by CPU_LOW, per pkt_buf_group_t
+static volatile u8 tx_pkt_buf_resync_pending;                     ///< Rebuild the masks before reporting no available buffers
+
 // Memory Allocation Debugging
 static volatile u32 num_malloc;                   ///< Tracking variable for number of times malloc has been called
 static volatile u32 num_free;                     ///< Tracking variable for number of times free has been called
@@ -118,6 +147,14 @@ static volatile u32 num_realloc;                  ///< Tracking variable for num
 
 /*************************** Functions Prototypes ****************************/
 
+static void wlan_mac_high_tx_pkt_buf_handoff(int tx_pkt_buf);
+static void wlan_mac_high_rx_pkt_buf_process(u8 rx_pkt_buf);
+static inline void tx_pkt_buf_set_low_owned(int tx_pkt_buf, pkt_buf_group_t pkt_buf_group);
+static inline void tx_pkt_buf_clear_low_owned(int tx_pkt_buf);
+static inline void tx_pkt_buf_set_empty(int tx_pkt_buf);
+static void tx_pkt_buf_ownership_resync();
+static void tx_pkt_buf_request_resync();
+
 #ifdef _DEBUG_
 void wlan_mac_high_copy_comparison();
 #endif
@@ -270,6 +307,10 @@ void wlan_mac_high_init(){
 
 	cpu_low_reg_read_buffer        = NULL;
 
+	tx_pipeline_enable             = 1;
+	tx_pkt_buf_copy_pending        = 0;
+	tx_pkt_buf_general_depth       = TX_PKT_BUF_GENERAL_DEPTH_DEFAULT;
+
 	// ***************************************************
 	// Initialize Transmit Packet Buffers
 	// ***************************************************
@@ -315,10 +356,21 @@ void wlan_mac_high_init(){
 			break;
 		}
 	}
+	tx_pkt_buf_ownership_resync();
 
 	// ***************************************************
 	// Initialize Receive Packet Buffers
 	// ***************************************************
+#if RX_PKT_BUF_RING_ENABLE
+	// CPU HIGH rebooted after CPU Low published packets for de-encap/logging
+	//  Release them without processing; CPU_LOW owns every other buffer
+	rx_pkt_buf_ring_reset(get_rx_pkt_buf_ring());
+
+	for(i = 0; i < NUM_RX_PKT_BUFS; i++){
+		rx_frame_info = (rx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, i);
+		rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_LOW_CTRL;
+	}
+#else
 	for(i = 0; i < NUM_RX_PKT_BUFS; i++){
 		rx_frame_info = (rx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, i);
 		switch(rx_frame_info->rx_pkt_buf_state){
@@ -346,6 +398,7 @@ void wlan_mac_high_init(){
 			break;
 		}
 	}
+#endif
 
 	// ***************************************************
 	// Initialize CDMA, GPIO, and UART drivers
@@ -396,6 +449,10 @@ void wlan_mac_high_init(){
 	wlan_eth_util_init();
 #endif
 	wlan_mac_schedule_init();
+
+	// Catch Tx packet buffers CPU Low returned on an error path without a TX_PKT_BUF_DONE message
+	wlan_mac_schedule_event_repeated(SCHEDULE_COARSE, SLOW_TIMER_DUR_US, SCHEDULE_REPEAT_FOREVER, (void*)tx_pkt_buf_request_resync);
+
 #if WLAN_SW_CONFIG_ENABLE_LTG
 	wlan_mac_ltg_sched_init();
 #endif //WLAN_SW_CONFIG_ENABLE_LTG
@@ -742,6 +799,8 @@ void wlan_mac_high_display_mallinfo(){
 	xil_printf("   fordblks:                %d\n", mi.fordblks);
 	xil_printf("   keepcost:                %d\n", mi.keepcost);
 #endif
+
+	slab_print_stats();
 }
 
 
@@ -1035,11 +1094,23 @@ int wlan_mac_high_cdma_start_transfer(void* dest, void* src, u32 size){
 
 	if(out_of_range == 0){
 		wlan_mac_high_cdma_finish_transfer();
+
+		// The CDMA reads the source from memory, not from the D-cache. Flush the destination
+		// too so that no dirty line can be evicted over the data the CDMA writes.
+		wlan_mac_high_dcache_flush(src, size);
+		wlan_mac_high_dcache_flush(dest, size);
+
 		return_value = XAxiCdma_SimpleTransfer(&cdma_inst, (u32)src, (u32)dest, size, NULL, NULL);
 
 		if(return_value != 0){
 			xil_printf("CDMA Error: code %d, (0x%08x,0x%08x,%d)\n", return_value, dest,src,size);
 		}
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+		else {
+			cdma_dest = dest;
+			cdma_size = size;
+		}
+#endif
 	} else {
 		xil_printf("CDMA Error: source and destination addresses must not located in the DLMB. Using memcpy instead. memcpy(0x%08x,0x%08x,%d)\n",dest,src,size);
 		memcpy(dest,src,size);
@@ -1063,23 +1134,94 @@ int wlan_mac_high_cdma_start_transfer(void* dest, void* src, u32 size){
  */
 void wlan_mac_high_cdma_finish_transfer(){
 	while(XAxiCdma_IsBusy(&cdma_inst)) {}
+
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+	// Discard any stale cached copy of the data the CDMA just wrote
+	if(cdma_size != 0){
+		wlan_mac_high_dcache_invalidate(cdma_dest, cdma_size);
+		cdma_size = 0;
+	}
+#endif
 	return;
 }
 
 
 
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+/**
+ * @brief Record Packet Processing Time
+ *
+ * @param pkt_proc_benchmark_t type
+ *  - Type of packet that was processed
+ * @param u64 start_usec
+ *  - System time when processing of the packet started
+ * @return None
+ *
+ */
+void wlan_mac_high_pkt_proc_benchmark_record(pkt_proc_benchmark_t type, u64 start_usec){
+	u32 elapsed_usec = (u32)(get_system_time_usec() - start_usec);
+
+	pkt_proc_times[type].num_pkts++;
+	pkt_proc_times[type].sum_usec += elapsed_usec;
+	if(elapsed_usec > pkt_proc_times[type].max_usec){
+		pkt_proc_times[type].max_usec = elapsed_usec;
+	}
+}
+
+/**
+ * @brief Print Packet Processing Times
+ *
+ * Prints the average and maximum time CPU High spent per packet, in usec and
+ * in CPU cycles.
+ *
+ * @param None
+ * @return None
+ *
+ */
+void wlan_mac_high_print_pkt_proc_benchmark(){
+	const char* type_names[PKT_PROC_BENCHMARK_NUM_TYPES] = {"WLAN Rx", "Eth Rx"};
+	u32 cpu_mhz = platform_high_dev_info.cpu_freq / 1000000;
+	u32 avg_nsec;
+	u32 i;
+
+	xil_printf("Packet Processing Times (D-cache %s):\n", WLAN_SW_CONFIG_ENABLE_DCACHE ? "enabled" : "disabled");
+	for(i = 0; i < PKT_PROC_BENCHMARK_NUM_TYPES; i++){
+		if(pkt_proc_times[i].num_pkts == 0) continue;
+
+		avg_nsec = (u32)((pkt_proc_times[i].sum_usec * 1000) / pkt_proc_times[i].num_pkts);
+		xil_printf("  %-8s %8d pkts: avg %d.%03d usec (%d cycles), max %d usec\n",
+				   type_names[i], pkt_proc_times[i].num_pkts,
+				   avg_nsec / 1000, avg_nsec % 1000,
+				   (avg_nsec * cpu_mhz) / 1000,
+				   pkt_proc_times[i].max_usec);
+	}
+}
+#endif //WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+
+
+
 /**
  * @brief Transmit MPDU
  *
  * This function passes off an MPDU to the lower-level processor for transmission.
  *
- * @param tx_queue_entry_t* packet
- *  - Pointer to the packet that should be transmitted
- * @return None
+ * When the Tx pipeline is enabled, this function does not wait for the CDMA copy of
+ * the MPDU into the Tx packet buffer. It returns as soon as the tx_frame_info is filled
+ * in, so the caller can dequeue the next MPDU while the copy is in flight. The packet
+ * buffer is handed off to CPU_LOW and the queue element is checked in by the next call
+ * to this function or to wlan_mac_high_mpdu_transmit_complete().
+ *
+ * @param dl_entry* packet
+ *  - Pointer to the Tx queue element that should be transmitted
+ * @param int tx_pkt_buf
+ *  - Tx packet buffer to copy the MPDU into
+ * @return int
+ *  - TX_HANDOFF_COMPLETE if the queue element can be checked in by the caller
+ *  - TX_HANDOFF_PENDING if the queue element is still being copied
  *
  */
-void wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf) {
-	wlan_ipc_msg_t ipc_msg_to_low;
+int wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf) {
+	interrupt_state_t curr_interrupt_state;
 	tx_frame_info_t* tx_frame_info;
 	mac_header_80211* header;
 	void* copy_destination;
@@ -1106,6 +1248,13 @@ void wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf) {
 
 	xfer_len  = tx_queue_buffer->length - WLAN_PHY_FCS_NBYTES;
 
+	// Stop interrupts so the pending packet buffer state is not modified by a nested transmission
+	curr_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	// Hand off the packet buffer whose copy was started by the previous call. The CDMA
+	// has been busy with it while the caller dequeued this MPDU.
+	wlan_mac_high_mpdu_transmit_complete();
+
 	// Transfer the frame info
 	wlan_mac_high_cdma_start_transfer( copy_destination, copy_source, xfer_len);
 
@@ -1153,18 +1302,124 @@ void wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf) {
 			memcpy(&(tx_frame_info->params), &(((tx_queue_buffer_t*)(packet->data))->station_info->tx_params_mgmt), sizeof(tx_params_t));
 		} else {
 			memcpy(&(tx_frame_info->params), &(((tx_queue_buffer_t*)(packet->data))->station_info->tx_params_data), sizeof(tx_params_t));
+
+			// Let the station's rate selection scheme choose the MCS for unicast data
+			if(!is_multicast){
+				rate_selection_apply(&(((tx_queue_buffer_t*)(packet->data))->station_info->rate_info), &(tx_frame_info->params.phy));
+			}
 		}
 	}
 
+	if(tx_pipeline_enable){
+		// Set the packet buffer state to READY now so that it is no longer considered empty
+		// and counts against its packet buffer group. CPU_LOW will not look at the packet
+		// buffer until it receives the IPC_MBOX_TX_PKT_BUF_READY message.
+		tx_frame_info->tx_pkt_buf_state = TX_PKT_BUF_READY;
+		tx_pkt_buf_set_low_owned(tx_pkt_buf, tx_frame_info->queue_info.pkt_buf_group);
+
+		tx_pkt_buf_copy_entry[tx_pkt_buf] = packet;
+		tx_pkt_buf_copy_pending |= (1 << tx_pkt_buf);
+
+		wlan_mac_high_interrupt_restore_state(curr_interrupt_state);
+		return TX_HANDOFF_PENDING;
+	}
+
 	// Wait for transfer to finish
 	wlan_mac_high_cdma_finish_transfer();
 
+	wlan_mac_high_tx_pkt_buf_handoff(tx_pkt_buf);
+
+	wlan_mac_high_interrupt_restore_state(curr_interrupt_state);
+	return TX_HANDOFF_COMPLETE;
+}
+
+
+
+/**
+ * @brief Complete Pipelined MPDU Transmissions
+ *
+ * This function waits for the CDMA to finish any outstanding copy, hands off every
+ * pending Tx packet buffer to CPU_LOW and checks in the corresponding Tx queue
+ * elements. It must be called after the last wlan_mac_high_mpdu_transmit() of a
+ * poll of the Tx queues so that no MPDU is left waiting for a later poll.
+ *
+ * @param None
+ * @return None
+ *
+ */
+void wlan_mac_high_mpdu_transmit_complete(){
+	interrupt_state_t curr_interrupt_state;
+	int tx_pkt_buf;
+
+	if(tx_pkt_buf_copy_pending == 0) return;
+
+	curr_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	wlan_mac_high_cdma_finish_transfer();
+
+	for(tx_pkt_buf = 0; tx_pkt_buf < NUM_TX_PKT_BUF_MPDU; tx_pkt_buf++){
+		if(tx_pkt_buf_copy_pending & (1 << tx_pkt_buf)){
+			tx_pkt_buf_copy_pending &= ~(1 << tx_pkt_buf);
+
+			wlan_mac_high_tx_pkt_buf_handoff(tx_pkt_buf);
+
+			// Check in the Tx Queue element because it is no longer being used
+			queue_checkin(tx_pkt_buf_copy_entry[tx_pkt_buf]);
+			tx_pkt_buf_copy_entry[tx_pkt_buf] = NULL;
+		}
+	}
+
+	wlan_mac_high_interrupt_restore_state(curr_interrupt_state);
+}
+
+
+
+/**
+ * @brief Enable / Disable the Tx Pipeline
+ *
+ * @param u8 enable
+ *  - 1 to overlap the CDMA copy of an MPDU with the dequeue of the next MPDU
+ *  - 0 to wait for each copy in wlan_mac_high_mpdu_transmit()
+ * @return None
+ *
+ */
+void wlan_mac_high_set_tx_pipeline(u8 enable){
+	tx_pipeline_enable = enable;
+
+	if(enable == 0){
+		wlan_mac_high_mpdu_transmit_complete();
+	}
+}
+
+u8 wlan_mac_high_get_tx_pipeline(){
+	return tx_pipeline_enable;
+}
+
+
+
+/**
+ * @brief Hand Off Tx Packet Buffer to CPU_LOW
+ *
+ * The CDMA copy into the packet buffer must be complete before calling this function.
+ *
+ * @param int tx_pkt_buf
+ *  - Tx packet buffer to hand off
+ * @return None
+ *
+ */
+static void wlan_mac_high_tx_pkt_buf_handoff(int tx_pkt_buf){
+	wlan_ipc_msg_t ipc_msg_to_low;
+	tx_frame_info_t* tx_frame_info;
+
+	tx_frame_info = (tx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.tx_pkt_buf_baseaddr, tx_pkt_buf);
+
 	ipc_msg_to_low.msg_id            = IPC_MBOX_MSG_ID(IPC_MBOX_TX_PKT_BUF_READY);
 	ipc_msg_to_low.arg0              = tx_pkt_buf;
 	ipc_msg_to_low.num_payload_words = 0;
 
 	// Set the packet buffer state to READY
 	tx_frame_info->tx_pkt_buf_state = TX_PKT_BUF_READY;
+	tx_pkt_buf_set_low_owned(tx_pkt_buf, tx_frame_info->queue_info.pkt_buf_group);
 
 	// Note: at this point in the code, the packet buffer state has been modified to TX_PKT_BUF_READY,
 	// yet we have not sent the IPC_MBOX_TX_PKT_BUF_READY message. If we happen to reboot here,
@@ -1181,6 +1436,7 @@ void wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf) {
 		// transmissions.
 		wlan_printf(PL_ERROR, "Error: unable to unlock tx pkt_buf %d\n",tx_pkt_buf);
 		tx_frame_info->tx_pkt_buf_state = TX_PKT_BUF_HIGH_CTRL;
+		tx_pkt_buf_set_empty(tx_pkt_buf);
 	} else {
 		// We successfully unlocked the packet buffer or we failed to unlock it because
 		// it was already unlocked. In either case, we can submit this READY message.
@@ -1188,6 +1444,59 @@ void wlan_mac_high_mpdu_transmit(dl_entry* packet, int tx_pkt_buf) {
 	}
 }
 
+/**
+ * @brief Process a Received MPDU
+ *
+ * Passes a reception from CPU Low to the network_info and station_info subsystems,
+ * the event log and the MPDU Rx callback of the upper-level MAC. The caller must
+ * own the Rx packet buffer.
+ *
+ * @param u8 rx_pkt_buf
+ *  - Rx packet buffer containing the reception
+ * @return None
+ *
+ */
+static void wlan_mac_high_rx_pkt_buf_process(u8 rx_pkt_buf){
+	void* pkt_buf_addr = (void*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf);
+	station_info_t* station_info;
+	u32 mpdu_rx_process_flags;
+	rx_common_entry* rx_event_log_entry = NULL;
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+	u64 start_usec = get_system_time_usec();
+#endif
+
+	//Let an active scan see the reception so it can adapt its dwell on the current channel
+	wlan_mac_scan_rx_notify(pkt_buf_addr);
+
+	//Before calling the user's callback, we'll pass this reception off to the BSS info subsystem so it can scrape for BSS metadata
+	network_info_rx_process(pkt_buf_addr);
+
+	//We will also pass this reception off to the Station Info subsystem
+	station_info = station_info_postrx_process(pkt_buf_addr);
+
+#if WLAN_SW_CONFIG_ENABLE_LOGGING
+	//Log this RX event
+	rx_event_log_entry = wlan_exp_log_create_rx_entry((rx_frame_info_t*)pkt_buf_addr);
+#endif
+
+	// Call the RX callback function to process the received packet
+	mpdu_rx_process_flags = mpdu_rx_callback(pkt_buf_addr, station_info, rx_event_log_entry);
+
+#if	WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
+	if( (mpdu_rx_process_flags & MAC_RX_CALLBACK_RETURN_FLAG_NO_COUNTS) == 0 ){
+		if(mpdu_rx_process_flags & MAC_RX_CALLBACK_RETURN_FLAG_DUP){
+			station_info_rx_process_counts(pkt_buf_addr, station_info, RX_PROCESS_COUNTS_OPTION_FLAG_IS_DUPLICATE);
+		} else {
+			station_info_rx_process_counts(pkt_buf_addr, station_info, 0);
+		}
+	}
+#endif
+
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+	wlan_mac_high_pkt_proc_benchmark_record(PKT_PROC_BENCHMARK_WLAN_RX, start_usec);
+#endif
+}
+
 /**
  * @brief Set up the 802.11 Header
  *
@@ -1272,10 +1581,28 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 			// CPU Low has received an MPDU addressed to this node or to the broadcast address
 			//
 
-			station_info_t* station_info;
-			u32 mpdu_rx_process_flags;
-			rx_common_entry* rx_event_log_entry = NULL;
+#if RX_PKT_BUF_RING_ENABLE
+			rx_pkt_buf_ring_t* rx_ring = get_rx_pkt_buf_ring();
+			int ring_pkt_buf;
+
+			// Process every buffer CPU Low has published, in order. The buffer in msg->arg0
+			// may already have been processed in response to an earlier message.
+			while((ring_pkt_buf = rx_pkt_buf_ring_consumer_peek(rx_ring)) != -1){
+				rx_pkt_buf    = ring_pkt_buf;
+				rx_frame_info = (rx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf);
+
+				if(rx_frame_info->rx_pkt_buf_state == RX_PKT_BUF_READY){
+					rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_HIGH_CTRL;
+					wlan_mac_high_rx_pkt_buf_process(rx_pkt_buf);
+				} else {
+					wlan_printf(PL_ERROR, "Error: rx pkt_buf %d published in state %d\n", rx_pkt_buf, rx_frame_info->rx_pkt_buf_state);
+				}
 
+				// Free up the rx_pkt_buf
+				rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_LOW_CTRL;
+				rx_pkt_buf_ring_consumer_pop(rx_ring);
+			}
+#else
 			rx_pkt_buf = msg->arg0;
 			if(rx_pkt_buf < NUM_RX_PKT_BUFS){
 				rx_frame_info = (rx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf);
@@ -1290,29 +1617,8 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 
 							rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_HIGH_CTRL;
 
-							//Before calling the user's callback, we'll pass this reception off to the BSS info subsystem so it can scrape for BSS metadata
-							network_info_rx_process((void*)(CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf)));
-
-							//We will also pass this reception off to the Station Info subsystem
-							station_info = station_info_postrx_process((void*)(CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf)));
-
-#if WLAN_SW_CONFIG_ENABLE_LOGGING
-							//Log this RX event
-							rx_event_log_entry = wlan_exp_log_create_rx_entry(rx_frame_info);
-#endif
+							wlan_mac_high_rx_pkt_buf_process(rx_pkt_buf);
 
-							// Call the RX callback function to process the received packet
-							mpdu_rx_process_flags = mpdu_rx_callback((void*)(CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf)), station_info, rx_event_log_entry);
-
-#if	WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
-							if( (mpdu_rx_process_flags & MAC_RX_CALLBACK_RETURN_FLAG_NO_COUNTS) == 0 ){
-								if(mpdu_rx_process_flags & MAC_RX_CALLBACK_RETURN_FLAG_DUP){
-									station_info_rx_process_counts((void*)(CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf)), station_info, RX_PROCESS_COUNTS_OPTION_FLAG_IS_DUPLICATE);
-								} else {
-									station_info_rx_process_counts((void*)(CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf)), station_info, 0);
-								}
-							}
-#endif
 							// Free up the rx_pkt_buf
 							rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_LOW_CTRL;
 
@@ -1335,6 +1641,7 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 			} else {
 				xil_printf("Error: IPC_MBOX_RX_MPDU_READY with invalid pkt buf index %d\n ", rx_pkt_buf);
 			}
+#endif
 		} break;
 
 		//---------------------------------------------------------------------
@@ -1376,9 +1683,14 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 						if(lock_tx_pkt_buf(tx_pkt_buf) != PKT_BUF_MUTEX_SUCCESS){
 							xil_printf("Error: DONE Lock Tx Pkt Buf State Mismatch\n");
 							tx_frame_info->tx_pkt_buf_state = TX_PKT_BUF_HIGH_CTRL;
+							tx_pkt_buf_set_empty(tx_pkt_buf);
 							return;
 						}
 
+						// CPU Low no longer owns this buffer, so it no longer counts against its group
+						//  for the dequeue below. It is not empty until post-Tx processing is done.
+						tx_pkt_buf_clear_low_owned(tx_pkt_buf);
+
 						//We can now attempt to dequeue any pending transmissions before we fully process
 						//this done message.
 						tx_poll_callback();
@@ -1393,6 +1705,7 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 						mpdu_tx_high_done_callback(tx_frame_info, station_info, tx_high_event_log_entry);
 
 						tx_frame_info->tx_pkt_buf_state = TX_PKT_BUF_HIGH_CTRL;
+						tx_pkt_buf_set_empty(tx_pkt_buf);
 					break;
 					// Something has gone wrong - TX_DONE message disagrees
 					//  with state of Tx pkt buf
@@ -1404,11 +1717,13 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 						//  leave it TX_PKT_BUF_HIGH_CTRL, will be used by future ping-pong rotation
 						force_lock_tx_pkt_buf(tx_pkt_buf);
 						tx_frame_info->tx_pkt_buf_state = TX_PKT_BUF_HIGH_CTRL;
+						tx_pkt_buf_set_empty(tx_pkt_buf);
 					case TX_PKT_BUF_READY:
 					case TX_PKT_BUF_LOW_CTRL:
 						//CPU Low will clean up
 						// Unlikely CPU High holds lock, but unlock just in case
 						unlock_tx_pkt_buf(tx_pkt_buf);
+						tx_pkt_buf_request_resync();
 					break;
 				}
 			} else {
@@ -1433,6 +1748,7 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 					wlan_printf(PL_ERROR, "ERROR:  An unrecoverable exception has occurred in CPU_LOW, halting...\n");
 					wlan_printf(PL_ERROR, "    Reason code: %d\n", ipc_msg_from_low_payload[1]);
 					wlan_platform_high_userio_disp_status(USERIO_DISP_STATUS_CPU_ERROR, WLAN_ERROR_CPU_STOP);
+					tx_pkt_buf_request_resync();
 				break;
 
 				case CPU_STATUS_REASON_BOOTED:
@@ -1450,6 +1766,9 @@ void wlan_mac_high_process_ipc_msg(wlan_ipc_msg_t* msg, u32* ipc_msg_from_low_pa
 					if(low_param_rx_filter != 0xFFFFFFFF) 	wlan_mac_high_set_rx_filter_mode(low_param_rx_filter);
 					if(low_param_random_seed != 0xFFFFFFFF) wlan_mac_high_set_srand(low_param_random_seed);
 
+					// CPU Low reset any Tx packet buffers it owned to TX_PKT_BUF_HIGH_CTRL while booting
+					tx_pkt_buf_request_resync();
+
 					// Attempt to dequeue and fill any available Tx packet buffers
 					tx_poll_callback();
 				break;
@@ -1910,70 +2229,178 @@ int wlan_mac_high_is_cpu_low_initialized(){
 }
 
 /**
- * @brief Check the nubmer of available tx packet buffers for an available group
+ * @brief Tx packet buffer ownership bookkeeping
  *
+ * Only the MPDU packet buffers and the GENERAL / DTIM_MCAST groups are tracked. The
+ * caller must have interrupts stopped or be in the IPC / poll context.
+ *
+ * @param  int tx_pkt_buf
+ *     - Tx packet buffer index
  * @param  pkt_buf_group_t pkt_buf_group
- * @return int
- *     - 0 if CPU low is not ready to transmit
- *     - 1 if CPU low is ready to transmit
+ *     - Group the buffer counts against while CPU Low owns it
+ * @return None
  */
-inline int wlan_mac_num_tx_pkt_buf_available(pkt_buf_group_t pkt_buf_group) {
+static inline void tx_pkt_buf_set_low_owned(int tx_pkt_buf, pkt_buf_group_t pkt_buf_group){
+	if(tx_pkt_buf >= NUM_TX_PKT_BUF_MPDU) return;
 
-	u8 i, num_empty, num_low_owned;
+	tx_pkt_buf_empty_mask &= ~(1 << tx_pkt_buf);
+	tx_pkt_buf_clear_low_owned(tx_pkt_buf);
+
+	if(pkt_buf_group <= PKT_BUF_GROUP_DTIM_MCAST){
+		tx_pkt_buf_group_mask[pkt_buf_group] |= (1 << tx_pkt_buf);
+	}
+}
+
+static inline void tx_pkt_buf_clear_low_owned(int tx_pkt_buf){
+	if(tx_pkt_buf >= NUM_TX_PKT_BUF_MPDU) return;
+
+	tx_pkt_buf_group_mask[PKT_BUF_GROUP_GENERAL]    &= ~(1 << tx_pkt_buf);
+	tx_pkt_buf_group_mask[PKT_BUF_GROUP_DTIM_MCAST] &= ~(1 << tx_pkt_buf);
+}
+
+static inline void tx_pkt_buf_set_empty(int tx_pkt_buf){
+	if(tx_pkt_buf >= NUM_TX_PKT_BUF_MPDU) return;
+
+	tx_pkt_buf_clear_low_owned(tx_pkt_buf);
+	tx_pkt_buf_empty_mask |= (1 << tx_pkt_buf);
+}
+
+static inline u32 tx_pkt_buf_count(u32 mask){
+	u32 count = 0;
+
+	while(mask){
+		mask &= (mask - 1);
+		count++;
+	}
+	return count;
+}
+
+/**
+ * @brief Rebuild the Tx packet buffer ownership masks from the packet buffer states
+ *
+ * @param  None
+ * @return None
+ */
+static void tx_pkt_buf_ownership_resync(){
+	u8 i;
 	tx_frame_info_t* tx_frame_info;
 
-	num_empty = 0;
-	num_low_owned = 0;
+	tx_pkt_buf_resync_pending = 0;
+	tx_pkt_buf_empty_mask = 0;
+	tx_pkt_buf_group_mask[PKT_BUF_GROUP_GENERAL]    = 0;
+	tx_pkt_buf_group_mask[PKT_BUF_GROUP_DTIM_MCAST] = 0;
 
 	for( i = 0; i < NUM_TX_PKT_BUF_MPDU; i++ ) {
 		tx_frame_info = (tx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.tx_pkt_buf_baseaddr, i);
 
-		if( tx_frame_info->tx_pkt_buf_state == TX_PKT_BUF_HIGH_CTRL ) {
-			num_empty++;
-		}
-
-		if( (tx_frame_info->queue_info.pkt_buf_group == pkt_buf_group) &&
-			( (tx_frame_info->tx_pkt_buf_state == TX_PKT_BUF_READY) ||
-			  (tx_frame_info->tx_pkt_buf_state == TX_PKT_BUF_LOW_CTRL))) {
-			num_low_owned++;
+		switch(tx_frame_info->tx_pkt_buf_state){
+			case TX_PKT_BUF_HIGH_CTRL:
+				tx_pkt_buf_set_empty(i);
+			break;
+			case TX_PKT_BUF_READY:
+			case TX_PKT_BUF_LOW_CTRL:
+				tx_pkt_buf_set_low_owned(i, tx_frame_info->queue_info.pkt_buf_group);
+			break;
+			default:
+			break;
 		}
 	}
+}
+
+/**
+ * @brief Request a rebuild of the Tx packet buffer ownership masks
+ *
+ * The rebuild is deferred to wlan_mac_num_tx_pkt_buf_available(), which runs before
+ * a buffer is claimed, so it never races a buffer CPU High has claimed but not yet
+ * marked TX_PKT_BUF_READY.
+ *
+ * @param  None
+ * @return None
+ */
+static void tx_pkt_buf_request_resync(){
+	tx_pkt_buf_resync_pending = 1;
+}
+
+/**
+ * @brief Check the nubmer of available tx packet buffers for an available group
+ *
+ * @param  pkt_buf_group_t pkt_buf_group
+ * @return int
+ *     - Number of Tx packet buffers of the group that can be filled now (0 if
+ *       CPU low is not ready to transmit)
+ */
+inline int wlan_mac_num_tx_pkt_buf_available(pkt_buf_group_t pkt_buf_group) {
+
+	u32 depth, num_empty, num_low_owned;
 
 	// The first requirement for being allowed to dequeue is that there is at least one empty packet buffer.
 
-	// The second requirement for being allowed to dequeue is that no more than one packet buffer is currently
-	// in the TX_PKT_BUF_READY or TX_PKT_BUF_LOW_CTRL for pkt_buf_group of PKT_BUF_GROUP_GENERAL and no more than two
-	// for PKT_BUF_GROUP_DTIM_MCAST
+	// The second requirement for being allowed to dequeue is that fewer than the group's depth of packet
+	// buffers are currently in TX_PKT_BUF_READY or TX_PKT_BUF_LOW_CTRL for pkt_buf_group
 
-	if(num_empty == 0) {
-		return 0;
+	switch(pkt_buf_group){
+		case PKT_BUF_GROUP_GENERAL:
+			depth = tx_pkt_buf_general_depth;
+		break;
+		case PKT_BUF_GROUP_DTIM_MCAST:
+			depth = TX_PKT_BUF_DTIM_MCAST_DEPTH;
+		break;
+		default:
+			// Invalid packet buffer group
+			return 0;
+		break;
 	}
 
-	if(pkt_buf_group==PKT_BUF_GROUP_GENERAL) {
-		if(num_low_owned > 2) {
-			// Should never happen - clip to 2 to restore sanity from here on
-			xil_printf("WARNING: wlan_mac_num_tx_pkt_buf_available found %d GENERAL buffers owned by low!\n", num_low_owned);
-			num_low_owned = 2;
+	num_empty     = tx_pkt_buf_count(tx_pkt_buf_empty_mask);
+	num_low_owned = tx_pkt_buf_count(tx_pkt_buf_group_mask[pkt_buf_group]);
+
+	if((num_empty == 0) || (num_low_owned >= depth)) {
+		if(tx_pkt_buf_resync_pending == 0) {
+			return 0;
 		}
 
-		// Return 1 (if one buffer is already filled) or 2 (if both can be filled)
-		return (2 - num_low_owned);
+		// Rule out buffers CPU Low returned without a TX_PKT_BUF_DONE message
+		tx_pkt_buf_ownership_resync();
 
-	} else if(pkt_buf_group==PKT_BUF_GROUP_DTIM_MCAST) {
-		if(num_low_owned > 3) {
-			// Should never happen - clip to 3 to restore sanity from here on
-			xil_printf("WARNING: wlan_mac_num_tx_pkt_buf_available found %d DTIM_MCAST buffers owned by low!\n", num_low_owned);
-			num_low_owned = 3;
-		}
+		num_empty     = tx_pkt_buf_count(tx_pkt_buf_empty_mask);
+		num_low_owned = tx_pkt_buf_count(tx_pkt_buf_group_mask[pkt_buf_group]);
 
-		// Return 3 if all buffers are available, otherwise 1 or 2
-		return (3 - num_low_owned);
+		if((num_empty == 0) || (num_low_owned >= depth)) {
+			return 0;
+		}
+	}
 
+	if((depth - num_low_owned) < num_empty) {
+		return (depth - num_low_owned);
 	} else {
-		// Invalid packet buffer group
-		return 0;
+		return num_empty;
+	}
+}
+
+
+
+/**
+ * @brief Set / get the GENERAL Tx packet buffer pipeline depth
+ *
+ * A depth of 2 is the classic ping-pong between CPU High and CPU Low; larger depths let
+ * CPU Low keep transmitting while CPU High refills the buffers returned earlier.
+ *
+ * @param  u8 depth
+ *     - Max # of GENERAL Tx packet buffers owned by CPU Low (1 to NUM_TX_PKT_BUF_MPDU)
+ * @return int
+ *     - 0 on success, -1 if the depth is out of range
+ */
+int wlan_mac_high_set_tx_pkt_buf_depth(u8 depth){
+	if((depth == 0) || (depth > NUM_TX_PKT_BUF_MPDU)){
+		return -1;
 	}
 
+	tx_pkt_buf_general_depth = depth;
+	return 0;
+}
+
+u8 wlan_mac_high_get_tx_pkt_buf_depth(){
+	return tx_pkt_buf_general_depth;
 }
 
 
@@ -1981,6 +2408,9 @@ inline int wlan_mac_num_tx_pkt_buf_available(pkt_buf_group_t pkt_buf_group) {
 /**
  * @brief Return the index of the next free transmit packet buffer
  *
+ * The returned buffer is claimed: it is no longer counted as empty until it is handed off
+ * to CPU Low and returned.
+ *
  * @param  None
  * @return int
  *     - packet buffer index of free, now-locked packet buffer
@@ -1988,22 +2418,22 @@ inline int wlan_mac_num_tx_pkt_buf_available(pkt_buf_group_t pkt_buf_group) {
  */
 int wlan_mac_high_get_empty_tx_packet_buffer(){
 
-	//TODO: Debate: This function assumes that it is currently safe to take control
-	// of an empty Tx packet buffer. In other words, it is the responsibility of the
-	// the calling function to ensure that wlan_mac_is_tx_pkt_buf_available() == 1.
-	// For extra safety, we could call wlan_mac_is_tx_pkt_buf_available() here at the
-	// expensive of another search through the three packet buffers.
+	// This function assumes that it is currently safe to take control of an empty Tx
+	// packet buffer. In other words, it is the responsibility of the calling function
+	// to ensure that wlan_mac_num_tx_pkt_buf_available() > 0.
 
 	u8 i;
-	int pkt_buf_sel = -1;
 
 	for( i = 0; i < NUM_TX_PKT_BUF_MPDU; i++ ){
-		if( ((tx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.tx_pkt_buf_baseaddr, i))->tx_pkt_buf_state == TX_PKT_BUF_HIGH_CTRL ){
-			pkt_buf_sel = i;
-			break;
+		if( tx_pkt_buf_empty_mask & (1 << i) ){
+			tx_pkt_buf_empty_mask &= ~(1 << i);
+
+			if( ((tx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.tx_pkt_buf_baseaddr, i))->tx_pkt_buf_state == TX_PKT_BUF_HIGH_CTRL ){
+				return i;
+			}
 		}
 	}
-	return pkt_buf_sel;
+	return -1;
 }
 
 /**
@@ -2156,63 +2586,135 @@ tx_params_t wlan_mac_sanitize_tx_params(station_info_t* station_info, tx_params_
 	return tx_params_ret;
 }
 
+/**
+ * @brief Calculate the duration of an OFDM waveform
+ *
+ * This is the CPU High copy of wlan_ofdm_calc_txtime() in the lower-level
+ * MAC framework, for airtime accounting. Short guard interval waveforms are
+ * not supported.
+ *
+ * @param  u16 length
+ *     - Length of MAC payload in bytes (including FCS)
+ * @param  u8 mcs
+ *     - MCS index
+ * @param  u8 phy_mode
+ *     - PHY_MODE_NONHT or PHY_MODE_HTMF
+ * @param  u8 phy_samp_rate
+ *     - PHY sampling rate (phy_samp_rate_t)
+ * @return u16
+ *     - Duration of transmission in microseconds (including signal extension)
+ */
+u16 wlan_mac_high_calc_txtime(u16 length, u8 mcs, u8 phy_mode, u8 phy_samp_rate){
+	static const u16 n_dbps_nonht[] = {24, 36, 48, 72, 96, 144, 192, 216};
+	static const u16 n_dbps_htmf[]  = {26, 52, 78, 104, 156, 208, 234, 260};
+
+	u16 t_sym;
+	u16 n_dbps;
+	u16 num_ht_preamble_syms;
+	u32 num_payload_bits;
+
+	switch(phy_samp_rate){
+		case PHY_40M:  t_sym = 2;  break;
+		default:
+		case PHY_20M:  t_sym = 4;  break;
+		case PHY_10M:  t_sym = 8;  break;
+	}
+
+	mcs = min(mcs, 7);
+
+	if(phy_mode == PHY_MODE_HTMF){
+		n_dbps               = n_dbps_htmf[mcs];
+		num_ht_preamble_syms = 4;
+	} else {
+		n_dbps               = n_dbps_nonht[mcs];
+		num_ht_preamble_syms = 0;
+	}
+
+	// SERVICE + payload + TAIL, rounded up to an integer number of symbols
+	num_payload_bits = 16 + (8 * length) + 6;
+
+	// 5 symbols of STF/LTF/SIGNAL, HT preamble, payload and 6 usec signal extension
+	return (t_sym * (5 + num_ht_preamble_syms + ((num_payload_bits + n_dbps - 1) / n_dbps))) + 6;
+}
+
 #ifdef _DEBUG_
 
 /**
  * @brief CDMA vs CPU copy performance comparison
  *
+ * For each packet size, this function reports the average time to copy a frame
+ * with memcpy, with a blocking CDMA transfer (as done by wlan_mac_high_mpdu_transmit()
+ * when the Tx pipeline is disabled) and the time the CPU spends issuing a CDMA transfer
+ * (the only part of the copy left on the critical path when the Tx pipeline is enabled).
+ *
  * @param  None
  * @return None
  */
 void wlan_mac_high_copy_comparison(){
 
-	#define MAXLEN 10000
+	#define COPY_COMPARISON_LEN_STEP     64
+	#define COPY_COMPARISON_NUM_ITER     16
 
+	u32 d_cdma_issue;
 	u32 d_cdma;
 	u32 d_memcpy;
 	u8  isMatched_memcpy;
 	u8  isMatched_cdma;
 
+	u32 len;
 	u32 i;
 	u32 j;
-	u8* srcAddr = (u8*)RX_PKT_BUF_TO_ADDR(0);
-	u8* destAddr = (u8*)DDR3_BASEADDR;
-	//u8* destAddr = (u8*)TX_PKT_BUF_TO_ADDR(1);
+	u8* srcAddr = (u8*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, 0);
+	u8* destAddr = (u8*)USER_SCRATCH_BASE;
 	u64 t_start;
 	u64 t_end;
 
-	xil_printf("--- MEMCPY vs. CDMA Speed Comparison ---\n");
-	xil_printf("LEN, T_MEMCPY, T_CDMA, MEMCPY Match?, CDMA Match?\n");
-	for(i=0; i<MAXLEN; i++){
-		memset(destAddr,0,MAXLEN);
+	xil_printf("--- MEMCPY vs. CDMA Speed Comparison (%d iterations) ---\n", COPY_COMPARISON_NUM_ITER);
+	xil_printf("LEN, T_MEMCPY, T_CDMA_BLOCKING, T_CDMA_ISSUE, MEMCPY Match?, CDMA Match?\n");
+	for(len = COPY_COMPARISON_LEN_STEP; len <= MAX_PKT_SIZE_B; len += COPY_COMPARISON_LEN_STEP){
+		memset(destAddr,0,len);
 		t_start = get_usec_timestamp();
-		memcpy(destAddr,srcAddr,i+1);
+		for(i=0; i<COPY_COMPARISON_NUM_ITER; i++){
+			memcpy(destAddr,srcAddr,len);
+		}
 		t_end = get_usec_timestamp();
 		d_memcpy = (u32)(t_end - t_start);
 
 		isMatched_memcpy = 1;
-		for(j=0; j<i; j++){
+		for(j=0; j<len; j++){
 			if(srcAddr[j] != destAddr[j]){
 				isMatched_memcpy = 0;
 			}
 		}
 
-		memset(destAddr,0,MAXLEN);
+		memset(destAddr,0,len);
 
 		t_start = get_usec_timestamp();
-		wlan_mac_high_cdma_start_transfer((void*)destAddr,(void*)srcAddr,i+1);
-		//wlan_mac_high_cdma_finish_transfer();
+		for(i=0; i<COPY_COMPARISON_NUM_ITER; i++){
+			wlan_mac_high_cdma_start_transfer((void*)destAddr,(void*)srcAddr,len);
+			wlan_mac_high_cdma_finish_transfer();
+		}
 		t_end = get_usec_timestamp();
-		wlan_mac_high_clear_debug_gpio(0x04);
 		d_cdma = (u32)(t_end - t_start);
 
 		isMatched_cdma = 1;
-		for(j=0; j<i; j++){
+		for(j=0; j<len; j++){
 			if(srcAddr[j] != destAddr[j]){
 				isMatched_cdma = 0;
 			}
 		}
-		xil_printf("%d, %d, %d, %d, %d\n", i+1, d_memcpy, d_cdma, isMatched_memcpy, isMatched_cdma);
+
+		d_cdma_issue = 0;
+		for(i=0; i<COPY_COMPARISON_NUM_ITER; i++){
+			t_start = get_usec_timestamp();
+			wlan_mac_high_cdma_start_transfer((void*)destAddr,(void*)srcAddr,len);
+			t_end = get_usec_timestamp();
+			d_cdma_issue += (u32)(t_end - t_start);
+			wlan_mac_high_cdma_finish_transfer();
+		}
+
+		xil_printf("%d, %d, %d, %d, %d, %d\n", len, d_memcpy/COPY_COMPARISON_NUM_ITER, d_cdma/COPY_COMPARISON_NUM_ITER,
+				   d_cdma_issue/COPY_COMPARISON_NUM_ITER, isMatched_memcpy, isMatched_cdma);
 	}
 }
 
@@ -1,3 +1,4 @@
+#include "string.h"
 #include "xmbox.h"
 
 #include "wlan_mac_common.h"
@@ -21,7 +22,10 @@ static platform_high_dev_info_t platform_high_dev_info;
 static wlan_ipc_msg_t ipc_msg_from_low;                                           ///< IPC message from lower-level
 static u32 ipc_msg_from_low_payload[MAILBOX_BUFFER_MAX_NUM_WORDS];     ///< Buffer space for IPC message from lower-level
 
+static ipc_rx_counts_t ipc_rx_counts;                                  ///< Counts of IPC messages received from lower-level
+
 void _mailbox_rx_watchdog(u32 timer_id);
+u32  _ipc_rx_batch(wlan_ipc_msg_t* batch);
 
 void wlan_mac_high_init_mailbox(){
 
@@ -32,20 +36,96 @@ void wlan_mac_high_init_mailbox(){
 
 	platform_common_dev_info = wlan_platform_common_get_dev_info();
 	platform_high_dev_info   = wlan_platform_high_get_dev_info();
+
+	wlan_mac_high_reset_ipc_rx_counts();
 }
 
 /**
  * @brief WLAN MAC IPC receive
  *
  * IPC receive function that will poll the mailbox for as many messages as are
- * available and then call the CPU high IPC processing function on each message
+ * available and then call the CPU high IPC processing function on each message.
+ * IPC_MBOX_BATCH messages are unpacked and each message in the batch is processed
+ * in order.
  *
  * @param  None
- * @return None
+ * @return u32
+ *     - Number of messages processed
  */
-void wlan_mac_high_ipc_rx(){
+u32 wlan_mac_high_ipc_rx(){
+	u32 num_msgs = 0;
+
 	while (read_mailbox_msg(&ipc_msg_from_low) == IPC_MBOX_SUCCESS) {
-		wlan_mac_high_process_ipc_msg(&ipc_msg_from_low, ipc_msg_from_low_payload);
+		if (IPC_MBOX_MSG_ID_TO_MSG(ipc_msg_from_low.msg_id) == IPC_MBOX_BATCH) {
+			num_msgs += _ipc_rx_batch(&ipc_msg_from_low);
+			ipc_rx_counts.num_batches++;
+		} else {
+			wlan_mac_high_process_ipc_msg(&ipc_msg_from_low, ipc_msg_from_low_payload);
+			num_msgs++;
+		}
+	}
+
+	ipc_rx_counts.num_msgs += num_msgs;
+
+	return num_msgs;
+}
+
+
+
+/**
+ * @brief Process IPC_MBOX_BATCH message
+ *
+ * @param  wlan_ipc_msg_t* batch
+ *     - Pointer to IPC_MBOX_BATCH message
+ * @return u32
+ *     - Number of messages processed
+ */
+u32 _ipc_rx_batch(wlan_ipc_msg_t* batch){
+	wlan_ipc_msg_t msg;
+	u32 offset = 0;
+	u32 num_msgs = 0;
+	int status;
+
+	while ((status = get_mailbox_batch_msg(batch, &offset, &msg)) != IPC_MBOX_NO_MSG_AVAIL) {
+		if (status == IPC_MBOX_INVALID_MSG) {
+			xil_printf("Error: invalid message in IPC batch (%d of %d)\n", num_msgs + 1, batch->arg0);
+			break;
+		}
+
+		wlan_mac_high_process_ipc_msg(&msg, msg.payload_ptr);
+		num_msgs++;
+	}
+
+	return num_msgs;
+}
+
+
+
+/**
+ * @brief IPC Receive Counts
+ *
+ * @param  None
+ * @return ipc_rx_counts_t*
+ *     - Pointer to the IPC receive counts
+ */
+ipc_rx_counts_t* wlan_mac_high_get_ipc_rx_counts(){
+	return &ipc_rx_counts;
+}
+
+void wlan_mac_high_reset_ipc_rx_counts(){
+	bzero(&ipc_rx_counts, sizeof(ipc_rx_counts_t));
+}
+
+void wlan_mac_high_print_ipc_rx_counts(){
+	xil_printf("IPC Rx Counts:\n");
+	xil_printf("  Interrupts:                %d\n", ipc_rx_counts.num_interrupts);
+	xil_printf("  Messages:                  %d\n", ipc_rx_counts.num_msgs);
+	xil_printf("  Batches:                   %d\n", ipc_rx_counts.num_batches);
+	if (ipc_rx_counts.num_interrupts > 0) {
+		xil_printf("  Messages per interrupt:    %d.%02d (max %d)\n",
+				   ipc_rx_counts.num_msgs / ipc_rx_counts.num_interrupts,
+				   ((ipc_rx_counts.num_msgs % ipc_rx_counts.num_interrupts) * 100) / ipc_rx_counts.num_interrupts,
+				   ipc_rx_counts.max_msgs_per_interrupt);
 	}
 }
 
@@ -96,6 +176,7 @@ int setup_mailbox_interrupt(XIntc* intc){
  *****************************************************************************/
 void mailbox_int_handler(void* callback_ref){
     u32 mask;
+    u32 num_msgs;
     XMbox* mbox_ptr = (XMbox *)callback_ref;
 
 #ifdef _ISR_PERF_MON_EN_
@@ -111,7 +192,12 @@ void mailbox_int_handler(void* callback_ref){
 
     // If this is a receive interrupt, then call the callback function
     if (mask & XMB_IX_RTA) {
-    	wlan_mac_high_ipc_rx();
+    	num_msgs = wlan_mac_high_ipc_rx();
+
+    	ipc_rx_counts.num_interrupts++;
+    	if (num_msgs > ipc_rx_counts.max_msgs_per_interrupt) {
+    		ipc_rx_counts.max_msgs_per_interrupt = num_msgs;
+    	}
     }
 
 	// It is technically possible that the mailbox could become full and
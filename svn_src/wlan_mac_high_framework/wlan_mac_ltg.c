@@ -30,6 +30,7 @@
 #include "wlan_mac_high.h"
 #include "wlan_mac_ltg.h"
 #include "wlan_mac_schedule.h"
+#include "wlan_mac_slab.h"
 #include "wlan_platform_common.h"
 #include "wlan_mac_packet_types.h"
 
@@ -37,6 +38,27 @@
 
 /*************************** Constant Definitions ****************************/
 
+// Largest params / state / payload of any LTG type
+typedef union ltg_sched_params_u{
+	ltg_sched_periodic_params          periodic;
+	ltg_sched_uniform_rand_params      uniform_rand;
+} ltg_sched_params_u;
+
+typedef union ltg_sched_state_u{
+	ltg_sched_periodic_state           periodic;
+	ltg_sched_uniform_rand_state       uniform_rand;
+} ltg_sched_state_u;
+
+typedef union ltg_pyld_u{
+	ltg_pyld_fixed                     fixed;
+	ltg_pyld_uniform_rand              uniform_rand;
+	ltg_pyld_all_assoc_fixed           all_assoc_fixed;
+} ltg_pyld_u;
+
+// The params cache holds one extra object for the params that are deserialized
+// by wlan_exp before they are copied by ltg_sched_create()
+#define LTG_NUM_PARAMS_OBJS                                (LTG_MAX_NUM_LTGS + 1)
+
 /*********************** Global Variable Definitions *************************/
 
 /*************************** Variable Definitions ****************************/
@@ -47,6 +69,19 @@ static volatile u64 num_ltg_checks;
 static volatile u32 schedule_id;
 static volatile u8 schedule_running;
 
+// LTG objects
+static dl_entry           ltg_entry_mem[LTG_MAX_NUM_LTGS];
+static tg_schedule        ltg_sched_mem[LTG_MAX_NUM_LTGS];
+static ltg_sched_params_u ltg_params_mem[LTG_NUM_PARAMS_OBJS];
+static ltg_sched_state_u  ltg_state_mem[LTG_MAX_NUM_LTGS];
+static ltg_pyld_u         ltg_pyld_mem[LTG_MAX_NUM_LTGS];
+
+static slab_cache_t ltg_entry_cache;
+static slab_cache_t ltg_sched_cache;
+static slab_cache_t ltg_params_cache;
+static slab_cache_t ltg_state_cache;
+static slab_cache_t ltg_pyld_cache;
+
 
 /*************************** Functions Prototypes ****************************/
 
@@ -69,6 +104,12 @@ int  wlan_mac_ltg_sched_init(){
 	num_ltg_checks   = 0;
 	ltg_sched_remove(LTG_REMOVE_ALL);
 	dl_list_init(&tg_list);
+
+	slab_cache_init(&ltg_entry_cache,  "ltg_entry",  ltg_entry_mem,  sizeof(dl_entry),           LTG_MAX_NUM_LTGS);
+	slab_cache_init(&ltg_sched_cache,  "ltg_sched",  ltg_sched_mem,  sizeof(tg_schedule),        LTG_MAX_NUM_LTGS);
+	slab_cache_init(&ltg_params_cache, "ltg_params", ltg_params_mem, sizeof(ltg_sched_params_u), LTG_NUM_PARAMS_OBJS);
+	slab_cache_init(&ltg_state_cache,  "ltg_state",  ltg_state_mem,  sizeof(ltg_sched_state_u),  LTG_MAX_NUM_LTGS);
+	slab_cache_init(&ltg_pyld_cache,   "ltg_pyld",   ltg_pyld_mem,   sizeof(ltg_pyld_u),         LTG_MAX_NUM_LTGS);
 	ltg_callback = (function_ptr_t)wlan_null_callback;
 
 	return return_value;
@@ -110,8 +151,8 @@ u32 ltg_sched_create(u32 type, void* params, void* callback_arg, void(*cleanup_c
 
 	switch(type){
 		case LTG_SCHED_TYPE_PERIODIC:
-			curr_tg->params = wlan_mac_high_malloc(sizeof(ltg_sched_periodic_params));
-			curr_tg->state  = wlan_mac_high_malloc(sizeof(ltg_sched_periodic_state));
+			curr_tg->params = slab_alloc(&ltg_params_cache);
+			curr_tg->state  = slab_alloc(&ltg_state_cache);
 
 			if(curr_tg->params != NULL && curr_tg->state != NULL){
                 bzero(curr_tg->state, sizeof(ltg_sched_periodic_state));
@@ -125,8 +166,8 @@ u32 ltg_sched_create(u32 type, void* params, void* callback_arg, void(*cleanup_c
 		break;
 
 		case LTG_SCHED_TYPE_UNIFORM_RAND:
-			curr_tg->params = wlan_mac_high_malloc(sizeof(ltg_sched_uniform_rand_params));
-			curr_tg->state  = wlan_mac_high_malloc(sizeof(ltg_sched_uniform_rand_state));
+			curr_tg->params = slab_alloc(&ltg_params_cache);
+			curr_tg->state  = slab_alloc(&ltg_state_cache);
 
 			if(curr_tg->params != NULL && curr_tg->state != NULL){
                 bzero(curr_tg->state, sizeof(ltg_sched_uniform_rand_state));
@@ -156,16 +197,16 @@ dl_entry* ltg_sched_create_l(){
 	dl_entry* curr_tg_dl_entry;
 	tg_schedule* curr_tg;
 
-	curr_tg_dl_entry = (dl_entry*)wlan_mac_high_malloc(sizeof(dl_entry));
+	curr_tg_dl_entry = slab_alloc(&ltg_entry_cache);
 
 	if(curr_tg_dl_entry == NULL){
 		return NULL;
 	}
 
-	curr_tg = (tg_schedule*)wlan_mac_high_malloc(sizeof(tg_schedule));
+	curr_tg = slab_calloc(&ltg_sched_cache);
 
 	if(curr_tg == NULL){
-		wlan_mac_high_free(curr_tg_dl_entry);
+		slab_free(&ltg_entry_cache, curr_tg_dl_entry);
 		return NULL;
 	}
 
@@ -528,21 +569,37 @@ void ltg_sched_destroy_params(tg_schedule* tg){
 	switch(tg->type){
 		case LTG_SCHED_TYPE_PERIODIC:
 		case LTG_SCHED_TYPE_UNIFORM_RAND:
-			wlan_mac_high_free(tg->params);
-			wlan_mac_high_free(tg->state);
+			slab_free(&ltg_params_cache, tg->params);
+			slab_free(&ltg_state_cache, tg->state);
 		break;
 	}
 }
 
 
+/*****************************************************************************/
+/**
+ * Free params returned by ltg_sched_deserialize() / payloads returned by
+ * ltg_payload_deserialize()
+ *
+ *****************************************************************************/
+void ltg_sched_params_free(void* params){
+	slab_free(&ltg_params_cache, params);
+}
+
+
+void ltg_payload_free(void* payload){
+	slab_free(&ltg_pyld_cache, payload);
+}
+
+
 void ltg_sched_destroy_l(dl_entry* tg_dl_entry){
 	tg_schedule* curr_tg;
 
 	curr_tg = (tg_schedule*)(tg_dl_entry->data);
 
 	ltg_sched_destroy_params(curr_tg);
-	wlan_mac_high_free(tg_dl_entry);
-	wlan_mac_high_free(curr_tg);
+	slab_free(&ltg_entry_cache, tg_dl_entry);
+	slab_free(&ltg_sched_cache, curr_tg);
 	return;
 }
 
@@ -615,7 +672,7 @@ void * ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
     switch(type){
         case LTG_SCHED_TYPE_PERIODIC:
         	if (size == 3){
-        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_periodic_params));
+        		ret_val = slab_alloc(&ltg_params_cache);
         	    if (ret_val != NULL){
         	    	((ltg_sched_periodic_params *)ret_val)->interval_count = (Xil_Ntohl(src[1]))/LTG_POLL_INTERVAL;
 
@@ -632,7 +689,7 @@ void * ltg_sched_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
 
         case LTG_SCHED_TYPE_UNIFORM_RAND:
         	if (size == 4){
-        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_sched_uniform_rand_params));
+        		ret_val = slab_alloc(&ltg_params_cache);
         	    if (ret_val != NULL){
         	    	((ltg_sched_uniform_rand_params *)ret_val)->min_interval_count = Xil_Ntohl(src[1])/LTG_POLL_INTERVAL;
         	    	((ltg_sched_uniform_rand_params *)ret_val)->max_interval_count = Xil_Ntohl(src[2])/LTG_POLL_INTERVAL;
@@ -675,7 +732,7 @@ void * ltg_payload_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
     switch(type){
         case LTG_PYLD_TYPE_FIXED:
         	if (size == 3){
-        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_pyld_fixed));
+        		ret_val = slab_alloc(&ltg_pyld_cache);
         	    if (ret_val != NULL){
 					((ltg_pyld_fixed *)ret_val)->hdr.type = LTG_PYLD_TYPE_FIXED;
 					wlan_exp_get_mac_addr(&src[1], &((ltg_pyld_fixed *)ret_val)->addr_da[0]);
@@ -688,7 +745,7 @@ void * ltg_payload_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
 
         case LTG_PYLD_TYPE_UNIFORM_RAND:
         	if (size == 4){
-        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_pyld_uniform_rand));
+        		ret_val = slab_alloc(&ltg_pyld_cache);
         	    if (ret_val != NULL){
 					((ltg_pyld_uniform_rand *)ret_val)->hdr.type   = LTG_PYLD_TYPE_UNIFORM_RAND;
 					wlan_exp_get_mac_addr(&src[1], &((ltg_pyld_fixed *)ret_val)->addr_da[0]);
@@ -703,7 +760,7 @@ void * ltg_payload_deserialize(u32 * src, u32 * ret_type, u32 * ret_size) {
 
         case LTG_PYLD_TYPE_ALL_ASSOC_FIXED:
         	if (size == 1){
-        		ret_val = (void *) wlan_mac_high_malloc(sizeof(ltg_pyld_all_assoc_fixed));
+        		ret_val = slab_alloc(&ltg_pyld_cache);
         	    if (ret_val != NULL){
 					((ltg_pyld_all_assoc_fixed *)ret_val)->hdr.type = LTG_PYLD_TYPE_ALL_ASSOC_FIXED;
         	    	((ltg_pyld_all_assoc_fixed *)ret_val)->length   = Xil_Ntohl(src[1]) & 0xFFFF;
@@ -34,6 +34,7 @@
 #include "wlan_mac_mgmt_tags.h"
 #include "wlan_mac_packet_types.h"
 #include "wlan_mac_common.h"
+#include "wlan_mac_hash_index.h"
 
 /*********************** Global Variable Definitions *************************/
 
@@ -42,17 +43,36 @@ extern platform_high_dev_info_t platform_high_dev_info;
 /*************************** Variable Definitions ****************************/
 
 /// The network_info_list is stored chronologically from .first being oldest
-/// and .last being newest. The "find" function search from last to first
-/// to minimize search time for new BSSes you hear from often.
+/// and .last being newest. Lookups by BSSID and SSID go through the hash
+/// indexes below rather than walking the list.
 static dl_list               network_info_list; ///< Filled network info
 static dl_list               network_info_free;	///< Available network info
-static dl_list               network_info_matching_ssid_list; ///< Filled network info that match the SSID provided to wlan_mac_high_find_network_info_SSID
+
+/// Base of the network_info_entry_t array; hash tables store (index + 1) into it so 0 can mark an empty bucket
+static network_info_entry_t* network_info_entry_base;
+
+/// BSSID index of every entry in network_info_list
+static u16                   network_info_bssid_hash_table[NETWORK_INFO_HASH_NUM_BUCKETS];
+static hash_index_t          network_info_bssid_hash;
+
+/// SSID index: bucket heads and per-entry chain links (NETWORK_INFO_SSID_NOT_INDEXED if the entry is not chained)
+static u16                   network_info_ssid_hash_table[NETWORK_INFO_HASH_NUM_BUCKETS];
+static u16                   network_info_ssid_next[NETWORK_INFO_HASH_NUM_BUCKETS];
+
+#define NETWORK_INFO_SSID_NOT_INDEXED                      0xFFFF
 
 
 /*************************** Functions Prototypes ****************************/
 
 network_info_entry_t* wlan_mac_high_find_network_info_oldest();
 
+static u32        network_info_bssid_hash_entry_bucket(u32 index);
+static inline u16 network_info_hash_ssid(char* ssid);
+static void       network_info_bssid_hash_insert(network_info_entry_t* entry);
+static void       network_info_bssid_hash_remove(network_info_entry_t* entry);
+static void       network_info_ssid_index_update(network_info_entry_t* entry);
+static void       network_info_ssid_index_remove(network_info_entry_t* entry);
+
 
 /******************************** Functions **********************************/
 
@@ -60,11 +80,12 @@ void network_info_init() {
 
 	u32 i;
 	u32 num_network_info;
-	network_info_entry_t* network_info_entry_base;
 
 	dl_list_init(&network_info_free);
 	dl_list_init(&network_info_list);
-	dl_list_init(&network_info_matching_ssid_list);
+
+	hash_index_init(&network_info_bssid_hash, network_info_bssid_hash_table, NETWORK_INFO_HASH_NUM_BITS, network_info_bssid_hash_entry_bucket);
+	bzero(network_info_ssid_hash_table, sizeof(network_info_ssid_hash_table));
 
 	// Clear the memory in the dram used for bss_infos
 	bzero((void*)BSS_INFO_BUFFER_BASE, BSS_INFO_BUFFER_SIZE);
@@ -74,6 +95,9 @@ void network_info_init() {
 	//     (2) The number of bss_info structs we can squeeze into BSS_INFO_BUFFER_SIZE
 	num_network_info = min(BSS_INFO_DL_ENTRY_MEM_SIZE/sizeof(network_info_entry_t), BSS_INFO_BUFFER_SIZE/sizeof(network_info_t));
 
+	// The BSSID index must always have an empty bucket to terminate a probe
+	num_network_info = min(num_network_info, NETWORK_INFO_HASH_NUM_BUCKETS - 1);
+
 	// At boot, every dl_entry buffer descriptor is free
 	// To set up the doubly linked list, we exploit the fact that we know the starting state is sequential.
 	// This matrix addressing is not safe once the queue is used. The insert/remove helper functions should be used
@@ -81,6 +105,7 @@ void network_info_init() {
 
 	for (i = 0; i < num_network_info; i++) {
 		network_info_entry_base[i].data = (void*)(BSS_INFO_BUFFER_BASE + (i*sizeof(network_info_t)));
+		network_info_ssid_next[i]       = NETWORK_INFO_SSID_NOT_INDEXED;
 		dl_entry_insertEnd(&network_info_free, (dl_entry*)&(network_info_entry_base[i]));
 	}
 
@@ -145,6 +170,8 @@ inline void network_info_rx_process(void* pkt_buf_addr) {
 
 						if (curr_network_info_entry != NULL) {
 							dl_entry_remove(&network_info_list, (dl_entry*)curr_network_info_entry);
+							network_info_bssid_hash_remove(curr_network_info_entry);
+							network_info_ssid_index_remove(curr_network_info_entry);
 						} else {
 							xil_printf("Cannot create network_info_t.\n");
 							return;
@@ -165,6 +192,7 @@ inline void network_info_rx_process(void* pkt_buf_addr) {
 					// Copy BSSID into network_info_entry_t struct
 					memcpy(curr_network_info_entry->bssid, rx_80211_header->address_3, MAC_ADDR_LEN);
 
+					network_info_bssid_hash_insert(curr_network_info_entry);
 				}
 
 				// Move the packet pointer to after the header
@@ -260,6 +288,9 @@ inline void network_info_rx_process(void* pkt_buf_addr) {
 
 				// TODO: Potential here for a application-specific callback on new BSS capabilities
 
+				// The SSID tag may have changed the SSID (e.g. a probe response for a hidden SSID)
+				network_info_ssid_index_update(curr_network_info_entry);
+
 				// Add network info into bss_info_list
 				dl_entry_insertEnd(&network_info_list, (dl_entry*)curr_network_info_entry);
 			break;
@@ -366,75 +397,88 @@ network_info_entry_t* network_info_checkout(){
 }
 
 void network_info_checkin(network_info_entry_t* network_info_entry){
+	network_info_bssid_hash_remove(network_info_entry);
+	network_info_ssid_index_remove(network_info_entry);
 	dl_entry_insertEnd(&network_info_free, (dl_entry*)network_info_entry);
 	return;
 }
 
 
-dl_list* wlan_mac_high_find_network_info_SSID(char* ssid){
-	// This function will return a pointer to a dl_list that contains every
-	// network_info_t struct that matches the SSID argument.
-
-    int iter;
-	network_info_entry_t* curr_network_info_entry_primary_list;
-	network_info_entry_t* curr_network_info_entry_match_list;
-	network_info_entry_t* next_network_info_entry_match_list;
-	network_info_t* curr_network_info;
-
-	// Remove/free any members of network_info_matching_ssid_list that exist since the last time
-	// this function was called
-
-	iter = network_info_matching_ssid_list.length;
-	curr_network_info_entry_match_list = (network_info_entry_t*)network_info_matching_ssid_list.first;
+/**
+ * @brief Find Network Info by SSID
+ *
+ * Iterates over every network_info_entry_t in the network list whose SSID
+ * matches the argument. Pass NULL as prev_entry to get the first match and the
+ * previous return value to get the next one. No memory is allocated, but the
+ * iteration is only valid until the network list is next modified.
+ *
+ * @param  char* ssid
+ *     - SSID to match
+ * @param  network_info_entry_t* prev_entry
+ *     - Previous match or NULL to start the search
+ * @return network_info_entry_t*
+ *     - Next match or NULL if there are no more matches
+ */
+network_info_entry_t* wlan_mac_high_find_network_info_SSID(char* ssid, network_info_entry_t* prev_entry){
+	u16 ssid_hash = network_info_hash_ssid(ssid);
+	u16 next;
+	network_info_entry_t* curr_network_info_entry;
 
-	while ((curr_network_info_entry_match_list != NULL) && (iter-- > 0)) {
-		next_network_info_entry_match_list = dl_entry_next(curr_network_info_entry_match_list);
-		dl_entry_remove(&network_info_matching_ssid_list, (dl_entry*)curr_network_info_entry_match_list);
-		wlan_mac_high_free(curr_network_info_entry_match_list);
-		curr_network_info_entry_match_list = next_network_info_entry_match_list;
+	if (prev_entry == NULL) {
+		next = network_info_ssid_hash_table[ssid_hash & (NETWORK_INFO_HASH_NUM_BUCKETS - 1)];
+	} else {
+		next = network_info_ssid_next[prev_entry - network_info_entry_base];
 	}
 
-	// At this point in the code, network_info_matching_ssid_list is guaranteed to be empty.
-	// We will fill it with new network_info_entry_t that point to existing network_info_t structs that
-	// match the SSID argument to this function. Note: these network_info_t structs will continue
-	// to be pointed to by the existing network_info_entry_t
-
-	iter = network_info_list.length;
-	curr_network_info_entry_primary_list = (network_info_entry_t*)network_info_list.last;
+	while ((next != 0) && (next != NETWORK_INFO_SSID_NOT_INDEXED)) {
+		curr_network_info_entry = &(network_info_entry_base[next - 1]);
 
-	while ((curr_network_info_entry_primary_list != NULL) && (iter-- > 0)) {
-		curr_network_info = curr_network_info_entry_primary_list->data;
-
-		if (strcmp(ssid, curr_network_info->bss_config.ssid) == 0) {
-			curr_network_info_entry_match_list = wlan_mac_high_malloc(sizeof(network_info_entry_t));
-			curr_network_info_entry_match_list->data = curr_network_info;
-			memcpy(curr_network_info_entry_match_list->bssid, curr_network_info->bss_config.bssid, MAC_ADDR_LEN);
-			dl_entry_insertEnd(&network_info_matching_ssid_list, (dl_entry*)curr_network_info_entry_match_list);
+		// Only compare the string in DRAM on a full hash match
+		if ((curr_network_info_entry->ssid_hash == ssid_hash) &&
+			(strcmp(ssid, curr_network_info_entry->data->bss_config.ssid) == 0)) {
+			return curr_network_info_entry;
 		}
 
-		curr_network_info_entry_primary_list = dl_entry_prev(curr_network_info_entry_primary_list);
+		next = network_info_ssid_next[next - 1];
 	}
-
-	return &network_info_matching_ssid_list;
+	return NULL;
 }
 
 
 network_info_entry_t* wlan_mac_high_find_network_info_BSSID(u8* bssid){
-	int iter;
+	u32 bucket = hash_index_addr_bucket(bssid, NETWORK_INFO_HASH_NUM_BITS);
+	u32 value;
 	network_info_entry_t* curr_network_info_entry;
 
-	iter = network_info_list.length;
-	curr_network_info_entry = (network_info_entry_t*)network_info_list.last;
+	while ((value = hash_index_probe(&network_info_bssid_hash, &bucket)) != 0) {
+		curr_network_info_entry = &(network_info_entry_base[value - 1]);
 
-	while ((curr_network_info_entry != NULL) && (iter-- > 0)) {
-		if (wlan_addr_eq(bssid,curr_network_info_entry->bssid)) {
+		if (wlan_addr_eq(bssid, curr_network_info_entry->bssid)) {
 			return curr_network_info_entry;
 		}
-		curr_network_info_entry = dl_entry_prev(curr_network_info_entry);
 	}
 	return NULL;
 }
 
+
+/**
+ * @brief Update Network Info SSID Index
+ *
+ * Must be called after the SSID of a network_info_t in the network list is
+ * modified outside of this subsystem.
+ *
+ * @param  network_info_t* info
+ *     - Network info whose SSID changed
+ * @return None
+ */
+void wlan_mac_high_update_network_info_SSID(network_info_t* info){
+	network_info_entry_t* curr_network_info_entry = wlan_mac_high_find_network_info_BSSID(info->bss_config.bssid);
+
+	if ((curr_network_info_entry != NULL) && (curr_network_info_entry->data == info)) {
+		network_info_ssid_index_update(curr_network_info_entry);
+	}
+}
+
 network_info_entry_t* wlan_mac_high_find_network_info_oldest(){
 	int iter;
 	network_info_entry_t* curr_network_info_entry;
@@ -483,6 +527,8 @@ network_info_t* wlan_mac_high_create_network_info(u8* bssid, char* ssid, u8 chan
 
 			if (curr_network_info_entry != NULL) {
 				dl_entry_remove(&network_info_list, (dl_entry*)curr_network_info_entry);
+				network_info_bssid_hash_remove(curr_network_info_entry);
+				network_info_ssid_index_remove(curr_network_info_entry);
 			} else {
 				xil_printf("Cannot create network_info_t.\n");
 				return NULL;
@@ -503,6 +549,8 @@ network_info_t* wlan_mac_high_create_network_info(u8* bssid, char* ssid, u8 chan
 
 		// Copy the BSS ID to the network_info_entry_t struct
 		memcpy(curr_network_info_entry->bssid, bssid, MAC_ADDR_LEN);
+
+		network_info_bssid_hash_insert(curr_network_info_entry);
 	}
 
 	// Update the fields of the BSS Info
@@ -511,6 +559,8 @@ network_info_t* wlan_mac_high_create_network_info(u8* bssid, char* ssid, u8 chan
 	curr_network_info->bss_config.chan_spec.chan_type      = CHAN_TYPE_BW20;
 	curr_network_info->latest_beacon_rx_time    = get_system_time_usec();
 
+	network_info_ssid_index_update(curr_network_info_entry);
+
 	//
 	// The following fields have their previous value retained if the were
 	// in the network list (i.e. wlan_mac_high_find_bss_info_BSSID() returned
@@ -596,3 +646,101 @@ void wlan_mac_high_clear_network_info(network_info_t* info){
 inline dl_list* wlan_mac_high_get_network_info_list(){
 	return &network_info_list;
 }
+
+
+/**
+ * @brief Network Info BSSID Hash
+ *
+ * Returns the home bucket of the network_info_entry_t at the given index in the
+ * BSSID index. See hash_index_addr_bucket().
+ *
+ * @param  u32 index
+ *     - Index of the entry in BSS_INFO_DL_ENTRY_MEM
+ * @return u32
+ *     - Home bucket for the entry's BSSID
+ */
+static u32 network_info_bssid_hash_entry_bucket(u32 index){
+	return hash_index_addr_bucket(network_info_entry_base[index].bssid, NETWORK_INFO_HASH_NUM_BITS);
+}
+
+/**
+ * @brief Network Info SSID Hash
+ *
+ * 32-bit FNV-1a folded to 16 bits. The full 16-bit value is kept in the
+ * network_info_entry_t so most mismatches are rejected without reading the
+ * SSID from DRAM; the low NETWORK_INFO_HASH_NUM_BITS select the bucket.
+ *
+ * @param  char* ssid
+ *     - NULL-terminated SSID to hash
+ * @return u16
+ *     - SSID hash
+ */
+static inline u16 network_info_hash_ssid(char* ssid){
+	u32 hash = 2166136261UL;
+	u32 i;
+
+	for (i = 0; (i < SSID_LEN_MAX) && (ssid[i] != 0); i++) {
+		hash = (hash ^ (u8)ssid[i]) * 16777619UL;
+	}
+
+	return (u16)(hash ^ (hash >> 16));
+}
+
+static void network_info_bssid_hash_insert(network_info_entry_t* entry){
+	hash_index_insert(&network_info_bssid_hash, entry - network_info_entry_base);
+}
+
+static void network_info_bssid_hash_remove(network_info_entry_t* entry){
+	hash_index_remove(&network_info_bssid_hash, entry - network_info_entry_base);
+}
+
+/**
+ * @brief Update Entry in Network Info SSID Index
+ *
+ * (Re-)chains the entry under the hash of its current SSID. Nothing is done if
+ * the entry is already chained under the same hash.
+ *
+ * @param  network_info_entry_t* entry
+ *     - Entry whose SSID may have changed
+ * @return None
+ */
+static void network_info_ssid_index_update(network_info_entry_t* entry){
+	u32 idx       = entry - network_info_entry_base;
+	u16 ssid_hash = network_info_hash_ssid(entry->data->bss_config.ssid);
+	u32 bucket;
+
+	if (network_info_ssid_next[idx] != NETWORK_INFO_SSID_NOT_INDEXED) {
+		if (entry->ssid_hash == ssid_hash) {
+			return;
+		}
+		network_info_ssid_index_remove(entry);
+	}
+
+	bucket = ssid_hash & (NETWORK_INFO_HASH_NUM_BUCKETS - 1);
+
+	entry->ssid_hash                     = ssid_hash;
+	network_info_ssid_next[idx]          = network_info_ssid_hash_table[bucket];
+	network_info_ssid_hash_table[bucket] = (u16)idx + 1;
+}
+
+static void network_info_ssid_index_remove(network_info_entry_t* entry){
+	u32  idx = entry - network_info_entry_base;
+	u16* link;
+
+	if (network_info_ssid_next[idx] == NETWORK_INFO_SSID_NOT_INDEXED) {
+		return;
+	}
+
+	// Chains are singly linked; find the link that points at this entry
+	link = &(network_info_ssid_hash_table[entry->ssid_hash & (NETWORK_INFO_HASH_NUM_BUCKETS - 1)]);
+
+	while ((*link != 0) && (*link != (idx + 1))) {
+		link = &(network_info_ssid_next[*link - 1]);
+	}
+
+	if (*link != 0) {
+		*link = network_info_ssid_next[idx];
+	}
+
+	network_info_ssid_next[idx] = NETWORK_INFO_SSID_NOT_INDEXED;
+}
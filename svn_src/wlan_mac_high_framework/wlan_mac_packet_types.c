@@ -19,6 +19,7 @@
 #include "xio.h"
 #include "string.h"
 #include "xil_types.h"
+#include "xil_io.h"
 #include "xintc.h"
 
 // WLAN includes
@@ -511,6 +512,102 @@ int wlan_create_data_frame(void* pkt_buf, mac_header_80211_common* common, u8 fl
 	return (sizeof(mac_header_80211) + WLAN_PHY_FCS_NBYTES);
 }
 
+/*****************************************************************************/
+/**
+ * @brief  A-MSDU construction
+ *
+ * wlan_create_amsdu_frame() converts a data frame created by
+ * wlan_create_data_frame() in place into a QoS data frame whose body is an
+ * A-MSDU with a single subframe. wlan_append_amsdu_subframe() then moves the
+ * MSDU of another data frame with the same receiver address into the next
+ * subframe. The DA / SA of each subframe come from the addresses of the
+ * original data frame, so this works for any combination of To DS / From DS
+ * except the 4-address case.
+ *
+ * @param  void* pkt_buf          - Frame to convert / append to
+ * @param  u32 length             - Length of the frame (including FCS)
+ * @param  void* mpdu_buf         - Data frame whose MSDU is appended
+ * @param  u32 mpdu_length        - Length of mpdu_buf (including FCS)
+ * @param  u32 max_length         - Maximum length of the resulting frame (including FCS)
+ *
+ * @return int                    - Length of the resulting frame (including FCS)
+ *                                  -1 if the subframe does not fit in max_length
+ *****************************************************************************/
+static void _wlan_amsdu_subframe_addrs(mac_header_80211* header, u8** da, u8** sa, u8** bssid) {
+	switch(header->frame_control_2 & (MAC_FRAME_CTRL2_FLAG_TO_DS | MAC_FRAME_CTRL2_FLAG_FROM_DS)) {
+		case MAC_FRAME_CTRL2_FLAG_FROM_DS:
+			*da = header->address_1;  *sa = header->address_3;  *bssid = header->address_2;
+		break;
+		case MAC_FRAME_CTRL2_FLAG_TO_DS:
+			*da = header->address_3;  *sa = header->address_2;  *bssid = header->address_1;
+		break;
+		default:
+			*da = header->address_1;  *sa = header->address_2;  *bssid = header->address_3;
+		break;
+	}
+}
+
+int wlan_create_amsdu_frame(void* pkt_buf, u32 length) {
+	mac_header_80211*      header    = (mac_header_80211*)pkt_buf;
+	qos_control*           qos_ctrl  = (qos_control*)((u8*)pkt_buf + sizeof(mac_header_80211));
+	amsdu_subframe_header* sub_hdr   = (amsdu_subframe_header*)((u8*)qos_ctrl + sizeof(qos_control));
+	u32                    msdu_length;
+	u8*                    da;
+	u8*                    sa;
+	u8*                    bssid;
+
+	msdu_length = length - sizeof(mac_header_80211) - WLAN_PHY_FCS_NBYTES;
+
+	// Move the MSDU behind the QoS control field and the subframe header
+	memmove((u8*)sub_hdr + sizeof(amsdu_subframe_header), qos_ctrl, msdu_length);
+
+	_wlan_amsdu_subframe_addrs(header, &da, &sa, &bssid);
+
+	memcpy(sub_hdr->da, da, MAC_ADDR_LEN);
+	memcpy(sub_hdr->sa, sa, MAC_ADDR_LEN);
+	sub_hdr->length = Xil_Htons(msdu_length);
+
+	// Address 3 of a frame carrying an A-MSDU is the BSSID
+	//     - Must be done after the DA / SA were copied since one of them may be address 3
+	memmove(header->address_3, bssid, MAC_ADDR_LEN);
+
+	header->frame_control_1 = MAC_FRAME_CTRL1_SUBTYPE_QOSDATA;
+	qos_ctrl->control       = QOS_CONTROL_AMSDU_PRESENT;
+
+	return (length + sizeof(qos_control) + sizeof(amsdu_subframe_header));
+}
+
+int wlan_append_amsdu_subframe(void* pkt_buf, u32 length, void* mpdu_buf, u32 mpdu_length, u32 max_length) {
+	u8*                    amsdu_end = (u8*)pkt_buf + length - WLAN_PHY_FCS_NBYTES;
+	u32                    pad;
+	u32                    msdu_length;
+	amsdu_subframe_header* sub_hdr;
+	u8*                    da;
+	u8*                    sa;
+	u8*                    bssid;
+
+	// Subframes start on a 4-byte boundary relative to the start of the A-MSDU
+	pad         = AMSDU_SUBFRAME_PAD(length - WLAN_PHY_FCS_NBYTES - sizeof(mac_header_80211) - sizeof(qos_control));
+	msdu_length = mpdu_length - sizeof(mac_header_80211) - WLAN_PHY_FCS_NBYTES;
+
+	if((length + pad + sizeof(amsdu_subframe_header) + msdu_length) > max_length) {
+		return -1;
+	}
+
+	bzero(amsdu_end, pad);
+	sub_hdr = (amsdu_subframe_header*)(amsdu_end + pad);
+
+	_wlan_amsdu_subframe_addrs((mac_header_80211*)mpdu_buf, &da, &sa, &bssid);
+
+	memcpy(sub_hdr->da, da, MAC_ADDR_LEN);
+	memcpy(sub_hdr->sa, sa, MAC_ADDR_LEN);
+	sub_hdr->length = Xil_Htons(msdu_length);
+
+	memcpy((u8*)sub_hdr + sizeof(amsdu_subframe_header), (u8*)mpdu_buf + sizeof(mac_header_80211), msdu_length);
+
+	return (length + pad + sizeof(amsdu_subframe_header) + msdu_length);
+}
+
 int wlan_create_rts_frame(void* pkt_buf_addr, u8* address_ra, u8* address_ta, u16 duration) {
 	//TODO: This function is redundant to the same function in wlam_mac_dcf.c. These could be merged,
 	//but there isn't currently a good place in wlan_mac_common to place this merged copy. If there
@@ -32,6 +32,9 @@
 #include "wlan_mac_pkt_buf_util.h"
 #include "wlan_platform_common.h"
 #include "wlan_mac_station_info.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_packet_types.h"
+#include "wlan_mac_slab.h"
 
 // WLAN Exp includes
 #include "wlan_exp_common.h"
@@ -52,6 +55,14 @@ extern platform_high_dev_info_t platform_high_dev_info;
 
 /*************************** Functions Prototypes ****************************/
 
+static int       _queue_create(u16 queue_sel);
+static inline tx_queue_t* _queue_get(u16 queue_sel);
+static dl_entry* _dequeue_from_head(u16 queue_sel);
+static u8        _queue_aqm_should_drop(tx_queue_t* queue, dl_entry* tqe, u64 curr_time);
+static void      _queue_aqm_drop(dl_entry* tqe);
+static u64       _queue_aqm_control_law(u64 t, u32 count);
+static u8        _queue_amsdu_eligible(tx_queue_buffer_t* head, tx_queue_buffer_t* tx_queue_buffer);
+
 /*************************** Variable Definitions ****************************/
 
 // List to hold all of the empty, free entries
@@ -60,18 +71,24 @@ static dl_list free_queue;
 // The tx_queues variable is an array of lists that will be filled with queue
 // entries from the free_queue list
 //
-// NOTE:  This implementation sparsely packs the tx_queues array to allow fast
-//     indexing at the cost of some wasted memory. The tx_queues array will be
-//     reallocated whenever the upper-level MAC asks to enqueue at an index
-//     that is larger than the current size of the array. It is assumed that
-//     this index will not continue to grow over the course of execution,
-//     otherwise this array will continue to grow and eventually be unable to
-//     be reallocated. Practically speaking, this means an AP needs to re-use
-//     the AIDs it issues stations if it wants to use the AIDs as an index into
-//     the tx queue.
+// NOTE:  The tx_queues array is indexed by queue ID. A queue is allocated from
+//     tx_queue_cache the first time it is used and is never freed, so IDs must
+//     be less than QUEUE_MAX_NUM_QUEUES. Practically speaking, this means an AP
+//     needs to re-use the AIDs it issues stations if it wants to use the AIDs as
+//     an index into the tx queue.
 //
-static dl_list* tx_queues;
-static u16 num_tx_queues;
+static tx_queue_t* tx_queues[QUEUE_MAX_NUM_QUEUES];
+static slab_cache_t tx_queue_cache;
+
+// The tx_queue_t structs are placed at the end of TX_QUEUE_DL_ENTRY_MEM
+#define TX_QUEUE_T_MEM_SIZE                                (QUEUE_MAX_NUM_QUEUES * sizeof(tx_queue_t))
+#define TX_QUEUE_T_MEM_BASE                                (TX_QUEUE_DL_ENTRY_MEM_BASE + TX_QUEUE_DL_ENTRY_MEM_SIZE - TX_QUEUE_T_MEM_SIZE)
+
+// Maximum length of queues whose max_length is QUEUE_MAX_LENGTH_DEFAULT
+static u16 default_max_length;
+
+// Maximum length of an A-MSDU built by dequeue_amsdu_from_head() (0 = disabled)
+static u32 amsdu_max_length;
 
 
 // Total number of Tx queue entries
@@ -86,6 +103,7 @@ static volatile u32 total_tx_queue_entries;
  *
  * The number of Tx Queue elements we can initialize is limited by the smaller of two values:
  *     (1) The number of dl_entry structs we can squeeze into TX_QUEUE_DL_ENTRY_MEM_SIZE
+ *         (less the space for the tx_queue_t structs)
  *     (2) The number of QUEUE_BUFFER_SIZE MPDU buffers we can squeeze into TX_QUEUE_BUFFER_SIZE
  *
  * @param  u8 dram_present        - Flag to indicate if DRAM is present
@@ -97,15 +115,18 @@ void queue_init() {
 	dl_entry* dl_entry_base;
 
 	// Set the total number of supported Tx Queue entries
-	total_tx_queue_entries = min((TX_QUEUE_DL_ENTRY_MEM_SIZE / sizeof(dl_entry)),   // Max dl_entry
-	                             (TX_QUEUE_BUFFER_SIZE / QUEUE_BUFFER_SIZE));       // Max buffers
+	total_tx_queue_entries = min(((TX_QUEUE_DL_ENTRY_MEM_SIZE - TX_QUEUE_T_MEM_SIZE) / sizeof(dl_entry)),   // Max dl_entry
+	                             (TX_QUEUE_BUFFER_SIZE / QUEUE_BUFFER_SIZE));                              // Max buffers
 
-	// Initialize the Tx queue
-	//     NOTE:  tx_queues is initially NULL because it will be dynamically allocated and
-	//         initialized.
+	// Initialize the Tx queues
+	//     NOTE:  Queues are created from tx_queue_cache as they are used
 	//
-	tx_queues = NULL;
-	num_tx_queues = 0;
+	for (i = 0; i < QUEUE_MAX_NUM_QUEUES; i++) { tx_queues[i] = NULL; }
+
+	slab_cache_init(&tx_queue_cache, "tx_queue", (void*)TX_QUEUE_T_MEM_BASE, sizeof(tx_queue_t), QUEUE_MAX_NUM_QUEUES);
+
+	default_max_length = QUEUE_MAX_LENGTH_UNLIMITED;
+	amsdu_max_length   = QUEUE_AMSDU_MAX_LENGTH_DEFAULT;
 
 	queue_state_change_callback = (function_ptr_t)wlan_null_callback;
 
@@ -187,15 +208,139 @@ u32 queue_num_free(){
  *
  *****************************************************************************/
 u32 queue_num_queued(u16 queue_sel){
-	if((queue_sel+1) > num_tx_queues){
+	tx_queue_t* queue = _queue_get(queue_sel);
+
+	if(queue == NULL){
 		return 0;
 	} else {
-		return tx_queues[queue_sel].length;
+		return queue->list.length;
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Set the maximum length of queues that do not have their own maximum
+ *
+ * @param  u16 max_length         - Maximum number of entries (QUEUE_MAX_LENGTH_UNLIMITED for no limit)
+ *
+ *****************************************************************************/
+void queue_set_default_max_length(u16 max_length){
+	if (max_length == QUEUE_MAX_LENGTH_DEFAULT) { max_length = QUEUE_MAX_LENGTH_UNLIMITED; }
+
+	default_max_length = max_length;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Set the maximum length of a given queue
+ *
+ * enqueue_after_tail() drops packets for a queue that already holds max_length
+ * entries. Lowering the maximum does not remove packets that are already queued.
+ *
+ * @param  u16 queue_sel          - ID of the queue
+ * @param  u16 max_length         - Maximum number of entries, QUEUE_MAX_LENGTH_UNLIMITED for no limit
+ *                                  or QUEUE_MAX_LENGTH_DEFAULT to follow queue_set_default_max_length()
+ *
+ *****************************************************************************/
+void queue_set_max_length(u16 queue_sel, u16 max_length){
+	if (_queue_create(queue_sel) == 0) {
+		tx_queues[queue_sel]->max_length = max_length;
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Maximum length of a given queue
+ *
+ * @param  u16 queue_sel          - ID of the queue
+ *
+ * @return u16                    - Maximum number of entries the queue will accept
+ *
+ *****************************************************************************/
+u16 queue_get_max_length(u16 queue_sel){
+	tx_queue_t* queue = _queue_get(queue_sel);
+
+	if ((queue == NULL) || (queue->max_length == QUEUE_MAX_LENGTH_DEFAULT)) {
+		return default_max_length;
+	} else {
+		return queue->max_length;
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Check whether a queue is at its maximum length
+ *
+ * The upper-level MAC should check this before filling a new queue entry
+ * since enqueue_after_tail() will drop the entry anyway.
+ *
+ * @param  u16 queue_sel          - ID of the queue
+ *
+ * @return u8                     - 1 if the queue is full, 0 otherwise
+ *
+ *****************************************************************************/
+u8 queue_is_full(u16 queue_sel){
+	return (queue_num_queued(queue_sel) >= queue_get_max_length(queue_sel));
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Enable or disable active queue management for a given queue
+ *
+ * AQM is enabled by default for every queue. It should be disabled for queues
+ * whose packets must not be dropped, such as the management queue, and while
+ * the packets of a queue are deliberately held (e.g. DTIM multicast buffering
+ * or a dozing power save station) so that the hold is not seen as queueing delay.
+ *
+ * The CoDel state of the queue is reset when the setting changes. Setting the
+ * current value again has no effect, so this can be called on every update.
+ *
+ * @param  u16 queue_sel          - ID of the queue
+ * @param  u8 enable              - 1 to enable CoDel drops at dequeue_from_head(), 0 to disable
+ *
+ *****************************************************************************/
+void queue_set_aqm_enable(u16 queue_sel, u8 enable){
+	enable = (enable != 0);
+
+	if ((_queue_create(queue_sel) == 0) && (tx_queues[queue_sel]->aqm_enable != enable)) {
+		tx_queues[queue_sel]->aqm_enable   = enable;
+		tx_queues[queue_sel]->aqm_dropping = 0;
+		tx_queues[queue_sel]->aqm_first_above_time = 0;
 	}
 }
 
 
 
+/*****************************************************************************/
+/**
+ * @brief  Set / get the maximum length of A-MSDUs
+ *
+ * The application passes this value to dequeue_amsdu_from_head() for
+ * receivers that support A-MSDUs.
+ *
+ * @param  u32 max_length         - Maximum MPDU length in bytes (including FCS); 0 disables A-MSDUs
+ *
+ *****************************************************************************/
+void queue_set_amsdu_max_length(u32 max_length){
+	amsdu_max_length = min(max_length, MAX_PKT_SIZE_B);
+}
+
+u32 queue_get_amsdu_max_length(){
+	return amsdu_max_length;
+}
+
+
+
 /*****************************************************************************/
 /**
  * @brief  Removes all Tx Queue entries in the selected queue
@@ -236,7 +381,7 @@ void purge_queue(u16 queue_sel){
 			//
 			prev_interrupt_state = wlan_mac_high_interrupt_stop();
 
-			curr_tx_queue_element = dequeue_from_head(queue_sel);
+			curr_tx_queue_element = _dequeue_from_head(queue_sel);
 
 			// Decrement the num_tx_queued field in the attached station_info_t. If this was the
 			// last queued packet for this station, this will allow the framework to recycle this
@@ -267,31 +412,25 @@ void purge_queue(u16 queue_sel){
  *                                  does not already exist.
  * @param  dl_entry* tqe  - Tx Queue entry containing packet for transmission
  *
+ * @return int                    - 0 if tqe was enqueued
+ *                                  -1 if tqe was dropped and returned to the free pool
+ *                                     because the queue is at its maximum length
+ *
  *****************************************************************************/
-void enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
-	u32 i;
-
-	// Create queues up to and including queue_sel if they don't already exist
-	// Queue IDs are low-valued integers, allowing for fast lookup by indexing the tx_queues array
-	if ((queue_sel + 1) > num_tx_queues) {
-		tx_queues = wlan_mac_high_realloc(tx_queues, ((queue_sel + 1) * sizeof(dl_list)));
+int enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
 
-		if(tx_queues == NULL){
-#if WLAN_SW_CONFIG_ENABLE_WLAN_EXP
-			wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Could not reallocate %d bytes for queue %d\n",
-			                ((queue_sel + 1) * sizeof(dl_list)), queue_sel);
-#endif
+	// Create queue_sel if it doesn't already exist
+	if ((_queue_create(queue_sel) != 0) || queue_is_full(queue_sel)) {
+		// Drop the packet
+		if (((tx_queue_buffer_t*)(tqe->data))->station_info != NULL) {
+			((tx_queue_buffer_t*)(tqe->data))->station_info->queue_drops.num_full++;
 		}
-
-		for(i = num_tx_queues; i <= queue_sel; i++){
-			dl_list_init(&(tx_queues[i]));
-		}
-
-		num_tx_queues = queue_sel + 1;
+		queue_checkin(tqe);
+		return -1;
 	}
 
 	// Insert the queue entry into the dl_list representing the selected queue
-	dl_entry_insertEnd(&(tx_queues[queue_sel]), (dl_entry*)tqe);
+	dl_entry_insertEnd(&(tx_queues[queue_sel]->list), (dl_entry*)tqe);
 
 	// Update the occupancy of the tx queue for the tx_queue_element
 	//     NOTE:  This is the best place to record this value since it will catch all cases.  However,
@@ -300,7 +439,7 @@ void enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
 	//         occupancy value includes itself.
 	//
 	((tx_queue_buffer_t*)(tqe->data))->queue_info.enqueue_timestamp = get_mac_time_usec();
-	((tx_queue_buffer_t*)(tqe->data))->queue_info.occupancy = (tx_queues[queue_sel].length & 0xFFFF);
+	((tx_queue_buffer_t*)(tqe->data))->queue_info.occupancy = (tx_queues[queue_sel]->list.length & 0xFFFF);
 	((tx_queue_buffer_t*)(tqe->data))->queue_info.id = queue_sel;
 
 	//Increment the num_tx_queued field in the attached station_info_t. This will prevent
@@ -308,7 +447,7 @@ void enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
 	// packet is enqueued.
 	((tx_queue_buffer_t*)(tqe->data))->station_info->num_tx_queued++;
 
-	if(tx_queues[queue_sel].length == 1){
+	if(tx_queues[queue_sel]->list.length == 1){
 		//If the queue element we just added is now the only member of this queue, we should inform
 		//the top-level MAC that the queue has transitioned from empty to non-empty.
 		queue_state_change_callback(queue_sel, 1);
@@ -317,7 +456,7 @@ void enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
     // Poll the TX queues to see if anything needs to be transmitted
 	tx_poll_callback();
 
-	return;
+	return 0;
 }
 
 
@@ -330,6 +469,11 @@ void enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
  * for the head entry in the queue. If the specified queue is empty this
  * function returns NULL.
  *
+ * If AQM is enabled for the queue, packets whose sojourn time in the queue
+ * calls for a CoDel drop are returned to the free pool here and counted in
+ * the queue_drops of their station_info. This can empty the queue, so NULL
+ * may be returned even if the queue was not empty.
+ *
  * @param  u16 queue_sel          - ID of the queue from which to dequeue an entry
  *
  * @return dl_entry *     - Pointer to queue entry if available,
@@ -337,23 +481,236 @@ void enqueue_after_tail(u16 queue_sel, dl_entry* tqe){
  *
  *****************************************************************************/
 dl_entry* dequeue_from_head(u16 queue_sel){
+	tx_queue_t* queue;
+	dl_entry* curr_dl_entry;
+	u64 curr_time;
+	u8 ok_to_drop;
+	u32 delta;
+
+	curr_dl_entry = _dequeue_from_head(queue_sel);
+	queue         = _queue_get(queue_sel);
+
+	if (curr_dl_entry == NULL) {
+		// The queue is empty (or does not exist) - leave the dropping state
+		if (queue != NULL) { queue->aqm_dropping = 0; }
+		return NULL;
+	}
+
+	if (queue->aqm_enable == 0) { return curr_dl_entry; }
+
+	// CoDel
+	//     NOTE:  This follows the pseudocode of RFC 8289 with the queue length
+	//         (in packets) used in place of the queue size in bytes.
+	//
+	curr_time  = get_mac_time_usec();
+	ok_to_drop = _queue_aqm_should_drop(queue, curr_dl_entry, curr_time);
+
+	if (queue->aqm_dropping) {
+		if (ok_to_drop == 0) {
+			// Sojourn time is below target - leave the dropping state
+			queue->aqm_dropping = 0;
+		} else {
+			while ((curr_time >= queue->aqm_drop_next) && queue->aqm_dropping) {
+				_queue_aqm_drop(curr_dl_entry);
+				queue->aqm_count++;
+
+				curr_dl_entry = _dequeue_from_head(queue_sel);
+
+				if (_queue_aqm_should_drop(queue, curr_dl_entry, curr_time) == 0) {
+					queue->aqm_dropping = 0;
+				} else {
+					queue->aqm_drop_next = _queue_aqm_control_law(queue->aqm_drop_next, queue->aqm_count);
+				}
+			}
+		}
+	} else if (ok_to_drop) {
+		// Enter the dropping state
+		_queue_aqm_drop(curr_dl_entry);
+		curr_dl_entry = _dequeue_from_head(queue_sel);
+		_queue_aqm_should_drop(queue, curr_dl_entry, curr_time);
+
+		queue->aqm_dropping = 1;
+
+		// If the queue was recently in the dropping state, resume from the drop
+		// rate that was reached at that time
+		delta = queue->aqm_count - queue->aqm_lastcount;
+
+		if ((delta > 1) && (curr_time < (queue->aqm_drop_next + (16 * QUEUE_AQM_INTERVAL_USEC)))) {
+			queue->aqm_count = delta;
+		} else {
+			queue->aqm_count = 1;
+		}
+
+		queue->aqm_drop_next = _queue_aqm_control_law(curr_time, queue->aqm_count);
+		queue->aqm_lastcount = queue->aqm_count;
+	}
+
+	return curr_dl_entry;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Removes the head entry from the specified queue and aggregates
+ *         the entries behind it into an A-MSDU
+ *
+ * The head entry is dequeued with dequeue_from_head(). While the next entry in
+ * the queue is a data frame for the same receiver and its MSDU fits in the
+ * remaining space, its MSDU is appended to the head entry as an A-MSDU
+ * subframe and the entry is returned to the free pool. The head entry is only
+ * converted to an A-MSDU if at least one other entry is aggregated into it.
+ *
+ * The caller must stop interrupts so the queue cannot change while it is
+ * being aggregated.
+ *
+ * @param  u16 queue_sel          - ID of the queue from which to dequeue an entry
+ * @param  u32 max_length         - Maximum length of the aggregated MPDU (including FCS)
+ *                                  0 disables aggregation
+ *
+ * @return dl_entry *     - Pointer to queue entry if available,
+ *                                  NULL if queue is empty
+ *
+ *****************************************************************************/
+dl_entry* dequeue_amsdu_from_head(u16 queue_sel, u32 max_length){
+	dl_entry* head_entry;
+	dl_entry* next_entry;
+	tx_queue_buffer_t* head;
+	tx_queue_buffer_t* next;
+	u32 amsdu_length;
+	int new_length;
+
+	head_entry = dequeue_from_head(queue_sel);
+
+	if ((head_entry == NULL) || (max_length == 0)) { return head_entry; }
+
+	max_length = min(max_length, MAX_PKT_SIZE_B);
+	head       = (tx_queue_buffer_t*)(head_entry->data);
+
+	// Length of the head entry once converted to a single-subframe A-MSDU
+	amsdu_length = head->length + sizeof(qos_control) + sizeof(amsdu_subframe_header);
+
+	while (1) {
+		next_entry = tx_queues[queue_sel]->list.first;
+
+		if (next_entry == NULL) { break; }
+
+		next = (tx_queue_buffer_t*)(next_entry->data);
+
+		if (_queue_amsdu_eligible(head, next) == 0) { break; }
+
+		if (head->frame[0] != MAC_FRAME_CTRL1_SUBTYPE_QOSDATA) {
+			// Only convert the head entry once it is known that a second subframe fits
+			if ((amsdu_length + AMSDU_SUBFRAME_PAD(amsdu_length - WLAN_PHY_FCS_NBYTES - sizeof(mac_header_80211) - sizeof(qos_control)) +
+			     sizeof(amsdu_subframe_header) + next->length - sizeof(mac_header_80211) - WLAN_PHY_FCS_NBYTES) > max_length) {
+				break;
+			}
+			head->length = wlan_create_amsdu_frame(head->frame, head->length);
+		}
+
+		new_length = wlan_append_amsdu_subframe(head->frame, head->length, next->frame, next->length, max_length);
+
+		if (new_length < 0) { break; }
+
+		head->length = new_length;
+
+		_dequeue_from_head(queue_sel);
+		next->station_info->num_tx_queued--;
+		queue_checkin(next_entry);
+	}
+
+	return head_entry;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Create the specified queue if it does not already exist
+ *
+ * Queue IDs are low-valued integers, allowing for fast lookup by indexing the
+ * tx_queues array
+ *
+ * @param  u16 queue_sel          - ID of the queue
+ *
+ * @return int                    - 0 on success, -1 if the queue could not be created
+ *
+ *****************************************************************************/
+static int _queue_create(u16 queue_sel){
+	tx_queue_t* queue;
+
+	if (queue_sel >= QUEUE_MAX_NUM_QUEUES) {
+#if WLAN_SW_CONFIG_ENABLE_WLAN_EXP
+		wlan_exp_printf(WLAN_EXP_PRINT_ERROR, print_type_queue, "Queue %d exceeds the maximum queue ID (%d)\n",
+		                queue_sel, (QUEUE_MAX_NUM_QUEUES - 1));
+#endif
+		return -1;
+	}
+
+	if (tx_queues[queue_sel] == NULL) {
+		queue = slab_calloc(&tx_queue_cache);
+
+		if (queue == NULL) { return -1; }
+
+		dl_list_init(&(queue->list));
+
+		queue->max_length = QUEUE_MAX_LENGTH_DEFAULT;
+		queue->aqm_enable = 1;
+
+		tx_queues[queue_sel] = queue;
+	}
+
+	return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Get the specified queue
+ *
+ * @param  u16 queue_sel          - ID of the queue
+ *
+ * @return tx_queue_t*            - Pointer to the queue or NULL if it has not been created
+ *
+ *****************************************************************************/
+static inline tx_queue_t* _queue_get(u16 queue_sel){
+	if (queue_sel >= QUEUE_MAX_NUM_QUEUES) { return NULL; }
+
+	return tx_queues[queue_sel];
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  Removes the head entry from the specified queue without AQM
+ *
+ * @param  u16 queue_sel          - ID of the queue from which to dequeue an entry
+ *
+ * @return dl_entry *     - Pointer to queue entry if available,
+ *                                  NULL if queue is empty
+ *
+ *****************************************************************************/
+static dl_entry* _dequeue_from_head(u16 queue_sel){
+	tx_queue_t* queue = _queue_get(queue_sel);
 	dl_entry* curr_dl_entry;
 
-	if ((queue_sel + 1) > num_tx_queues) {
+	if (queue == NULL) {
 		// The specified queue does not exist; this can happen if a node has
 		//     associated (has a valid AID = queue_sel) but no packet has ever
 		//     been enqueued to it, as queues are created upon first insertion
 		//     - see enqueue_after_tail()
 		return NULL;
 	} else {
-		if (tx_queues[queue_sel].length == 0) {
+		if (queue->list.length == 0) {
 			// Requested queue exists but is empty
 			return NULL;
 		} else {
-			curr_dl_entry = (tx_queues[queue_sel].first);
-			dl_entry_remove(&tx_queues[queue_sel], curr_dl_entry);
+			curr_dl_entry = (queue->list.first);
+			dl_entry_remove(&(queue->list), curr_dl_entry);
 
-			if(tx_queues[queue_sel].length == 0){
+			if(queue->list.length == 0){
 				//If the queue element we just removed empties the queue, we should inform
 				//the top-level MAC that the queue has transitioned from non-empty to empty.
 				queue_state_change_callback(queue_sel, 0);
@@ -365,6 +722,118 @@ dl_entry* dequeue_from_head(u16 queue_sel){
 
 
 
+/*****************************************************************************/
+/**
+ * @brief  Check whether a queued entry can be aggregated into the A-MSDU of
+ *         the head entry
+ *
+ * Both entries must be non-QoS data frames (or, for the head entry, already
+ * converted to an A-MSDU) with the same receiver, To DS / From DS flags and
+ * Tx queue buffer flags. Entries that need per-MPDU treatment on Tx
+ * (timestamps or unique sequence numbers) are never aggregated.
+ *
+ * @param  tx_queue_buffer_t* head             - Head entry
+ * @param  tx_queue_buffer_t* tx_queue_buffer  - Candidate entry
+ *
+ * @return u8                     - 1 if the entry can be aggregated, 0 otherwise
+ *
+ *****************************************************************************/
+static u8 _queue_amsdu_eligible(tx_queue_buffer_t* head, tx_queue_buffer_t* tx_queue_buffer){
+	mac_header_80211* head_header = (mac_header_80211*)(head->frame);
+	mac_header_80211* header      = (mac_header_80211*)(tx_queue_buffer->frame);
+
+	if ((head->flags & ~TX_QUEUE_BUFFER_FLAGS_FILL_DURATION) || (tx_queue_buffer->flags != head->flags)) { return 0; }
+
+	if ((head_header->frame_control_1 != MAC_FRAME_CTRL1_SUBTYPE_DATA) &&
+	    (head_header->frame_control_1 != MAC_FRAME_CTRL1_SUBTYPE_QOSDATA)) { return 0; }
+
+	if (header->frame_control_1 != MAC_FRAME_CTRL1_SUBTYPE_DATA) { return 0; }
+
+	if (header->frame_control_2 != head_header->frame_control_2) { return 0; }
+
+	if (tx_queue_buffer->station_info != head->station_info) { return 0; }
+
+	return wlan_addr_eq(header->address_1, head_header->address_1);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief  CoDel helper functions
+ *
+ * _queue_aqm_should_drop() checks the sojourn time of a dequeued entry and
+ * tracks how long it has been above QUEUE_AQM_TARGET_USEC. _queue_aqm_drop()
+ * returns a dequeued entry to the free pool. _queue_aqm_control_law() returns
+ * the time of the next drop, t + QUEUE_AQM_INTERVAL_USEC / sqrt(count).
+ *
+ *****************************************************************************/
+static u8 _queue_aqm_should_drop(tx_queue_t* queue, dl_entry* tqe, u64 curr_time){
+	u64 enqueue_timestamp;
+
+	if (tqe == NULL) {
+		queue->aqm_first_above_time = 0;
+		return 0;
+	}
+
+	enqueue_timestamp = ((tx_queue_buffer_t*)(tqe->data))->queue_info.enqueue_timestamp;
+
+	// Do not drop if the sojourn time is below target or if this is the last
+	// packet in the queue
+	//     NOTE:  MAC time can be moved backwards (e.g. when adopting the timestamp
+	//         of a BSS), so an enqueue timestamp in the future is a sojourn time of 0.
+	if ((curr_time < (enqueue_timestamp + QUEUE_AQM_TARGET_USEC)) || (queue->list.length == 0)) {
+		queue->aqm_first_above_time = 0;
+		return 0;
+	}
+
+	if (queue->aqm_first_above_time == 0) {
+		queue->aqm_first_above_time = curr_time + QUEUE_AQM_INTERVAL_USEC;
+		return 0;
+	}
+
+	return (curr_time >= queue->aqm_first_above_time);
+}
+
+
+static void _queue_aqm_drop(dl_entry* tqe){
+	station_info_t* station_info = ((tx_queue_buffer_t*)(tqe->data))->station_info;
+
+	// Release the hold that this packet had on the station_info_t
+	station_info->num_tx_queued--;
+	station_info->queue_drops.num_aqm++;
+
+	queue_checkin(tqe);
+}
+
+
+static u64 _queue_aqm_control_law(u64 t, u32 count){
+	u32 x;
+	u32 root;
+	u32 bit;
+
+	// Integer square root of (count << 16), i.e. 256 * sqrt(count)
+	x    = min(count, 0xFFFF) << 16;
+	root = 0;
+	bit  = 1 << 30;
+
+	while (bit > x) { bit >>= 2; }
+
+	while (bit != 0) {
+		if (x >= (root + bit)) {
+			x    -= (root + bit);
+			root  = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return t + ((QUEUE_AQM_INTERVAL_USEC << 8) / root);
+}
+
+
+
 /*****************************************************************************/
 /**
  * @brief  Checks out one queue entry from the free pool
@@ -513,21 +982,28 @@ int queue_checkin_list(dl_list * list) {
 
 void transmit_checkin(dl_entry* tx_queue_buffer_entry){
 	int tx_pkt_buf = -1;
-	tx_pkt_buf = wlan_mac_high_get_empty_tx_packet_buffer();
+	int handoff_status;
 
+	// Check the entry before claiming a packet buffer that could not be released otherwise
 	if (tx_queue_buffer_entry == NULL) return;
 
+	tx_pkt_buf = wlan_mac_high_get_empty_tx_packet_buffer();
+
 	if( tx_pkt_buf != -1 ){
 		// Transmit the Tx Queue element
 		//     NOTE:  This copies all the contents of the queue element to the
 		//         packet buffer so that the queue element can be safely returned
 		//         to the free pool
-		wlan_mac_high_mpdu_transmit(tx_queue_buffer_entry, tx_pkt_buf);
+		handoff_status = wlan_mac_high_mpdu_transmit(tx_queue_buffer_entry, tx_pkt_buf);
 
 		// Decrement the num_tx_queued field in the attached station_info_t. If this was the
 		// last queued packet for this station, this will allow the framework to recycle this
 		// station_info_t if it also has not been flagged as something to keep.
 		((tx_queue_buffer_t*)(tx_queue_buffer_entry->data))->station_info->num_tx_queued--;
+
+		// The copy out of the Tx Queue element is still in flight. It will be checked in
+		// by wlan_mac_high_mpdu_transmit_complete().
+		if(handoff_status == TX_HANDOFF_PENDING) return;
 	} else {
 		xil_printf("Error in transmit_checkin(): no free Tx packet buffers. Packet was freed without being sent\n");
 	}
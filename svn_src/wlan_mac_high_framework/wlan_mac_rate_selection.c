@@ -0,0 +1,312 @@
+/** @file wlan_mac_rate_selection.c
+ *  @brief Rate Selection
+ *
+ *  This contains code for per-station adaptive Tx rate selection.
+ *
+ *  The MINSTREL scheme follows the Minstrel algorithm: every Tx report for a
+ *  unicast data MPDU updates attempt / success counters for the MCS that was
+ *  used. Once per update interval the counters are folded into an EWMA success
+ *  probability for each MCS, which is combined with the airtime of a reference
+ *  frame to estimate the goodput at that MCS. Data frames are sent at the MCS
+ *  with the best estimated goodput, except for a fraction of frames that sample
+ *  other rates so that the statistics follow changes in the channel.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+/***************************** Include Files *********************************/
+
+#include "wlan_mac_high_sw_config.h"
+
+#include "xil_types.h"
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+
+#include "wlan_mac_common.h"
+#include "wlan_platform_common.h"
+#include "wlan_platform_high.h"
+#include "wlan_mac_pkt_buf_util.h"
+#include "wlan_mac_rate_selection.h"
+
+
+/*************************** Constant Definitions ****************************/
+
+// Goodput (in kbps) of a 1200-byte reference frame at probability 1.0 is
+//     (1200 * 8 * 1000 / airtime_usec) = (RATE_SELECTION_REF_KBPS_USEC * RATE_SELECTION_PROB_SCALE) / airtime_usec
+#define RATE_SELECTION_REF_KBPS_USEC                       2344
+
+
+/*************************** Variable Definitions ****************************/
+
+// Airtime (in usec) of one attempt of a 1200-byte MPDU at 20 MSps, including
+// DIFS, the mean CWmin backoff, SIFS and the ACK at the mandatory control rate.
+// Indexed by MCS; computed with the same formula as wlan_ofdm_calc_txtime().
+static const u16 rate_selection_airtime_nonht[RATE_SELECTION_NUM_RATES] = {1797, 1265, 985, 717, 581, 445, 381, 357};
+static const u16 rate_selection_airtime_htmf[RATE_SELECTION_NUM_RATES]  = {1693,  941, 693, 565, 441, 381, 361, 345};
+
+
+/*************************** Functions Prototypes ****************************/
+
+static void rate_selection_update_stats(rate_selection_info_t* rate_info);
+static u8   rate_selection_get_sample_mcs(rate_selection_info_t* rate_info);
+
+
+/******************************** Functions **********************************/
+
+static inline const u16* rate_selection_get_airtime_table(u8 phy_mode){
+	if(phy_mode == PHY_MODE_HTMF){
+		return rate_selection_airtime_htmf;
+	} else {
+		return rate_selection_airtime_nonht;
+	}
+}
+
+/**
+ * @brief Initialize Rate Selection Information
+ *
+ * @param  rate_selection_info_t* rate_info
+ *     - Rate selection state to initialize
+ * @param  u16 scheme
+ *     - Rate selection scheme (RATE_SELECTION_SCHEME_*)
+ * @param  phy_tx_params_t* phy_params
+ *     - Configured PHY Tx parameters. The MCS is used as the starting rate and the
+ *       PHY mode selects which rate table the statistics apply to.
+ * @return None
+ */
+void rate_selection_init_info(rate_selection_info_t* rate_info, u16 scheme, phy_tx_params_t* phy_params){
+	u32 i;
+	u8  mcs = min(phy_params->mcs, RATE_SELECTION_NUM_RATES - 1);
+
+	bzero(rate_info, sizeof(rate_selection_info_t));
+
+	rate_info->rate_selection_scheme = scheme;
+	rate_info->phy_mode              = phy_params->phy_mode;
+	rate_info->max_tp_mcs            = mcs;
+	rate_info->max_tp2_mcs           = mcs;
+	rate_info->max_prob_mcs          = mcs;
+	rate_info->sample_mcs            = mcs;
+	rate_info->sample_countdown      = RATE_SELECTION_SAMPLE_INTERVAL;
+	rate_info->last_update_timestamp = get_system_time_usec();
+
+	for(i = 0; i < RATE_SELECTION_NUM_RATES; i++){
+		rate_info->stats[i].prob = RATE_SELECTION_PROB_UNKNOWN;
+	}
+}
+
+/**
+ * @brief Process a Tx Report
+ *
+ * Accumulates the result of one low-level MPDU attempt. This should only be
+ * called for unicast data MPDUs so that management frames sent at a different
+ * rate do not affect the statistics.
+ *
+ * @param  rate_selection_info_t* rate_info
+ *     - Rate selection state of the receiving station
+ * @param  wlan_mac_low_tx_details_t* wlan_mac_low_tx_details
+ *     - Tx details from CPU Low for this attempt
+ * @return None
+ */
+void rate_selection_txreport_process(rate_selection_info_t* rate_info, wlan_mac_low_tx_details_t* wlan_mac_low_tx_details){
+	rate_selection_stats_t* stats;
+	u8 mcs = wlan_mac_low_tx_details->phy_params_mpdu.mcs;
+
+	if(rate_info->rate_selection_scheme != RATE_SELECTION_SCHEME_MINSTREL) return;
+
+	if((wlan_mac_low_tx_details->tx_details_type != TX_DETAILS_MPDU) &&
+	   (wlan_mac_low_tx_details->tx_details_type != TX_DETAILS_RTS_MPDU)) return;
+
+	if((wlan_mac_low_tx_details->phy_params_mpdu.phy_mode != rate_info->phy_mode) ||
+	   (mcs >= RATE_SELECTION_NUM_RATES)) return;
+
+	stats = &(rate_info->stats[mcs]);
+
+	if(stats->attempts < 0xFFFF){
+		stats->attempts++;
+
+		if(wlan_mac_low_tx_details->flags & TX_DETAILS_FLAGS_RECEIVED_RESPONSE){
+			stats->successes++;
+		}
+	}
+
+	if((get_system_time_usec() - rate_info->last_update_timestamp) >= RATE_SELECTION_UPDATE_INTERVAL_USEC){
+		rate_selection_update_stats(rate_info);
+	}
+}
+
+/**
+ * @brief Apply Rate Selection to Tx Parameters
+ *
+ * Overwrites the MCS of the PHY Tx parameters for a unicast data frame
+ * with the rate chosen by the station's rate selection scheme.
+ *
+ * @param  rate_selection_info_t* rate_info
+ *     - Rate selection state of the destination station
+ * @param  phy_tx_params_t* phy_params
+ *     - PHY Tx parameters that will be used for the frame
+ * @return None
+ */
+void rate_selection_apply(rate_selection_info_t* rate_info, phy_tx_params_t* phy_params){
+
+	if(rate_info->rate_selection_scheme != RATE_SELECTION_SCHEME_MINSTREL) return;
+
+	if(phy_params->phy_mode != rate_info->phy_mode){
+		// The configured PHY mode changed, so the statistics no longer apply
+		rate_selection_init_info(rate_info, rate_info->rate_selection_scheme, phy_params);
+	}
+
+	if(--(rate_info->sample_countdown) == 0){
+		rate_info->sample_countdown = RATE_SELECTION_SAMPLE_INTERVAL;
+		phy_params->mcs = rate_selection_get_sample_mcs(rate_info);
+	} else {
+		phy_params->mcs = rate_info->max_tp_mcs;
+	}
+}
+
+/**
+ * @brief Get the Next Sampling Rate
+ *
+ * Rotates through the rate table and returns the first MCS, other than the
+ * current best, that has not been tried yet or whose ideal goodput is higher
+ * than the current best estimate. Slower rates that cannot improve throughput
+ * are skipped; they are still reached through max_tp_mcs when the faster rates
+ * stop being acknowledged.
+ *
+ * CPU Low retries a frame at the rate it was submitted with, so a sampling
+ * frame sent far above a failing link costs the whole retry budget. Sampling
+ * is therefore limited to one MCS above the current best rate.
+ *
+ * @param  rate_selection_info_t* rate_info
+ *     - Rate selection state
+ * @return u8
+ *     - MCS to sample (max_tp_mcs if no rate is worth sampling)
+ */
+static u8 rate_selection_get_sample_mcs(rate_selection_info_t* rate_info){
+	u32 i;
+	u8  mcs;
+	const u16* airtime = rate_selection_get_airtime_table(rate_info->phy_mode);
+	u32 curr_tp = rate_info->stats[rate_info->max_tp_mcs].throughput;
+
+	for(i = 0; i < RATE_SELECTION_NUM_RATES; i++){
+		mcs = rate_info->sample_mcs;
+		rate_info->sample_mcs = (rate_info->sample_mcs + 1) & (RATE_SELECTION_NUM_RATES - 1);
+
+		if((mcs == rate_info->max_tp_mcs) || (mcs > (rate_info->max_tp_mcs + 1))) continue;
+
+		if((rate_info->stats[mcs].prob == RATE_SELECTION_PROB_UNKNOWN) ||
+		   ((curr_tp * airtime[mcs]) < (RATE_SELECTION_REF_KBPS_USEC * RATE_SELECTION_PROB_SCALE))){
+			return mcs;
+		}
+	}
+
+	return rate_info->max_tp_mcs;
+}
+
+/**
+ * @brief Update Rate Statistics
+ *
+ * Folds the counters of the interval that just ended into the EWMA success
+ * probabilities and picks new best-throughput and best-probability rates.
+ *
+ * @param  rate_selection_info_t* rate_info
+ *     - Rate selection state
+ * @return None
+ */
+static void rate_selection_update_stats(rate_selection_info_t* rate_info){
+	u32 i;
+	s32 prob;
+	s32 interval_prob;
+	u8  max_tp   = 0;
+	u8  max_tp2  = 0;
+	u8  max_prob = 0;
+	u8  found    = 0;
+	rate_selection_stats_t* stats = rate_info->stats;
+	const u16* airtime = rate_selection_get_airtime_table(rate_info->phy_mode);
+
+	for(i = 0; i < RATE_SELECTION_NUM_RATES; i++){
+		if(stats[i].attempts >= RATE_SELECTION_MIN_ATTEMPTS){
+			interval_prob = (stats[i].successes * RATE_SELECTION_PROB_SCALE) / stats[i].attempts;
+
+			if(stats[i].prob == RATE_SELECTION_PROB_UNKNOWN){
+				prob = interval_prob;
+			} else {
+				prob = stats[i].prob;
+				prob += (interval_prob - prob) >> RATE_SELECTION_EWMA_SHIFT;
+			}
+			stats[i].prob = (u16)prob;
+
+			// Rates that rarely succeed are not useful even if they are fast
+			if(prob < RATE_SELECTION_PROB_MIN){
+				stats[i].throughput = 0;
+			} else {
+				stats[i].throughput = (prob * RATE_SELECTION_REF_KBPS_USEC) / airtime[i];
+			}
+
+			stats[i].attempts  = 0;
+			stats[i].successes = 0;
+		}
+
+		if(stats[i].prob == RATE_SELECTION_PROB_UNKNOWN) continue;
+
+		if(found == 0){
+			max_tp   = i;
+			max_tp2  = i;
+			max_prob = i;
+			found    = 1;
+			continue;
+		}
+
+		if(stats[i].throughput > stats[max_tp].throughput){
+			max_tp2 = max_tp;
+			max_tp  = i;
+		} else if((stats[i].throughput > stats[max_tp2].throughput) || (max_tp2 == max_tp)){
+			max_tp2 = i;
+		}
+
+		// Ties go to the faster rate
+		if(stats[i].prob >= stats[max_prob].prob){
+			max_prob = i;
+		}
+	}
+
+	if(found){
+		if(stats[max_tp].throughput == 0){
+			// Every rate tried so far is failing; fall back to the most reliable one
+			max_tp = max_prob;
+		}
+		rate_info->max_tp_mcs   = max_tp;
+		rate_info->max_tp2_mcs  = max_tp2;
+		rate_info->max_prob_mcs = max_prob;
+	}
+
+	rate_info->last_update_timestamp = get_system_time_usec();
+}
+
+void rate_selection_print(rate_selection_info_t* rate_info){
+	u32 i;
+
+	switch(rate_info->rate_selection_scheme){
+		case RATE_SELECTION_SCHEME_STATIC:
+			xil_printf(" Rate selection:             STATIC\n");
+		break;
+		case RATE_SELECTION_SCHEME_MINSTREL:
+			xil_printf(" Rate selection:             MINSTREL (best %d, second %d, max prob %d)\n",
+					   rate_info->max_tp_mcs, rate_info->max_tp2_mcs, rate_info->max_prob_mcs);
+
+			for(i = 0; i < RATE_SELECTION_NUM_RATES; i++){
+				if(rate_info->stats[i].prob != RATE_SELECTION_PROB_UNKNOWN){
+					xil_printf("   MCS %d: prob %4d/%d, %5d kbps\n", i, rate_info->stats[i].prob,
+							   RATE_SELECTION_PROB_SCALE, rate_info->stats[i].throughput);
+				}
+			}
+		break;
+		default:
+			xil_printf(" Rate selection:             UNKNOWN (%d)\n", rate_info->rate_selection_scheme);
+		break;
+	}
+}
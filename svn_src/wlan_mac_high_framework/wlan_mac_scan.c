@@ -35,6 +35,14 @@
  * and the interval to change channels.  There is no error checking on the scan
  * timing parameters.
  *
+ * If min_dwell_usec is non-zero, the dwell on each channel is adaptive.  Every
+ * min_dwell_usec the scan checks the receptions reported by
+ * wlan_mac_scan_rx_notify() since the last check.  A quiet channel is left
+ * early; a channel where beacons / probe responses are still arriving is kept
+ * past time_per_channel_usec up to max_dwell_usec.  If the
+ * SCAN_FLAG_ORDER_BY_NETWORK_INFO flag is set, each pass through the channel
+ * list visits the channels with the most recently seen networks first.
+ *
  */
 
 /***************************** Include Files *********************************/
@@ -48,7 +56,12 @@
 #include "string.h"
 
 // WLAN includes
+#include "wlan_platform_common.h"
 #include "wlan_mac_high.h"
+#include "wlan_mac_pkt_buf_util.h"
+#include "wlan_mac_802_11_defs.h"
+#include "wlan_mac_dl_list.h"
+#include "wlan_mac_network_info.h"
 #include "wlan_mac_packet_types.h"
 #include "wlan_mac_schedule.h"
 #include "wlan_mac_scan.h"
@@ -85,6 +98,22 @@ static u32 probe_sched_id;
 static scan_state_t scan_state;
 static int num_full_scans;
 
+// Adaptive dwell state variables
+static u8  curr_scan_chan;
+static u8  curr_chan_extended;
+static u32 curr_chan_window_rx;
+static u32 curr_chan_window_responses;
+static u64 curr_chan_start_usec;
+static u64 full_scan_start_usec;
+
+// Channel order for the current pass
+//     - Indexes into channel_vec followed by the per-channel hit counts
+//     - NULL when channels are visited in channel_vec order
+static u8* scan_chan_order;
+static u32 scan_chan_order_len;
+
+static scan_stats_t scan_stats;
+
 
 // Callback Function
 //     Used to transmit probe requests during the scan process
@@ -96,6 +125,11 @@ volatile function_ptr_t scan_state_change_callback;
 /*************************** Functions Prototypes ****************************/
 
 void wlan_mac_scan_state_transition();
+void wlan_mac_scan_dwell_check();
+
+static void _wlan_mac_scan_end_dwell(u64 curr_time);
+static void _wlan_mac_scan_update_channel_order();
+static void _wlan_mac_scan_free_channel_order();
 
 
 /******************************** Functions **********************************/
@@ -127,6 +161,9 @@ int wlan_mac_scan_init(){
     gl_scan_parameters.probe_tx_interval_usec   = DEFAULT_SCAN_PROBE_TX_INTERVAL_USEC;
     gl_scan_parameters.time_per_channel_usec    = DEFAULT_SCAN_TIME_PER_CHANNEL_USEC;
     gl_scan_parameters.ssid                     = strndup("", SSID_LEN_MAX);
+    gl_scan_parameters.min_dwell_usec           = DEFAULT_SCAN_MIN_DWELL_USEC;
+    gl_scan_parameters.max_dwell_usec           = DEFAULT_SCAN_MAX_DWELL_USEC;
+    gl_scan_parameters.flags                    = DEFAULT_SCAN_FLAGS;
 
     // Set global scan parameters
     //     - Other global variables will be initialized when wlan_mac_scan_start() is called
@@ -134,6 +171,11 @@ int wlan_mac_scan_init(){
     probe_sched_id = SCHEDULE_ID_RESERVED_MAX;
     scan_state     = SCAN_IDLE;
 
+    scan_chan_order     = NULL;
+    scan_chan_order_len = 0;
+
+    wlan_mac_scan_reset_stats();
+
     return XST_SUCCESS;
 }
 
@@ -185,7 +227,9 @@ void wlan_mac_scan_start(){
         num_full_scans = -1;
 
         // Initialize scan variables
-        curr_scan_chan_idx = -1;
+        curr_scan_chan_idx   = -1;
+        curr_chan_start_usec = 0;
+        full_scan_start_usec = 0;
         scan_state = SCAN_RUNNING;
         scan_state_change_callback(scan_state);
 
@@ -231,6 +275,12 @@ void wlan_mac_scan_stop() {
         // Restore interrupt state
         wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 
+        // Account for the time spent on the last channel
+        _wlan_mac_scan_end_dwell(get_system_time_usec());
+
+        // Channel list may change before the next scan
+        _wlan_mac_scan_free_channel_order();
+
         // Update scan state variables
         curr_scan_chan_idx = -1;
         scan_state = SCAN_IDLE;
@@ -272,6 +322,9 @@ void wlan_mac_scan_pause(){
         // Restore interrupt state
         wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
 
+        // Time spent paused does not count as dwell time
+        _wlan_mac_scan_end_dwell(get_system_time_usec());
+
         // Update scan state variables
         scan_state = SCAN_PAUSED;
         scan_state_change_callback(scan_state);
@@ -334,6 +387,7 @@ u32 wlan_mac_scan_is_scanning(){
  *
  *****************************************************************************/
 void wlan_mac_scan_state_transition(){
+    u64 curr_time = get_system_time_usec();
 
     // Remove existing scheduled probe requests
     if (probe_sched_id != SCHEDULE_ID_RESERVED_MAX) {
@@ -341,15 +395,40 @@ void wlan_mac_scan_state_transition(){
         probe_sched_id = SCHEDULE_ID_RESERVED_MAX;
     }
 
-    // Update the channel
+    // Account for the time spent on the previous channel
+    _wlan_mac_scan_end_dwell(curr_time);
+
+    // Update the channel index
     curr_scan_chan_idx = (curr_scan_chan_idx + 1) % (gl_scan_parameters.channel_vec_len);
-    wlan_mac_high_set_radio_channel(gl_scan_parameters.channel_vec[(u8)curr_scan_chan_idx]);
 
     // Update the number of full scan loops variable
     if (curr_scan_chan_idx == 0) {
         num_full_scans++;
+
+        if (full_scan_start_usec != 0) {
+            scan_stats.last_full_scan_usec = (u32)(curr_time - full_scan_start_usec);
+        }
+        full_scan_start_usec = curr_time;
+
+        // Re-order the channels at the start of each pass
+        _wlan_mac_scan_update_channel_order();
     }
 
+    // Update the channel
+    if (scan_chan_order != NULL) {
+        curr_scan_chan = gl_scan_parameters.channel_vec[scan_chan_order[(u8)curr_scan_chan_idx]];
+    } else {
+        curr_scan_chan = gl_scan_parameters.channel_vec[(u8)curr_scan_chan_idx];
+    }
+    wlan_mac_high_set_radio_channel(curr_scan_chan);
+
+    // Start the dwell on the new channel
+    curr_chan_start_usec       = curr_time;
+    curr_chan_extended         = 0;
+    curr_chan_window_rx        = 0;
+    curr_chan_window_responses = 0;
+    scan_stats.num_channels_visited++;
+
     // Send a probe request
     //     - A probe interval of 0 results in a passive scan
     if (gl_scan_parameters.probe_tx_interval_usec > 0) {
@@ -365,12 +444,216 @@ void wlan_mac_scan_state_transition(){
     // Schedule the scan state transition
     //     - This will only be executed when moving from IDLE to RUNNING
     //     - The scheduled event will only be stopped when scan is paused or stopped
+    //     - With an adaptive dwell, the event checks the channel every min_dwell_usec
+    //       and calls wlan_mac_scan_state_transition() when it is time to move on
     //
     if (scan_sched_id == SCHEDULE_ID_RESERVED_MAX) {
-        scan_sched_id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, gl_scan_parameters.time_per_channel_usec, SCHEDULE_REPEAT_FOREVER, (void*)wlan_mac_scan_state_transition);
+        if (gl_scan_parameters.min_dwell_usec > 0) {
+            scan_sched_id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, gl_scan_parameters.min_dwell_usec, SCHEDULE_REPEAT_FOREVER, (void*)wlan_mac_scan_dwell_check);
+        } else {
+            scan_sched_id = wlan_mac_schedule_event_repeated(SCHEDULE_FINE, gl_scan_parameters.time_per_channel_usec, SCHEDULE_REPEAT_FOREVER, (void*)wlan_mac_scan_state_transition);
+        }
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Adaptive dwell check
+ *
+ * This internal function is called every min_dwell_usec when the adaptive
+ * dwell is enabled.  It decides from the receptions since the last check
+ * whether to stay on the current channel:
+ *     - No receptions                       -> leave the channel
+ *     - Dwell has reached max_dwell_usec    -> leave the channel
+ *     - Dwell has reached time_per_channel_usec and no beacons / probe
+ *       responses were received             -> leave the channel
+ *
+ *****************************************************************************/
+void wlan_mac_scan_dwell_check(){
+    u32 dwell_usec = (u32)(get_system_time_usec() - curr_chan_start_usec);
+    u32 leave      = 0;
+
+    if (curr_chan_window_rx == 0) {
+        leave = 1;
+    } else if (dwell_usec >= gl_scan_parameters.max_dwell_usec) {
+        leave = 1;
+    } else if (dwell_usec >= gl_scan_parameters.time_per_channel_usec) {
+        if (curr_chan_window_responses == 0) {
+            leave = 1;
+        } else if (curr_chan_extended == 0) {
+            curr_chan_extended = 1;
+            scan_stats.num_extensions++;
+        }
+    }
+
+    // Start a new observation window
+    curr_chan_window_rx        = 0;
+    curr_chan_window_responses = 0;
+
+    if (leave) {
+        if (dwell_usec < gl_scan_parameters.time_per_channel_usec) {
+            scan_stats.num_early_exits++;
+        }
+        wlan_mac_scan_state_transition();
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Note a reception for the adaptive dwell
+ *
+ * This function must be called for every reception passed up by CPU Low.  Any
+ * reception on the current scan channel counts as activity; beacons and probe
+ * responses with a good FCS also count as responses.
+ *
+ * @param   pkt_buf_addr     - Address of the Rx packet buffer
+ *
+ *****************************************************************************/
+void wlan_mac_scan_rx_notify(void* pkt_buf_addr){
+    rx_frame_info_t*  rx_frame_info = (rx_frame_info_t*)pkt_buf_addr;
+    mac_header_80211* rx_80211_header;
+
+    if ((scan_state != SCAN_RUNNING) || (rx_frame_info->channel != curr_scan_chan)) {
+        return;
+    }
+
+    curr_chan_window_rx++;
+    scan_stats.num_rx++;
+
+    if (rx_frame_info->flags & RX_FRAME_INFO_FLAGS_FCS_GOOD) {
+        rx_80211_header = (mac_header_80211*)((u8*)pkt_buf_addr + PHY_RX_PKT_BUF_MPDU_OFFSET);
+
+        if ((rx_80211_header->frame_control_1 == MAC_FRAME_CTRL1_SUBTYPE_BEACON) ||
+            (rx_80211_header->frame_control_1 == MAC_FRAME_CTRL1_SUBTYPE_PROBE_RESP)) {
+            curr_chan_window_responses++;
+            scan_stats.num_responses++;
+        }
     }
 }
 
+
+
+/*****************************************************************************/
+/**
+ * End the dwell on the current channel
+ *
+ * @param   curr_time        - Current system time (in microseconds)
+ *
+ *****************************************************************************/
+static void _wlan_mac_scan_end_dwell(u64 curr_time){
+    if (curr_chan_start_usec != 0) {
+        scan_stats.total_dwell_usec += (curr_time - curr_chan_start_usec);
+        curr_chan_start_usec = 0;
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Update the channel order for the next pass
+ *
+ * When SCAN_FLAG_ORDER_BY_NETWORK_INFO is set, the channels are sorted by the
+ * number of network_info_t entries heard on them in the last
+ * SCAN_CHANNEL_ORDER_WINDOW_USEC.  The sort is stable so channels without any
+ * hits keep their channel_vec order.
+ *
+ *****************************************************************************/
+static void _wlan_mac_scan_update_channel_order(){
+    u32                   i;
+    u32                   j;
+    u8                    tmp;
+    u8                    chan;
+    u8*                   hits;
+    u32                   len = gl_scan_parameters.channel_vec_len;
+    u64                   curr_time = get_system_time_usec();
+    network_info_entry_t* curr_network_info_entry;
+    network_info_t*       curr_network_info;
+
+    if (((gl_scan_parameters.flags & SCAN_FLAG_ORDER_BY_NETWORK_INFO) == 0) || (len > 0xFF)) {
+        _wlan_mac_scan_free_channel_order();
+        return;
+    }
+
+    // Order indexes and hit counts share one allocation
+    if (scan_chan_order_len != len) {
+        _wlan_mac_scan_free_channel_order();
+
+        scan_chan_order = wlan_mac_high_malloc(2 * len);
+        if (scan_chan_order == NULL) { return; }
+
+        scan_chan_order_len = len;
+    }
+
+    hits = scan_chan_order + len;
+
+    for (i = 0; i < len; i++) {
+        scan_chan_order[i] = i;
+        hits[i]            = 0;
+    }
+
+    // Count recent networks per channel
+    curr_network_info_entry = (network_info_entry_t*)(wlan_mac_high_get_network_info_list()->first);
+
+    while (curr_network_info_entry != NULL) {
+        curr_network_info = curr_network_info_entry->data;
+
+        if ((curr_time - curr_network_info->latest_beacon_rx_time) < SCAN_CHANNEL_ORDER_WINDOW_USEC) {
+            chan = wlan_mac_high_bss_channel_spec_to_radio_chan(curr_network_info->bss_config.chan_spec);
+
+            for (i = 0; i < len; i++) {
+                if (gl_scan_parameters.channel_vec[i] == chan) {
+                    if (hits[i] < 0xFF) { hits[i]++; }
+                    break;
+                }
+            }
+        }
+
+        curr_network_info_entry = dl_entry_next(curr_network_info_entry);
+    }
+
+    // Stable insertion sort by descending hit count
+    for (i = 1; i < len; i++) {
+        tmp = scan_chan_order[i];
+
+        for (j = i; (j > 0) && (hits[scan_chan_order[j - 1]] < hits[tmp]); j--) {
+            scan_chan_order[j] = scan_chan_order[j - 1];
+        }
+
+        scan_chan_order[j] = tmp;
+    }
+}
+
+
+
+static void _wlan_mac_scan_free_channel_order(){
+    if (scan_chan_order != NULL) {
+        wlan_mac_high_free(scan_chan_order);
+        scan_chan_order = NULL;
+    }
+    scan_chan_order_len = 0;
+}
+
+
+
 int wlan_mac_scan_get_num_scans(){
     return num_full_scans;
 }
+
+
+
+/*****************************************************************************/
+/**
+ * Get / reset the scan statistics
+ *
+ *****************************************************************************/
+scan_stats_t* wlan_mac_scan_get_stats(){
+    return &scan_stats;
+}
+void wlan_mac_scan_reset_stats(){
+    memset(&scan_stats, 0, sizeof(scan_stats_t));
+}
@@ -19,19 +19,24 @@
 #include "xil_types.h"
 #include "xil_exception.h"
 
+#include "stdio.h"
+#include "string.h"
+
 #include "wlan_platform_high.h"
 #include "wlan_platform_common.h"
 #include "xtmrctr.h"
 #include "xintc.h"
 
+#include "wlan_mac_common.h"
 #include "wlan_mac_high.h"
 #include "wlan_mac_dl_list.h"
 #include "wlan_mac_schedule.h"
-
+#include "wlan_mac_slab.h"
 
 /*************************** Constant Definitions *****************************/
 
-#define WLAN_SCHED_EXEC_MONITOR                            0
+#define WLAN_SCHED_EXEC_MONITOR                            1              // Histogram of time between executions (see CMDID_DEV_SCHED_EXEC_MONITOR)
+#define WLAN_SCHED_EXEC_MONITOR_PRINT                      0              // Print when the time between executions exceeds the threshold
 #define WLAN_SCHED_EXEC_MONITOR_DEFAULT_THRESHOLD          100000         // 100 ms
 
 
@@ -42,7 +47,17 @@ static volatile u32 schedule_count;
 
 static wlan_sched_state_t wlan_sched_coarse;
 static wlan_sched_state_t wlan_sched_fine;
-static dl_list disabled_list;
+
+// Preallocated schedule slots
+//     - A slot that is not in use has an ID of 0 and is free in sched_cache
+//     - A disabled schedule is in the disabled_list
+//     - An enabled schedule is in the heap of its scheduler (or has been popped
+//       from the heap by schedule_handler() for execution)
+//
+static dl_entry   sched_entry_pool[SCHEDULE_NUM_SLOTS];
+static wlan_sched sched_pool[SCHEDULE_NUM_SLOTS];
+static slab_cache_t sched_cache;
+static dl_list    disabled_list;
 
 extern platform_high_dev_info_t platform_high_dev_info;
 
@@ -50,6 +65,7 @@ extern platform_high_dev_info_t platform_high_dev_info;
 static u64 last_exec_timestamp;
 static u64 schedule_exec_monitor;
 static u32 monitor_threshold;
+static u32 exec_monitor_hist[SCHEDULE_EXEC_MONITOR_NUM_BINS];
 #endif
 
 
@@ -58,6 +74,19 @@ static u32 monitor_threshold;
 void timer_interrupt_handler(void* instancePtr);
 void schedule_handler(void* callback_ref, u8 timer_number);
 
+static wlan_sched_state_t* sched_get_state(u8 scheduler_sel);
+static dl_entry* sched_lookup(u32 id);
+static void sched_release(dl_entry* sched_entry);
+static void sched_enabled_count_inc(u8 scheduler_sel);
+static void sched_enabled_count_dec(u8 scheduler_sel);
+
+static void sched_heap_insert(wlan_sched_state_t* sched_state, u8 slot);
+static void sched_heap_remove(wlan_sched_state_t* sched_state, u8 heap_index);
+static void sched_heap_sift_up(wlan_sched_state_t* sched_state, u8 heap_index);
+static void sched_heap_sift_down(wlan_sched_state_t* sched_state, u8 heap_index);
+
+
+
 
 /******************************** Functions **********************************/
 
@@ -72,6 +101,7 @@ void schedule_handler(void* callback_ref, u8 timer_number);
  *****************************************************************************/
 int wlan_mac_schedule_init(){
 	int status;
+	u32 slot;
 
 	// Initialize internal variables
 	schedule_count = 1;
@@ -81,14 +111,24 @@ int wlan_mac_schedule_init(){
 	schedule_exec_monitor = 0;
 	monitor_threshold = WLAN_SCHED_EXEC_MONITOR_DEFAULT_THRESHOLD;
 #endif
+	wlan_mac_schedule_reset_exec_monitor();
 
-	dl_list_init(&(wlan_sched_coarse.enabled_list));
-	wlan_sched_coarse.next = NULL;
-	dl_list_init(&(wlan_sched_fine.enabled_list));
-	wlan_sched_fine.next = NULL;
+	bzero(&wlan_sched_coarse, sizeof(wlan_sched_state_t));
+	bzero(&wlan_sched_fine, sizeof(wlan_sched_state_t));
 
 	dl_list_init(&disabled_list);
 
+	// Schedule slots are handed out by a slab cache over sched_pool
+	slab_cache_init(&sched_cache, "schedule", sched_pool, sizeof(wlan_sched), SCHEDULE_NUM_SLOTS);
+
+	// Attach each schedule slot to its dl_entry
+	for(slot = 0; slot < SCHEDULE_NUM_SLOTS; slot++){
+		bzero(&(sched_pool[slot]), sizeof(wlan_sched));
+		sched_pool[slot].heap_index = SCHEDULE_HEAP_INDEX_NONE;
+
+		sched_entry_pool[slot].data = &(sched_pool[slot]);
+	}
+
 	// Initialize the timer
 	// The driver for the timer does not handle a reboot of CPU_HIGH
 	// gracefully. Before initializing it, we should stop any running
@@ -178,168 +218,143 @@ int wlan_mac_schedule_setup_interrupt(XIntc* intc){
  *****************************************************************************/
 u32 wlan_mac_schedule_event_repeated(u8 scheduler_sel, u32 delay, u32 num_calls, void(*callback)()){
 	u32 id;
-	dl_entry* entry_ptr;
+	u32 slot;
 	wlan_sched* sched_ptr;
-	u64 curr_system_time;
+	wlan_sched_state_t* sched_state;
 
-	// Allocate memory for data structures
-	entry_ptr = wlan_mac_high_malloc(sizeof(dl_entry));
-	if (entry_ptr == NULL) { return SCHEDULE_FAILURE; }
+	sched_state = sched_get_state(scheduler_sel);
 
-	sched_ptr = wlan_mac_high_malloc(sizeof(wlan_sched));
-	if (sched_ptr == NULL) { wlan_mac_high_free(entry_ptr); return SCHEDULE_FAILURE; }
+	if (sched_state == NULL) {
+		xil_printf("Unknown scheduler selection.  No event scheduled.\n");
+		return SCHEDULE_FAILURE;
+	}
 
-	// Attach the schedule struct to this dl_entry
-	entry_ptr->data = sched_ptr;
+	// Check out a free schedule slot
+	sched_ptr = slab_alloc(&sched_cache);
 
-	do{
-		// Get Schedule ID from global counter
-		id = (schedule_count++);
+	if (sched_ptr == NULL) {
+		xil_printf("ERROR:  No free schedule slots (%d in use).  No event scheduled.\n", SCHEDULE_NUM_SLOTS);
+		return SCHEDULE_FAILURE;
+	}
 
-		// Check if we hit the section of reserved IDs; Wrap back to 0 and start again
-		if ((id >= SCHEDULE_ID_RESERVED_MIN) && (id <= SCHEDULE_ID_RESERVED_MAX)) { id = 1; }
+	slot      = sched_ptr - sched_pool;
 
-		// Check to make sure that this id has not been issued to any currently
-		// scheduled events
-	} while( (wlan_mac_schedule_find(&wlan_sched_coarse.enabled_list, id) != NULL) ||
-			 (wlan_mac_schedule_find(&wlan_sched_fine.enabled_list, id) != NULL) ||
-			 (wlan_mac_schedule_find(&disabled_list, id) != NULL));
+	// Get Schedule ID from global counter
+	//     NOTE:  The slot index makes the ID unique among the current schedules. Wrap the
+	//         counter before the ID reaches the section of reserved IDs.
+	if ((schedule_count << SCHEDULE_SLOT_BITS) >= SCHEDULE_ID_RESERVED_MIN) { schedule_count = 1; }
 
-	// Get the current system time
-	curr_system_time     = get_system_time_usec();
+	id = ((schedule_count++) << SCHEDULE_SLOT_BITS) | slot;
 
 	// Initialize the schedule struct
-	sched_ptr->enabled	 = 1;
-	sched_ptr->id        = id;
-	sched_ptr->delay_us  = delay;
-	sched_ptr->num_calls = num_calls;
-	sched_ptr->target_us = curr_system_time + (u64)(delay);
-	sched_ptr->callback  = (function_ptr_t)callback;
-
-	// Add schedule struct to the appropriate schedule list
-	switch(scheduler_sel){
-		// ------------------------------------------------
-		case SCHEDULE_COARSE:
-			// Start timer if the list goes from 0 -> 1 event
-			if (wlan_sched_coarse.enabled_list.length == 0) {
-				XTmrCtr_SetResetValue(&timer_instance, TIMER_CNTR_SLOW, (SLOW_TIMER_DUR_US * TIMER_CLKS_PER_US));
-				XTmrCtr_Start(&timer_instance, TIMER_CNTR_SLOW);
-			}
-
-			dl_entry_insertBeginning(&(wlan_sched_coarse.enabled_list), entry_ptr);
-		break;
-
-		// ------------------------------------------------
-		case SCHEDULE_FINE:
-			// Start timer if the list goes from 0 -> 1 event
-			if(wlan_sched_fine.enabled_list.length == 0){
-				XTmrCtr_SetResetValue(&timer_instance, TIMER_CNTR_FAST, (FAST_TIMER_DUR_US * TIMER_CLKS_PER_US));
-				XTmrCtr_Start(&timer_instance, TIMER_CNTR_FAST);
-			}
-
-			dl_entry_insertBeginning(&(wlan_sched_fine.enabled_list), entry_ptr);
-		break;
-
-		// ------------------------------------------------
-		default:
-			xil_printf("Unknown scheduler selection.  No event scheduled.\n");
-			return SCHEDULE_FAILURE;
-		break;
-	}
+	sched_ptr->enabled	     = 1;
+	sched_ptr->scheduler_sel = scheduler_sel;
+	sched_ptr->id            = id;
+	sched_ptr->delay_us      = delay;
+	sched_ptr->num_calls     = num_calls;
+	sched_ptr->target_us     = get_system_time_usec() + (u64)(delay);
+	sched_ptr->callback      = (function_ptr_t)callback;
+
+	// Add the schedule to the heap of the scheduler (starts the timer if necessary)
+	sched_heap_insert(sched_state, slot);
+	sched_enabled_count_inc(scheduler_sel);
 
 	return id;
 }
 
 
+
+/*****************************************************************************/
+/**
+ * @brief  Disables a scheduled callback without releasing it
+ *
+ * The schedule is moved to the list of disabled schedules until it is passed
+ * to wlan_mac_schedule_enable().
+ *
+ * @param   scheduler_sel    - SCHEDULE_COARSE or SCHEDULE_FINE
+ * @param   sched_id         - ID of schedule that should be disabled
+ *
+ * @return  dl_entry*        - Pointer to the disabled schedule or NULL if error
+ *
+ * @note    Disabling a schedule whose num_calls is 0 is not supported. The most
+ *          common occurence of this scenario is trying to disable a schedule
+ *          from the final execution of a callback of that schedule.
+ *
+ *****************************************************************************/
 dl_entry* wlan_mac_schedule_disable_id(u8 scheduler_sel, u32 sched_id){
 	dl_entry* sched_entry;
-	dl_list* enabled_list;
-	u8 timer_sel;
+	wlan_sched* sched_ptr;
+	wlan_sched_state_t* sched_state;
 
-	switch(scheduler_sel){
-		case SCHEDULE_COARSE:
-			enabled_list = &(wlan_sched_coarse.enabled_list);
-			timer_sel = TIMER_CNTR_SLOW;
-		break;
-
-		case SCHEDULE_FINE:
-			enabled_list = &(wlan_sched_fine.enabled_list);
-			timer_sel = TIMER_CNTR_FAST;
-		break;
-
-		default:
-			return NULL;
-		break;
-	}
+	sched_state = sched_get_state(scheduler_sel);
+	sched_entry = sched_lookup(sched_id);
 
-	sched_entry = wlan_mac_schedule_find(enabled_list, sched_id);
+	if ((sched_state == NULL) || (sched_entry == NULL)) { return NULL; }
 
-	if(sched_entry != NULL){
-		if( ((wlan_sched*)(sched_entry->data))->num_calls != 0 ){
-			dl_entry_remove(enabled_list, sched_entry);
-			dl_entry_insertEnd(&disabled_list, sched_entry);
-			((wlan_sched*)(sched_entry->data))->enabled = 0;
-		} else {
-			// wlan_mac_schedule_disable_id() is not supported for a schedule whose num_calls
-			// is 0. The most common occurence of this scenario is trying to disable a schedule
-			// from the final execution of a callback of that schedule.
-			return NULL;
-		}
+	sched_ptr = (wlan_sched*)(sched_entry->data);
+
+	if ((sched_ptr->enabled == 0) || (sched_ptr->scheduler_sel != scheduler_sel) || (sched_ptr->num_calls == 0)) {
+		return NULL;
+	}
+
+	// Remove the schedule from the heap
+	//     NOTE:  A schedule executing its callback has already been popped from the heap
+	if (sched_ptr->heap_index != SCHEDULE_HEAP_INDEX_NONE) {
+		sched_heap_remove(sched_state, sched_ptr->heap_index);
 	}
 
+	sched_ptr->enabled = 0;
+	dl_entry_insertEnd(&disabled_list, sched_entry);
+
 	// Stop the timer if there are no more events
 	//     NOTE:  Will be restarted when an event is added or re-enabled
-	if (enabled_list->length == 0) {
-		XTmrCtr_Stop(&timer_instance, timer_sel);
-	}
+	sched_enabled_count_dec(scheduler_sel);
 
 	return sched_entry;
 }
 
+
+
+/*****************************************************************************/
+/**
+ * @brief  Re-enables a schedule previously disabled by wlan_mac_schedule_disable_id()
+ *
+ * The next execution of the callback will occur one schedule interval after
+ * this call.
+ *
+ * @param   scheduler_sel    - SCHEDULE_COARSE or SCHEDULE_FINE
+ * @param   sched_entry      - Pointer to the disabled schedule
+ *
+ * @return  int              - 0 on success, -1 on error
+ *
+ *****************************************************************************/
 int wlan_mac_schedule_enable(u8 scheduler_sel, dl_entry* sched_entry){
+	wlan_sched* sched_ptr;
+	wlan_sched_state_t* sched_state;
 
-	dl_list* enabled_list;
-	u8 timer_sel;
-	u32 reset_value;
+	sched_state = sched_get_state(scheduler_sel);
 
-	if(sched_entry == NULL){
-		return -1;
-	}
-	switch(scheduler_sel){
-		case SCHEDULE_COARSE:
-			enabled_list = &(wlan_sched_coarse.enabled_list);
-			timer_sel = TIMER_CNTR_SLOW;
-			reset_value = (SLOW_TIMER_DUR_US * TIMER_CLKS_PER_US);
-		break;
-
-		case SCHEDULE_FINE:
-			enabled_list = &(wlan_sched_fine.enabled_list);
-			timer_sel = TIMER_CNTR_FAST;
-			reset_value = (FAST_TIMER_DUR_US * TIMER_CLKS_PER_US);
-		break;
-
-		default:
-			return -1;
-		break;
-	}
+	if ((sched_state == NULL) || (sched_entry == NULL)) { return -1; }
+
+	sched_ptr = (wlan_sched*)(sched_entry->data);
+
+	if ((sched_ptr->id == 0) || (sched_ptr->enabled == 1)) { return -1; }
 
 	dl_entry_remove(&disabled_list, sched_entry);
-	dl_entry_insertEnd(enabled_list, sched_entry);
 
-	((wlan_sched*)(sched_entry->data))->enabled = 1;
-	((wlan_sched*)(sched_entry->data))->target_us = get_system_time_usec() + ((wlan_sched*)(sched_entry->data))->delay_us;
+	sched_ptr->enabled       = 1;
+	sched_ptr->scheduler_sel = scheduler_sel;
+	sched_ptr->target_us     = get_system_time_usec() + (u64)(sched_ptr->delay_us);
 
-	// Start timer if the list goes from 0 -> 1 event
-	if(wlan_sched_fine.enabled_list.length == 1){
-		XTmrCtr_SetResetValue(&timer_instance, timer_sel, reset_value);
-		XTmrCtr_Start(&timer_instance, timer_sel);
-	}
+	// Add the schedule to the heap of the scheduler (starts the timer if necessary)
+	sched_heap_insert(sched_state, sched_entry - sched_entry_pool);
+	sched_enabled_count_inc(scheduler_sel);
 
 	return 0;
-
 }
 
 
+
 /*****************************************************************************/
 /**
  * @brief  Cancels the execution of a scheduled callback
@@ -350,100 +365,25 @@ int wlan_mac_schedule_enable(u8 scheduler_sel, dl_entry* sched_entry){
  * @return  None
  *
  * @note    This function will fail silently if the ID parameter does not match
- *          any currently running schedule event IDs.
+ *          any current schedule event IDs of the given scheduler.
  *
  *****************************************************************************/
 void wlan_mac_remove_schedule(u8 scheduler_sel, u32 id){
 	dl_entry* curr_entry_ptr;
-	wlan_sched* curr_sched_ptr;
-
-	dl_list* enabled_list;
-
-	switch(scheduler_sel){
-		case SCHEDULE_COARSE:
-			enabled_list = &(wlan_sched_coarse.enabled_list);
-		break;
-
-		case SCHEDULE_FINE:
-			enabled_list = &(wlan_sched_fine.enabled_list);
-		break;
-
-		default:
-			return;
-		break;
-	}
 
-	curr_entry_ptr = wlan_mac_schedule_find(enabled_list, id);
+	curr_entry_ptr = sched_lookup(id);
 
 	if (curr_entry_ptr != NULL) {
-
-		// Extract the schedule struct from dl_entry
-		curr_sched_ptr = (wlan_sched*)(curr_entry_ptr->data);
-
-		switch (scheduler_sel) {
-			// ------------------------------------------------
-			case SCHEDULE_COARSE:
-				if(curr_sched_ptr != NULL){
-					if(wlan_sched_coarse.next == curr_entry_ptr){
-						// The next dl_entry in the schedule_handler iteration
-						// is the schedule we are about to remove. We need to advance
-						// this pointer prior to removing so that we do not break
-						// the execution of schedule_handler.
-						wlan_sched_coarse.next = dl_entry_next(curr_entry_ptr);
-					}
-					dl_entry_remove(&(wlan_sched_coarse.enabled_list), curr_entry_ptr);
-					wlan_mac_high_free(curr_entry_ptr);
-					wlan_mac_high_free(curr_sched_ptr);
-				}
-
-				// Stop the timer if there are no more events
-				//     NOTE:  Will be restarted when new event is added
-				if (wlan_sched_coarse.enabled_list.length == 0) {
-					XTmrCtr_Stop(&timer_instance, TIMER_CNTR_SLOW);
-				}
-			break;
-
-			// ------------------------------------------------
-			case SCHEDULE_FINE:
-				if(curr_sched_ptr != NULL){
-					if(wlan_sched_fine.next == curr_entry_ptr){
-						// The next dl_entry in the schedule_handler iteration
-						// is the schedule we are about to remove. We need to advance
-						// this pointer prior to removing so that we do not break
-						// the execution of schedule_handler.
-						wlan_sched_fine.next = dl_entry_next(curr_entry_ptr);
-					}
-					dl_entry_remove(&(wlan_sched_fine.enabled_list), curr_entry_ptr);
-					wlan_mac_high_free(curr_entry_ptr);
-					wlan_mac_high_free(curr_sched_ptr);
-				}
-
-				// Stop the timer if there are no more events
-				//     NOTE:  Will be restarted when new event is added
-				if (wlan_sched_fine.enabled_list.length == 0){
-					XTmrCtr_Stop(&timer_instance, TIMER_CNTR_FAST);
-				}
-			break;
-
-			// ------------------------------------------------
-			default:
-				xil_printf("Unknown scheduler selection.  No event removed.\n");
-			break;
-		}
-
-#if WLAN_SCHED_EXEC_MONITOR
-		// If both timers are stopped, then we need to reset the last_exec_timestamp
-		//     NOTE:  This is so we do not get erroneous results when the timer is off
-		//         for extended periods of time.
-		if ((wlan_sched_coarse.length == 0) && (wlan_sched_fine.length == 0)) {
-			last_exec_timestamp = 0;
+		if (((wlan_sched*)(curr_entry_ptr->data))->scheduler_sel == scheduler_sel) {
+			// Return the slot to the free list (stops timer if necessary)
+			sched_release(curr_entry_ptr);
 		}
-#endif
-    }
+	}
 }
 
 
 
+
 /*****************************************************************************/
 /**
  * Timer interrupt handler
@@ -510,7 +450,6 @@ void timer_interrupt_handler(void * instance_ptr){
 }
 
 
-
 /*****************************************************************************/
 /**
  * Internal callback used by the timer interrupt handler. This function should
@@ -521,19 +460,26 @@ void timer_interrupt_handler(void * instance_ptr){
  *
  * @return  None
  *
+ * @note    Only schedules whose target time has passed are touched. Each of them
+ *          is popped from the heap before any callback is called so that a
+ *          schedule re-armed, re-enabled or added by a callback is not executed
+ *          again until the next timer interrupt.
+ *
  *****************************************************************************/
 void schedule_handler(void * callback_ref, u8 timer_number){
-	dl_entry* curr_entry_ptr;
 	wlan_sched* curr_sched_ptr;
 
 	u8 scheduler;
-	volatile wlan_sched_state_t* wlan_sched_state;
+	wlan_sched_state_t* wlan_sched_state;
 	u32 sched_id;
 	function_ptr_t sched_callback;
 
-	u64 curr_system_time;
+	u8  expired_slot[SCHEDULE_NUM_SLOTS];
+	u32 expired_id[SCHEDULE_NUM_SLOTS];
+	u32 num_expired;
+	u32 i;
 
-	static volatile u8 debug_print = 0;
+	u64 curr_system_time;
 
 	// Get current system time
 	curr_system_time = get_system_time_usec();
@@ -551,15 +497,25 @@ void schedule_handler(void * callback_ref, u8 timer_number){
 	//
 	if (last_exec_timestamp != 0) {
 		schedule_exec_monitor = curr_system_time - last_exec_timestamp;
+
+		// Add the interval to the histogram
+		//     NOTE:  Bin index is floor(log2(interval)), saturated at the last bin
+		i = 0;
+		while (((schedule_exec_monitor >> (i + 1)) != 0) && (i < (SCHEDULE_EXEC_MONITOR_NUM_BINS - 1))) { i++; }
+
+		exec_monitor_hist[i]++;
 	}
 
+#if WLAN_SCHED_EXEC_MONITOR_PRINT
     // If the monitor threshold is exceeded, print a warning.
 	//     NOTE:  Since prints take a long time, update the system time so the
 	//         print does not affect the collection of "time between executions"
+	//     NOTE:  The coarse scheduler alone runs every SLOW_TIMER_DUR_US
 	if (schedule_exec_monitor > monitor_threshold) {
-		xil_printf("WARNING:  %d us between scheduler executions.\n", schedule_exec_monitor);
+		xil_printf("WARNING:  %d us between scheduler executions.\n", (u32)schedule_exec_monitor);
 		curr_system_time = get_system_time_usec();
 	}
+#endif
 
 	// Store the current time in the last_timer_timestamp
 	last_exec_timestamp = curr_system_time;
@@ -575,45 +531,57 @@ void schedule_handler(void * callback_ref, u8 timer_number){
 		wlan_sched_state = &(wlan_sched_coarse);
 	}
 
-	// Get the first entry of the schedule dl_list
-	wlan_sched_state->next = wlan_sched_state->enabled_list.first;
+	// Pop every schedule whose target time has passed
+	num_expired = 0;
+
+	while (wlan_sched_state->heap_length > 0) {
+		curr_sched_ptr = &(sched_pool[wlan_sched_state->heap[0]]);
+
+		if (curr_sched_ptr->target_us > curr_system_time) { break; }
+
+		expired_slot[num_expired] = wlan_sched_state->heap[0];
+		expired_id[num_expired]   = curr_sched_ptr->id;
+		num_expired++;
+
+		sched_heap_remove(wlan_sched_state, 0);
+	}
 
-	// Update the appropriate scheduler
-	while (wlan_sched_state->next != NULL) {
-		curr_entry_ptr = wlan_sched_state->next;
-		wlan_sched_state->next = dl_entry_next(wlan_sched_state->next);
-		curr_sched_ptr = (wlan_sched*)(curr_entry_ptr->data);
+	// Process the expired events
+	for (i = 0; i < num_expired; i++) {
+		curr_sched_ptr = &(sched_pool[expired_slot[i]]);
 
-		if(debug_print){
-			xil_printf("curr_sched_ptr = 0x%08x\n", curr_sched_ptr);
-			xil_printf("curr_sched_ptr->callback = 0x%08x\n", curr_sched_ptr->callback);
-			xil_printf("curr_sched_ptr->id = %d\n", curr_sched_ptr->id);
+		// A previous callback in this loop may have removed, disabled or re-enabled
+		// this schedule. In all of these cases it is no longer due.
+		if ((curr_sched_ptr->id != expired_id[i]) ||
+			(curr_sched_ptr->enabled == 0) ||
+			(curr_sched_ptr->heap_index != SCHEDULE_HEAP_INDEX_NONE)) {
+			continue;
 		}
 
-		// If the target time has passed, then process the event
-		if (curr_system_time >= (curr_sched_ptr->target_us)) {
-			sched_id       = curr_sched_ptr->id;
-			sched_callback = curr_sched_ptr->callback;
+		sched_id       = curr_sched_ptr->id;
+		sched_callback = curr_sched_ptr->callback;
 
-			// Update the number of scheduled event calls
-			if ((curr_sched_ptr->num_calls != SCHEDULE_REPEAT_FOREVER) &&
-				(curr_sched_ptr->num_calls != 0)) {
-				(curr_sched_ptr->num_calls)--;
-			}
+		// Update the number of scheduled event calls
+		if ((curr_sched_ptr->num_calls != SCHEDULE_REPEAT_FOREVER) &&
+			(curr_sched_ptr->num_calls != 0)) {
+			(curr_sched_ptr->num_calls)--;
+		}
 
-			sched_callback(sched_id);
-
-			// The update of the target or removal of the schedule occurs after the callback so that the callback
-			// has the opportunity to "save" the schedule. It can do this by updating "num_calls" or by calling
-			// wlan_mac_schedule_disable
-			if(curr_sched_ptr->enabled == 1){
-				if(curr_sched_ptr->num_calls == 0){
-					// Remove event (stops timer if necessary)
-					wlan_mac_remove_schedule(scheduler, sched_id);
-				} else {
-					// Update scheduled event for next execution
-					curr_sched_ptr->target_us = curr_system_time + (u64)(curr_sched_ptr->delay_us);
-				}
+		sched_callback(sched_id);
+
+		// The update of the target or removal of the schedule occurs after the callback so that the callback
+		// has the opportunity to "save" the schedule. It can do this by updating "num_calls" or by calling
+		// wlan_mac_schedule_disable
+		if ((curr_sched_ptr->id == sched_id) &&
+			(curr_sched_ptr->enabled == 1) &&
+			(curr_sched_ptr->heap_index == SCHEDULE_HEAP_INDEX_NONE)) {
+			if(curr_sched_ptr->num_calls == 0){
+				// Remove event (stops timer if necessary)
+				wlan_mac_remove_schedule(scheduler, sched_id);
+			} else {
+				// Update scheduled event for next execution
+				curr_sched_ptr->target_us = curr_system_time + (u64)(curr_sched_ptr->delay_us);
+				sched_heap_insert(wlan_sched_state, expired_slot[i]);
 			}
 		}
 	}
@@ -623,36 +591,221 @@ void schedule_handler(void * callback_ref, u8 timer_number){
 
 /*****************************************************************************/
 /**
- * Find schedule that corresponds to a given ID
+ * Get the scheduler execution monitor histogram
+ *
+ * @param   hist            - Buffer of at least max_bins u32 values to be filled in
+ * @param   max_bins        - Maximum number of bins to copy
  *
- * @param   dl_list*        - List to search through; typically the fine, coarse, and deactivated lists
- * @param   id              - ID of the scheduler that should be returned
+ * @return  u32             - Number of bins copied (0 if WLAN_SCHED_EXEC_MONITOR is disabled)
  *
- * @return  dl_entry*       - Pointer to the list entry that contains the schedule
+ * @note    Bin N of the histogram counts the intervals between executions of the
+ *          scheduler in [2^N, 2^(N+1)) microseconds.
  *
  *****************************************************************************/
-dl_entry* wlan_mac_schedule_find(dl_list* sched_list, u32 id){
-	int iter;
+u32 wlan_mac_schedule_get_exec_monitor_hist(u32* hist, u32 max_bins){
+#if WLAN_SCHED_EXEC_MONITOR
+	u32 num_bins = min(max_bins, SCHEDULE_EXEC_MONITOR_NUM_BINS);
 
-	dl_entry* curr_dl_entry;
-	dl_entry* next_dl_entry;
-	wlan_sched* curr_wlan_sched;
+	memcpy(hist, exec_monitor_hist, num_bins * sizeof(u32));
+
+	return num_bins;
+#else
+	return 0;
+#endif
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Reset the scheduler execution monitor histogram
+ *
+ * @param   None
+ *
+ * @return  None
+ *
+ *****************************************************************************/
+void wlan_mac_schedule_reset_exec_monitor(){
+#if WLAN_SCHED_EXEC_MONITOR
+	bzero(exec_monitor_hist, sizeof(exec_monitor_hist));
+#endif
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Print the scheduler execution monitor histogram
+ *
+ * @param   None
+ *
+ * @return  None
+ *
+ *****************************************************************************/
+void wlan_mac_schedule_print_exec_monitor(){
+#if WLAN_SCHED_EXEC_MONITOR
+	u32 i;
+
+	xil_printf("Scheduler execution interval histogram:\n");
+
+	for (i = 0; i < SCHEDULE_EXEC_MONITOR_NUM_BINS; i++) {
+		if (exec_monitor_hist[i] != 0) {
+			xil_printf("  [%10d, %10d) us: %d\n", (1 << i), (1 << (i + 1)), exec_monitor_hist[i]);
+		}
+	}
+#else
+	xil_printf("Scheduler execution monitor disabled (WLAN_SCHED_EXEC_MONITOR = 0)\n");
+#endif
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Internal helpers for schedule slot and heap management
+ *
+ *****************************************************************************/
+static wlan_sched_state_t* sched_get_state(u8 scheduler_sel){
+	switch(scheduler_sel){
+		case SCHEDULE_COARSE:  return &(wlan_sched_coarse);
+		case SCHEDULE_FINE:    return &(wlan_sched_fine);
+		default:               return NULL;
+	}
+}
 
-	// Initialize the loop variables
-	iter = sched_list->length;
-	next_dl_entry = sched_list->first;
 
-	// Process the list
-	while ((next_dl_entry != NULL) && (iter-- > 0)) {
-		curr_dl_entry   = next_dl_entry;
-		next_dl_entry   = dl_entry_next(next_dl_entry);
-		curr_wlan_sched = (wlan_sched*)(curr_dl_entry->data);
+static dl_entry* sched_lookup(u32 id){
+	u32 slot = id & SCHEDULE_SLOT_MASK;
 
-		if(curr_wlan_sched->id == id){
-			return curr_dl_entry;
+	// The ID of a free slot is 0; no issued ID is 0
+	if ((id == 0) || (sched_pool[slot].id != id)) { return NULL; }
+
+	return &(sched_entry_pool[slot]);
+}
+
+
+static void sched_release(dl_entry* sched_entry){
+	wlan_sched* sched_ptr = (wlan_sched*)(sched_entry->data);
+
+	if (sched_ptr->enabled) {
+		if (sched_ptr->heap_index != SCHEDULE_HEAP_INDEX_NONE) {
+			sched_heap_remove(sched_get_state(sched_ptr->scheduler_sel), sched_ptr->heap_index);
 		}
+		sched_ptr->enabled = 0;
+		sched_ptr->id      = 0;
+		sched_enabled_count_dec(sched_ptr->scheduler_sel);
+	} else {
+		dl_entry_remove(&disabled_list, sched_entry);
+		sched_ptr->id      = 0;
 	}
 
-	return NULL;
+	slab_free(&sched_cache, sched_ptr);
 }
 
+
+static void sched_enabled_count_inc(u8 scheduler_sel){
+	wlan_sched_state_t* sched_state = sched_get_state(scheduler_sel);
+
+	sched_state->num_enabled++;
+
+	// Start timer if the scheduler goes from 0 -> 1 event
+	if (sched_state->num_enabled == 1) {
+		if (scheduler_sel == SCHEDULE_FINE) {
+			XTmrCtr_SetResetValue(&timer_instance, TIMER_CNTR_FAST, (FAST_TIMER_DUR_US * TIMER_CLKS_PER_US));
+			XTmrCtr_Start(&timer_instance, TIMER_CNTR_FAST);
+		} else {
+			XTmrCtr_SetResetValue(&timer_instance, TIMER_CNTR_SLOW, (SLOW_TIMER_DUR_US * TIMER_CLKS_PER_US));
+			XTmrCtr_Start(&timer_instance, TIMER_CNTR_SLOW);
+		}
+	}
+}
+
+
+static void sched_enabled_count_dec(u8 scheduler_sel){
+	wlan_sched_state_t* sched_state = sched_get_state(scheduler_sel);
+
+	sched_state->num_enabled--;
+
+	// Stop the timer if there are no more events
+	//     NOTE:  Will be restarted when new event is added
+	if (sched_state->num_enabled == 0) {
+		XTmrCtr_Stop(&timer_instance, (scheduler_sel == SCHEDULE_FINE) ? TIMER_CNTR_FAST : TIMER_CNTR_SLOW);
+	}
+
+#if WLAN_SCHED_EXEC_MONITOR
+	// If both timers are stopped, then we need to reset the last_exec_timestamp
+	//     NOTE:  This is so we do not get erroneous results when the timer is off
+	//         for extended periods of time.
+	if ((wlan_sched_coarse.num_enabled == 0) && (wlan_sched_fine.num_enabled == 0)) {
+		last_exec_timestamp = 0;
+	}
+#endif
+}
+
+
+static void sched_heap_insert(wlan_sched_state_t* sched_state, u8 slot){
+	u8 heap_index = sched_state->heap_length++;
+
+	sched_state->heap[heap_index]  = slot;
+	sched_pool[slot].heap_index    = heap_index;
+
+	sched_heap_sift_up(sched_state, heap_index);
+}
+
+
+static void sched_heap_remove(wlan_sched_state_t* sched_state, u8 heap_index){
+	u8 last_index = --(sched_state->heap_length);
+	u8 moved_slot = sched_state->heap[last_index];
+
+	sched_pool[sched_state->heap[heap_index]].heap_index = SCHEDULE_HEAP_INDEX_NONE;
+
+	if (heap_index != last_index) {
+		// Move the last element into the hole and restore the heap property
+		sched_state->heap[heap_index]  = moved_slot;
+		sched_pool[moved_slot].heap_index = heap_index;
+
+		sched_heap_sift_up(sched_state, heap_index);
+		sched_heap_sift_down(sched_state, sched_pool[moved_slot].heap_index);
+	}
+}
+
+
+static void sched_heap_sift_up(wlan_sched_state_t* sched_state, u8 heap_index){
+	u8 parent;
+	u8 slot = sched_state->heap[heap_index];
+
+	while (heap_index > 0) {
+		parent = (heap_index - 1) >> 1;
+
+		if (sched_pool[sched_state->heap[parent]].target_us <= sched_pool[slot].target_us) { break; }
+
+		sched_state->heap[heap_index] = sched_state->heap[parent];
+		sched_pool[sched_state->heap[heap_index]].heap_index = heap_index;
+		heap_index = parent;
+	}
+
+	sched_state->heap[heap_index] = slot;
+	sched_pool[slot].heap_index   = heap_index;
+}
+
+
+static void sched_heap_sift_down(wlan_sched_state_t* sched_state, u8 heap_index){
+	u32 child;
+	u8 slot = sched_state->heap[heap_index];
+
+	while ((child = (2 * heap_index) + 1) < sched_state->heap_length) {
+		if (((child + 1) < sched_state->heap_length) &&
+			(sched_pool[sched_state->heap[child + 1]].target_us < sched_pool[sched_state->heap[child]].target_us)) {
+			child++;
+		}
+
+		if (sched_pool[slot].target_us <= sched_pool[sched_state->heap[child]].target_us) { break; }
+
+		sched_state->heap[heap_index] = sched_state->heap[child];
+		sched_pool[sched_state->heap[heap_index]].heap_index = heap_index;
+		heap_index = child;
+	}
+
+	sched_state->heap[heap_index] = slot;
+	sched_pool[slot].heap_index   = heap_index;
+}
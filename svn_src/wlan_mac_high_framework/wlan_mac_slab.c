@@ -0,0 +1,272 @@
+/** @file wlan_mac_slab.c
+ *  @brief Slab Allocator
+ *
+ *  This contains code for fixed-size object caches.
+ *
+ *  @copyright Copyright 2014-2017, Mango Communications. All rights reserved.
+ *          Distributed under the Mango Communications Reference Design License
+ *              See LICENSE.txt included in the design archive or
+ *              at http://mangocomm.com/802.11/license
+ *
+ *  This file is part of the Mango 802.11 Reference Design (https://mangocomm.com/802.11)
+ */
+
+/***************************** Include Files *********************************/
+
+#include "wlan_mac_high_sw_config.h"
+
+#include "stdio.h"
+#include "string.h"
+#include "xil_types.h"
+#include "xil_io.h"
+
+#include "wlan_mac_common.h"
+#include "wlan_mac_high.h"
+#include "wlan_mac_slab.h"
+
+
+/*************************** Variable Definitions ****************************/
+
+// Registered caches
+static slab_cache_t* slab_caches[SLAB_MAX_NUM_CACHES];
+static u32           slab_num_caches;
+
+
+/******************************** Functions **********************************/
+
+/*****************************************************************************/
+/**
+ * @brief Initialize a slab cache
+ *
+ * The cache is registered the first time it is initialized. Initializing a
+ * registered cache again (e.g. after a reset of its subsystem) frees all of its
+ * objects and reuses the memory reserved the first time.
+ *
+ * @param  slab_cache_t* cache      - Cache to initialize
+ * @param  char* name               - Name reported in the cache statistics
+ * @param  void* mem                - Array of num_objs objects of obj_size bytes
+ *                                    or NULL to reserve (aligned) memory from the heap
+ * @param  u32 obj_size             - Size of each object (in bytes)
+ * @param  u16 num_objs             - Number of objects in the cache
+ *
+ * @return int                      - 0 on success, -1 if memory could not be reserved
+ *
+ *****************************************************************************/
+int slab_cache_init(slab_cache_t* cache, char* name, void* mem, u32 obj_size, u16 num_objs){
+	u32 i;
+	u8  is_registered = 0;
+
+	for(i = 0; i < slab_num_caches; i++){
+		if(slab_caches[i] == cache){ is_registered = 1; }
+	}
+
+	if(is_registered == 0){
+		if(mem == NULL){
+			// Keep objects word-aligned (or 8-byte aligned if they may contain u64s)
+			obj_size = (obj_size >= 8) ? ((obj_size + 7) & ~7) : ((obj_size + 3) & ~3);
+			mem      = wlan_mac_high_malloc(obj_size * num_objs);
+		}
+		cache->free_stack = wlan_mac_high_malloc(num_objs * sizeof(u16));
+
+		if((mem == NULL) || (cache->free_stack == NULL)){
+			xil_printf("ERROR: Could not reserve memory for slab cache %s (%d x %d bytes)\n", name, num_objs, obj_size);
+			cache->num_objs = 0;
+			cache->num_free = 0;
+			return -1;
+		}
+
+		strncpy(cache->name, name, SLAB_CACHE_NAME_MAXLEN);
+		cache->name[SLAB_CACHE_NAME_MAXLEN] = 0;
+		cache->mem      = mem;
+		cache->obj_size = obj_size;
+		cache->num_objs = num_objs;
+
+		if(slab_num_caches < SLAB_MAX_NUM_CACHES){
+			slab_caches[slab_num_caches++] = cache;
+		}
+	}
+
+	// Lowest indexes are handed out first
+	for(i = 0; i < cache->num_objs; i++){
+		cache->free_stack[i] = cache->num_objs - 1 - i;
+	}
+	cache->num_free        = cache->num_objs;
+	cache->max_used        = 0;
+	cache->num_allocs      = 0;
+	cache->num_alloc_fails = 0;
+
+	return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Allocate an object from a slab cache
+ *
+ * @param  slab_cache_t* cache      - Cache to allocate from
+ *
+ * @return void*                    - Pointer to the object or NULL if the cache is empty
+ *
+ *****************************************************************************/
+void* slab_alloc(slab_cache_t* cache){
+	interrupt_state_t prev_interrupt_state;
+	void* obj = NULL;
+	u16   num_used;
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	if(cache->num_free > 0){
+		cache->num_free--;
+		obj = cache->mem + (cache->free_stack[cache->num_free] * cache->obj_size);
+
+		cache->num_allocs++;
+		num_used = cache->num_objs - cache->num_free;
+		if(num_used > cache->max_used){ cache->max_used = num_used; }
+	} else {
+		cache->num_alloc_fails++;
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return obj;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Allocate a zeroed object from a slab cache
+ *
+ * @param  slab_cache_t* cache      - Cache to allocate from
+ *
+ * @return void*                    - Pointer to the object or NULL if the cache is empty
+ *
+ *****************************************************************************/
+void* slab_calloc(slab_cache_t* cache){
+	void* obj = slab_alloc(cache);
+
+	if(obj != NULL){ bzero(obj, cache->obj_size); }
+
+	return obj;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Return an object to a slab cache
+ *
+ * @param  slab_cache_t* cache      - Cache the object was allocated from
+ * @param  void* obj                - Object to free (NULL is ignored)
+ *
+ *****************************************************************************/
+void slab_free(slab_cache_t* cache, void* obj){
+	interrupt_state_t prev_interrupt_state;
+
+	if(obj == NULL){ return; }
+
+	if(slab_contains(cache, obj) == 0){
+		xil_printf("ERROR: 0x%08x is not an object of slab cache %s\n", (u32)obj, cache->name);
+		return;
+	}
+
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+	if(cache->num_free < cache->num_objs){
+		cache->free_stack[cache->num_free++] = ((u8*)obj - cache->mem) / cache->obj_size;
+	} else {
+		xil_printf("ERROR: slab cache %s freed more objects than it holds\n", cache->name);
+	}
+
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Check if a pointer is an object of a slab cache
+ *
+ * @param  slab_cache_t* cache      - Cache
+ * @param  void* obj                - Pointer to check
+ *
+ * @return u8                       - 1 if obj points to the start of an object in the cache, 0 otherwise
+ *
+ *****************************************************************************/
+u8 slab_contains(slab_cache_t* cache, void* obj){
+	u32 offset;
+
+	if(((u8*)obj < cache->mem) || ((u8*)obj >= (cache->mem + (cache->num_objs * cache->obj_size)))){
+		return 0;
+	}
+
+	offset = (u8*)obj - cache->mem;
+
+	return ((offset % cache->obj_size) == 0);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Slab cache statistics
+ *
+ * slab_get_stats() fills SLAB_CACHE_STATS_NUM_WORDS words (in host byte order
+ * except for the name) with:
+ *     [0:2] Name (NULL terminated)
+ *     [3]   Object size (in bytes)
+ *     [4]   Number of objects
+ *     [5]   Number of objects in use
+ *     [6]   Largest number of objects in use at once
+ *     [7]   Number of successful allocations
+ *     [8]   Number of failed allocations
+ *
+ *****************************************************************************/
+u32 slab_get_num_caches(){
+	return slab_num_caches;
+}
+
+slab_cache_t* slab_get_cache(u32 index){
+	if(index >= slab_num_caches){ return NULL; }
+
+	return slab_caches[index];
+}
+
+u32 slab_get_stats(slab_cache_t* cache, u32* buffer){
+	memcpy(&(buffer[0]), cache->name, SLAB_CACHE_NAME_MAXLEN + 1);
+	buffer[3] = cache->obj_size;
+	buffer[4] = cache->num_objs;
+	buffer[5] = cache->num_objs - cache->num_free;
+	buffer[6] = cache->max_used;
+	buffer[7] = cache->num_allocs;
+	buffer[8] = cache->num_alloc_fails;
+
+	return SLAB_CACHE_STATS_NUM_WORDS;
+}
+
+void slab_reset_stats(){
+	u32 i;
+
+	for(i = 0; i < slab_num_caches; i++){
+		slab_caches[i]->max_used        = slab_caches[i]->num_objs - slab_caches[i]->num_free;
+		slab_caches[i]->num_allocs      = 0;
+		slab_caches[i]->num_alloc_fails = 0;
+	}
+}
+
+void slab_print_stats(){
+	u32 i;
+	slab_cache_t* cache;
+
+	xil_printf("\n");
+	xil_printf("--- Slab Caches ---\n");
+	xil_printf("NAME         SIZE  USED/ NUM   MAX     ALLOCS  FAILS\n");
+
+	for(i = 0; i < slab_num_caches; i++){
+		cache = slab_caches[i];
+		xil_printf("%-11s %5d %5d/%4d %5d %10d %6d\n", cache->name, cache->obj_size,
+		           cache->num_objs - cache->num_free, cache->num_objs, cache->max_used,
+		           cache->num_allocs, cache->num_alloc_fails);
+	}
+}
@@ -29,6 +29,7 @@
 #include "wlan_mac_schedule.h"
 #include "wlan_mac_addr_filter.h"
 #include "wlan_mac_network_info.h"
+#include "wlan_mac_hash_index.h"
 #include "wlan_platform_common.h"
 #include "wlan_mac_common.h"
 #include "wlan_common_types.h"
@@ -47,6 +48,24 @@ static dl_list station_info_free; ///< Free station_info_t
 /// to minimize search time for new BSSes you hear from often.
 static dl_list station_info_list; ///< Filled station_info_t
 
+/// Address index over station_info_list. Each bucket holds (1 + index) of a
+/// station_info_entry_t in STATION_INFO_DL_ENTRY_MEM, or 0 if the bucket is empty.
+/// The probe compares against the address copy in each station_info_entry_t (aux. BRAM)
+/// so a lookup never has to touch the station_info_t structs in DRAM.
+static station_info_entry_t* station_info_entry_base;
+static u16 station_info_hash_table[STATION_INFO_HASH_NUM_BUCKETS];
+static hash_index_t station_info_hash;
+static u32 station_info_num_entries;
+
+/// Generation stamped into station_info_t.generation whenever a station is created
+/// or updated. It only advances when a host asks for the stations that changed
+/// (see station_info_advance_generation()), so stamping is a single store.
+static volatile u32 station_info_generation;
+
+/// Value of station_info_generation when a station was last removed from station_info_list
+/// (see station_info_get_removal_generation()). 0 if no station has been removed.
+static volatile u32 station_info_removal_generation;
+
 
 
 // Default Transmission Parameters
@@ -59,11 +78,19 @@ typedef struct default_tx_params_t{
 
 static default_tx_params_t default_tx_params;
 
+// Rate selection scheme applied to new unicast station_info_t structs
+static u16 default_rate_selection_scheme;
+
 
 /*************************** Functions Prototypes ****************************/
 
 station_info_entry_t* station_info_find_oldest();
 
+static u32          station_info_hash_entry_bucket(u32 index);
+static void         station_info_hash_insert(station_info_entry_t* entry);
+static void         station_info_hash_remove(station_info_entry_t* entry);
+static station_info_entry_t* station_info_hash_find(u8* addr);
+
 
 /******************************** Functions **********************************/
 
@@ -71,7 +98,6 @@ void station_info_init() {
 
 	u32 i;
 	u32 num_station_info;
-	station_info_entry_t* station_info_entry_base;
 
 	// Set sane default Tx params. These will be overwritten by the user application
 	tx_params_t	tx_params = { .phy = { .mcs = 0, .phy_mode = PHY_MODE_NONHT, .antenna_mode = TX_ANTMODE_SISO_ANTA, .power = 15 },
@@ -82,9 +108,13 @@ void station_info_init() {
 	wlan_mac_set_default_tx_params(mcast_data, &tx_params);
 	wlan_mac_set_default_tx_params(mcast_mgmt, &tx_params);
 
+	default_rate_selection_scheme = RATE_SELECTION_SCHEME_STATIC;
+
 	dl_list_init(&station_info_free);
 	dl_list_init(&station_info_list);
 
+	hash_index_init(&station_info_hash, station_info_hash_table, STATION_INFO_HASH_NUM_BITS, station_info_hash_entry_bucket);
+
 	// Clear the memory in the dram used for bss_infos
 	bzero((void*)STATION_INFO_BUFFER_BASE, STATION_INFO_BUFFER_SIZE);
 
@@ -93,6 +123,14 @@ void station_info_init() {
 	//     (2) The number of station_info_t structs we can squeeze into STATION_INFO_BUFFER_SIZE
 	num_station_info = min(STATION_INFO_DL_ENTRY_MEM_SIZE/sizeof(station_info_entry_t), STATION_INFO_BUFFER_SIZE/sizeof(station_info_t));
 
+	// The hash index must always have an empty bucket to terminate a probe
+	num_station_info = min(num_station_info, STATION_INFO_HASH_NUM_BUCKETS - 1);
+	station_info_num_entries = num_station_info;
+
+	// Generation 0 is reserved for cleared station_info_t structs
+	station_info_generation = 1;
+	station_info_removal_generation = 0;
+
 	// At boot, every dl_entry buffer descriptor is free
 	// To set up the doubly linked list, we exploit the fact that we know the starting state is sequential.
 	// This matrix addressing is not safe once the queue is used. The insert/remove helper functions should be used
@@ -119,12 +157,12 @@ inline station_info_t* station_info_txreport_process(void* pkt_buf_addr, wlan_ma
 	mac_header_80211* tx_80211_header = (mac_header_80211*)((u8*)tx_frame_info + PHY_TX_PKT_BUF_MPDU_OFFSET);
 	station_info_t* curr_station_info;
 	u64 curr_system_time = get_system_time_usec();
+	u8 pkt_type;
 #if WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
 	station_txrx_counts_t* curr_txrx_counts;
 	txrx_counts_sub_t* txrx_counts_sub;
-	u8 pkt_type;
-	pkt_type = (tx_80211_header->frame_control_1 & MAC_FRAME_CTRL1_MASK_TYPE);
 #endif
+	pkt_type = (tx_80211_header->frame_control_1 & MAC_FRAME_CTRL1_MASK_TYPE);
 
 	curr_station_info = station_info_create(tx_80211_header->address_1);
 
@@ -140,6 +178,11 @@ inline station_info_t* station_info_txreport_process(void* pkt_buf_addr, wlan_ma
 		curr_station_info->latest_rx_timestamp = curr_system_time;
 	}
 
+	// Only unicast data frames are sent at the rate chosen by the rate selection scheme
+	if((pkt_type == MAC_FRAME_CTRL1_TYPE_DATA) && !wlan_addr_mcast(tx_80211_header->address_1)){
+		rate_selection_txreport_process(&(curr_station_info->rate_info), wlan_mac_low_tx_details);
+	}
+
 #if WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
 	curr_txrx_counts = &(curr_station_info->txrx_counts);
 
@@ -330,6 +373,7 @@ void station_info_print(dl_list* list, u32 option_flags){
 		}
 
 		xil_printf(" Num Tx Queued: %d\n", curr_station_info->num_tx_queued);
+		xil_printf(" Num Tx Queue Drops (full / AQM): %d / %d\n", curr_station_info->queue_drops.num_full, curr_station_info->queue_drops.num_aqm);
 
 		xil_printf(" Data Tx MCS:                %d\n", curr_station_info->tx_params_data.phy.mcs);
 		xil_printf(" Data Tx PHY mode:           %d\n", curr_station_info->tx_params_data.phy.phy_mode);
@@ -339,6 +383,7 @@ void station_info_print(dl_list* list, u32 option_flags){
 		xil_printf(" Management Tx PHY mode:     %d\n", curr_station_info->tx_params_mgmt.phy.phy_mode);
 		xil_printf(" Management Tx power:        %d\n", curr_station_info->tx_params_mgmt.phy.power);
 		xil_printf(" Management Tx antenna_mode: 0x%x\n", curr_station_info->tx_params_mgmt.phy.antenna_mode);
+		rate_selection_print(&(curr_station_info->rate_info));
 
 #if WLAN_SW_CONFIG_ENABLE_TXRX_COUNTS
 		if(option_flags & STATION_INFO_PRINT_OPTION_FLAG_INCLUDE_COUNTS){
@@ -394,6 +439,7 @@ void station_info_reset_all_counts_txrx(){
 
 		bzero(&(curr_txrx_counts->data), sizeof(txrx_counts_sub_t));
 		bzero(&(curr_txrx_counts->mgmt), sizeof(txrx_counts_sub_t));
+		curr_station_info->generation = station_info_generation;
 
 		curr_dl_entry = dl_entry_prev(curr_dl_entry);
 		i++;
@@ -414,9 +460,11 @@ void station_info_timestamp_check() {
 
 		if((get_system_time_usec() - curr_station_info->latest_txrx_timestamp) > STATION_INFO_TIMEOUT_USEC){
 			if( ((curr_station_info->flags & STATION_INFO_FLAG_KEEP) == 0) && (curr_station_info->num_tx_queued <= 0) ){
+				station_info_hash_remove((station_info_entry_t*)curr_dl_entry);
 				station_info_clear(curr_station_info);
 				dl_entry_remove(&station_info_list, curr_dl_entry);
 				station_info_checkin(curr_dl_entry);
+				station_info_removal_generation = station_info_generation;
 			}
 		} else {
 			// Nothing after this entry is older, so it's safe to quit
@@ -477,10 +525,10 @@ station_info_entry_t* station_info_find_by_addr(u8* addr, dl_list* list){
 	station_info_entry_t* curr_station_info_entry;
 	dl_list* list_to_search;
 
-	if(list == NULL){
+	if((list == NULL) || (list == &station_info_list)){
 		//Optional "list" argument not provided. Search will occur over
-		// flat "station_info_list" global.
-		list_to_search = &station_info_list;
+		// flat "station_info_list" global, which is indexed by address.
+		return station_info_hash_find(addr);
 	} else {
 		list_to_search = list;
 	}
@@ -520,6 +568,45 @@ station_info_entry_t* station_info_find_oldest(){
 }
 
 
+/**
+ * @brief Station Info Address Hash
+ *
+ * Returns the home bucket of the station_info_entry_t at the given index in the
+ * station_info_hash index. See hash_index_addr_bucket().
+ *
+ * @param  u32 index
+ *     - Index of the entry in STATION_INFO_DL_ENTRY_MEM
+ * @return u32
+ *     - Home bucket for the entry's address
+ */
+static u32 station_info_hash_entry_bucket(u32 index){
+	return hash_index_addr_bucket(station_info_entry_base[index].addr, STATION_INFO_HASH_NUM_BITS);
+}
+
+static void station_info_hash_insert(station_info_entry_t* entry){
+	hash_index_insert(&station_info_hash, entry - station_info_entry_base);
+}
+
+static void station_info_hash_remove(station_info_entry_t* entry){
+	hash_index_remove(&station_info_hash, entry - station_info_entry_base);
+}
+
+static station_info_entry_t* station_info_hash_find(u8* addr){
+	u32 bucket = hash_index_addr_bucket(addr, STATION_INFO_HASH_NUM_BITS);
+	u32 value;
+	station_info_entry_t* curr_station_info_entry;
+
+	while((value = hash_index_probe(&station_info_hash, &bucket)) != 0){
+		curr_station_info_entry = &(station_info_entry_base[value - 1]);
+
+		if (wlan_addr_eq(addr, curr_station_info_entry->addr)) {
+			return curr_station_info_entry;
+		}
+	}
+	return NULL;
+}
+
+
 
 // Function will create a station_info_t and make sure that the address is unique
 // in the flat station_info_list.
@@ -546,7 +633,9 @@ station_info_t* station_info_create(u8* addr){
 			curr_station_info_entry = station_info_find_oldest();
 
 			if (curr_station_info_entry != NULL) {
+				station_info_hash_remove(curr_station_info_entry);
 				dl_entry_remove(&station_info_list, (dl_entry*)curr_station_info_entry);
+				station_info_removal_generation = station_info_generation;
 			} else {
 				xil_printf("Cannot create station_info.\n");
 				return NULL;
@@ -565,6 +654,9 @@ station_info_t* station_info_create(u8* addr){
 		// Copy the addr to the station_info_entry_t
 		memcpy(curr_station_info_entry->addr, addr, MAC_ADDR_LEN);
 
+		// Index the entry by its new address
+		station_info_hash_insert(curr_station_info_entry);
+
 		// Set default tx_params_t for management and data frames
 		if (wlan_addr_mcast(addr)){
 			curr_station_info->tx_params_data = default_tx_params.multicast_data;
@@ -572,6 +664,8 @@ station_info_t* station_info_create(u8* addr){
 		} else {
 			curr_station_info->tx_params_data = default_tx_params.unicast_data;
 			curr_station_info->tx_params_mgmt = default_tx_params.unicast_mgmt;
+
+			rate_selection_init_info(&(curr_station_info->rate_info), default_rate_selection_scheme, &(curr_station_info->tx_params_data.phy));
 		}
 	}
 
@@ -589,6 +683,9 @@ station_info_t* station_info_create(u8* addr){
 	// to accidentally have the framework delete this struct.
 	curr_station_info->latest_txrx_timestamp = get_system_time_usec();
 
+	// Every Tx/Rx update of a station goes through this function
+	curr_station_info->generation = station_info_generation;
+
 	// Insert the updated entry into the network list
 	dl_entry_insertEnd(&station_info_list, (dl_entry*)curr_station_info_entry);
 
@@ -615,9 +712,11 @@ void station_info_reset_all(){
 		curr_station_info = (station_info_t*)(curr_dl_entry->data);
 
 		if( ((curr_station_info->flags & STATION_INFO_FLAG_KEEP) == 0) && (curr_station_info->num_tx_queued <= 0)){
+			station_info_hash_remove((station_info_entry_t*)curr_dl_entry);
 			station_info_clear(curr_station_info);
 			dl_entry_remove(&station_info_list, curr_dl_entry);
 			station_info_checkin(curr_dl_entry);
+			station_info_removal_generation = station_info_generation;
 		}
 	}
 }
@@ -644,6 +743,7 @@ void txrx_counts_zero_all(){
 		curr_station_info = (station_info_t*)(curr_dl_entry->data);
 		curr_txrx_counts = &(curr_station_info->txrx_counts);
 		station_info_clear_txrx_counts(curr_txrx_counts);
+		curr_station_info->generation = station_info_generation;
 	}
 
 }
@@ -668,6 +768,79 @@ inline dl_list* station_info_get_list(){
 	return &station_info_list;
 }
 
+/**
+ * @brief Advance Station Info Generation
+ *
+ * Ends the current generation. Every station created or updated from this point
+ * on is stamped with a newer generation than the one returned.
+ *
+ * @param  None
+ * @return u32
+ *     - Generation that just ended. A station changed since a previous call
+ *       returned G has G < generation <= the returned value.
+ */
+u32 station_info_advance_generation(){
+	u32 generation;
+	interrupt_state_t prev_interrupt_state;
+
+	// Stations are stamped in interrupt context, so the increment must not be split
+	prev_interrupt_state = wlan_mac_high_interrupt_stop();
+	generation = station_info_generation++;
+	wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+	return generation;
+}
+
+/**
+ * @brief Get Station Info Removal Generation
+ *
+ * Stations removed from station_info_list leave nothing behind to report, so the
+ * latest removal is recorded as a generation instead.
+ *
+ * @param  None
+ * @return u32
+ *     - Generation during which a station was last removed (0 if none). If it is newer
+ *       than the G a host last synchronized to, the host may hold a stale station.
+ */
+u32 station_info_get_removal_generation(){
+	return station_info_removal_generation;
+}
+
+/**
+ * @brief Find Changed Station Info
+ *
+ * Walks the station_info_t pool in storage order and returns the next station
+ * whose generation is in (since, until]. Unlike station_info_list, the storage
+ * order does not change when a station is updated, so an interrupted walk
+ * neither skips nor repeats stations.
+ *
+ * @param  u32* index
+ *     - Pool index to start from (set to 0 to start a walk); updated to continue the walk
+ * @param  u32 since
+ *     - Generation returned by a previous station_info_advance_generation() (0 for all stations)
+ * @param  u32 until
+ *     - Generation returned by the latest station_info_advance_generation()
+ * @return station_info_t*
+ *     - Pointer to the station_info_t or NULL if there are no more changed stations
+ */
+station_info_t* station_info_find_changed(u32* index, u32 since, u32 until){
+	station_info_t* curr_station_info;
+	u32 generation;
+
+	while(*index < station_info_num_entries){
+		curr_station_info = station_info_entry_base[*index].data;
+		(*index)++;
+
+		// Cleared (ie free) station_info_t structs are generation 0
+		generation = curr_station_info->generation;
+
+		if((generation > since) && (generation <= until)){
+			return curr_station_info;
+		}
+	}
+	return NULL;
+}
+
 /**
  * @brief Add Station Info
  *
@@ -744,9 +917,6 @@ station_info_t*  station_info_add(dl_list* app_station_info_list, u8* addr, u16
 			return NULL;
 		}
 
-		bzero(&(station_info->rate_info),sizeof(rate_selection_info_t));
-		station_info->rate_info.rate_selection_scheme = RATE_SELECTION_SCHEME_STATIC;
-
 		// Populate the entry
 		entry->data = (void*)station_info;
 
@@ -982,3 +1152,32 @@ void wlan_mac_reapply_default_tx_params(){
 	wlan_mac_high_update_beacon_tx_params(&(default_tx_params.multicast_mgmt));
 
 }
+
+u16 station_info_get_default_rate_selection_scheme(){
+	return default_rate_selection_scheme;
+}
+
+/**
+ * @brief Set Default Rate Selection Scheme
+ *
+ * Sets the rate selection scheme given to unicast station_info_t structs as they
+ * are created. Existing station_info_t structs are not modified.
+ *
+ * @param  u16 scheme
+ *     - Rate selection scheme (RATE_SELECTION_SCHEME_*)
+ * @return None
+ */
+void station_info_set_default_rate_selection_scheme(u16 scheme){
+	default_rate_selection_scheme = scheme;
+}
+
+void station_info_set_rate_selection_scheme(station_info_t* station_info, u16 scheme){
+	if (station_info == NULL) return;
+
+	// Multicast frames are never acknowledged, so they are always sent at a static rate
+	if (wlan_addr_mcast(station_info->addr)) scheme = RATE_SELECTION_SCHEME_STATIC;
+
+	if (station_info->rate_info.rate_selection_scheme != scheme){
+		rate_selection_init_info(&(station_info->rate_info), scheme, &(station_info->tx_params_data.phy));
+	}
+}
@@ -100,7 +100,6 @@ mac_header_80211_common tx_header_common;
 network_info_t* active_network_info;
 
 // Tx queue variables;
-static u32 max_queue_size;
 volatile u8 pause_data_queue;
 
 // MAC address
@@ -129,15 +128,18 @@ int main() {
 	// Initialize Microblaze --
 	//  these functions should be called before anything
 	//  else is executed
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+	Xil_DCacheEnable();
+#else
 	Xil_DCacheDisable();
+#endif
 	Xil_ICacheDisable();
 	microblaze_enable_exceptions();
 
 	u64 scan_start_timestamp;
 	u64 scan_duration;
 	u8 locally_administered_addr[MAC_ADDR_LEN];
-	dl_list* ssid_match_list = NULL;
-	dl_entry* temp_dl_entry = NULL;
+	network_info_entry_t* temp_network_info_entry = NULL;
 	network_info_t* temp_network_info = NULL;
 	bss_config_t bss_config;
 	u32 update_mask;
@@ -157,7 +159,10 @@ int main() {
 	wlan_mac_common_malloc_init();
 
 	// Initialize the maximum TX queue size
-	max_queue_size = MAX_TX_QUEUE_LEN;
+	queue_set_default_max_length(MAX_TX_QUEUE_LEN);
+
+	// Management frames must not be dropped by AQM
+	queue_set_aqm_enable(MANAGEMENT_QID, 0);
 
 	// Unpause the queue
 	pause_data_queue       = 0;
@@ -292,28 +297,24 @@ int main() {
 		wlan_mac_scan_start();
 
 		while (((get_system_time_usec() < (scan_start_timestamp + scan_duration))) &&
-				(temp_dl_entry == NULL)) {
+				(temp_network_info_entry == NULL)) {
 			// Only try to find a match if the IBSS has completed at least one full scan
 			if (wlan_mac_scan_get_num_scans() > 0) {
-				ssid_match_list = wlan_mac_high_find_network_info_SSID(default_ssid);
-
-				if (ssid_match_list->length > 0) {
-					// Join the first entry in the list
-					//     - This could be modified in the future to use some other selection,
-					//       for example RX power.
-					//
-					temp_dl_entry = ssid_match_list->first;
-				}
+				// Join the first matching network
+				//     - This could be modified in the future to use some other selection,
+				//       for example RX power.
+				//
+				temp_network_info_entry = wlan_mac_high_find_network_info_SSID(default_ssid, NULL);
 			}
 		}
 
 		wlan_mac_scan_stop();
 
 		// Set the BSSID / SSID / Channel based on whether the scan was successful
-		if (temp_dl_entry != NULL) {
+		if (temp_network_info_entry != NULL) {
 			// Found an existing network matching the default SSID. Adopt that network's BSS configuration
 			xil_printf("Found existing %s network. Matching BSS settings.\n", default_ssid);
-			temp_network_info = (network_info_t*)(temp_dl_entry->data);
+			temp_network_info = temp_network_info_entry->data;
 
 			bss_config = temp_network_info->bss_config;
 		} else {
@@ -486,6 +487,7 @@ void poll_tx_queues(){
 	u32 i;
 
 	int num_pkt_bufs_avail;
+	int num_pkt_bufs_avail_init;
 	int poll_loop_cnt;
 
 	// Remember the next group to poll between calls to this function
@@ -509,12 +511,13 @@ void poll_tx_queues(){
 
 	// First handle the general packet buffer group
 	num_pkt_bufs_avail = wlan_mac_num_tx_pkt_buf_available(PKT_BUF_GROUP_GENERAL);
+	num_pkt_bufs_avail_init = num_pkt_bufs_avail;
 
-	// This loop will (at most) check every queue twice
+	// This loop will (at most) check every queue once per available packet buffer
 	//  This handles the case of a single non-empty queue needing to supply packets
-	//  for both GENERAL packet buffers
+	//  for every available GENERAL packet buffer
 	poll_loop_cnt = 0;
-	while((num_pkt_bufs_avail > 0) && (poll_loop_cnt < (2*NUM_QUEUE_GROUPS))) {
+	while((num_pkt_bufs_avail > 0) && (poll_loop_cnt < (num_pkt_bufs_avail_init*NUM_QUEUE_GROUPS))) {
 		poll_loop_cnt++;
 		curr_queue_group = next_queue_group;
 
@@ -592,6 +595,9 @@ void poll_tx_queues(){
 		} // END if(MGMT or DATA queue group)
 	} // END while(buffers available && keep polling)
 
+	// Hand off the last MPDU dequeued above once its copy is finished
+	wlan_mac_high_mpdu_transmit_complete();
+
 	wlan_mac_high_interrupt_restore_state(curr_interrupt_state);
 }
 
@@ -709,7 +715,7 @@ int ethernet_receive(dl_entry* curr_tx_queue_element, u8* eth_dest, u8* eth_src,
 			curr_tx_queue_buffer->station_info = station_info;
 		}
 
-		if(queue_num_queued(queue_sel) < max_queue_size){
+		if(queue_is_full(queue_sel) == 0){
 			// Put the packet in the queue
 			enqueue_after_tail(queue_sel, curr_tx_queue_element);
 
@@ -1113,7 +1119,7 @@ void ltg_event(u32 id, void* callback_arg){
 		do{
 			continue_loop = 0;
 
-			if(queue_num_queued(queue_sel) < max_queue_size){
+			if(queue_is_full(queue_sel) == 0){
 				// Checkout 1 element from the queue;
 				curr_tx_queue_element = queue_checkout();
 				if(curr_tx_queue_element != NULL){
@@ -1383,6 +1389,7 @@ u32	configure_bss(bss_config_t* bss_config, u32 update_mask){
 			}
 			if (update_mask & BSS_FIELD_MASK_SSID) {
 				strncpy(active_network_info->bss_config.ssid, bss_config->ssid, SSID_LEN_MAX);
+				wlan_mac_high_update_network_info_SSID(active_network_info);
 				update_beacon_template = 1;
 			}
 			if (update_mask & BSS_FIELD_MASK_BEACON_INTERVAL) {
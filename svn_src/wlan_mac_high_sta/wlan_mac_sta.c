@@ -86,7 +86,6 @@ u8 my_aid;
 network_info_t* active_network_info;
 
 // Tx queue variables;
-static u32 max_queue_size;
 volatile u8 pause_data_queue;
 
 // MAC address
@@ -112,7 +111,11 @@ int main() {
 	// Initialize Microblaze --
 	//  these functions should be called before anything
 	//  else is executed
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+	Xil_DCacheEnable();
+#else
 	Xil_DCacheDisable();
+#endif
 	Xil_ICacheDisable();
 	microblaze_enable_exceptions();
 
@@ -136,7 +139,10 @@ int main() {
 	wlan_mac_common_malloc_init();
 
 	// Initialize the maximum TX queue size
-	max_queue_size = MAX_TX_QUEUE_LEN;
+	queue_set_default_max_length(MAX_TX_QUEUE_LEN);
+
+	// Management frames (e.g. association requests) must not be dropped by AQM
+	queue_set_aqm_enable(MANAGEMENT_QID, 0);
 
 	// Unpause the queue
 	pause_data_queue = 0;
@@ -413,23 +419,25 @@ void process_scan_state_change(scan_state_t scan_state){
 void poll_tx_queues(){
 	u32 i;
 	int num_pkt_bufs_avail;
+	int num_pkt_bufs_avail_init;
 	int poll_loop_cnt;
 	dl_entry* tx_queue_buffer_entry;
 
 	#define MAX_NUM_QUEUE 2
 
 	num_pkt_bufs_avail = wlan_mac_num_tx_pkt_buf_available(PKT_BUF_GROUP_GENERAL);
+	num_pkt_bufs_avail_init = num_pkt_bufs_avail;
 
 
 	// Are we pausing transmissions?
 	if (pause_data_queue == 0) {
 		static u32 queue_index = 0;
 
-		// This loop will (at most) check every queue twice
+		// This loop will (at most) check every queue once per available packet buffer
 		//  This handles the case of a single non-empty queue needing to supply packets
-		//  for both GENERAL packet buffers
+		//  for every available GENERAL packet buffer
 		poll_loop_cnt = 0;
-		while((num_pkt_bufs_avail > 0) && (poll_loop_cnt < (2*MAX_NUM_QUEUE))) {
+		while((num_pkt_bufs_avail > 0) && (poll_loop_cnt < (num_pkt_bufs_avail_init*MAX_NUM_QUEUE))) {
 			poll_loop_cnt++;
 
 			queue_index = (queue_index + 1) % MAX_NUM_QUEUE;
@@ -469,6 +477,9 @@ void poll_tx_queues(){
 			}
 		}
 	}
+
+	// Hand off the last MPDU dequeued above once its copy is finished
+	wlan_mac_high_mpdu_transmit_complete();
 }
 
 
@@ -522,7 +533,7 @@ int ethernet_receive(dl_entry* curr_tx_queue_element, u8* eth_dest, u8* eth_src,
 		ap_station_info = (station_info_t*)((active_network_info->members.first)->data);
 
 		// Send the packet to the AP
-		if(queue_num_queued(UNICAST_QID) < max_queue_size){
+		if(queue_is_full(UNICAST_QID) == 0){
 
 			// Send the pre-encapsulated Ethernet frame over the wireless interface
 			//     NOTE:  The queue element has already been provided, so we do not need to check if it is NULL
@@ -864,7 +875,7 @@ void ltg_event(u32 id, void* callback_arg){
 		ap_station_info = (station_info_t*)((active_network_info->members.first)->data);
 
 		// Send a Data packet to AP
-		if(queue_num_queued(UNICAST_QID) < max_queue_size){
+		if(queue_is_full(UNICAST_QID) == 0){
 			// Checkout 1 element from the queue;
 			curr_tx_queue_element = queue_checkout();
 			if(curr_tx_queue_element != NULL){
@@ -1176,6 +1187,7 @@ u32	configure_bss(bss_config_t* bss_config, u32 update_mask){
 			}
 			if (update_mask & BSS_FIELD_MASK_SSID) {
 				strncpy(active_network_info->bss_config.ssid, bss_config->ssid, SSID_LEN_MAX);
+				wlan_mac_high_update_network_info_SSID(active_network_info);
 			}
 			if (update_mask & BSS_FIELD_MASK_BEACON_INTERVAL) {
 				active_network_info->bss_config.beacon_interval = bss_config->beacon_interval;
@@ -426,8 +426,7 @@ void wlan_mac_sta_join_return_to_idle(){
  *
  *****************************************************************************/
 void wlan_mac_sta_join_bss_search_poll(u32 schedule_id){
-	dl_list* ssid_match_list = NULL;
-    dl_entry* curr_dl_entry = NULL;
+    network_info_entry_t* curr_network_info_entry = NULL;
 
     switch(join_state){
         case IDLE:
@@ -440,14 +439,13 @@ void wlan_mac_sta_join_bss_search_poll(u32 schedule_id){
             	// networks with matching SSIDs. In this scenario, the condition on
             	// wlan_mac_scan_get_num_scans() may be made more strict to require at least
             	// one full "loop" through all channels.
-                ssid_match_list = wlan_mac_high_find_network_info_SSID(gl_join_parameters.ssid);
+                // Join the first matching network
+                //     - This could be modified in the future to use some other selection,
+                //       for example RX power.
+                //
+                curr_network_info_entry = wlan_mac_high_find_network_info_SSID(gl_join_parameters.ssid, NULL);
 
-                if (ssid_match_list->length > 0) {
-                    // Join the first entry in the list
-                    //     - This could be modified in the future to use some other selection,
-                    //       for example RX power.
-                    //
-                    curr_dl_entry = ssid_match_list->first;
+                if (curr_network_info_entry != NULL) {
 
                     // Return to the IDLE state
                     //     - Will stop the current scan
@@ -455,7 +453,7 @@ void wlan_mac_sta_join_bss_search_poll(u32 schedule_id){
                     wlan_mac_sta_join_return_to_idle();
 
                     // Set network info to attempt to join
-                    attempt_network_info = (network_info_t*)(curr_dl_entry->data);
+                    attempt_network_info = curr_network_info_entry->data;
 
 	               // Start the "ATTEMPTING" process
 	               start_join_attempt();
@@ -27,6 +27,7 @@
 #include "wlan_mac_802_11_defs.h"
 #include "wlan_mac_queue.h"
 #include "wlan_mac_high.h"
+#include "wlan_mac_high_mailbox_util.h"
 #include "wlan_mac_packet_types.h"
 #include "wlan_mac_eth_util.h"
 #include "wlan_mac_sta.h"
@@ -38,6 +39,7 @@
 #include "wlan_mac_scan.h"
 #include "wlan_mac_station_info.h"
 #include "wlan_platform_common.h"
+#include "wlan_platform_high.h"
 
 
 //
@@ -181,6 +183,20 @@ void uart_rx(u8 rxByte){
 					wlan_mac_high_display_mallinfo();
 				break;
 
+				// ----------------------------------------
+				// 'i' - Display IPC receive, Ethernet Tx and scheduler execution counts
+				//
+				case ASCII_i:
+					wlan_mac_high_print_ipc_rx_counts();
+					wlan_mac_schedule_print_exec_monitor();
+#if WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
+					wlan_platform_ethernet_print_tx_counts();
+#endif //WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
+#if WLAN_MAC_HIGH_PKT_PROC_BENCHMARK
+					wlan_mac_high_print_pkt_proc_benchmark();
+#endif
+				break;
+
 				// ----------------------------------------
 				// 'x' - Reset network list
 				//
@@ -24,7 +24,7 @@ enum phy_samp_rate_t;
 struct beacon_txrx_configure_t;
 
 #define PKT_BUF_INVALID                                   0xFF
-#define MAX_NUM_PENDING_TX_PKT_BUFS 					  5
+#define MAX_NUM_PENDING_TX_PKT_BUFS 					  NUM_TX_PKT_BUF_MPDU    ///< CPU High may hand off every MPDU packet buffer at once
 
 
 //-----------------------------------------------
@@ -74,6 +74,27 @@ typedef struct mac_timing{
 #define LOW_PARAM_DCF_PHYSICAL_CS_THRESH                   0x10000004
 #define LOW_PARAM_DCF_CW_EXP_MIN                           0x10000005
 #define LOW_PARAM_DCF_CW_EXP_MAX                           0x10000006
+#define LOW_PARAM_DCF_PRINT_LOOP_STATS                     0x10000007     ///< Print main loop stats to the CPU Low UART; non-zero payload[1] also resets them
+
+
+//-----------------------------------------------
+// Main loop instrumentation
+//     - Time spent servicing each event source is measured with the 1 usec
+//       system time counter, so services shorter than 1 usec may count as 0
+//     - The stats live in gl_loop_stats and can also be read from CPU Low memory
+//
+#define DCF_LOOP_STATS                                     1
+
+//-----------------------------------------------
+// Tx setup instrumentation
+//     - When enabled, DCF_TX_PERF_MON_GPIO_MASK is raised on entry to a
+//       frame_transmit_*() variant and lowered once Tx controller A has been
+//       started for the first attempt, so per-variant setup time can be
+//       compared on a scope
+//     - The pin must be one of the SW-controlled debug header outputs
+//
+#define DCF_TX_PERF_MON_GPIO_MASK                          0x1000
+// #define _DCF_TX_PERF_MON_EN_                                      ///< Tx Setup Performance Monitor Toggle
 
 
 
@@ -105,6 +126,45 @@ typedef enum tx_mode_t{
     TX_MODE_LONG
 } tx_mode_t;
 
+
+// Specialized frame_transmit_general() paths; the path is chosen once per MPDU
+typedef enum dcf_tx_path_t{
+    DCF_TX_PATH_UNICAST,                                   ///< Unicast MPDU at or below the RTS threshold
+    DCF_TX_PATH_MCAST,                                     ///< MPDU that does not require a post-Tx timeout
+    DCF_TX_PATH_RTS                                        ///< Unicast MPDU above the RTS threshold
+} dcf_tx_path_t;
+
+
+//-----------------------------------------------
+// Main loop event sources
+//     - Sources are serviced in this (priority) order on each pass of the loop
+//
+typedef enum dcf_event_source_t{
+    DCF_EVENT_RX_START,
+    DCF_EVENT_IPC_RX,
+    DCF_EVENT_TX_READY,
+    DCF_EVENT_TBTT,
+    DCF_NUM_EVENT_SOURCES
+} dcf_event_source_t;
+
+#define DCF_EVENT_MASK(source)                             (1 << (source))
+
+
+typedef struct dcf_event_stats_t{
+    u32 num_serviced;                       ///< # of times the source was serviced
+    u32 max_usec;                           ///< Longest service time
+    u64 total_usec;                         ///< Total service time
+} dcf_event_stats_t;
+
+typedef struct dcf_loop_stats_t{
+    u64               start_usec;           ///< System time when the stats were reset
+    u32               num_loops;            ///< # of passes through the main loop
+    u32               num_idle_loops;       ///< # of passes with no pending event
+    dcf_event_stats_t source[DCF_NUM_EVENT_SOURCES];
+    u64               tx_starve_start_usec; ///< System time the GENERAL Tx ready list ran dry (0 if it has not)
+    dcf_event_stats_t tx_starve;            ///< Gaps between the GENERAL Tx ready list running dry and the next READY
+} dcf_loop_stats_t;
+
 /*************************** Function Prototypes *****************************/
 int                main();
 
@@ -133,6 +193,11 @@ void        	   increment_lrc(u16* lrc_ptr);
 
 void 	   		   poll_tbtt_and_send_beacon();
 
+u32                get_pending_events();
+void               service_events(u32 events);
+void               reset_loop_stats();
+void               print_loop_stats();
+
 #define 		   SEND_BEACON_RETURN_DTIM			0x00000001
 #define 		   SEND_BEACON_RETURN_CANCELLED		0x00000002
 u32 		   	   send_beacon(u8 tx_pkt_buf);
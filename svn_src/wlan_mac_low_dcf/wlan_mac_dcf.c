@@ -33,6 +33,10 @@
 #include "wlan_mac_pkt_buf_util.h"
 #include "wlan_mac_low.h"
 #include "wlan_mac_mailbox_util.h"
+#ifdef _DCF_TX_PERF_MON_EN_
+#include "w3_userio_util.h"
+#include "wlan_platform_debug_hdr.h"
+#endif
 
 // WLAN Exp includes
 #include "wlan_exp.h"
@@ -93,9 +97,16 @@ const u8 cts_duration_lookup[3][8] = {
 // Precalculated durations for short (non-RTS) frames
 static u16 gl_precalc_duration[3][8]; ///< To improve reliability in achieving slot-0 transmissions, we precompute duration fields to insert into frames.
 
+// Main loop instrumentation
+static dcf_loop_stats_t gl_loop_stats; ///< Time spent servicing each main loop event source
+
 /*************************** Functions Prototypes ****************************/
 
 int process_low_param(u8 mode, u32* payload); ///< Implementation of DCF-specific processing of low params from wlan_exp
+static void frame_transmit_unicast(u8 pkt_buf);
+static void frame_transmit_mcast(u8 pkt_buf);
+static void frame_transmit_rts(u8 pkt_buf);
+static inline void _frame_transmit(u8 pkt_buf, const dcf_tx_path_t tx_path);
 
 /******************************** Functions **********************************/
 
@@ -107,7 +118,7 @@ int main(){
 	Xil_ICacheDisable();
 	microblaze_enable_exceptions();
 
-	u32 i, poll_tx_pkt_buf_list_return;
+	u32 i;
     wlan_mac_hw_info_t* hw_info;
     compilation_details_t compilation_details;
     bzero(&compilation_details, sizeof(compilation_details_t));
@@ -188,26 +199,163 @@ int main(){
     xil_printf("  Serial Number     : W3-a-%05d\n", hw_info->serial_number);
     xil_printf("  Wireless MAC Addr : %02x:%02x:%02x:%02x:%02x:%02x\n\n", gl_eeprom_addr[0], gl_eeprom_addr[1], gl_eeprom_addr[2], gl_eeprom_addr[3], gl_eeprom_addr[4], gl_eeprom_addr[5]);
 
-    while(1){
+    reset_loop_stats();
 
-        // Poll PHY RX start
+    while(1){
     	gl_waiting_for_response = 0;
-        wlan_mac_low_poll_frame_rx();
 
-        // Poll IPC rx
-        wlan_mac_low_poll_ipc_rx();
+    	// Only service the sources that have something to do
+        service_events(get_pending_events());
+    }
+    return 0;
+}
 
-    	// Poll for new Tx Ready
+/*****************************************************************************/
+/**
+ * @brief Get pending main loop events
+ *
+ * Builds a mask of the event sources that need servicing. Every source is
+ * level-sensitive (latched status bit, mailbox fill level or list length), so an
+ * event that is not serviced on this pass is seen again on the next one.
+ *
+ * @param   None
+ * @return  u32				- Mask of DCF_EVENT_MASK() bits
+ */
+inline u32 get_pending_events(){
+	u32 events = 0;
 
-        do {
-        	poll_tx_pkt_buf_list_return = poll_tx_pkt_buf_list(PKT_BUF_GROUP_GENERAL);
-        } while( poll_tx_pkt_buf_list_return & POLL_TX_PKT_BUF_LIST_RETURN_TRANSMITTED);
+	// PHY Rx start
+	if(wlan_mac_get_status() & WLAN_MAC_STATUS_MASK_RX_PHY_STARTED){
+		events |= DCF_EVENT_MASK(DCF_EVENT_RX_START);
+	}
 
+	// Mailbox not empty or notifications waiting in the batch
+	if(is_mailbox_msg_avail() || is_mailbox_batch_pending()){
+		events |= DCF_EVENT_MASK(DCF_EVENT_IPC_RX);
+	}
 
-        // Poll the timestamp (for periodic transmissions like beacons)
-        poll_tbtt_and_send_beacon();
-    }
-    return 0;
+	// Tx ready list
+	if(gl_tx_pkt_buf_ready_list_general.length > 0){
+		events |= DCF_EVENT_MASK(DCF_EVENT_TX_READY);
+	}
+
+	// TBTT (only checked when this node sends beacons)
+	if(( gl_beacon_txrx_config.beacon_tx_mode == AP_BEACON_TX ) ||
+	   ( gl_beacon_txrx_config.beacon_tx_mode == IBSS_BEACON_TX )){
+		if( wlan_mac_check_tu_latch() ){
+			events |= DCF_EVENT_MASK(DCF_EVENT_TBTT);
+		}
+	}
+
+	return events;
+}
+
+/*****************************************************************************/
+/**
+ * @brief Service main loop events
+ *
+ * Services each pending source in priority order (see dcf_event_source_t) and,
+ * if DCF_LOOP_STATS is set, records the time spent on it.
+ *
+ * @param   u32		events		- Mask returned by get_pending_events()
+ * @return  None
+ */
+inline void service_events(u32 events){
+	u32 source;
+	u32 poll_tx_pkt_buf_list_return;
+#if DCF_LOOP_STATS
+	u64 start_usec;
+	u32 service_usec;
+#endif
+
+#if DCF_LOOP_STATS
+	gl_loop_stats.num_loops++;
+
+	if(events == 0){
+		gl_loop_stats.num_idle_loops++;
+		return;
+	}
+#endif
+
+	for(source = 0; source < DCF_NUM_EVENT_SOURCES; source++){
+		if((events & DCF_EVENT_MASK(source)) == 0) continue;
+
+#if DCF_LOOP_STATS
+		start_usec = get_system_time_usec();
+#endif
+
+		switch(source){
+			case DCF_EVENT_RX_START:
+				wlan_mac_low_poll_frame_rx();
+			break;
+
+			case DCF_EVENT_IPC_RX:
+				wlan_mac_low_poll_ipc_rx();
+			break;
+
+			case DCF_EVENT_TX_READY:
+				do {
+					poll_tx_pkt_buf_list_return = poll_tx_pkt_buf_list(PKT_BUF_GROUP_GENERAL);
+				} while( poll_tx_pkt_buf_list_return & POLL_TX_PKT_BUF_LIST_RETURN_TRANSMITTED);
+			break;
+
+			case DCF_EVENT_TBTT:
+				poll_tbtt_and_send_beacon();
+			break;
+		}
+
+#if DCF_LOOP_STATS
+		service_usec = (u32)(get_system_time_usec() - start_usec);
+
+		gl_loop_stats.source[source].num_serviced++;
+		gl_loop_stats.source[source].total_usec += service_usec;
+		if(service_usec > gl_loop_stats.source[source].max_usec){
+			gl_loop_stats.source[source].max_usec = service_usec;
+		}
+#endif
+	}
+}
+
+/*****************************************************************************/
+/**
+ * @brief Reset / print main loop stats
+ *
+ * The time not spent servicing any source is the headroom of the main loop.
+ *
+ * @param   None
+ * @return  None
+ */
+void reset_loop_stats(){
+	bzero(&gl_loop_stats, sizeof(dcf_loop_stats_t));
+	gl_loop_stats.start_usec = get_system_time_usec();
+}
+
+void print_loop_stats(){
+	const char* source_names[DCF_NUM_EVENT_SOURCES] = {"Rx Start", "IPC Rx", "Tx Ready", "TBTT"};
+	u32 source;
+	u64 elapsed_usec = get_system_time_usec() - gl_loop_stats.start_usec;
+	u64 busy_usec    = 0;
+
+	xil_printf("DCF main loop (%d msec):\n", (u32)(elapsed_usec / 1000));
+	xil_printf("  Loops: %d (%d idle)\n", gl_loop_stats.num_loops, gl_loop_stats.num_idle_loops);
+
+	for(source = 0; source < DCF_NUM_EVENT_SOURCES; source++){
+		busy_usec += gl_loop_stats.source[source].total_usec;
+
+		xil_printf("  %-8s: %10d serviced, %10d usec total, %6d usec max\n", source_names[source],
+				   gl_loop_stats.source[source].num_serviced,
+				   (u32)(gl_loop_stats.source[source].total_usec),
+				   gl_loop_stats.source[source].max_usec);
+	}
+
+	if(elapsed_usec > 0){
+		xil_printf("  Headroom: %d%%\n", (u32)(100 - ((100 * busy_usec) / elapsed_usec)));
+	}
+
+	xil_printf("  Tx starve: %10d gaps,     %10d usec total, %6d usec max\n",
+			   gl_loop_stats.tx_starve.num_serviced,
+			   (u32)(gl_loop_stats.tx_starve.total_usec),
+			   gl_loop_stats.tx_starve.max_usec);
 }
 
 /*****************************************************************************/
@@ -368,7 +516,7 @@ void handle_sample_rate_change(phy_samp_rate_t phy_samp_rate){
 			phy_mode = idx_phy_mode;
 			mcs = wlan_mac_low_mcs_to_ctrl_resp_mcs(idx_mcs, phy_mode);
 
-			gl_precalc_duration[idx_phy_mode][idx_mcs] = wlan_ofdm_calc_txtime(sizeof(mac_header_80211_ACK) + WLAN_PHY_FCS_NBYTES, mcs, PHY_MODE_NONHT, wlan_mac_low_get_phy_samp_rate()) + gl_mac_timing_values.t_sifs;
+			gl_precalc_duration[idx_phy_mode][idx_mcs] = wlan_phy_txtime_lookup(sizeof(mac_header_80211_ACK) + WLAN_PHY_FCS_NBYTES, mcs, PHY_MODE_NONHT) + gl_mac_timing_values.t_sifs;
 		}
 	}
 
@@ -1414,7 +1562,7 @@ u32 frame_receive(u8 rx_pkt_buf, phy_rx_details_t* phy_details) {
     	// race in practice, but step-by-step debugging can accentuate the risk since there can be an arbitrary
     	// amount of time spent in this window.
 
-        if (unlock_rx_pkt_buf(rx_pkt_buf) != PKT_BUF_MUTEX_SUCCESS) {
+        if (wlan_mac_low_release_rx_pkt_buf(rx_pkt_buf) != PKT_BUF_MUTEX_SUCCESS) {
             xil_printf("Error: unable to unlock RX pkt_buf %d\n", rx_pkt_buf);
             wlan_mac_low_send_exception(WLAN_ERROR_CODE_CPU_LOW_RX_MUTEX);
         } else {
@@ -1471,6 +1619,20 @@ int handle_tx_pkt_buf_ready(u8 pkt_buf){
 
 		dl_entry_insertEnd(list, entry);
 
+#if DCF_LOOP_STATS
+		// Close out a gap during which CPU Low had nothing to send from the GENERAL group
+		if((list == &gl_tx_pkt_buf_ready_list_general) && (gl_loop_stats.tx_starve_start_usec != 0)){
+			u32 starve_usec = (u32)(get_system_time_usec() - gl_loop_stats.tx_starve_start_usec);
+
+			gl_loop_stats.tx_starve.num_serviced++;
+			gl_loop_stats.tx_starve.total_usec += starve_usec;
+			if(starve_usec > gl_loop_stats.tx_starve.max_usec){
+				gl_loop_stats.tx_starve.max_usec = starve_usec;
+			}
+			gl_loop_stats.tx_starve_start_usec = 0;
+		}
+#endif
+
 	} else {
 		return_value = -1;
 	}
@@ -1524,6 +1686,12 @@ u32 poll_tx_pkt_buf_list(pkt_buf_group_t pkt_buf_group){
 
 				dl_entry_remove(&gl_tx_pkt_buf_ready_list_general, entry);
 				dl_entry_insertEnd(&gl_tx_pkt_buf_ready_list_free, entry);
+
+#if DCF_LOOP_STATS
+				if(gl_tx_pkt_buf_ready_list_general.length == 0){
+					gl_loop_stats.tx_starve_start_usec = get_system_time_usec();
+				}
+#endif
 			}
 		break;
 		case PKT_BUF_GROUP_DTIM_MCAST:
@@ -1809,12 +1977,61 @@ u32 frame_transmit_dtim_mcast(u8 pkt_buf, u8 resume) {
  * @brief Handles transmission of a general packet
  *
  * This function is responsible for using Tx Controller A to send a new MPDU and handle
- * any retries that the MPDU may require.
+ * any retries that the MPDU may require. The Tx path (unicast, multicast, or RTS-protected)
+ * is selected once here and each path runs a copy of _frame_transmit() specialized for it.
  *
  * @param   pkt_buf     - Index of the Tx packet buffer containing the packet to transmit
  * @return  none
  */
 void frame_transmit_general(u8 pkt_buf) {
+    tx_frame_info_t* tx_frame_info = (tx_frame_info_t*) (CALC_PKT_BUF_ADDR(platform_common_dev_info.tx_pkt_buf_baseaddr, pkt_buf));
+
+#ifdef _DCF_TX_PERF_MON_EN_
+    wlan_mac_set_dbg_hdr_out(DCF_TX_PERF_MON_GPIO_MASK);
+#endif
+
+    if(((tx_frame_info->flags) & TX_FRAME_INFO_FLAGS_REQ_TO) == 0){
+        frame_transmit_mcast(pkt_buf);
+    } else if(tx_frame_info->length <= gl_dot11RTSThreshold){
+        frame_transmit_unicast(pkt_buf);
+    } else {
+        frame_transmit_rts(pkt_buf);
+    }
+}
+
+/*****************************************************************************/
+/**
+ * @brief Specialized Tx paths
+ *
+ * Each of these is a separate copy of _frame_transmit() with the Tx path fixed at
+ * compile time, so the RTS / ACK / no-response decisions in the retry loop fold away.
+ *
+ * @param   pkt_buf     - Index of the Tx packet buffer containing the packet to transmit
+ * @return  none
+ */
+static void frame_transmit_unicast(u8 pkt_buf) {
+    _frame_transmit(pkt_buf, DCF_TX_PATH_UNICAST);
+}
+
+static void frame_transmit_mcast(u8 pkt_buf) {
+    _frame_transmit(pkt_buf, DCF_TX_PATH_MCAST);
+}
+
+static void frame_transmit_rts(u8 pkt_buf) {
+    _frame_transmit(pkt_buf, DCF_TX_PATH_RTS);
+}
+
+/*****************************************************************************/
+/**
+ * @brief Shared body of the specialized Tx paths
+ *
+ * Always inlined into the frame_transmit_*() variants with a constant tx_path.
+ *
+ * @param   pkt_buf     - Index of the Tx packet buffer containing the packet to transmit
+ * @param   tx_path     - DCF_TX_PATH_* value (must be a compile-time constant)
+ * @return  none
+ */
+static inline __attribute__((always_inline)) void _frame_transmit(u8 pkt_buf, const dcf_tx_path_t tx_path) {
     u8  mac_cfg_mcs;
     u16 mac_cfg_length;
     u8  mac_cfg_pkt_buf;
@@ -1858,13 +2075,27 @@ void frame_transmit_general(u8 pkt_buf) {
     tx_frame_info->num_tx_attempts = 0;
     tx_frame_info->phy_samp_rate = (u8)wlan_mac_low_get_phy_samp_rate();
 
-	// Compare the length of this frame to the RTS Threshold
-	if(length <= gl_dot11RTSThreshold) {
-		tx_mode = TX_MODE_SHORT;
-	} else {
-		tx_mode = TX_MODE_LONG;
+	// The unicast and RTS paths were selected by comparing the length of this frame to the
+	// RTS Threshold, so only the multicast path still needs the comparison (for the retry counters)
+	switch(tx_path){
+		case DCF_TX_PATH_UNICAST:
+			tx_mode = TX_MODE_SHORT;
+		break;
+		case DCF_TX_PATH_RTS:
+			tx_mode = TX_MODE_LONG;
+		break;
+		default:
+			if(length <= gl_dot11RTSThreshold) {
+				tx_mode = TX_MODE_SHORT;
+			} else {
+				tx_mode = TX_MODE_LONG;
+			}
+		break;
 	}
 
+	// Only the multicast path is sent without a post-Tx timeout
+	req_timeout = (tx_path != DCF_TX_PATH_MCAST);
+
 	if((tx_frame_info->flags) & TX_FRAME_INFO_FLAGS_FILL_DURATION){
 		// ACK_N_DBPS is used to calculate duration of the ACK waveform which might be received in response to this transmission
 		//  The ACK duration is used to calculate the DURATION field in the MAC header
@@ -1885,9 +2116,6 @@ void frame_transmit_general(u8 pkt_buf) {
 
 		(tx_frame_info->num_tx_attempts)++;
 
-		// Check if the higher-layer MAC requires this transmission have a post-Tx timeout
-		req_timeout = ((tx_frame_info->flags) & TX_FRAME_INFO_FLAGS_REQ_TO) != 0;
-
 		// Write the SIGNAL field (interpreted by the PHY during Tx waveform generation)
 		// This is the SIGNAL field for the MPDU we will eventually transmit. It's possible
 		// the next waveform we send will be an RTS with its own independent SIGNAL
@@ -1895,7 +2123,7 @@ void frame_transmit_general(u8 pkt_buf) {
 		//wlan_phy_set_tx_signal(mpdu_pkt_buf, mpdu_rate, mpdu_length);
 		write_phy_preamble(pkt_buf, phy_mode, mcs, length);
 
-		if ((tx_mode == TX_MODE_LONG) && (req_timeout == 1)) {
+		if (tx_path == DCF_TX_PATH_RTS) {
 			// This is a long MPDU that requires an RTS/CTS handshake prior to the MPDU transmission.
 			tx_wait_state   = TX_WAIT_CTS;
 
@@ -1934,7 +2162,7 @@ void frame_transmit_general(u8 pkt_buf) {
 			}
 
 			rts_header_duration = (gl_mac_timing_values.t_sifs) + cts_header_duration +
-								  (gl_mac_timing_values.t_sifs) + wlan_ofdm_calc_txtime(length, tx_frame_info->params.phy.mcs, tx_frame_info->params.phy.phy_mode, wlan_mac_low_get_phy_samp_rate()) +
+								  (gl_mac_timing_values.t_sifs) + wlan_phy_txtime_lookup(length, tx_frame_info->params.phy.mcs, tx_frame_info->params.phy.phy_mode) +
 								  header->duration_id;
 
 			// We let "duration" be equal to the duration field of an RTS. This value is provided explicitly to CPU_HIGH
@@ -1955,7 +2183,7 @@ void frame_transmit_general(u8 pkt_buf) {
 			// Configure the Tx power - update all antennas, even though only one will be used
 			curr_tx_pow = wlan_mac_low_get_current_ctrl_tx_pow();
 
-		} else if((tx_mode == TX_MODE_SHORT) && (req_timeout == 1)) {
+		} else if(tx_path == DCF_TX_PATH_UNICAST) {
 			// Unicast, no RTS
 			tx_wait_state = TX_WAIT_ACK;
 			mac_cfg_mcs = mcs;
@@ -2023,6 +2251,10 @@ void frame_transmit_general(u8 pkt_buf) {
 		wlan_mac_tx_ctrl_A_start(1);
 		wlan_mac_tx_ctrl_A_start(0);
 
+#ifdef _DCF_TX_PERF_MON_EN_
+		wlan_mac_clear_dbg_hdr_out(DCF_TX_PERF_MON_GPIO_MASK);
+#endif
+
 		// Immediately re-read the current slot count.
 		n_slots_readback = wlan_mac_get_backoff_count_A();
 
@@ -2657,6 +2889,15 @@ int process_low_param(u8 mode, u32* payload){
                 }
                 break;
 
+                //---------------------------------------------------------------------
+                case LOW_PARAM_DCF_PRINT_LOOP_STATS: {
+                    print_loop_stats();
+                    if(payload[1]){
+                        reset_loop_stats();
+                    }
+                }
+                break;
+
                 //---------------------------------------------------------------------
                 default: {}
                 break;
@@ -352,6 +352,7 @@ int 			   wlan_mac_low_finish_frame_transmit(u16 tx_pkt_buf);
 
 
 void        wlan_mac_low_lock_empty_rx_pkt_buf();
+int         wlan_mac_low_release_rx_pkt_buf(u8 pkt_buf);
 
 u32         wlan_mac_hw_rx_finish();
 
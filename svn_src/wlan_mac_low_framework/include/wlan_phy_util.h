@@ -38,6 +38,27 @@ enum phy_samp_rate_t;
 #define N_DBPS_R48  192
 #define N_DBPS_R54  216
 
+// ****************************************************************************
+// Table-driven Tx time lookups
+//     - The table holds one entry per (phy_mode, mcs) and is regenerated by
+//       wlan_phy_txtime_table_update() whenever the PHY sampling rate changes
+//     - Symbol counts use a multiply by ceil(2^WLAN_PHY_TXTIME_RECIP_BITS / N_DBPS)
+//       instead of a divide; this is exact as long as length * N_DBPS stays
+//       below 2^WLAN_PHY_TXTIME_RECIP_BITS
+//     - Longer lengths (and invalid phy_mode / mcs) fall back to wlan_ofdm_calc_*()
+//
+#define WLAN_PHY_TXTIME_RECIP_BITS                         21
+#define WLAN_PHY_TXTIME_MAX_TABLE_LENGTH                   8064
+#define WLAN_PHY_TXTIME_NUM_PHY_MODES                      3          ///< Indexed directly by PHY_MODE_NONHT / PHY_MODE_HTMF
+#define WLAN_PHY_TXTIME_NUM_MCS                            8
+
+typedef struct wlan_phy_txtime_entry_t{
+    u32        n_dbps_recip;                ///< ceil(2^WLAN_PHY_TXTIME_RECIP_BITS / N_DBPS)
+    u16        n_dbps;                      ///< Data bits per OFDM symbol (0 if the entry is unused)
+    u16        t_fixed;                     ///< Preamble + HT preamble + signal extension (usec) at the current sampling rate
+} wlan_phy_txtime_entry_t;
+
+
 /**************************** Macro Definitions ******************************/
 
 #define REG_CLEAR_BITS(addr, mask) Xil_Out32(addr, (Xil_In32(addr) & ~(mask)))
@@ -60,4 +81,9 @@ void write_phy_preamble(u8 pkt_buf, u8 phy_mode, u8 mcs, u16 length);
 u16 wlan_ofdm_calc_txtime(u16 length, u8 mcs, u8 phy_mode, enum phy_samp_rate_t phy_samp_rate);
 u16 wlan_ofdm_calc_num_payload_syms(u16 length, u8 mcs, u8 phy_mode);
 
+// Table-driven equivalents of the above
+void wlan_phy_txtime_table_update(enum phy_samp_rate_t phy_samp_rate);
+u16  wlan_phy_txtime_lookup(u16 length, u8 mcs, u8 phy_mode);
+u16  wlan_phy_num_payload_syms_lookup(u16 length, u8 mcs, u8 phy_mode);
+
 #endif /* WLAN_PHY_UTIL_H_ */
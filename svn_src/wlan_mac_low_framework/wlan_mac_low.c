@@ -215,6 +215,20 @@ int wlan_mac_low_init(u32 type, compilation_details_t compilation_details){
 	// ***************************************************
 	// Initialize Receive Packet Buffers
 	// ***************************************************
+#if RX_PKT_BUF_RING_ENABLE
+	// Buffers are passed with the ring; CPU Low resumes at the head of the ring
+	rx_pkt_buf_ring_t* rx_ring = get_rx_pkt_buf_ring();
+
+	rx_pkt_buf_ring_init(rx_ring);
+
+	for(i = 0; i < NUM_RX_PKT_BUFS; i++){
+		// Buffers published before CPU Low rebooted are handled by CPU High
+		if(((i - rx_ring->tail) % NUM_RX_PKT_BUFS) >= (rx_ring->head - rx_ring->tail)){
+			rx_frame_info = (rx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, i);
+			rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_LOW_CTRL;
+		}
+	}
+#else
 	for(i = 0; i < NUM_RX_PKT_BUFS; i++){
 		rx_frame_info = (rx_frame_info_t*)CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, i);
 		switch(rx_frame_info->rx_pkt_buf_state){
@@ -236,6 +250,7 @@ int wlan_mac_low_init(u32 type, compilation_details_t compilation_details){
 		   break;
 		}
 	}
+#endif
 
     // Create IPC message to receive into
     ipc_msg_from_high.payload_ptr = &(ipc_msg_from_high_payload[0]);
@@ -343,6 +358,9 @@ void set_phy_samp_rate(phy_samp_rate_t phy_samp_rate) {
     	break;
     }
 
+    // Regenerate the Tx time tables first so the callback can use them
+    wlan_phy_txtime_table_update(phy_samp_rate);
+
     // Call user callback so it can deal with any changes that need to happen due to a change in sampling rate
 	sample_rate_change_callback(gl_phy_samp_rate);
 
@@ -595,10 +613,19 @@ inline u32 wlan_mac_low_poll_frame_rx(){
  *
  * This function is a non-blocking poll for IPC receptions from the upper-level MAC.
  *
+ * Batched notifications for the upper-level MAC are sent here unless the PHY has
+ * already started another reception. During back-to-back receptions, this lets the
+ * Rx / Tx notifications for several frames reach CPU High in one mailbox interrupt.
+ *
  * @param   None
  * @return  int				- 0 when mailbox was empty, 1 when one message was processed
  */
 inline int wlan_mac_low_poll_ipc_rx(){
+    // Send batched notifications unless another reception is underway
+    if ((wlan_mac_get_status() & WLAN_MAC_STATUS_MASK_RX_PHY_STARTED) == 0) {
+        flush_mailbox_batch();
+    }
+
     // Poll mailbox read msg
     if (read_mailbox_msg(&ipc_msg_from_high) == IPC_MBOX_SUCCESS) {
         wlan_mac_low_process_ipc_msg(&ipc_msg_from_high);
@@ -1019,7 +1046,7 @@ int wlan_mac_low_finish_frame_transmit(u16 tx_pkt_buf){
 
 					ipc_msg_to_high.arg0 = tx_pkt_buf;
 
-					write_mailbox_msg(&ipc_msg_to_high);
+					write_mailbox_msg_batched(&ipc_msg_to_high);
 				}
 			}
 		break;
@@ -1084,7 +1111,7 @@ void wlan_mac_low_send_low_tx_details(u8 pkt_buf, wlan_mac_low_tx_details_t* low
 	ipc_msg_to_high.num_payload_words = (sizeof(wlan_mac_low_tx_details_t) / sizeof(u32));
 
 	ipc_msg_to_high.msg_id =  IPC_MBOX_MSG_ID(IPC_MBOX_PHY_TX_REPORT);
-	write_mailbox_msg(&ipc_msg_to_high);
+	write_mailbox_msg_batched(&ipc_msg_to_high);
 	return;
 }
 
@@ -1095,7 +1122,8 @@ void wlan_mac_low_send_low_tx_details(u8 pkt_buf, wlan_mac_low_tx_details_t* low
  * @brief Notify upper-level MAC of frame reception
  *
  * Sends an IPC message to the upper-level MAC to notify it that a frame has been
- * received and is ready to be processed
+ * received and is ready to be processed. The message is batched and reaches the
+ * upper-level MAC at the next flush (see wlan_mac_low_poll_ipc_rx()).
  *
  * @param   None
  * @return  None
@@ -1109,7 +1137,7 @@ void wlan_mac_low_frame_ipc_send(){
     ipc_msg_to_high.num_payload_words = 0;
     ipc_msg_to_high.arg0              = rx_pkt_buf;
 
-    write_mailbox_msg(&ipc_msg_to_high);
+    write_mailbox_msg_batched(&ipc_msg_to_high);
 }
 
 
@@ -1277,6 +1305,31 @@ inline void wlan_mac_low_lock_empty_rx_pkt_buf(){
     rx_frame_info_t* rx_frame_info;
     u32 i = 1;
 
+#if RX_PKT_BUF_RING_ENABLE
+    rx_pkt_buf_ring_t* rx_ring = get_rx_pkt_buf_ring();
+    int ring_pkt_buf;
+
+    // The next buffer is the one after the last buffer passed to CPU High. It is
+    // free once CPU High has released it from the ring.
+    while((ring_pkt_buf = rx_pkt_buf_ring_producer_peek(rx_ring)) == -1) {
+        if (i == 1) {
+            // CPU High cannot release Rx packet buffers it has not been told about
+            flush_mailbox_batch();
+            xil_printf("Searching for empty packet buff ... ");
+        }
+        i++;
+    }
+
+    rx_pkt_buf    = ring_pkt_buf;
+    rx_frame_info = (rx_frame_info_t*) CALC_PKT_BUF_ADDR(platform_common_dev_info.rx_pkt_buf_baseaddr, rx_pkt_buf);
+    rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_LOW_CTRL;
+
+    // Set the OFDM and DSSS PHYs to use the same Rx pkt buffer
+    wlan_phy_rx_pkt_buf_ofdm(rx_pkt_buf);
+    wlan_phy_rx_pkt_buf_dsss(rx_pkt_buf);
+
+    if (i > 1) { xil_printf("found in %d iterations.\n", i); }
+#else
     while(1) {
     	//rx_pkt_buf is the global shared by all contexts which deal with wireless Rx
     	// Rx packet buffers are used in order. Thus incrementing rx_pkt_buf should
@@ -1305,9 +1358,45 @@ inline void wlan_mac_low_lock_empty_rx_pkt_buf(){
         }
         }
 
-        if (i == 1) { xil_printf("Searching for empty packet buff ... "); }
+        if (i == 1) {
+        	// CPU High cannot release Rx packet buffers it has not been told about
+        	flush_mailbox_batch();
+        	xil_printf("Searching for empty packet buff ... ");
+        }
         i++;
     }
+#endif
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Release Rx Packet Buffer to CPU High
+ *
+ * Passes ownership of the current Rx packet buffer to CPU High. The caller must set
+ * the rx_pkt_buf_state to RX_PKT_BUF_READY first. With RX_PKT_BUF_RING_ENABLE the
+ * buffer is published in the Rx packet buffer ring; otherwise the buffer mutex is
+ * unlocked.
+ *
+ * @param   pkt_buf          - Index of the Rx packet buffer
+ * @return  int              - PKT_BUF_MUTEX_SUCCESS or a PKT_BUF_MUTEX_FAIL_* status
+ */
+int wlan_mac_low_release_rx_pkt_buf(u8 pkt_buf){
+#if RX_PKT_BUF_RING_ENABLE
+    rx_pkt_buf_ring_t* rx_ring = get_rx_pkt_buf_ring();
+
+    // Buffers are published in order; only the buffer at the head of the ring can be released
+    if (rx_pkt_buf_ring_producer_peek(rx_ring) != pkt_buf) {
+        return PKT_BUF_MUTEX_FAIL_NOT_LOCK_OWNER;
+    }
+
+    rx_pkt_buf_ring_producer_push(rx_ring);
+
+    return PKT_BUF_MUTEX_SUCCESS;
+#else
+    return unlock_rx_pkt_buf(pkt_buf);
+#endif
 }
 
 
@@ -51,6 +51,10 @@ const u8 ones_in_chars[256] = {
 // Common Platform Device Info
 extern platform_common_dev_info_t platform_common_dev_info;
 
+// Tx time lookup table; rows are indexed by PHY mode, columns by MCS
+static wlan_phy_txtime_entry_t gl_txtime_table[WLAN_PHY_TXTIME_NUM_PHY_MODES][WLAN_PHY_TXTIME_NUM_MCS];
+static u8                      gl_txtime_sym_shift;    ///< log2(OFDM symbol duration in usec) at the current sampling rate
+
 
 /*****************************************************************************/
 /**
@@ -117,7 +121,7 @@ void write_phy_preamble(u8 pkt_buf, u8 phy_mode, u8 mcs, u16 length) {
 
 		// Calc (3*(num_payload_syms+num_ht_preamble_syms) = (3*(num_payload_syms+4))
 
-		lsig_length = 3*wlan_ofdm_calc_num_payload_syms(length, mcs, phy_mode) + 12 - 3;
+		lsig_length = 3*wlan_phy_num_payload_syms_lookup(length, mcs, phy_mode) + 12 - 3;
 
 		
 
@@ -240,3 +244,117 @@ inline u16 wlan_ofdm_calc_num_payload_syms(u16 length, u8 mcs, u8 phy_mode) {
      return num_payload_syms;
 }
 
+
+
+/*****************************************************************************/
+/**
+ * Regenerates the Tx time lookup table for a new PHY sampling rate.
+ *
+ * Must be called before any wlan_phy_*_lookup() for the new rate takes effect;
+ * set_phy_samp_rate() calls this before the MAC's sample rate change callback.
+ *
+ * @param   phy_samp_rate  - PHY sampling rate - one of (PHY_10M, PHY_20M, PHY_40M)
+ *
+ * @return  None
+ *****************************************************************************/
+void wlan_phy_txtime_table_update(phy_samp_rate_t phy_samp_rate) {
+	u8  phy_mode, mcs;
+	u16 n_dbps;
+	u16 t_sym;
+	wlan_phy_txtime_entry_t* entry;
+
+	// Same symbol durations as wlan_ofdm_calc_txtime()
+	switch(phy_samp_rate) {
+		case PHY_40M:
+			gl_txtime_sym_shift = 1;
+		break;
+
+		default:
+		case PHY_20M:
+			gl_txtime_sym_shift = 2;
+		break;
+
+		case PHY_10M:
+			gl_txtime_sym_shift = 3;
+		break;
+	}
+	t_sym = 1 << gl_txtime_sym_shift;
+
+	bzero(gl_txtime_table, sizeof(gl_txtime_table));
+
+	for(phy_mode = PHY_MODE_NONHT; phy_mode <= PHY_MODE_HTMF; phy_mode++) {
+		for(mcs = 0; mcs < WLAN_PHY_TXTIME_NUM_MCS; mcs++) {
+			entry  = &(gl_txtime_table[phy_mode][mcs]);
+			n_dbps = wlan_mac_low_mcs_to_n_dbps(mcs, phy_mode);
+
+			entry->n_dbps       = n_dbps;
+			entry->n_dbps_recip = ((1 << WLAN_PHY_TXTIME_RECIP_BITS) + n_dbps - 1) / n_dbps;
+
+			// 5 symbols for STF/LTF/SIGNAL, 4 more for HT-SIG/HT-STF/HT-LTF, plus 6 usec signal extension
+			entry->t_fixed      = (5 * t_sym) + 6;
+			if(phy_mode == PHY_MODE_HTMF) {
+				entry->t_fixed += (4 * t_sym);
+			}
+		}
+	}
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Table-driven version of wlan_ofdm_calc_num_payload_syms().
+ *
+ * @param   length         - Length of MAC payload in bytes
+ * @param   mcs            - MCS index
+ * @param   phy_mode       - PHY waveform mode - either PHY_MODE_NONHT (11a/g) or PHY_MODE_HTMF (11n)
+ *
+ * @return  u16            - Number of OFDM symbols
+ *****************************************************************************/
+inline u16 wlan_phy_num_payload_syms_lookup(u16 length, u8 mcs, u8 phy_mode) {
+	wlan_phy_txtime_entry_t* entry;
+	u32 q, r;
+
+	if((phy_mode >= WLAN_PHY_TXTIME_NUM_PHY_MODES) || (mcs >= WLAN_PHY_TXTIME_NUM_MCS) || (length > WLAN_PHY_TXTIME_MAX_TABLE_LENGTH)) {
+		return wlan_ofdm_calc_num_payload_syms(length, mcs, phy_mode);
+	}
+
+	entry = &(gl_txtime_table[phy_mode][mcs]);
+
+	if(entry->n_dbps == 0) {
+		return wlan_ofdm_calc_num_payload_syms(length, mcs, phy_mode);
+	}
+
+	// With length = q*N_DBPS + r:
+	//   ceil((16 + 8*length + 6) / N_DBPS) = 8*q + ceil((8*r + 22) / N_DBPS)
+	//  Both divides are done as a multiply by the reciprocal and a shift
+	q = (length * entry->n_dbps_recip) >> WLAN_PHY_TXTIME_RECIP_BITS;
+	r = length - (q * entry->n_dbps);
+
+	return (8 * q) + ((((8 * r) + 22 + entry->n_dbps - 1) * entry->n_dbps_recip) >> WLAN_PHY_TXTIME_RECIP_BITS);
+}
+
+
+
+/*****************************************************************************/
+/**
+ * Table-driven version of wlan_ofdm_calc_txtime() at the sampling rate last
+ * passed to wlan_phy_txtime_table_update().
+ *
+ * @param   length         - Length of MAC payload in bytes
+ * @param   mcs            - MCS index
+ * @param   phy_mode       - PHY waveform mode - either PHY_MODE_NONHT (11a/g) or PHY_MODE_HTMF (11n)
+ *
+ * @return  u16            - Duration of transmission in microseconds
+ *****************************************************************************/
+inline u16 wlan_phy_txtime_lookup(u16 length, u8 mcs, u8 phy_mode) {
+	u16 num_payload_syms;
+
+	if((phy_mode >= WLAN_PHY_TXTIME_NUM_PHY_MODES) || (mcs >= WLAN_PHY_TXTIME_NUM_MCS) || (gl_txtime_table[phy_mode][mcs].n_dbps == 0)) {
+		return wlan_ofdm_calc_txtime(length, mcs, phy_mode, wlan_mac_low_get_phy_samp_rate());
+	}
+
+	num_payload_syms = wlan_phy_num_payload_syms_lookup(length, mcs, phy_mode);
+
+	return gl_txtime_table[phy_mode][mcs].t_fixed + (num_payload_syms << gl_txtime_sym_shift);
+}
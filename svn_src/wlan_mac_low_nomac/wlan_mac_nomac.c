@@ -171,7 +171,7 @@ u32 frame_receive(u8 rx_pkt_buf, phy_rx_details_t* phy_details){
     }
 
     rx_frame_info->rx_pkt_buf_state = RX_PKT_BUF_READY;
-	if (unlock_rx_pkt_buf(rx_pkt_buf) != PKT_BUF_MUTEX_SUCCESS) {
+	if (wlan_mac_low_release_rx_pkt_buf(rx_pkt_buf) != PKT_BUF_MUTEX_SUCCESS) {
 		xil_printf("Error: unable to unlock RX pkt_buf %d\n", rx_pkt_buf);
 		wlan_mac_low_send_exception(WLAN_ERROR_CODE_CPU_LOW_RX_MUTEX);
 	} else {
@@ -41,7 +41,44 @@
 #define WLAN_ETH_LINK_SPEED	                               1000
 #define WLAN_ETH_PKT_BUF_SIZE                              0x800               // 2KB - space allocated per pkt
 
+
+//-----------------------------------------------
+// WLAN Ethernet Tx defines
+//     - If WLAN_ETH_TX_ASYNC is 1, wlan_platform_ethernet_send() copies each packet into a Tx
+//       queue buffer and returns as soon as the packet is handed to the DMA. Completed Tx BDs
+//       are reclaimed by the Tx DMA interrupt or by the next send.
+//     - If WLAN_ETH_TX_ASYNC is 0, wlan_platform_ethernet_send() uses a single Tx BD and
+//       blocks until the DMA has read the packet from the caller's buffer.
+//     - Tx BDs are carved from the front of the Eth BD memory; the remainder is used for Rx BDs.
+//
+#define WLAN_ETH_TX_ASYNC                                  1
+#define WLAN_ETH_TX_NUM_BD                                 16
+#define WLAN_ETH_TX_COALESCE_COUNT                         4                   // Tx completions per interrupt
+#define WLAN_ETH_TX_COALESCE_DELAY                         16                  // Tx interrupt delay timeout (DMA delay timer units)
+
+
+/********************************************************************
+ * @brief Ethernet Tx Counts
+ *
+ * Counts maintained by the asynchronous Ethernet Tx path
+ *
+ ********************************************************************/
+typedef struct eth_tx_counts_t{
+    u32        num_pkts;                    ///< # of packets submitted to the Tx DMA
+    u32        num_batches;                 ///< # of XAxiDma_BdRingToHw() calls used to submit them
+    u32        num_pkts_reclaimed;          ///< # of completed packets whose BD / buffer were reclaimed
+    u32        num_drops;                   ///< # of packets dropped (no Tx queue buffer or DMA error)
+    u32        num_ring_full;               ///< # of sends that waited on a completion because every Tx BD was in use
+    u32        bd_high_water_mark;          ///< Maximum # of Tx BDs in use at once
+    u32        reclaim_latency_max;         ///< Maximum time (usec) from submission to reclaim
+    u32        num_dma_errors;              ///< # of Tx DMA errors recovered by resetting the DMA
+    u64        reclaim_latency_sum;         ///< Sum of submission-to-reclaim times (usec)
+} eth_tx_counts_t;
+
 int wlan_platform_ethernet_send(u8* pkt_ptr, u32 length);
+void wlan_platform_ethernet_tx_batch_start();
+int wlan_platform_ethernet_tx_batch_end();
+void wlan_platform_ethernet_print_tx_counts();
 int w3_wlan_platform_ethernet_init();
 int w3_wlan_platform_ethernet_setup_interrupt(XIntc* intc);
 void w3_wlan_platform_ethernet_free_queue_entry_notify();
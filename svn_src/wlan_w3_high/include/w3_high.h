@@ -62,6 +62,9 @@
 #define TIMER_FREQ                           XPAR_TMRCTR_0_CLOCK_FREQ_HZ
 #define PLATFORM_INT_ID_TIMER                XPAR_INTC_0_TMRCTR_0_VEC_ID        ///< XParameters rename of timer interrupt ID
 
+// CPU
+#define CPU_FREQ                             XPAR_CPU_CORE_CLOCK_FREQ_HZ
+
 // Central DMA (CMDA)
 #define PLATFORM_DEV_ID_CMDA				 XPAR_AXI_CDMA_0_DEVICE_ID
 
@@ -11,6 +11,7 @@
 #include "xaxidma.h"
 #include "xintc.h"
 #include "stddef.h"
+#include "string.h"
 #include "wlan_platform_common.h"
 #include "wlan_platform_high.h"
 #include "wlan_mac_common.h"
@@ -73,14 +74,229 @@ static u32 gl_eth_rx_bd_mem_high;
 static u32                   bd_high_water_mark;
 #endif
 
+// Ethernet Tx variables
+//
+//   Transmissions are copied into Tx queue buffers and handed to the DMA without waiting for
+// completion. Each Tx BD's ID field holds the dl_entry* of its Tx queue buffer so the buffer
+// can be checked back in when the BD is reclaimed. Packets sent while a batch is open are
+// allocated BDs but only pushed to hardware (with one XAxiDma_BdRingToHw() call) when the
+// batch ends.
+static eth_tx_counts_t       eth_tx_counts;
+
+#if WLAN_ETH_TX_ASYNC
+static u8                    tx_batch_open;
+static u32                   tx_batch_count;
+static XAxiDma_Bd*           tx_batch_first_bd_ptr;
+static u64                   tx_bd_submit_time[WLAN_ETH_TX_NUM_BD];
+#endif
+
 // Local Function Declarations -- these are not intended to be called by functions outside of this file
 int _wlan_eth_dma_init();
 int _init_rx_bd(XAxiDma_Bd * bd_ptr, dl_entry * tqe_ptr, u32 max_transfer_len);
 void _wlan_process_all_eth_pkts(u32 schedule_id);
 void _eth_rx_interrupt_handler(void *callbarck_arg);
 void _wlan_eth_dma_update();
+#if WLAN_ETH_TX_ASYNC
+void _eth_tx_interrupt_handler(void *callback_arg);
+static inline u32 _eth_tx_bd_index(XAxiDma_Bd* bd_ptr);
+static int _eth_tx_flush(XAxiDma_BdRing* tx_ring_ptr);
+static void _eth_tx_reclaim(XAxiDma_BdRing* tx_ring_ptr);
+static int _eth_dma_recover();
+#endif
 
 
+#if WLAN_ETH_TX_ASYNC
+/*****************************************************************************/
+/**
+ * @brief Transmits a packet over Ethernet using the ETH DMA
+ *
+ * This function transmits a single packet via Ethernet using the axi_dma. The
+ * packet passed via pkt_ptr must be a valid Ethernet packet, complete with
+ * 14-byte Ethernet header. This function does not check for a valid header
+ * (i.e. the calling function must ensure this).
+ *
+ * The packet is copied into a Tx queue buffer in DRAM, so pkt_ptr may point
+ * anywhere (including the DLMB) and the caller may reuse its buffer as soon as
+ * this function returns. In the reference implementation all Ethernet
+ * transmissions start as wireless receptions, so this allows the wireless Rx
+ * packet buffer to be returned to CPU Low without waiting on the Ethernet.
+ *
+ * This function does not wait for the Ethernet transmission to complete. The
+ * BD and Tx queue buffer are reclaimed by the Tx DMA interrupt or by a later
+ * call to this function. If called between wlan_platform_ethernet_tx_batch_start()
+ * and wlan_platform_ethernet_tx_batch_end(), the packet is not handed to the
+ * DMA until the batch ends.
+ *
+ * @param u8* pkt_ptr
+ *  - Pointer to the first byte of the Ethernet header of the packet to send; valid
+ *    header must be created before calling this function
+ * @param u32 length
+ *  - Length (in bytes) of the packet to send
+ *
+ * @return 0 for successful Ethernet transmission, -1 otherwise
+ */
+int wlan_platform_ethernet_send(u8* pkt_ptr, u32 length) {
+    int status;
+    u32 bd_in_use;
+    interrupt_state_t prev_interrupt_state;
+    XAxiDma_BdRing* tx_ring_ptr;
+    XAxiDma_Bd* cur_bd_ptr = NULL;
+    dl_entry* tx_queue_entry;
+    tx_queue_buffer_t* tx_queue_buffer;
+
+    if ((length == 0) || (length > 1518)) {
+        xil_printf("ERROR: wlan_eth_dma_send length = %d\n", length);
+        return -1;
+    }
+
+    // Get pointer to the axi_dma Tx buffer descriptor ring
+    tx_ring_ptr = XAxiDma_GetTxRing(&eth_dma_instance);
+
+    // The Tx BD ring and batch state are shared with the Tx DMA interrupt
+    prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+    // Reclaim any BDs the DMA has finished with
+    _eth_tx_reclaim(tx_ring_ptr);
+
+    if (XAxiDma_BdRingGetFreeCnt(tx_ring_ptr) == 0) {
+        // Every Tx BD is in use. Submit any open batch so that the DMA can make
+        // progress, then wait for the oldest transmission to complete.
+        eth_tx_counts.num_ring_full++;
+
+        _eth_tx_flush(tx_ring_ptr);
+
+        while (XAxiDma_BdRingGetFreeCnt(tx_ring_ptr) == 0) {
+            if (tx_ring_ptr->HwCnt == 0) {
+                // Nothing in flight to wait on
+                eth_tx_counts.num_drops++;
+                wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+                return -1;
+            }
+
+            // A DMA error halts the channel, so the in-flight BDs would never complete.
+            //     NOTE:  The error bit is set in the status register even though the Tx
+            //         interrupt cannot be serviced while interrupts are stopped.
+            if (XAxiDma_BdRingGetIrq(tx_ring_ptr) & XAXIDMA_IRQ_ERROR_MASK) {
+                if (_eth_dma_recover() != 0) {
+                    eth_tx_counts.num_drops++;
+                    wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+                    return -1;
+                }
+            }
+
+            _eth_tx_reclaim(tx_ring_ptr);
+        }
+    }
+
+    // Check out a Tx queue entry to hold a copy of the packet
+    tx_queue_entry = queue_checkout();
+
+    if (tx_queue_entry == NULL) {
+        eth_tx_counts.num_drops++;
+        wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+        return -1;
+    }
+
+    tx_queue_buffer = (tx_queue_buffer_t*)(tx_queue_entry->data);
+    memcpy(tx_queue_buffer->frame, pkt_ptr, length);
+
+    // The DMA reads packet contents directly from RAM, bypassing the data cache
+    wlan_mac_high_dcache_flush(tx_queue_buffer->frame, length);
+
+    // Allocate and setup one Tx BD
+    status = XAxiDma_BdRingAlloc(tx_ring_ptr, 1, &cur_bd_ptr);
+
+    if (status != XST_SUCCESS) {
+        xil_printf("ERROR allocating ETH TX BD! Err = %d\n", status);
+        eth_tx_counts.num_drops++;
+        queue_checkin(tx_queue_entry);
+        wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+        return -1;
+    }
+
+    status  = XAxiDma_BdSetBufAddr(cur_bd_ptr, (u32)(tx_queue_buffer->frame));
+    status |= XAxiDma_BdSetLength(cur_bd_ptr, length, tx_ring_ptr->MaxTransferLen);
+
+    if (status != XST_SUCCESS) {
+        xil_printf("length = %d, max_transfer_len = %d\n", length, tx_ring_ptr->MaxTransferLen );
+        xil_printf("ERROR setting ETH TX BD! Err = %d\n", status);
+        eth_tx_counts.num_drops++;
+        XAxiDma_BdRingUnAlloc(tx_ring_ptr, 1, cur_bd_ptr);
+        queue_checkin(tx_queue_entry);
+        wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+        return -1;
+    }
+
+    // When using 1 BD for 1 pkt set both start-of-frame (SOF) and end-of-frame (EOF)
+    XAxiDma_BdSetCtrl(cur_bd_ptr, (XAXIDMA_BD_CTRL_TXSOF_MASK | XAXIDMA_BD_CTRL_TXEOF_MASK));
+
+    // Remember which Tx queue entry to check back in when this BD completes
+    XAxiDma_BdSetId(cur_bd_ptr, (u32)tx_queue_entry);
+    tx_bd_submit_time[_eth_tx_bd_index(cur_bd_ptr)] = get_system_time_usec();
+
+    // Add the BD to the current batch
+    if (tx_batch_count == 0) {
+        tx_batch_first_bd_ptr = cur_bd_ptr;
+    }
+    tx_batch_count++;
+
+    bd_in_use = num_tx_bd - XAxiDma_BdRingGetFreeCnt(tx_ring_ptr);
+    if (bd_in_use > eth_tx_counts.bd_high_water_mark) {
+        eth_tx_counts.bd_high_water_mark = bd_in_use;
+    }
+
+    // Push the BD to hardware immediately unless the caller is batching packets
+    status = 0;
+    if (tx_batch_open == 0) {
+        status = _eth_tx_flush(tx_ring_ptr);
+    }
+
+    wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+    return status;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Starts a batch of Ethernet transmissions
+ *
+ * Packets passed to wlan_platform_ethernet_send() after this call are held until
+ * wlan_platform_ethernet_tx_batch_end(), which submits them to the DMA with a
+ * single XAxiDma_BdRingToHw() call. A batch is also submitted early if the Tx BD
+ * ring fills.
+ */
+void wlan_platform_ethernet_tx_batch_start() {
+    tx_batch_open = 1;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Ends a batch of Ethernet transmissions
+ *
+ * Submits all packets held since wlan_platform_ethernet_tx_batch_start() to the DMA
+ *
+ * @return 0 on success, -1 otherwise
+ */
+int wlan_platform_ethernet_tx_batch_end() {
+    int status;
+    interrupt_state_t prev_interrupt_state;
+
+    prev_interrupt_state = wlan_mac_high_interrupt_stop();
+
+    tx_batch_open = 0;
+    status = _eth_tx_flush(XAxiDma_GetTxRing(&eth_dma_instance));
+
+    wlan_mac_high_interrupt_restore_state(prev_interrupt_state);
+
+    return status;
+}
+
+#else
+
 /*****************************************************************************/
 /**
  * @brief Transmits a packet over Ethernet using the ETH DMA
@@ -120,13 +336,8 @@ int wlan_platform_ethernet_send(u8* pkt_ptr, u32 length) {
         return -1;
     }
 
-    // IMPORTANT:  If the data cache is enabled the cache must be flushed before
-    // attempting to send a packet via the ETH DMA. The DMA will read packet
-    // contents directly from RAM, bypassing any cache checking normally done by
-    // the MicroBlaze.  The data cache is disabled by default in the reference
-    // implementation.
-    //
-    // Xil_DCacheFlushRange((u32)TxPacket, MAX_PKT_LEN);
+    // The DMA reads packet contents directly from RAM, bypassing the data cache
+    wlan_mac_high_dcache_flush(pkt_ptr, length);
 
     // Check if the user-supplied pointer is in the DLMB, unreachable by the DMA
 #pragma GCC diagnostic push
@@ -167,16 +378,57 @@ int wlan_platform_ethernet_send(u8* pkt_ptr, u32 length) {
     }
 
     // Wait for this DMA transfer to finish
-    //     !!! TODO: replace with post-Tx ISR !!!
     while (XAxiDma_BdRingFromHw(tx_ring_ptr, 1, &cur_bd_ptr) == 0) { /*Do Nothing*/ }
 
     // Free the BD for future use
     status = XAxiDma_BdRingFree(tx_ring_ptr, 1, cur_bd_ptr);
     if(status != XST_SUCCESS) {xil_printf("ERROR: TX XAxiDma_BdRingFree! Err = %d\n", status); return -1;}
 
+    eth_tx_counts.num_pkts++;
+    eth_tx_counts.num_batches++;
+    eth_tx_counts.num_pkts_reclaimed++;
+    eth_tx_counts.bd_high_water_mark = 1;
+
     return 0;
 }
 
+void wlan_platform_ethernet_tx_batch_start() {
+    // Packets are sent synchronously - nothing to batch
+}
+
+int wlan_platform_ethernet_tx_batch_end() {
+    return 0;
+}
+#endif //WLAN_ETH_TX_ASYNC
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Prints the Ethernet Tx counts
+ */
+void wlan_platform_ethernet_print_tx_counts() {
+    u32 num_tx_bd_in_use;
+
+    num_tx_bd_in_use = num_tx_bd - XAxiDma_BdRingGetFreeCnt(XAxiDma_GetTxRing(&eth_dma_instance));
+
+    xil_printf("Eth Tx Counts:\n");
+    xil_printf("  Packets:                   %d\n", eth_tx_counts.num_pkts);
+    xil_printf("  Batches:                   %d\n", eth_tx_counts.num_batches);
+    xil_printf("  Reclaimed:                 %d\n", eth_tx_counts.num_pkts_reclaimed);
+    xil_printf("  Dropped:                   %d\n", eth_tx_counts.num_drops);
+    xil_printf("  Ring full:                 %d\n", eth_tx_counts.num_ring_full);
+    xil_printf("  DMA errors:                %d\n", eth_tx_counts.num_dma_errors);
+    xil_printf("  BDs in use:                %d of %d (max %d)\n", num_tx_bd_in_use, num_tx_bd, eth_tx_counts.bd_high_water_mark);
+    if (eth_tx_counts.num_pkts_reclaimed > 0) {
+        xil_printf("  Reclaim latency:           %d usec avg (max %d)\n",
+                   (u32)(eth_tx_counts.reclaim_latency_sum / eth_tx_counts.num_pkts_reclaimed),
+                   eth_tx_counts.reclaim_latency_max);
+    }
+}
+
+
+
 int w3_wlan_platform_ethernet_init(){
 	int status = 0;
 
@@ -194,16 +446,27 @@ int w3_wlan_platform_ethernet_init(){
 	bd_high_water_mark = 0;
 #endif
 
+	bzero(&eth_tx_counts, sizeof(eth_tx_counts_t));
+
+#if WLAN_ETH_TX_ASYNC
+	tx_batch_open = 0;
+	tx_batch_count = 0;
+	tx_batch_first_bd_ptr = NULL;
+	num_tx_bd = WLAN_ETH_TX_NUM_BD;
+#else
+	num_tx_bd = 1;
+#endif
+
 	// Check to see if we were given enough room by wlan_mac_high.h for our buffer descriptors
-	// At an absolute minimum, there needs to be room for 1 Tx BD and 1 Rx BD
-	if (AUX_BRAM_ETH_BD_MEM_SIZE < (2*XAXIDMA_BD_MINIMUM_ALIGNMENT) ) {
-		xil_printf("Only %d bytes allocated for Eth Tx BD. Must be at least %d bytes\n", AUX_BRAM_ETH_BD_MEM_SIZE, 2*XAXIDMA_BD_MINIMUM_ALIGNMENT);
+	// At an absolute minimum, there needs to be room for the Tx BDs and 1 Rx BD
+	if (AUX_BRAM_ETH_BD_MEM_SIZE < ((num_tx_bd + 1)*XAXIDMA_BD_MINIMUM_ALIGNMENT) ) {
+		xil_printf("Only %d bytes allocated for Eth BDs. Must be at least %d bytes\n", AUX_BRAM_ETH_BD_MEM_SIZE, (num_tx_bd + 1)*XAXIDMA_BD_MINIMUM_ALIGNMENT);
 		wlan_platform_high_userio_disp_status(USERIO_DISP_STATUS_CPU_ERROR, WLAN_ERROR_CODE_INSUFFICIENT_BD_SIZE);
 	}
 
 	// Split up the memory set aside for us in ETH_MEM_BASE
 	gl_eth_tx_bd_mem_base = ETH_BD_MEM_BASE;
-	gl_eth_tx_bd_mem_size = XAXIDMA_BD_MINIMUM_ALIGNMENT;
+	gl_eth_tx_bd_mem_size = num_tx_bd * XAXIDMA_BD_MINIMUM_ALIGNMENT;
 	gl_eth_tx_bd_mem_high = CALC_HIGH_ADDR(gl_eth_tx_bd_mem_base, gl_eth_tx_bd_mem_size);
 	gl_eth_rx_bd_mem_base = gl_eth_tx_bd_mem_high+1;
 	gl_eth_rx_bd_mem_size = AUX_BRAM_ETH_BD_MEM_SIZE - gl_eth_tx_bd_mem_size;
@@ -211,7 +474,6 @@ int w3_wlan_platform_ethernet_init(){
 
 
 	// Initialize buffer descriptor counts
-	num_tx_bd = 1;
 	xil_printf("%3d Eth Tx BDs placed in BRAM: using %d B\n", num_tx_bd, num_tx_bd*XAXIDMA_BD_MINIMUM_ALIGNMENT);
 
 	num_rx_bd = gl_eth_rx_bd_mem_size / XAXIDMA_BD_MINIMUM_ALIGNMENT;
@@ -277,6 +539,18 @@ int w3_wlan_platform_ethernet_setup_interrupt(XIntc* intc){
 
     XIntc_Enable(intc, WLAN_ETH_RX_INTR_ID);
 
+#if WLAN_ETH_TX_ASYNC
+    // Connect the axi_dma Tx interrupt used to reclaim completed Tx BDs
+    status = XIntc_Connect(intc, WLAN_ETH_TX_INTR_ID, (XInterruptHandler)_eth_tx_interrupt_handler, XAxiDma_GetTxRing(&eth_dma_instance));
+
+    if (status != XST_SUCCESS) {
+        xil_printf("ERROR: Failed to connect axi_dma Tx interrupt: (%d)\n", status);
+        return XST_FAILURE;
+    }
+
+    XIntc_Enable(intc, WLAN_ETH_TX_INTR_ID);
+#endif
+
     return 0;
 }
 
@@ -338,8 +612,14 @@ int _wlan_eth_dma_init() {
     XAxiDma_BdRingIntDisable(eth_rx_ring_ptr, XAXIDMA_IRQ_ALL_MASK);
 
     // Disable delays and coalescing by default
-    //      NOTE:  We observed no performance increase with interrupt coalescing
+    //      NOTE:  We observed no performance increase with interrupt coalescing on Rx. Tx
+    //          completions only reclaim BDs / buffers, so they are coalesced; the delay
+    //          timer reclaims the tail of a burst.
+#if WLAN_ETH_TX_ASYNC
+    XAxiDma_BdRingSetCoalesce(eth_tx_ring_ptr, WLAN_ETH_TX_COALESCE_COUNT, WLAN_ETH_TX_COALESCE_DELAY);
+#else
     XAxiDma_BdRingSetCoalesce(eth_tx_ring_ptr, 1, 0);
+#endif
     XAxiDma_BdRingSetCoalesce(eth_rx_ring_ptr, 1, 0);
 
     // Setup Tx/Rx buffer descriptor rings in memory
@@ -394,6 +674,9 @@ int _wlan_eth_dma_init() {
 
     // Enable Interrupts
     XAxiDma_BdRingIntEnable(eth_rx_ring_ptr, XAXIDMA_IRQ_ALL_MASK);
+#if WLAN_ETH_TX_ASYNC
+    XAxiDma_BdRingIntEnable(eth_tx_ring_ptr, XAXIDMA_IRQ_ALL_MASK);
+#endif
 
     status |= XAxiDma_BdRingStart(eth_rx_ring_ptr);
     if (status != XST_SUCCESS) { xil_printf("Error in XAxiDma BdRingToHw/BdRingStart! Err = %d\n", status); return -1; }
@@ -441,6 +724,9 @@ int _init_rx_bd(XAxiDma_Bd * bd_ptr, dl_entry * tqe_ptr, u32 max_transfer_len) {
     // Rx BD's don't need control flags before use; DMA populates these post-Rx
     XAxiDma_BdSetCtrl(bd_ptr, 0);
 
+    // Make sure no dirty line of the buffer can be evicted over the frame the DMA writes
+    wlan_mac_high_dcache_flush(buf_addr, WLAN_ETH_PKT_BUF_SIZE);
+
     return 0;
 }
 
@@ -548,6 +834,8 @@ void _wlan_process_all_eth_pkts(u32 schedule_id) {
         eth_rx_len = XAxiDma_BdGetActualLength(bd_set_to_process_ptr, rx_ring_ptr->MaxTransferLen);
         eth_rx_buf = XAxiDma_BdGetBufAddr(bd_set_to_process_ptr);
 
+        // The DMA wrote the packet directly to RAM; discard any stale cached copy
+        wlan_mac_high_dcache_invalidate(eth_rx_buf, eth_rx_len);
 
     	// The start of the MPDU is before the first byte of the DMA transfer. We can work our way backwards from this point.
     	mpdu_start_ptr = (void*)( (u8*)eth_rx_buf - ETH_PAYLOAD_OFFSET );
@@ -756,6 +1044,221 @@ void _wlan_eth_dma_update() {
 #endif
 }
 
+#if WLAN_ETH_TX_ASYNC
+/*****************************************************************************/
+/**
+ * @brief Interrupt handler for ETH DMA transmissions
+ *
+ * @param void* callback_arg
+ *  - Argument passed in by interrupt controller (pointer to axi_dma Tx BD ring for Eth Tx)
+ */
+void _eth_tx_interrupt_handler(void *callback_arg) {
+    XAxiDma_BdRing* tx_ring_ptr = (XAxiDma_BdRing*) callback_arg;
+    u32 tx_irq_status;
+
+    tx_irq_status = XAxiDma_BdRingGetIrq(tx_ring_ptr);
+    XAxiDma_BdRingAckIrq(tx_ring_ptr, tx_irq_status);
+
+    if (!(tx_irq_status & XAXIDMA_IRQ_ERROR_MASK)) {
+        _eth_tx_reclaim(tx_ring_ptr);
+    } else {
+        _eth_dma_recover();
+    }
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Recovers the ETH DMA from a Tx DMA error
+ *
+ * The axi_dma halts a channel on a DMA error and only a reset clears the error.
+ * Resetting either channel resets the whole DMA engine, so both BD rings are torn
+ * down: the Tx queue buffer of every outstanding Tx and Rx BD is checked back in
+ * and the DMA is re-initialized with fresh Rx buffers. Packets in flight, or
+ * received but not yet processed, are dropped.
+ *
+ * Must be called with interrupts stopped (or from the Tx ISR).
+ *
+ * @return 0 on success, -1 otherwise
+ */
+static int _eth_dma_recover() {
+    int status;
+    u32 i;
+    u32 bd_count;
+    u32 eth_rx_buf;
+    XAxiDma_BdRing* tx_ring_ptr;
+    XAxiDma_BdRing* rx_ring_ptr;
+    XAxiDma_Bd* cur_bd_ptr;
+    tx_queue_buffer_t* tx_queue_buffer;
+    dl_list checkin;
+
+    tx_ring_ptr = XAxiDma_GetTxRing(&eth_dma_instance);
+    rx_ring_ptr = XAxiDma_GetRxRing(&eth_dma_instance);
+
+    eth_tx_counts.num_dma_errors++;
+    xil_printf("ERROR: ETH Tx DMA error (status 0x%08x) - resetting the ETH DMA\n",
+               XAxiDma_ReadReg(tx_ring_ptr->ChanBase, XAXIDMA_SR_OFFSET));
+
+    // Stop the DMA from interrupting while the rings are rebuilt
+    XAxiDma_BdRingIntDisable(tx_ring_ptr, XAXIDMA_IRQ_ALL_MASK);
+    XAxiDma_BdRingIntDisable(rx_ring_ptr, XAXIDMA_IRQ_ALL_MASK);
+
+    dl_list_init(&checkin);
+
+    // Every Tx BD that is not free holds a Tx queue buffer in its ID field
+    //     NOTE:  The BDs that are not free are contiguous in the ring starting at
+    //         the post-processing group (post -> hw -> pre-processing).
+    bd_count   = num_tx_bd - XAxiDma_BdRingGetFreeCnt(tx_ring_ptr);
+    cur_bd_ptr = tx_ring_ptr->PostHead;
+
+    for (i = 0; i < bd_count; i++) {
+        dl_entry_insertEnd(&checkin, (dl_entry*)XAxiDma_BdGetId(cur_bd_ptr));
+        cur_bd_ptr = XAxiDma_BdRingNext(tx_ring_ptr, cur_bd_ptr);
+    }
+
+    eth_tx_counts.num_drops += bd_count;
+    tx_batch_count           = 0;
+    tx_batch_first_bd_ptr    = NULL;
+
+    // Every Rx BD that is not free points into a Tx queue buffer (see _init_rx_bd())
+    bd_count   = num_rx_bd - XAxiDma_BdRingGetFreeCnt(rx_ring_ptr);
+    cur_bd_ptr = rx_ring_ptr->PostHead;
+
+    for (i = 0; i < bd_count; i++) {
+        eth_rx_buf      = XAxiDma_BdGetBufAddr(cur_bd_ptr);
+        tx_queue_buffer = (tx_queue_buffer_t*)((u8*)eth_rx_buf - ETH_PAYLOAD_OFFSET - offsetof(tx_queue_buffer_t, frame));
+
+        dl_entry_insertEnd(&checkin, tx_queue_buffer->tx_queue_entry);
+        cur_bd_ptr = XAxiDma_BdRingNext(rx_ring_ptr, cur_bd_ptr);
+    }
+
+    // Drop any receptions waiting on _wlan_process_all_eth_pkts(); it handles bd_set_count = 0
+    bd_set_count          = 0;
+    bd_set_to_process_ptr = NULL;
+
+    queue_checkin_list(&checkin);
+
+    // Reset the DMA and rebuild both BD rings
+    status = _wlan_eth_dma_init();
+
+    if (status != 0) {
+        xil_printf("ERROR: Unable to re-initialize the ETH DMA\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Returns the index of a Tx BD within the Tx BD ring
+ */
+static inline u32 _eth_tx_bd_index(XAxiDma_Bd* bd_ptr) {
+    return ((u32)bd_ptr - gl_eth_tx_bd_mem_base) / XAXIDMA_BD_MINIMUM_ALIGNMENT;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Submits the current batch of Tx BDs to the DMA
+ *
+ * Must be called with interrupts stopped. If the DMA rejects the batch, its
+ * BDs are un-allocated and their Tx queue buffers checked back in.
+ *
+ * @param XAxiDma_BdRing* tx_ring_ptr
+ *  - Pointer to the axi_dma Tx BD ring
+ *
+ * @return 0 on success, -1 otherwise
+ */
+static int _eth_tx_flush(XAxiDma_BdRing* tx_ring_ptr) {
+    int status;
+    u32 i;
+    XAxiDma_Bd* cur_bd_ptr;
+
+    if (tx_batch_count == 0) { return 0; }
+
+    // Push the BDs to hardware; this initiates the actual DMA transfers and Ethernet Tx
+    status = XAxiDma_BdRingToHw(tx_ring_ptr, tx_batch_count, tx_batch_first_bd_ptr);
+
+    if (status != XST_SUCCESS) {
+        xil_printf("ERROR: TX XAxiDma_BdRingToHw! Err = %d\n", status);
+
+        cur_bd_ptr = tx_batch_first_bd_ptr;
+        for (i = 0; i < tx_batch_count; i++) {
+            queue_checkin((dl_entry*)XAxiDma_BdGetId(cur_bd_ptr));
+            cur_bd_ptr = XAxiDma_BdRingNext(tx_ring_ptr, cur_bd_ptr);
+        }
+        XAxiDma_BdRingUnAlloc(tx_ring_ptr, tx_batch_count, tx_batch_first_bd_ptr);
+
+        eth_tx_counts.num_drops += tx_batch_count;
+        tx_batch_count = 0;
+        return -1;
+    }
+
+    eth_tx_counts.num_pkts += tx_batch_count;
+    eth_tx_counts.num_batches++;
+    tx_batch_count = 0;
+
+    return 0;
+}
+
+
+
+/*****************************************************************************/
+/**
+ * @brief Reclaims completed Tx BDs
+ *
+ * Frees every Tx BD the DMA has finished with and checks its Tx queue buffer
+ * back in. Must be called with interrupts stopped (or from the Tx ISR).
+ *
+ * @param XAxiDma_BdRing* tx_ring_ptr
+ *  - Pointer to the axi_dma Tx BD ring
+ */
+static void _eth_tx_reclaim(XAxiDma_BdRing* tx_ring_ptr) {
+    int status;
+    u32 i;
+    u32 bd_count;
+    u32 latency;
+    u64 curr_time;
+    XAxiDma_Bd* first_bd_ptr;
+    XAxiDma_Bd* cur_bd_ptr;
+    dl_list checkin;
+
+    bd_count = XAxiDma_BdRingFromHw(tx_ring_ptr, XAXIDMA_ALL_BDS, &first_bd_ptr);
+
+    if (bd_count == 0) { return; }
+
+    dl_list_init(&checkin);
+    curr_time  = get_system_time_usec();
+    cur_bd_ptr = first_bd_ptr;
+
+    for (i = 0; i < bd_count; i++) {
+        latency = (u32)(curr_time - tx_bd_submit_time[_eth_tx_bd_index(cur_bd_ptr)]);
+
+        eth_tx_counts.reclaim_latency_sum += latency;
+        if (latency > eth_tx_counts.reclaim_latency_max) {
+            eth_tx_counts.reclaim_latency_max = latency;
+        }
+
+        dl_entry_insertEnd(&checkin, (dl_entry*)XAxiDma_BdGetId(cur_bd_ptr));
+        cur_bd_ptr = XAxiDma_BdRingNext(tx_ring_ptr, cur_bd_ptr);
+    }
+
+    status = XAxiDma_BdRingFree(tx_ring_ptr, bd_count, first_bd_ptr);
+    if (status != XST_SUCCESS) { xil_printf("ERROR: TX XAxiDma_BdRingFree! Err = %d\n", status); }
+
+    eth_tx_counts.num_pkts_reclaimed += bd_count;
+
+    // Return the Tx queue buffers to the free pool and give them to any Rx BDs waiting on one
+    queue_checkin_list(&checkin);
+    _wlan_eth_dma_update();
+}
+#endif //WLAN_ETH_TX_ASYNC
+
 
 #endif //WLAN_SW_CONFIG_ENABLE_ETH_BRIDGE
 
@@ -14,6 +14,14 @@
 #include "wlan_exp_common.h"
 #include "wlan_exp_node.h"
 
+#if WLAN_SW_CONFIG_ENABLE_DCACHE
+// The D-cache must not cover the peripherals or the packet buffers shared with CPU Low;
+// only DRAM is given cache maintenance around DMA transfers.
+#if (XPAR_MB_HIGH_DCACHE_BASEADDR < DRAM_BASEADDR)
+#error "WLAN_SW_CONFIG_ENABLE_DCACHE requires the mb_high D-cache address range to start at DRAM_BASEADDR"
+#endif
+#endif
+
 static const platform_high_dev_info_t w3_platform_high_dev_info = {
 		.dlmb_baseaddr = DLMB_BASEADDR,
 		.dlmb_size = DLMB_HIGHADDR - DLMB_BASEADDR + 1,
@@ -27,6 +35,7 @@ static const platform_high_dev_info_t w3_platform_high_dev_info = {
 		.timer_dev_id = PLATFORM_DEV_ID_TIMER,
 		.timer_int_id = PLATFORM_INT_ID_TIMER,
 		.timer_freq = TIMER_FREQ,
+		.cpu_freq = CPU_FREQ,
 		.cdma_dev_id = PLATFORM_DEV_ID_CMDA,
 		.mailbox_int_id = PLATFORM_INT_ID_MAILBOX,
 		.wlan_exp_eth_mac_dev_id = WLAN_EXP_ETH_MAC_ID,